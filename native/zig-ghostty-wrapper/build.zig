@@ -111,6 +111,22 @@ fn addVtDeps(
     }
 }
 
+/// The wrapper compiles search patterns itself, against the same
+/// oniguruma build the ghostty module links.
+fn addOnigurumaImport(
+    b: *std.Build,
+    module: *std.Build.Module,
+    target: std.Build.ResolvedTarget,
+    optimize: std.builtin.OptimizeMode,
+) void {
+    if (b.lazyDependency("oniguruma", .{
+        .target = target,
+        .optimize = optimize,
+    })) |dep| {
+        module.addImport("oniguruma", dep.module("oniguruma"));
+    }
+}
+
 fn addSimdDeps(
     b: *std.Build,
     module: *std.Build.Module,
@@ -246,6 +262,7 @@ pub fn build(b: *std.Build) !void {
     });
 
     lib.root_module.addImport("ghostty", ghostty_module);
+    addOnigurumaImport(b, lib.root_module, target, optimize);
     lib.installHeadersDirectory(
         b.path("include/zig-ghostty-wrapper"),
         "zig-ghostty-wrapper",
@@ -264,6 +281,7 @@ pub fn build(b: *std.Build) !void {
     });
 
     main_tests.root_module.addImport("ghostty", ghostty_module);
+    addOnigurumaImport(b, main_tests.root_module, target, optimize);
 
     const run_tests = b.addRunArtifact(main_tests);
     const test_step = b.step("test", "Run unit tests");
@@ -13,6 +13,7 @@
  *   3. Each frame:
  *      - ghostty_render_state_update(term)
  *      - ghostty_render_state_get_viewport(term, buffer, size)
+ *        (or ghostty_render_state_get_dirty_rows for partial updates)
  *      - Render the buffer
  *      - ghostty_render_state_mark_clean(term)
  *   4. Free: ghostty_terminal_free(term)
@@ -82,6 +83,28 @@ typedef struct {
     int32_t z;
 } GhosttyKittyPlacement;
 
+/** Result header of ghostty_terminal_get_kitty_snapshot - 16 bytes */
+typedef struct {
+    uint64_t generation;
+    uint32_t image_count;
+    uint32_t placement_count;
+} GhosttyKittySnapshot;
+
+/** Search match - 8 bytes. Columns are cell columns; end_col is exclusive. */
+typedef struct {
+    uint32_t line;     /* 0 = oldest scrollback line, scrollback length = first active row */
+    uint16_t start_col;
+    uint16_t end_col;
+} GhosttySearchMatch;
+
+/** Search resume point - 8 bytes. Zero-initialize to start a search. */
+typedef struct {
+    uint32_t line;
+    uint16_t col;
+    uint8_t done;      /* Set once the last row has been searched */
+    uint8_t _pad;
+} GhosttySearchCursor;
+
 /** Cell structure - 16 bytes, pre-resolved colors */
 typedef struct {
     uint32_t codepoint;
@@ -104,6 +127,25 @@ typedef struct {
 #define GHOSTTY_CELL_BLINK         (1 << 6)
 #define GHOSTTY_CELL_FAINT         (1 << 7)
 
+/** Compact cell - 8 bytes, colors and flags via the style table */
+typedef struct {
+    uint32_t codepoint;
+    uint16_t style;        /* Index into the GhosttyCellStyle table */
+    uint8_t width;
+    uint8_t grapheme_len;
+} GhosttyCompactCell;
+
+/** Resolved style shared by compact cells - 8 bytes */
+typedef struct {
+    uint8_t fg_r, fg_g, fg_b;
+    uint8_t bg_r, bg_g, bg_b;
+    uint8_t flags;         /* GHOSTTY_CELL_* */
+    uint8_t attrs;         /* GHOSTTY_STYLE_* */
+} GhosttyCellStyle;
+
+/** Style attributes */
+#define GHOSTTY_STYLE_HYPERLINK    (1 << 0)
+
 /** Dirty state */
 typedef enum {
     GHOSTTY_DIRTY_NONE = 0,
@@ -143,6 +185,43 @@ void ghostty_terminal_set_pixel_size(GhosttyTerminal term, int width_px, int hei
 /** Write data to terminal (parses VT sequences) */
 void ghostty_terminal_write(GhosttyTerminal term, const uint8_t* data, size_t len);
 
+/* ============================================================================
+ * Output Pre-filter - single pass over PTY output before it is written
+ *
+ * Reports the sequences the host handles itself (titles, cwd, notifications,
+ * sync mode, ED 3, kitty APCs, focus tracking, queries) so host-side stages
+ * only run on chunks that need them. State carries across chunks.
+ * ========================================================================= */
+
+/** Opaque pre-filter handle (independent of any terminal) */
+typedef void* GhosttyPrefilter;
+
+/** Summary flags returned by ghostty_prefilter_scan */
+#define GHOSTTY_PREFILTER_HAS_OSC            (1 << 0)
+#define GHOSTTY_PREFILTER_HAS_TITLE          (1 << 1)
+#define GHOSTTY_PREFILTER_HAS_CWD            (1 << 2)
+#define GHOSTTY_PREFILTER_HAS_NOTIFICATION   (1 << 3)
+#define GHOSTTY_PREFILTER_HAS_SYNC           (1 << 4)
+#define GHOSTTY_PREFILTER_HAS_ERASE_SCROLLBACK (1 << 5)
+#define GHOSTTY_PREFILTER_HAS_KITTY          (1 << 6)
+#define GHOSTTY_PREFILTER_HAS_KITTY_QUERY    (1 << 7)
+#define GHOSTTY_PREFILTER_HAS_FOCUS_TRACKING (1 << 8)
+#define GHOSTTY_PREFILTER_FOCUS_ENABLED      (1 << 9)
+#define GHOSTTY_PREFILTER_HAS_QUERY          (1 << 10)
+#define GHOSTTY_PREFILTER_PENDING            (1 << 11)
+
+/** Create a pre-filter, or NULL on allocation failure */
+GhosttyPrefilter ghostty_prefilter_new(void);
+
+/** Free a pre-filter */
+void ghostty_prefilter_free(GhosttyPrefilter filter);
+
+/**
+ * Scan a chunk of PTY output.
+ * @return Summary flags (GHOSTTY_PREFILTER_*)
+ */
+uint32_t ghostty_prefilter_scan(GhosttyPrefilter filter, const uint8_t* data, size_t len);
+
 /* ============================================================================
  * RenderState API - High-performance rendering
  * ========================================================================= */
@@ -180,6 +259,48 @@ int ghostty_render_state_get_viewport(
     size_t buffer_size
 );
 
+/**
+ * Get only the dirty rows in one call (every row when fully dirty).
+ * Row indices are written to out_rows; the cells of each row (cols cells per
+ * row) are packed into out_cells in the same order.
+ * @param out_rows Buffer to receive row indices
+ * @param rows_size Size of out_rows in elements (rows is always enough)
+ * @param out_cells Buffer to receive cells
+ * @param cells_size Size of out_cells in cells (rows * cols is always enough)
+ * @return Number of rows written, or -1 on error
+ */
+int ghostty_render_state_get_dirty_rows(
+    GhosttyTerminal term,
+    uint32_t* out_rows,
+    size_t rows_size,
+    GhosttyCell* out_cells,
+    size_t cells_size
+);
+
+/**
+ * Get viewport rows as compact cells plus a table of resolved styles.
+ * Cells with identical colors, flags and hyperlink state share one style
+ * entry, so the copy is about half the size of GhosttyCell data.
+ * @param dirty_only Only export dirty rows (all rows when fully dirty)
+ * @param out_rows Buffer to receive row indices (rows elements is enough)
+ * @param out_cells Buffer to receive cols cells per exported row
+ * @param out_styles Buffer to receive the style table
+ * @param styles_size Size of out_styles in elements (rows * cols + 1 is enough)
+ * @param out_style_count Receives the number of styles written
+ * @return Number of rows written, or -1 on error (including more than 65536 styles)
+ */
+int ghostty_render_state_get_viewport_compact(
+    GhosttyTerminal term,
+    bool dirty_only,
+    uint32_t* out_rows,
+    size_t rows_size,
+    GhosttyCompactCell* out_cells,
+    size_t cells_size,
+    GhosttyCellStyle* out_styles,
+    size_t styles_size,
+    uint32_t* out_style_count
+);
+
 /**
  * Get grapheme codepoints for a cell at (row, col).
  * For cells with grapheme_len > 0, this returns all codepoints that make up
@@ -265,6 +386,112 @@ int ghostty_terminal_get_scrollback_grapheme(
 /** Check if a row is a continuation from previous row (soft-wrapped) */
 bool ghostty_terminal_is_row_wrapped(GhosttyTerminal term, int y);
 
+/**
+ * Check if a scrollback line soft-wraps into the next line.
+ * @param offset Scrollback line offset (0 = oldest)
+ */
+bool ghostty_terminal_is_scrollback_row_wrapped(GhosttyTerminal term, int offset);
+
+/**
+ * Export the oldest scrollback lines as compact cells plus a style table,
+ * the same format as ghostty_render_state_get_viewport_compact. Used to
+ * spill history to disk in batches.
+ * @param max_rows Maximum number of lines to export (oldest first)
+ * @param out_cells Buffer to receive cols cells per exported line
+ * @param out_styles Buffer to receive the style table
+ * @param styles_size Size of out_styles in elements (rows * cols + 1 is enough)
+ * @param out_style_count Receives the number of styles written
+ * @param out_wrapped Receives 1 per line that soft-wraps into the next, else 0
+ * @return Number of lines written, or -1 on error (including more than 65536 styles)
+ */
+int ghostty_terminal_get_scrollback_compact(
+    GhosttyTerminal term,
+    uint32_t max_rows,
+    GhosttyCompactCell* out_cells,
+    size_t cells_size,
+    GhosttyCellStyle* out_styles,
+    size_t styles_size,
+    uint32_t* out_style_count,
+    uint8_t* out_wrapped
+);
+
+/* ============================================================================
+ * Search API - literal text search over scrollback and the active area
+ * ========================================================================= */
+
+/** Search flags */
+#define GHOSTTY_SEARCH_CASE_INSENSITIVE (1 << 0) /* ASCII and Latin-1 folding */
+
+/**
+ * Search for a codepoint sequence, reading rows straight from the page list.
+ * Wide-character spacer cells are skipped and empty cells match spaces.
+ * Matches are reported in order starting at the cursor; when the buffer
+ * fills, the cursor is left on the next unreported match so the call can
+ * be repeated. cursor->done is set once the last row has been searched.
+ * @param query Query codepoints
+ * @param buffer_size Size of buffer in GhosttySearchMatch entries
+ * @param max_rows Rows to scan before returning (0 = unlimited); the cursor
+ *                 is left on the next row so the call can resume
+ * @return Number of matches written, or -1 on error
+ */
+int ghostty_terminal_search(
+    GhosttyTerminal term,
+    const uint32_t* query,
+    size_t query_len,
+    uint32_t flags,
+    GhosttySearchCursor* cursor,
+    GhosttySearchMatch* out_buffer,
+    size_t buffer_size,
+    uint32_t max_rows
+);
+
+/** Opaque compiled search pattern (independent of any terminal) */
+typedef void* GhosttyRegex;
+
+/** Regex compile flags */
+#define GHOSTTY_REGEX_CASE_INSENSITIVE (1 << 0)
+
+/** Compile a UTF-8 pattern (Oniguruma syntax), or NULL if it is invalid */
+GhosttyRegex ghostty_regex_new(const uint8_t* pattern, size_t len, uint32_t flags);
+
+/** Free a compiled pattern */
+void ghostty_regex_free(GhosttyRegex regex);
+
+/**
+ * Search with a compiled pattern. Soft-wrapped rows are joined into one
+ * logical line before matching; a match crossing a wrap point is reported
+ * once per row it covers. Cursor semantics match ghostty_terminal_search.
+ * @param max_rows Rows to scan before returning (0 = unlimited); the cursor
+ *                 is left on the next logical line so the call can resume
+ * @return Number of matches written, or -1 on error
+ */
+int ghostty_terminal_search_regex(
+    GhosttyTerminal term,
+    GhosttyRegex regex,
+    GhosttySearchCursor* cursor,
+    GhosttySearchMatch* out_buffer,
+    size_t buffer_size,
+    uint32_t max_rows
+);
+
+/**
+ * Search UTF-8 text the caller has already joined into one logical line
+ * (e.g. archived scrollback) with a compiled pattern.
+ * @param from       Byte offset to start matching at
+ * @param out_ranges Receives [start, end) byte offsets of non-empty matches,
+ *                   two entries per match
+ * @param max_ranges Matches that fit in out_ranges; resume from the last end
+ * @return Number of matches written, or -1 on error
+ */
+int ghostty_regex_search_text(
+    GhosttyRegex regex,
+    const uint8_t* text,
+    size_t len,
+    size_t from,
+    uint32_t* out_ranges,
+    size_t max_ranges
+);
+
 /* ============================================================================
  * Response API - for DSR and other terminal queries
  * ========================================================================= */
@@ -348,6 +575,27 @@ int ghostty_terminal_get_kitty_placements(
     size_t buffer_size
 );
 
+/**
+ * Get the active screen's kitty image infos and placements in one call.
+ * Changes (the dirty flag, or a screen switch) are first folded into a
+ * monotonic generation counter; this consumes the dirty flag, so don't mix
+ * it with ghostty_terminal_clear_kitty_images_dirty.
+ * @param since_generation Generation the caller last synced (0 = never)
+ * @param out_snapshot Receives the generation and the list lengths
+ * @return 1 if both lists were written, 0 if the generation is unchanged
+ *         (nothing written), or -1 if a buffer is too small (out_snapshot
+ *         holds the required counts; retry with larger buffers)
+ */
+int ghostty_terminal_get_kitty_snapshot(
+    GhosttyTerminal term,
+    uint64_t since_generation,
+    GhosttyKittyImageInfo* out_images,
+    size_t images_size,
+    GhosttyKittyPlacement* out_placements,
+    size_t placements_size,
+    GhosttyKittySnapshot* out_snapshot
+);
+
 #ifdef __cplusplus
 }
 #endif
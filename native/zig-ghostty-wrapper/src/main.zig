@@ -12,6 +12,11 @@ comptime {
     @export(&terminal.write, .{ .name = "ghostty_terminal_write" });
     @export(&terminal.trimScrollback, .{ .name = "ghostty_terminal_trim_scrollback" });
 
+    // Output pre-filter
+    @export(&terminal.prefilterNew, .{ .name = "ghostty_prefilter_new" });
+    @export(&terminal.prefilterFree, .{ .name = "ghostty_prefilter_free" });
+    @export(&terminal.prefilterScan, .{ .name = "ghostty_prefilter_scan" });
+
     // Render state API
     @export(&terminal.renderStateUpdate, .{ .name = "ghostty_render_state_update" });
     @export(&terminal.renderStateGetCols, .{ .name = "ghostty_render_state_get_cols" });
@@ -24,6 +29,8 @@ comptime {
     @export(&terminal.renderStateIsRowDirty, .{ .name = "ghostty_render_state_is_row_dirty" });
     @export(&terminal.renderStateMarkClean, .{ .name = "ghostty_render_state_mark_clean" });
     @export(&terminal.renderStateGetViewport, .{ .name = "ghostty_render_state_get_viewport" });
+    @export(&terminal.renderStateGetDirtyRows, .{ .name = "ghostty_render_state_get_dirty_rows" });
+    @export(&terminal.renderStateGetViewportCompact, .{ .name = "ghostty_render_state_get_viewport_compact" });
     @export(&terminal.renderStateGetGrapheme, .{ .name = "ghostty_render_state_get_grapheme" });
 
     // Terminal modes
@@ -37,6 +44,15 @@ comptime {
     @export(&terminal.getScrollbackLine, .{ .name = "ghostty_terminal_get_scrollback_line" });
     @export(&terminal.getScrollbackGrapheme, .{ .name = "ghostty_terminal_get_scrollback_grapheme" });
     @export(&terminal.isRowWrapped, .{ .name = "ghostty_terminal_is_row_wrapped" });
+    @export(&terminal.isScrollbackRowWrapped, .{ .name = "ghostty_terminal_is_scrollback_row_wrapped" });
+    @export(&terminal.getScrollbackCompact, .{ .name = "ghostty_terminal_get_scrollback_compact" });
+
+    // Search
+    @export(&terminal.search, .{ .name = "ghostty_terminal_search" });
+    @export(&terminal.regexNew, .{ .name = "ghostty_regex_new" });
+    @export(&terminal.regexFree, .{ .name = "ghostty_regex_free" });
+    @export(&terminal.searchRegex, .{ .name = "ghostty_terminal_search_regex" });
+    @export(&terminal.regexSearchText, .{ .name = "ghostty_regex_search_text" });
 
     // Responses
     @export(&terminal.hasResponse, .{ .name = "ghostty_terminal_has_response" });
@@ -51,6 +67,7 @@ comptime {
     @export(&terminal.copyKittyImageData, .{ .name = "ghostty_terminal_copy_kitty_image_data" });
     @export(&terminal.getKittyPlacementCount, .{ .name = "ghostty_terminal_get_kitty_placement_count" });
     @export(&terminal.getKittyPlacements, .{ .name = "ghostty_terminal_get_kitty_placements" });
+    @export(&terminal.getKittySnapshot, .{ .name = "ghostty_terminal_get_kitty_snapshot" });
 
     // Key event
     @export(&key_event.new, .{ .name = "ghostty_key_event_new" });
@@ -6,6 +6,8 @@
 //!
 //! API Design:
 //! - Lifecycle: new, free, resize, write
+//! - Pre-filter: single-pass scan of PTY output before it reaches write
+//! - Search: literal and regex search over scrollback and the active area
 //! - Rendering: render_state_update, render_state_get_viewport, etc.
 //!
 //! The RenderState approach means:
@@ -20,12 +22,20 @@ const modes = @import("terminal/modes.zig");
 const scrollback = @import("terminal/scrollback.zig");
 const response = @import("terminal/response.zig");
 const kitty_graphics = @import("terminal/kitty_graphics.zig");
+const prefilter = @import("terminal/prefilter.zig");
+const text_search = @import("terminal/search.zig");
+const regex = @import("terminal/regex.zig");
 
 pub const GhosttyCell = types.GhosttyCell;
+pub const GhosttyCompactCell = types.GhosttyCompactCell;
+pub const GhosttyCellStyle = types.GhosttyCellStyle;
 pub const GhosttyDirty = types.GhosttyDirty;
 pub const GhosttyTerminalConfig = types.GhosttyTerminalConfig;
 pub const GhosttyKittyImageInfo = types.GhosttyKittyImageInfo;
 pub const GhosttyKittyPlacement = types.GhosttyKittyPlacement;
+pub const GhosttyKittySnapshot = types.GhosttyKittySnapshot;
+pub const GhosttySearchMatch = types.GhosttySearchMatch;
+pub const GhosttySearchCursor = types.GhosttySearchCursor;
 
 pub const new = lifecycle.new;
 pub const newWithConfig = lifecycle.newWithConfig;
@@ -35,6 +45,10 @@ pub const setPixelSize = lifecycle.setPixelSize;
 pub const write = lifecycle.write;
 pub const trimScrollback = lifecycle.trimScrollback;
 
+pub const prefilterNew = prefilter.new;
+pub const prefilterFree = prefilter.free;
+pub const prefilterScan = prefilter.scan;
+
 pub const renderStateUpdate = render_state.renderStateUpdate;
 pub const renderStateGetCols = render_state.renderStateGetCols;
 pub const renderStateGetRows = render_state.renderStateGetRows;
@@ -46,6 +60,8 @@ pub const renderStateGetFgColor = render_state.renderStateGetFgColor;
 pub const renderStateIsRowDirty = render_state.renderStateIsRowDirty;
 pub const renderStateMarkClean = render_state.renderStateMarkClean;
 pub const renderStateGetViewport = render_state.renderStateGetViewport;
+pub const renderStateGetDirtyRows = render_state.renderStateGetDirtyRows;
+pub const renderStateGetViewportCompact = render_state.renderStateGetViewportCompact;
 pub const renderStateGetGrapheme = render_state.renderStateGetGrapheme;
 
 pub const isAlternateScreen = modes.isAlternateScreen;
@@ -57,6 +73,14 @@ pub const getScrollbackLength = scrollback.getScrollbackLength;
 pub const getScrollbackLine = scrollback.getScrollbackLine;
 pub const getScrollbackGrapheme = scrollback.getScrollbackGrapheme;
 pub const isRowWrapped = scrollback.isRowWrapped;
+pub const isScrollbackRowWrapped = scrollback.isScrollbackRowWrapped;
+pub const getScrollbackCompact = scrollback.getScrollbackCompact;
+
+pub const search = text_search.search;
+pub const regexNew = regex.new;
+pub const regexFree = regex.free;
+pub const searchRegex = regex.search;
+pub const regexSearchText = regex.searchText;
 
 pub const hasResponse = response.hasResponse;
 pub const readResponse = response.readResponse;
@@ -69,3 +93,4 @@ pub const getKittyImageInfo = kitty_graphics.getKittyImageInfo;
 pub const copyKittyImageData = kitty_graphics.copyKittyImageData;
 pub const getKittyPlacementCount = kitty_graphics.getKittyPlacementCount;
 pub const getKittyPlacements = kitty_graphics.getKittyPlacements;
+pub const getKittySnapshot = kitty_graphics.getKittySnapshot;
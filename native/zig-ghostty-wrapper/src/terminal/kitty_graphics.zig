@@ -6,6 +6,7 @@ const types = @import("types.zig");
 const TerminalWrapper = state.TerminalWrapper;
 const GhosttyKittyImageInfo = types.GhosttyKittyImageInfo;
 const GhosttyKittyPlacement = types.GhosttyKittyPlacement;
+const GhosttyKittySnapshot = types.GhosttyKittySnapshot;
 
 const is_posix_clock = switch (builtin.os.tag) {
     .windows, .uefi, .wasi => false,
@@ -66,9 +67,13 @@ pub fn getKittyImageInfo(
     const wrapper: *const TerminalWrapper = @ptrCast(@alignCast(ptr orelse return false));
     const storage = &wrapper.terminal.screens.active.kitty_images;
     const img = storage.imageById(image_id) orelse return false;
-    const data_len = std.math.cast(u32, img.data.len) orelse return false;
+    out.* = imageInfo(img) orelse return false;
+    return true;
+}
 
-    out.* = .{
+fn imageInfo(img: anytype) ?GhosttyKittyImageInfo {
+    const data_len = std.math.cast(u32, img.data.len) orelse return null;
+    return .{
         .id = img.id,
         .number = img.number,
         .width = img.width,
@@ -79,8 +84,6 @@ pub fn getKittyImageInfo(
         .implicit_id = if (img.implicit_id) 1 else 0,
         .transmit_time = instantToNanos(img.transmit_time),
     };
-
-    return true;
 }
 
 pub fn copyKittyImageData(
@@ -100,6 +103,71 @@ pub fn copyKittyImageData(
 
 pub fn getKittyPlacementCount(ptr: ?*anyopaque) callconv(.c) c_int {
     const wrapper: *const TerminalWrapper = @ptrCast(@alignCast(ptr orelse return 0));
+    const count = countPlacements(wrapper);
+    return std.math.cast(c_int, count) orelse return 0;
+}
+
+pub fn getKittyPlacements(
+    ptr: ?*anyopaque,
+    out: [*]GhosttyKittyPlacement,
+    buf_size: usize,
+) callconv(.c) c_int {
+    const wrapper: *const TerminalWrapper = @ptrCast(@alignCast(ptr orelse return -1));
+    const written = writePlacements(wrapper, out, buf_size) orelse return -1;
+    return std.math.cast(c_int, written) orelse return -1;
+}
+
+/// Export the active screen's image infos and placements in one call.
+/// Pending kitty changes (the dirty flag, or a screen switch) are folded
+/// into a generation counter first, consuming the dirty flag. When the
+/// generation equals since_generation nothing is written and 0 is
+/// returned; otherwise both lists are written and 1 is returned. -1 means
+/// a buffer was too small: out holds the required counts and the
+/// generation, so the caller can grow its buffers and retry.
+pub fn getKittySnapshot(
+    ptr: ?*anyopaque,
+    since_generation: u64,
+    out_images: [*]GhosttyKittyImageInfo,
+    images_size: usize,
+    out_placements: [*]GhosttyKittyPlacement,
+    placements_size: usize,
+    out: *GhosttyKittySnapshot,
+) callconv(.c) c_int {
+    const wrapper: *TerminalWrapper = @ptrCast(@alignCast(ptr orelse return -1));
+    const generation = kittyGeneration(wrapper);
+    out.* = .{ .generation = generation, .image_count = 0, .placement_count = 0 };
+    if (generation == since_generation) return 0;
+
+    const storage = &wrapper.terminal.screens.active.kitty_images;
+    const image_count = storage.images.count();
+    const placement_count = countPlacements(wrapper);
+    out.image_count = std.math.cast(u32, image_count) orelse return -1;
+    out.placement_count = std.math.cast(u32, placement_count) orelse return -1;
+    if (images_size < image_count or placements_size < placement_count) return -1;
+
+    var idx: usize = 0;
+    var it = storage.images.iterator();
+    while (it.next()) |entry| {
+        out_images[idx] = imageInfo(entry.value_ptr.*) orelse continue;
+        idx += 1;
+    }
+    out.image_count = @intCast(idx);
+    out.placement_count = @intCast(writePlacements(wrapper, out_placements, placements_size) orelse return -1);
+    return 1;
+}
+
+fn kittyGeneration(wrapper: *TerminalWrapper) u64 {
+    const storage = &wrapper.terminal.screens.active.kitty_images;
+    const alternate = wrapper.terminal.screens.active_key == .alternate;
+    if (storage.dirty or alternate != wrapper.kitty_alternate) {
+        wrapper.kitty_generation += 1;
+        wrapper.kitty_alternate = alternate;
+        storage.dirty = false;
+    }
+    return wrapper.kitty_generation;
+}
+
+fn countPlacements(wrapper: *const TerminalWrapper) usize {
     const storage = &wrapper.terminal.screens.active.kitty_images;
     var count: usize = 0;
 
@@ -114,16 +182,14 @@ pub fn getKittyPlacementCount(ptr: ?*anyopaque) callconv(.c) c_int {
             .virtual => {},
         }
     }
-
-    return std.math.cast(c_int, count) orelse return 0;
+    return count;
 }
 
-pub fn getKittyPlacements(
-    ptr: ?*anyopaque,
+fn writePlacements(
+    wrapper: *const TerminalWrapper,
     out: [*]GhosttyKittyPlacement,
     buf_size: usize,
-) callconv(.c) c_int {
-    const wrapper: *const TerminalWrapper = @ptrCast(@alignCast(ptr orelse return -1));
+) ?usize {
     const storage = &wrapper.terminal.screens.active.kitty_images;
     const pages = &wrapper.terminal.screens.active.pages;
 
@@ -138,7 +204,7 @@ pub fn getKittyPlacements(
         // Pins moved to top-left after scrollback pruning are invalid for placements.
         if (pin.garbage) continue;
 
-        if (idx >= buf_size) return -1;
+        if (idx >= buf_size) return null;
 
         const pt = pages.pointFromPin(.screen, pin.*) orelse continue;
         const coord = pt.coord();
@@ -165,5 +231,5 @@ pub fn getKittyPlacements(
         idx += 1;
     }
 
-    return std.math.cast(c_int, idx) orelse return -1;
+    return idx;
 }
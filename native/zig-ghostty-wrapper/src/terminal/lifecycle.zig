@@ -188,6 +188,7 @@ pub fn free(ptr: ?*anyopaque) callconv(.c) void {
     wrapper.stream.deinit();
     wrapper.response_buffer.deinit(alloc);
     wrapper.render_state.deinit(alloc);
+    wrapper.style_index.deinit(alloc);
     wrapper.terminal.deinit(alloc);
     alloc.destroy(wrapper);
 }
@@ -0,0 +1,498 @@
+//! Streaming pre-filter for PTY output.
+//!
+//! A single pass over the raw bytes reports the escape sequences the host
+//! pipeline cares about (titles, cwd, notifications, sync mode, ED 3, kitty
+//! APCs, focus tracking and terminal queries), so the host only runs its own
+//! stages on chunks that actually need them. Parser state carries across
+//! chunks; plain text and string payloads are skipped with vectorized scalar
+//! searches for the few bytes that can change state.
+
+const std = @import("std");
+const builtin = @import("builtin");
+
+const Allocator = std.mem.Allocator;
+
+/// Summary flags returned by scan()
+pub const scan_flag = struct {
+    /// Chunk contains any part of an OSC sequence
+    pub const osc: u32 = 1 << 0;
+    pub const title: u32 = 1 << 1;
+    pub const cwd: u32 = 1 << 2;
+    pub const notification: u32 = 1 << 3;
+    pub const sync: u32 = 1 << 4;
+    pub const erase_scrollback: u32 = 1 << 5;
+    /// Chunk contains any part of a kitty graphics APC
+    pub const kitty: u32 = 1 << 6;
+    pub const kitty_query: u32 = 1 << 7;
+    pub const focus_tracking: u32 = 1 << 8;
+    /// Last focus tracking change in the chunk enabled it
+    pub const focus_enabled: u32 = 1 << 9;
+    pub const query: u32 = 1 << 10;
+    /// Chunk ends inside an escape sequence
+    pub const pending: u32 = 1 << 11;
+};
+
+const ESC: u8 = 0x1b;
+const BEL: u8 = 0x07;
+const C1_LEAD: u8 = 0xc2;
+const C1_DCS: u8 = 0x90;
+const C1_CSI: u8 = 0x9b;
+const C1_ST: u8 = 0x9c;
+const C1_OSC: u8 = 0x9d;
+const C1_APC: u8 = 0x9f;
+
+const max_params = 16;
+const max_param_value = 99_999;
+const no_match: u8 = 0xff;
+
+const State = enum(u8) {
+    ground,
+    escape,
+    /// 0xC2 was the last byte of a chunk; resume in `c1_return`
+    c1_lead,
+    csi,
+    osc,
+    dcs,
+    apc_start,
+    apc,
+    kitty,
+    /// ESC inside a string; resume in `string_state` unless ST follows
+    string_esc,
+};
+
+/// Cached forward search for one byte value. Positions only move forward
+/// within a scan, so each byte value is searched at most once per chunk.
+const Finder = struct {
+    data: []const u8,
+    byte: u8,
+    pos: usize = 0,
+    searched: bool = false,
+
+    fn find(self: *Finder, from: usize) usize {
+        if (!self.searched or self.pos < from) {
+            self.pos = std.mem.indexOfScalarPos(u8, self.data, from, self.byte) orelse self.data.len;
+            self.searched = true;
+        }
+        return self.pos;
+    }
+};
+
+pub const Prefilter = struct {
+    state: State = .ground,
+    c1_return: State = .ground,
+    string_state: State = .ground,
+
+    // CSI
+    csi_len: u32 = 0,
+    csi_private: u8 = 0,
+    csi_intermediate: u8 = 0,
+    params: [max_params]u32 = undefined,
+    param_count: u8 = 0,
+    param_value: u32 = 0,
+    param_started: bool = false,
+
+    // OSC
+    osc_in_code: bool = true,
+    osc_code: u32 = 0,
+    osc_has_digits: bool = false,
+    osc_invalid: bool = false,
+    osc_query: bool = false,
+    osc_last: u8 = 0,
+
+    // Kitty APC control data
+    kitty_in_ctrl: bool = false,
+    kitty_match: u8 = 0,
+    kitty_query: bool = false,
+
+    // Summary of the chunk being scanned
+    summary: u32 = 0,
+
+    /// Scan one chunk and return its summary flags.
+    pub fn scan(self: *Prefilter, data: []const u8) u32 {
+        self.summary = 0;
+        if (self.state != .ground) {
+            self.summary |= touchFlags(self.activeString());
+        }
+
+        var esc = Finder{ .data = data, .byte = ESC };
+        var lead = Finder{ .data = data, .byte = C1_LEAD };
+        var bel = Finder{ .data = data, .byte = BEL };
+
+        const len = data.len;
+        var i: usize = 0;
+        while (i < len) {
+            switch (self.state) {
+                .ground => {
+                    i = @min(esc.find(i), lead.find(i));
+                    if (i >= len) break;
+                    if (data[i] == ESC) {
+                        self.state = .escape;
+                        i += 1;
+                    } else if (i + 1 >= len) {
+                        self.c1_return = .ground;
+                        self.state = .c1_lead;
+                        i += 1;
+                    } else if (self.enterC1(data[i + 1])) {
+                        i += 2;
+                    } else {
+                        i += 1;
+                    }
+                },
+                .escape => {
+                    const b = data[i];
+                    switch (b) {
+                        '[' => self.enterCsi(),
+                        ']' => self.enterOsc(),
+                        'P' => self.state = .dcs,
+                        '_' => self.state = .apc_start,
+                        // Another ESC restarts the sequence
+                        ESC => {},
+                        else => {
+                            self.state = .ground;
+                            // A C1 introducer right after ESC starts its own sequence
+                            if (b == C1_LEAD) continue;
+                        },
+                    }
+                    i += 1;
+                },
+                .c1_lead => {
+                    const b = data[i];
+                    if (self.c1_return == .ground) {
+                        if (self.enterC1(b)) {
+                            i += 1;
+                        } else {
+                            self.state = .ground;
+                        }
+                    } else if (b == C1_ST) {
+                        self.finishString(self.c1_return);
+                        i += 1;
+                    } else {
+                        self.state = self.c1_return;
+                        self.consumeBody(&[_]u8{C1_LEAD});
+                    }
+                },
+                .csi => {
+                    self.csiByte(data[i]);
+                    i += 1;
+                },
+                .apc_start => {
+                    if (data[i] == 'G') {
+                        self.enterKitty();
+                        i += 1;
+                    } else {
+                        self.state = .apc;
+                    }
+                },
+                .osc, .dcs, .apc, .kitty => {
+                    var stop = @min(esc.find(i), lead.find(i));
+                    if (self.state == .osc) stop = @min(stop, bel.find(i));
+                    if (stop > i) self.consumeBody(data[i..stop]);
+                    i = stop;
+                    if (i >= len) break;
+
+                    const b = data[i];
+                    if (b == BEL) {
+                        self.finishString(.osc);
+                        i += 1;
+                    } else if (b == ESC) {
+                        self.string_state = self.state;
+                        self.state = .string_esc;
+                        i += 1;
+                    } else if (i + 1 >= len) {
+                        self.c1_return = self.state;
+                        self.state = .c1_lead;
+                        i += 1;
+                    } else if (data[i + 1] == C1_ST) {
+                        self.finishString(self.state);
+                        i += 2;
+                    } else {
+                        self.consumeBody(data[i .. i + 1]);
+                        i += 1;
+                    }
+                },
+                .string_esc => {
+                    if (data[i] == '\\') {
+                        self.finishString(self.string_state);
+                        i += 1;
+                    } else {
+                        // ESC aborts the string and starts a new sequence
+                        self.state = .escape;
+                    }
+                },
+            }
+        }
+
+        if (self.state != .ground) {
+            self.summary |= scan_flag.pending;
+            if (self.activeString() == .kitty and self.kitty_query) {
+                self.summary |= scan_flag.kitty_query;
+            }
+        }
+
+        return self.summary;
+    }
+
+    /// String state the scanner is inside of (through ESC / C1 lead detours)
+    fn activeString(self: *const Prefilter) State {
+        return switch (self.state) {
+            .string_esc => self.string_state,
+            .c1_lead => self.c1_return,
+            else => self.state,
+        };
+    }
+
+    fn touchFlags(state: State) u32 {
+        return switch (state) {
+            .osc => scan_flag.osc,
+            .kitty => scan_flag.kitty,
+            else => 0,
+        };
+    }
+
+    fn enterC1(self: *Prefilter, b: u8) bool {
+        switch (b) {
+            C1_CSI => self.enterCsi(),
+            C1_OSC => self.enterOsc(),
+            C1_DCS => self.state = .dcs,
+            C1_APC => self.state = .apc_start,
+            else => return false,
+        }
+        return true;
+    }
+
+    fn enterCsi(self: *Prefilter) void {
+        self.state = .csi;
+        self.csi_len = 0;
+        self.csi_private = 0;
+        self.csi_intermediate = 0;
+        self.param_count = 0;
+        self.param_value = 0;
+        self.param_started = false;
+    }
+
+    fn enterOsc(self: *Prefilter) void {
+        self.state = .osc;
+        self.osc_in_code = true;
+        self.osc_code = 0;
+        self.osc_has_digits = false;
+        self.osc_invalid = false;
+        self.osc_query = false;
+        self.osc_last = 0;
+        self.summary |= scan_flag.osc;
+    }
+
+    fn enterKitty(self: *Prefilter) void {
+        self.state = .kitty;
+        self.kitty_in_ctrl = true;
+        self.kitty_match = 0;
+        self.kitty_query = false;
+        self.summary |= scan_flag.kitty;
+    }
+
+    fn pushParam(self: *Prefilter) void {
+        if (self.param_count < max_params) {
+            self.params[self.param_count] = self.param_value;
+            self.param_count += 1;
+        }
+        self.param_value = 0;
+        self.param_started = false;
+    }
+
+    fn csiByte(self: *Prefilter, b: u8) void {
+        defer self.csi_len += 1;
+        switch (b) {
+            '0'...'9' => {
+                if (self.param_value < max_param_value) {
+                    self.param_value = self.param_value * 10 + (b - '0');
+                }
+                self.param_started = true;
+            },
+            ';', ':' => self.pushParam(),
+            '<'...'?' => {
+                if (self.csi_len == 0) self.csi_private = b;
+            },
+            0x20...0x2f => self.csi_intermediate = b,
+            0x40...0x7e => {
+                if (self.param_started or self.param_count > 0) self.pushParam();
+                self.state = .ground;
+                self.dispatchCsi(b);
+            },
+            ESC => self.state = .escape,
+            else => {},
+        }
+    }
+
+    fn dispatchCsi(self: *Prefilter, final: u8) void {
+        const private = self.csi_private;
+        const intermediate = self.csi_intermediate;
+        const params = self.params[0..self.param_count];
+        switch (final) {
+            'h', 'l' => {
+                if (private != '?' or intermediate != 0) return;
+                const set = final == 'h';
+                for (params) |param| {
+                    switch (param) {
+                        2026 => self.summary |= scan_flag.sync,
+                        1004 => {
+                            self.summary |= scan_flag.focus_tracking;
+                            if (set) {
+                                self.summary |= scan_flag.focus_enabled;
+                            } else {
+                                self.summary &= ~scan_flag.focus_enabled;
+                            }
+                        },
+                        else => {},
+                    }
+                }
+            },
+            'J' => {
+                if (private != 0 or intermediate != 0) return;
+                for (params) |param| {
+                    if (param == 3) {
+                        self.summary |= scan_flag.erase_scrollback;
+                        return;
+                    }
+                }
+            },
+            else => {
+                const is_query = switch (final) {
+                    // DSR / DECXCPR
+                    'n' => private == 0 or private == '?',
+                    // DA1 / DA2 / DA3
+                    'c' => private == 0 or private == '>' or private == '=',
+                    // XTVERSION
+                    'q' => private == '>',
+                    // DECRQM
+                    'p' => intermediate == '$',
+                    // Kitty keyboard flags
+                    'u' => private == '?',
+                    // XTWINOPS
+                    't' => private == 0,
+                    else => false,
+                };
+                if (is_query) self.summary |= scan_flag.query;
+            },
+        }
+    }
+
+    fn consumeBody(self: *Prefilter, body: []const u8) void {
+        switch (self.state) {
+            .osc => self.oscBody(body),
+            .kitty => self.kittyBody(body),
+            else => {},
+        }
+    }
+
+    fn oscBody(self: *Prefilter, body: []const u8) void {
+        var rest = body;
+        while (self.osc_in_code and rest.len > 0) {
+            const b = rest[0];
+            rest = rest[1..];
+            switch (b) {
+                '0'...'9' => {
+                    if (self.osc_code < max_param_value) {
+                        self.osc_code = self.osc_code * 10 + (b - '0');
+                    }
+                    self.osc_has_digits = true;
+                },
+                ';' => self.osc_in_code = false,
+                else => {
+                    self.osc_in_code = false;
+                    self.osc_invalid = true;
+                },
+            }
+            self.osc_last = b;
+        }
+        if (rest.len == 0) return;
+
+        if (!self.osc_query) {
+            if (self.osc_last == ';' and rest[0] == '?') {
+                self.osc_query = true;
+            } else if (std.mem.indexOf(u8, rest, ";?") != null) {
+                self.osc_query = true;
+            }
+        }
+        self.osc_last = rest[rest.len - 1];
+    }
+
+    fn kittyBody(self: *Prefilter, body: []const u8) void {
+        for (body) |b| {
+            if (!self.kitty_in_ctrl) return;
+            switch (b) {
+                ',' => {
+                    if (self.kitty_match == 3) self.kitty_query = true;
+                    self.kitty_match = 0;
+                },
+                ';' => {
+                    if (self.kitty_match == 3) self.kitty_query = true;
+                    self.kitty_in_ctrl = false;
+                },
+                else => {
+                    // Match the key/value pair "a=q" at the start of a key
+                    const expected: u8 = switch (self.kitty_match) {
+                        0 => 'a',
+                        1 => '=',
+                        2 => 'q',
+                        else => 0,
+                    };
+                    self.kitty_match = if (expected != 0 and b == expected) self.kitty_match + 1 else no_match;
+                },
+            }
+        }
+    }
+
+    fn finishString(self: *Prefilter, kind: State) void {
+        self.state = .ground;
+        switch (kind) {
+            .osc => self.finishOsc(),
+            .dcs => self.summary |= scan_flag.query,
+            .kitty => {
+                if (self.kitty_in_ctrl and self.kitty_match == 3) self.kitty_query = true;
+                if (self.kitty_query) self.summary |= scan_flag.kitty_query;
+            },
+            else => {},
+        }
+    }
+
+    fn finishOsc(self: *Prefilter) void {
+        if (self.osc_has_digits and !self.osc_invalid) {
+            switch (self.osc_code) {
+                0, 1, 2 => self.summary |= scan_flag.title,
+                7 => self.summary |= scan_flag.cwd,
+                9, 777 => self.summary |= scan_flag.notification,
+                else => {},
+            }
+        }
+        if (self.osc_query or (self.osc_has_digits and !self.osc_invalid and self.osc_code == 66)) {
+            self.summary |= scan_flag.query;
+        }
+    }
+};
+
+// ============================================================================
+// C API
+// ============================================================================
+
+fn allocator() Allocator {
+    return if (builtin.target.cpu.arch.isWasm())
+        std.heap.wasm_allocator
+    else
+        std.heap.c_allocator;
+}
+
+pub fn new() callconv(.c) ?*anyopaque {
+    const prefilter = allocator().create(Prefilter) catch return null;
+    prefilter.* = .{};
+    return @ptrCast(prefilter);
+}
+
+pub fn free(ptr: ?*anyopaque) callconv(.c) void {
+    const prefilter: *Prefilter = @ptrCast(@alignCast(ptr orelse return));
+    allocator().destroy(prefilter);
+}
+
+/// Scan a chunk of PTY output. Returns summary flags (0 on null handle).
+pub fn scan(ptr: ?*anyopaque, data: [*]const u8, len: usize) callconv(.c) u32 {
+    const prefilter: *Prefilter = @ptrCast(@alignCast(ptr orelse return 0));
+    return prefilter.scan(data[0..len]);
+}
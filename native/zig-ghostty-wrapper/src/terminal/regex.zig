@@ -0,0 +1,320 @@
+//! Regex search over logical lines.
+//!
+//! Patterns are compiled once with Oniguruma into a handle the host keeps
+//! for the lifetime of a query. Searching joins soft-wrapped rows into one
+//! logical line so patterns match across wrap points, runs the compiled
+//! pattern over its UTF-8 text, and maps each match back to per-row cell
+//! spans. A match that crosses a wrap point is reported once per row.
+//! Text the host joins itself (archived scrollback) is searched with the
+//! same handle and reported as byte ranges.
+
+const std = @import("std");
+const builtin = @import("builtin");
+const oni = @import("oniguruma");
+const state = @import("state.zig");
+const types = @import("types.zig");
+
+const Allocator = std.mem.Allocator;
+const TerminalWrapper = state.TerminalWrapper;
+const GhosttySearchMatch = types.GhosttySearchMatch;
+const GhosttySearchCursor = types.GhosttySearchCursor;
+
+/// Compile flags (ghostty_regex_new `flags`)
+pub const flag = struct {
+    pub const case_insensitive: u32 = 1 << 0;
+};
+
+const Regex = struct {
+    alloc: Allocator,
+    regex: oni.Regex,
+};
+
+var init_once = std.once(initOniguruma);
+var init_ok = false;
+
+fn initOniguruma() void {
+    oni.init(&.{oni.Encoding.utf8}) catch return;
+    init_ok = true;
+}
+
+/// Cell span of one codepoint (plus any grapheme extenders) in a logical line.
+const Span = struct {
+    byte: u32,
+    line: u32,
+    start_col: u16,
+    end_col: u16,
+};
+
+/// Soft-wrapped rows joined into one UTF-8 string.
+const LogicalLine = struct {
+    text: std.ArrayList(u8) = .empty,
+    spans: std.ArrayList(Span) = .empty,
+
+    fn deinit(self: *LogicalLine, alloc: Allocator) void {
+        self.text.deinit(alloc);
+        self.spans.deinit(alloc);
+    }
+
+    fn clear(self: *LogicalLine) void {
+        self.text.clearRetainingCapacity();
+        self.spans.clearRetainingCapacity();
+    }
+
+    /// Append one row. Trailing empty cells are dropped unless the row
+    /// wraps, so `$` anchors at the last written cell.
+    fn appendRow(self: *LogicalLine, alloc: Allocator, pin: anytype, line: u32, wraps: bool) !void {
+        const cells = pin.cells(.all);
+        const page = pin.node.data;
+
+        var used = cells.len;
+        if (!wraps) {
+            while (used > 0 and cells[used - 1].codepoint() == 0) used -= 1;
+        }
+
+        for (cells[0..used], 0..) |*cell, x| {
+            const width: usize = switch (cell.wide) {
+                .narrow => 1,
+                .wide => 2,
+                .spacer_tail, .spacer_head => continue,
+            };
+            try self.spans.append(alloc, .{
+                .byte = @intCast(self.text.items.len),
+                .line = line,
+                .start_col = @intCast(x),
+                .end_col = @intCast(@min(x + width, cells.len)),
+            });
+
+            const cp = cell.codepoint();
+            try self.appendCodepoint(alloc, if (cp == 0) ' ' else cp);
+            if (cell.hasGrapheme()) {
+                if (page.lookupGrapheme(cell)) |extra| {
+                    for (extra) |extra_cp| try self.appendCodepoint(alloc, extra_cp);
+                }
+            }
+        }
+    }
+
+    fn appendCodepoint(self: *LogicalLine, alloc: Allocator, cp: u32) !void {
+        var buf: [4]u8 = undefined;
+        const scalar = std.math.cast(u21, cp) orelse std.unicode.replacement_character;
+        const len = std.unicode.utf8Encode(scalar, &buf) catch
+            std.unicode.utf8Encode(std.unicode.replacement_character, &buf) catch unreachable;
+        try self.text.appendSlice(alloc, buf[0..len]);
+    }
+
+    /// Index of the span containing `byte`.
+    fn spanAt(self: *const LogicalLine, byte: usize) usize {
+        const spans = self.spans.items;
+        var lo: usize = 0;
+        var hi: usize = spans.len;
+        while (hi - lo > 1) {
+            const mid = lo + (hi - lo) / 2;
+            if (spans[mid].byte <= byte) lo = mid else hi = mid;
+        }
+        return lo;
+    }
+};
+
+/// Writes matches to the caller's buffer, skipping those before the
+/// resume point and parking the cursor on the first one that doesn't fit.
+const Emitter = struct {
+    out: [*]GhosttySearchMatch,
+    buf_size: usize,
+    count: usize = 0,
+    resume_line: u32,
+    resume_col: u16,
+    cursor: *GhosttySearchCursor,
+
+    /// Returns false once the buffer is full.
+    fn push(self: *Emitter, line: u32, start_col: u16, end_col: u16) bool {
+        if (line < self.resume_line or (line == self.resume_line and start_col < self.resume_col)) {
+            return true;
+        }
+        if (self.count >= self.buf_size) {
+            self.cursor.* = .{ .line = line, .col = start_col, .done = 0 };
+            return false;
+        }
+        self.out[self.count] = .{ .line = line, .start_col = start_col, .end_col = end_col };
+        self.count += 1;
+        return true;
+    }
+
+    /// Report byte range [start, end) of a logical line, one match per row.
+    fn pushRange(self: *Emitter, logical: *const LogicalLine, start: usize, end: usize) bool {
+        const spans = logical.spans.items;
+        const first = logical.spanAt(start);
+        const last = logical.spanAt(end - 1);
+        var seg = first;
+        for (first..last + 1) |i| {
+            if (i == last or spans[i + 1].line != spans[seg].line) {
+                if (!self.push(spans[seg].line, spans[seg].start_col, spans[i].end_col)) return false;
+                seg = i + 1;
+            }
+        }
+        return true;
+    }
+};
+
+const Match = struct { start: usize, end: usize };
+
+/// First non-empty match in `text` at or after byte `from`, or null.
+fn nextMatch(handle: *Regex, text: []const u8, from: usize, region: *oni.Region) !?Match {
+    var pos = from;
+    while (pos < text.len) {
+        _ = handle.regex.searchAdvanced(text, pos, text.len, region, .{}) catch |err| switch (err) {
+            error.Mismatch => return null,
+            else => return err,
+        };
+        const start: usize = @intCast(region.starts()[0]);
+        const end: usize = @intCast(region.ends()[0]);
+        if (end > start) return .{ .start = start, .end = end };
+        // Empty match: step over one codepoint
+        if (start >= text.len) return null;
+        pos = start + (std.unicode.utf8ByteSequenceLength(text[start]) catch 1);
+    }
+    return null;
+}
+
+// ============================================================================
+// C API
+// ============================================================================
+
+fn allocator() Allocator {
+    return if (builtin.target.cpu.arch.isWasm())
+        std.heap.wasm_allocator
+    else
+        std.heap.c_allocator;
+}
+
+/// Compile a UTF-8 pattern. Returns null if the pattern is invalid.
+pub fn new(pattern: [*]const u8, len: usize, flags: u32) callconv(.c) ?*anyopaque {
+    init_once.call();
+    if (!init_ok) return null;
+
+    const alloc = allocator();
+    const handle = alloc.create(Regex) catch return null;
+    const regex = oni.Regex.init(
+        pattern[0..len],
+        .{ .ignorecase = flags & flag.case_insensitive != 0 },
+        oni.Encoding.utf8,
+        oni.Syntax.default,
+        null,
+    ) catch {
+        alloc.destroy(handle);
+        return null;
+    };
+    handle.* = .{ .alloc = alloc, .regex = regex };
+    return @ptrCast(handle);
+}
+
+pub fn free(ptr: ?*anyopaque) callconv(.c) void {
+    const handle: *Regex = @ptrCast(@alignCast(ptr orelse return));
+    const alloc = handle.alloc;
+    handle.regex.deinit();
+    alloc.destroy(handle);
+}
+
+/// Search scrollback and the active area with a compiled pattern.
+/// Cursor semantics match ghostty_terminal_search. At most `max_rows` rows
+/// (0 = unlimited) are scanned per call; when the budget runs out the
+/// cursor is left at the next logical line with `done` unset.
+/// Returns the number of matches written, or -1 on error.
+pub fn search(
+    ptr: ?*anyopaque,
+    regex_ptr: ?*anyopaque,
+    cursor: *GhosttySearchCursor,
+    out: [*]GhosttySearchMatch,
+    buf_size: usize,
+    max_rows: u32,
+) callconv(.c) c_int {
+    const wrapper: *const TerminalWrapper = @ptrCast(@alignCast(ptr orelse return -1));
+    const handle: *Regex = @ptrCast(@alignCast(regex_ptr orelse return -1));
+    if (cursor.done != 0) return 0;
+
+    const pages = &wrapper.terminal.screens.active.pages;
+    var pin = pages.pin(.{ .screen = .{ .y = @intCast(cursor.line) } }) orelse {
+        cursor.done = 1;
+        return 0;
+    };
+
+    // Resume from the start of the logical line holding the cursor
+    var line = cursor.line;
+    while (pin.rowAndCell().row.wrap_continuation) {
+        pin = pin.up(1) orelse break;
+        line -= 1;
+    }
+
+    const alloc = wrapper.alloc;
+    var logical: LogicalLine = .{};
+    defer logical.deinit(alloc);
+    var region: oni.Region = .{};
+    defer region.deinit();
+
+    var emitter: Emitter = .{
+        .out = out,
+        .buf_size = buf_size,
+        .resume_line = cursor.line,
+        .resume_col = cursor.col,
+        .cursor = cursor,
+    };
+    var rows: u32 = 0;
+
+    while (true) {
+        logical.clear();
+        while (true) {
+            const wraps = pin.rowAndCell().row.wrap;
+            logical.appendRow(alloc, pin, line, wraps) catch return -1;
+            rows += 1;
+            if (!wraps) break;
+            pin = pin.down(1) orelse break;
+            line += 1;
+        }
+
+        const text = logical.text.items;
+        var pos: usize = 0;
+        while (nextMatch(handle, text, pos, &region) catch return -1) |match| {
+            if (!emitter.pushRange(&logical, match.start, match.end)) return @intCast(emitter.count);
+            pos = match.end;
+        }
+
+        const next = pin.down(1) orelse break;
+        if (max_rows != 0 and rows >= max_rows) {
+            cursor.* = .{ .line = line + 1, .col = 0, .done = 0 };
+            return @intCast(emitter.count);
+        }
+        pin = next;
+        line += 1;
+    }
+
+    cursor.* = .{ .line = line + 1, .col = 0, .done = 1 };
+    return @intCast(emitter.count);
+}
+
+/// Search UTF-8 `text` that the host has already joined into a logical
+/// line (e.g. archived scrollback). Non-empty matches at or after byte
+/// `from` are written to `out` as [start, end) byte offset pairs, at most
+/// `max_ranges` of them; call again from the last end to resume.
+/// Returns the number of ranges written, or -1 on error.
+pub fn searchText(
+    regex_ptr: ?*anyopaque,
+    text: [*]const u8,
+    len: usize,
+    from: usize,
+    out: [*]u32,
+    max_ranges: usize,
+) callconv(.c) c_int {
+    const handle: *Regex = @ptrCast(@alignCast(regex_ptr orelse return -1));
+    var region: oni.Region = .{};
+    defer region.deinit();
+
+    var count: usize = 0;
+    var pos = from;
+    while (count < max_ranges) {
+        const match = (nextMatch(handle, text[0..len], pos, &region) catch return -1) orelse break;
+        out[count * 2] = @intCast(match.start);
+        out[count * 2 + 1] = @intCast(match.end);
+        count += 1;
+        pos = match.end;
+    }
+    return @intCast(count);
+}
@@ -8,6 +8,8 @@ const RenderState = ghostty.RenderState;
 const Style = ghostty.Style;
 const color = ghostty.color;
 const GhosttyCell = types.GhosttyCell;
+const GhosttyCompactCell = types.GhosttyCompactCell;
+const GhosttyCellStyle = types.GhosttyCellStyle;
 const GhosttyDirty = types.GhosttyDirty;
 
 /// Update render state from terminal. Call once per frame.
@@ -111,117 +113,283 @@ pub fn renderStateGetViewport(
 ) callconv(.c) c_int {
     const wrapper: *const TerminalWrapper = @ptrCast(@alignCast(ptr orelse return -1));
     const rs = &wrapper.render_state;
-    const t = &wrapper.terminal;
     const rows = rs.rows;
-    const cols = rs.cols;
+    const cols: usize = rs.cols;
     const total: usize = @as(usize, rows) * cols;
 
     if (buf_size < total) return -1;
 
-    // Read directly from terminal's active screen, bypassing RenderState cache.
-    // This ensures we always get fresh data for ALL rows, not just dirty ones.
-    const pages = &t.screens.active.pages;
-
-    var idx: usize = 0;
     for (0..rows) |y| {
-        // Get the row from the active viewport
-        const pin = pages.pin(.{ .active = .{ .y = @intCast(y) } }) orelse {
-            // Row doesn't exist, fill with defaults
-            for (0..cols) |_| {
-                out[idx] = .{
-                    .codepoint = 0,
-                    .fg_r = rs.colors.foreground.r,
-                    .fg_g = rs.colors.foreground.g,
-                    .fg_b = rs.colors.foreground.b,
-                    .bg_r = rs.colors.background.r,
-                    .bg_g = rs.colors.background.g,
-                    .bg_b = rs.colors.background.b,
-                    .flags = 0,
-                    .width = 1,
-                    .hyperlink_id = 0,
-                };
-                idx += 1;
+        const start = y * cols;
+        writeRowCells(wrapper, y, out[start .. start + cols]);
+    }
+
+    return @intCast(total);
+}
+
+/// Get only the rows marked dirty since the last mark_clean, in one call.
+/// Row indices go to out_rows; each row's cols cells are packed into out_cells
+/// in the same order. Every row is reported when the render state is fully dirty.
+/// Returns the number of rows written, or -1 on error (including short buffers).
+pub fn renderStateGetDirtyRows(
+    ptr: ?*anyopaque,
+    out_rows: [*]u32,
+    rows_size: usize,
+    out_cells: [*]GhosttyCell,
+    cells_size: usize,
+) callconv(.c) c_int {
+    const wrapper: *const TerminalWrapper = @ptrCast(@alignCast(ptr orelse return -1));
+    const rs = &wrapper.render_state;
+    const cols: usize = rs.cols;
+
+    if (rs.dirty == .false) return 0;
+
+    const all = rs.dirty == .full;
+    const dirty_flags = rs.row_data.items(.dirty);
+
+    var count: usize = 0;
+    for (0..rs.rows) |y| {
+        if (!all and (y >= dirty_flags.len or !dirty_flags[y])) continue;
+        if (count >= rows_size or (count + 1) * cols > cells_size) return -1;
+
+        out_rows[count] = @intCast(y);
+        const start = count * cols;
+        writeRowCells(wrapper, y, out_cells[start .. start + cols]);
+        count += 1;
+    }
+
+    return @intCast(count);
+}
+
+/// Get viewport rows in the compact format: 8-byte cells that index a
+/// per-call table of resolved styles, so repeated colors are sent once.
+/// With dirty_only, only rows marked dirty are written (all rows when fully
+/// dirty); otherwise every row is. Row indices go to out_rows and each row's
+/// cols cells are packed into out_cells in the same order.
+/// Returns the number of rows written and stores the style count in
+/// out_style_count, or -1 on error (short buffers or more than 65536 styles).
+pub fn renderStateGetViewportCompact(
+    ptr: ?*anyopaque,
+    dirty_only: bool,
+    out_rows: [*]u32,
+    rows_size: usize,
+    out_cells: [*]GhosttyCompactCell,
+    cells_size: usize,
+    out_styles: [*]GhosttyCellStyle,
+    styles_size: usize,
+    out_style_count: *u32,
+) callconv(.c) c_int {
+    const wrapper: *TerminalWrapper = @ptrCast(@alignCast(ptr orelse return -1));
+    const rs = &wrapper.render_state;
+    const cols: usize = rs.cols;
+
+    out_style_count.* = 0;
+    if (dirty_only and rs.dirty == .false) return 0;
+
+    const all = !dirty_only or rs.dirty == .full;
+    const dirty_flags = rs.row_data.items(.dirty);
+
+    wrapper.style_index.clearRetainingCapacity();
+    var table: StyleTable = .{
+        .alloc = wrapper.alloc,
+        .index = &wrapper.style_index,
+        .out = out_styles[0..styles_size],
+    };
+
+    var count: usize = 0;
+    for (0..rs.rows) |y| {
+        if (!all and (y >= dirty_flags.len or !dirty_flags[y])) continue;
+        if (count >= rows_size or (count + 1) * cols > cells_size) return -1;
+
+        out_rows[count] = @intCast(y);
+        const start = count * cols;
+        writeRowCompact(wrapper, y, out_cells[start .. start + cols], &table) catch return -1;
+        count += 1;
+    }
+
+    out_style_count.* = @intCast(table.count);
+    return @intCast(count);
+}
+
+/// Interns resolved styles for one compact export.
+pub const StyleTable = struct {
+    alloc: std.mem.Allocator,
+    index: *std.AutoHashMapUnmanaged(u64, u16),
+    out: []GhosttyCellStyle,
+    count: usize = 0,
+    last_key: ?u64 = null,
+    last_style: u16 = 0,
+
+    pub fn intern(self: *StyleTable, cell: GhosttyCell) !u16 {
+        const hyperlink: u64 = if (cell.hyperlink_id != 0) 1 else 0;
+        const key: u64 = @as(u64, cell.fg_r) |
+            (@as(u64, cell.fg_g) << 8) |
+            (@as(u64, cell.fg_b) << 16) |
+            (@as(u64, cell.bg_r) << 24) |
+            (@as(u64, cell.bg_g) << 32) |
+            (@as(u64, cell.bg_b) << 40) |
+            (@as(u64, cell.flags) << 48) |
+            (hyperlink << 56);
+
+        // Runs of identically styled cells are the common case
+        if (self.last_key == key) return self.last_style;
+
+        const entry = try self.index.getOrPut(self.alloc, key);
+        if (!entry.found_existing) {
+            if (self.count >= self.out.len or self.count > std.math.maxInt(u16)) {
+                _ = self.index.remove(key);
+                return error.StyleTableFull;
             }
+            self.out[self.count] = .{
+                .fg_r = cell.fg_r,
+                .fg_g = cell.fg_g,
+                .fg_b = cell.fg_b,
+                .bg_r = cell.bg_r,
+                .bg_g = cell.bg_g,
+                .bg_b = cell.bg_b,
+                .flags = cell.flags,
+                .attrs = @intCast(hyperlink),
+            };
+            entry.value_ptr.* = @intCast(self.count);
+            self.count += 1;
+        }
+
+        self.last_key = key;
+        self.last_style = entry.value_ptr.*;
+        return self.last_style;
+    }
+};
+
+fn writeRowCompact(
+    wrapper: *const TerminalWrapper,
+    y: usize,
+    out: []GhosttyCompactCell,
+    table: *StyleTable,
+) !void {
+    const pages = &wrapper.terminal.screens.active.pages;
+    try writePinCompact(&wrapper.render_state, pages.pin(.{ .active = .{ .y = @intCast(y) } }), out, table);
+}
+
+/// Pack the row at `maybe_pin` into compact cells; a missing row, or columns
+/// missing from the page, are filled with default cells.
+pub fn writePinCompact(
+    rs: *const RenderState,
+    maybe_pin: anytype,
+    out: []GhosttyCompactCell,
+    table: *StyleTable,
+) !void {
+    const empty = defaultCell(rs);
+    const empty_style = try table.intern(empty);
+    const empty_cell: GhosttyCompactCell = .{ .codepoint = 0, .style = empty_style, .width = 1 };
+
+    const pin = maybe_pin orelse {
+        @memset(out, empty_cell);
+        return;
+    };
+
+    const cells = pin.cells(.all);
+    const page = pin.node.data;
+
+    for (out, 0..) |*dst, x| {
+        if (x >= cells.len) {
+            dst.* = empty_cell;
             continue;
+        }
+        const cell = resolveCell(rs, &page, &cells[x]);
+        dst.* = .{
+            .codepoint = cell.codepoint,
+            .style = try table.intern(cell),
+            .width = cell.width,
+            .grapheme_len = cell.grapheme_len,
         };
+    }
+}
 
-        const cells = pin.cells(.all);
-        const page = pin.node.data;
-
-        for (0..cols) |x| {
-            if (x >= cells.len) {
-                // Past end of row, fill with default
-                out[idx] = .{
-                    .codepoint = 0,
-                    .fg_r = rs.colors.foreground.r,
-                    .fg_g = rs.colors.foreground.g,
-                    .fg_b = rs.colors.foreground.b,
-                    .bg_r = rs.colors.background.r,
-                    .bg_g = rs.colors.background.g,
-                    .bg_b = rs.colors.background.b,
-                    .flags = 0,
-                    .width = 1,
-                    .hyperlink_id = 0,
-                };
-                idx += 1;
-                continue;
-            }
+/// Convert one active-screen row into packed cells, resolving styles and colors.
+/// Rows or columns missing from the page are filled with default cells.
+fn writeRowCells(wrapper: *const TerminalWrapper, y: usize, out: []GhosttyCell) void {
+    const rs = &wrapper.render_state;
 
-            const cell = &cells[x];
+    // Read directly from terminal's active screen, bypassing RenderState cache.
+    const pages = &wrapper.terminal.screens.active.pages;
+    const pin = pages.pin(.{ .active = .{ .y = @intCast(y) } }) orelse {
+        @memset(out, defaultCell(rs));
+        return;
+    };
 
-            // Get style from page styles (cell has style_id)
-            const sty: Style = if (cell.style_id > 0)
-                page.styles.get(page.memory, cell.style_id).*
-            else
-                .{};
+    const cells = pin.cells(.all);
+    const page = pin.node.data;
 
-            // Resolve colors
-            const fg: color.RGB = switch (sty.fg_color) {
-                .none => rs.colors.foreground,
-                .palette => |i| rs.colors.palette[i],
-                .rgb => |rgb| rgb,
-            };
-            const bg: color.RGB = if (sty.bg(cell, &rs.colors.palette)) |rgb| rgb else rs.colors.background;
-
-            // Build flags
-            var flags: u8 = 0;
-            if (sty.flags.bold) flags |= 1 << 0;
-            if (sty.flags.italic) flags |= 1 << 1;
-            if (sty.flags.underline != .none) flags |= 1 << 2;
-            if (sty.flags.strikethrough) flags |= 1 << 3;
-            if (sty.flags.inverse) flags |= 1 << 4;
-            if (sty.flags.invisible) flags |= 1 << 5;
-            if (sty.flags.blink) flags |= 1 << 6;
-            if (sty.flags.faint) flags |= 1 << 7;
-
-            // Get grapheme length if cell has grapheme data
-            const grapheme_len: u8 = if (cell.hasGrapheme())
-                if (page.lookupGrapheme(cell)) |cps| @min(@as(u8, @intCast(cps.len)), 255) else 0
-            else
-                0;
-
-            out[idx] = .{
-                .codepoint = cell.codepoint(),
-                .fg_r = fg.r,
-                .fg_g = fg.g,
-                .fg_b = fg.b,
-                .bg_r = bg.r,
-                .bg_g = bg.g,
-                .bg_b = bg.b,
-                .flags = flags,
-                .width = switch (cell.wide) {
-                    .narrow => 1,
-                    .wide => 2,
-                    .spacer_tail, .spacer_head => 0,
-                },
-                .hyperlink_id = if (cell.hyperlink) 1 else 0,
-                .grapheme_len = grapheme_len,
-            };
-            idx += 1;
-        }
+    for (out, 0..) |*dst, x| {
+        dst.* = if (x >= cells.len) defaultCell(rs) else resolveCell(rs, &page, &cells[x]);
     }
+}
 
-    return @intCast(total);
+fn defaultCell(rs: *const RenderState) GhosttyCell {
+    return .{
+        .codepoint = 0,
+        .fg_r = rs.colors.foreground.r,
+        .fg_g = rs.colors.foreground.g,
+        .fg_b = rs.colors.foreground.b,
+        .bg_r = rs.colors.background.r,
+        .bg_g = rs.colors.background.g,
+        .bg_b = rs.colors.background.b,
+        .flags = 0,
+        .width = 1,
+        .hyperlink_id = 0,
+    };
+}
+
+/// Resolve a page cell's style into colors and flags.
+fn resolveCell(rs: *const RenderState, page: anytype, cell: anytype) GhosttyCell {
+    // Get style from page styles (cell has style_id)
+    const sty: Style = if (cell.style_id > 0)
+        page.styles.get(page.memory, cell.style_id).*
+    else
+        .{};
+
+    // Resolve colors
+    const fg: color.RGB = switch (sty.fg_color) {
+        .none => rs.colors.foreground,
+        .palette => |i| rs.colors.palette[i],
+        .rgb => |rgb| rgb,
+    };
+    const bg: color.RGB = if (sty.bg(cell, &rs.colors.palette)) |rgb| rgb else rs.colors.background;
+
+    // Build flags
+    var flags: u8 = 0;
+    if (sty.flags.bold) flags |= 1 << 0;
+    if (sty.flags.italic) flags |= 1 << 1;
+    if (sty.flags.underline != .none) flags |= 1 << 2;
+    if (sty.flags.strikethrough) flags |= 1 << 3;
+    if (sty.flags.inverse) flags |= 1 << 4;
+    if (sty.flags.invisible) flags |= 1 << 5;
+    if (sty.flags.blink) flags |= 1 << 6;
+    if (sty.flags.faint) flags |= 1 << 7;
+
+    // Get grapheme length if cell has grapheme data
+    const grapheme_len: u8 = if (cell.hasGrapheme())
+        if (page.lookupGrapheme(cell)) |cps| @min(@as(u8, @intCast(cps.len)), 255) else 0
+    else
+        0;
+
+    return .{
+        .codepoint = cell.codepoint(),
+        .fg_r = fg.r,
+        .fg_g = fg.g,
+        .fg_b = fg.b,
+        .bg_r = bg.r,
+        .bg_g = bg.g,
+        .bg_b = bg.b,
+        .flags = flags,
+        .width = switch (cell.wide) {
+            .narrow => 1,
+            .wide => 2,
+            .spacer_tail, .spacer_head => 0,
+        },
+        .hyperlink_id = if (cell.hyperlink) 1 else 0,
+        .grapheme_len = grapheme_len,
+    };
 }
 
 /// Get grapheme codepoints for a cell at (row, col).
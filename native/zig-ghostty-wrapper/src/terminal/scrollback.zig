@@ -1,4 +1,5 @@
 const ghostty = @import("ghostty");
+const render_state = @import("render_state.zig");
 const state = @import("state.zig");
 const types = @import("types.zig");
 
@@ -6,6 +7,8 @@ const Style = ghostty.Style;
 const color = ghostty.color;
 const TerminalWrapper = state.TerminalWrapper;
 const GhosttyCell = types.GhosttyCell;
+const GhosttyCompactCell = types.GhosttyCompactCell;
+const GhosttyCellStyle = types.GhosttyCellStyle;
 
 /// Get the number of scrollback lines (history, not including active screen)
 pub fn getScrollbackLength(ptr: ?*anyopaque) callconv(.c) c_int {
@@ -169,6 +172,65 @@ pub fn getScrollbackGrapheme(
     return @intCast(count);
 }
 
+/// Check if a scrollback row soft-wraps into the next row.
+/// offset 0 = oldest line in scrollback (same as getScrollbackLine).
+/// Unlike isRowWrapped this reports the row's own wrap flag, which is what
+/// the disk archive needs to rejoin logical lines it receives in batches.
+pub fn isScrollbackRowWrapped(ptr: ?*anyopaque, offset: c_int) callconv(.c) bool {
+    const wrapper: *const TerminalWrapper = @ptrCast(@alignCast(ptr orelse return false));
+    if (offset < 0 or offset >= getScrollbackLength(ptr)) return false;
+
+    const pages = &wrapper.terminal.screens.active.pages;
+    const pin = pages.pin(.{ .history = .{ .y = @intCast(offset) } }) orelse return false;
+    return pin.rowAndCell().row.wrap;
+}
+
+/// Export the oldest scrollback rows in the compact viewport format, for the
+/// disk archiver: one call instead of a line and a wrap-flag call per row.
+/// Writes up to max_rows rows (fewer when out_cells holds less), cols cells
+/// each, with one style table shared by the batch; out_wrapped[i] is 1 when
+/// row i soft-wraps into the next one.
+/// Returns the number of rows written and stores the style count in
+/// out_style_count, or -1 on error (short buffers or more than 65536 styles).
+pub fn getScrollbackCompact(
+    ptr: ?*anyopaque,
+    max_rows: c_uint,
+    out_cells: [*]GhosttyCompactCell,
+    cells_size: usize,
+    out_styles: [*]GhosttyCellStyle,
+    styles_size: usize,
+    out_style_count: *u32,
+    out_wrapped: [*]u8,
+) callconv(.c) c_int {
+    const wrapper: *TerminalWrapper = @ptrCast(@alignCast(ptr orelse return -1));
+    const rs = &wrapper.render_state;
+    const cols: usize = rs.cols;
+
+    out_style_count.* = 0;
+    if (cols == 0) return 0;
+
+    const scrollback_len: usize = @intCast(getScrollbackLength(ptr));
+    const count = @min(@min(@as(usize, max_rows), scrollback_len), cells_size / cols);
+
+    wrapper.style_index.clearRetainingCapacity();
+    var table: render_state.StyleTable = .{
+        .alloc = wrapper.alloc,
+        .index = &wrapper.style_index,
+        .out = out_styles[0..styles_size],
+    };
+
+    const pages = &wrapper.terminal.screens.active.pages;
+    for (0..count) |y| {
+        const pin = pages.pin(.{ .history = .{ .y = @intCast(y) } });
+        const start = y * cols;
+        render_state.writePinCompact(rs, pin, out_cells[start .. start + cols], &table) catch return -1;
+        out_wrapped[y] = if (pin) |p| @intFromBool(p.rowAndCell().row.wrap) else 0;
+    }
+
+    out_style_count.* = @intCast(table.count);
+    return @intCast(count);
+}
+
 /// Check if a row is a continuation from the previous row (soft-wrapped)
 /// This matches xterm.js semantics where isWrapped indicates the row continues
 /// from the previous row, not that it wraps to the next row.
@@ -0,0 +1,179 @@
+//! Text search over the terminal's page list.
+//!
+//! Rows are read straight from the active screen's PageList (scrollback
+//! followed by the active area), so a search never materializes GhosttyCell
+//! rows for the host. Each row is flattened into a codepoint buffer with
+//! wide-character spacers dropped and empty cells read as spaces, then
+//! scanned for the first query codepoint with a vector compare before the
+//! rest of the candidate is verified.
+
+const std = @import("std");
+const state = @import("state.zig");
+const types = @import("types.zig");
+
+const TerminalWrapper = state.TerminalWrapper;
+const GhosttySearchMatch = types.GhosttySearchMatch;
+const GhosttySearchCursor = types.GhosttySearchCursor;
+
+/// Search flags (ghostty_terminal_search `flags`)
+pub const flag = struct {
+    /// Fold ASCII and Latin-1 letters before comparing
+    pub const case_insensitive: u32 = 1 << 0;
+};
+
+const lanes = std.simd.suggestVectorLength(u32) orelse 4;
+const Lane = @Vector(lanes, u32);
+
+/// Simple case folding for ASCII and Latin-1. Other codepoints compare
+/// exactly; hosts run their own search for case-insensitive queries that
+/// need more than this.
+pub fn foldCase(cp: u32) u32 {
+    return switch (cp) {
+        'A'...'Z', 0xC0...0xD6, 0xD8...0xDE => cp + 0x20,
+        else => cp,
+    };
+}
+
+/// Index of the first `needle` codepoint in `haystack` at or after `from`.
+pub fn indexOfCodepoint(haystack: []const u32, from: usize, needle: u32) ?usize {
+    var i = from;
+    const splat: Lane = @splat(needle);
+    while (i + lanes <= haystack.len) : (i += lanes) {
+        const chunk: Lane = haystack[i..][0..lanes].*;
+        if (std.simd.firstTrue(chunk == splat)) |lane| return i + lane;
+    }
+    while (i < haystack.len) : (i += 1) {
+        if (haystack[i] == needle) return i;
+    }
+    return null;
+}
+
+/// Index of the first occurrence of `needle` in `haystack` at or after `from`.
+pub fn indexOf(haystack: []const u32, from: usize, needle: []const u32) ?usize {
+    if (needle.len == 0 or needle.len > haystack.len) return null;
+    const starts = haystack[0 .. haystack.len - needle.len + 1];
+    var i = from;
+    while (indexOfCodepoint(starts, i, needle[0])) |at| {
+        if (std.mem.eql(u32, haystack[at + 1 ..][0 .. needle.len - 1], needle[1..])) return at;
+        i = at + 1;
+    }
+    return null;
+}
+
+/// Flattened row: searchable codepoints plus the cell span of each.
+const RowText = struct {
+    text: []u32,
+    start_cols: []u16,
+    end_cols: []u16,
+
+    /// Load a row from its pin. Returns the number of codepoints.
+    fn load(self: RowText, pin: anytype, fold: bool) usize {
+        const cells = pin.cells(.all);
+        var n: usize = 0;
+        for (cells, 0..) |*cell, x| {
+            const width: usize = switch (cell.wide) {
+                .narrow => 1,
+                .wide => 2,
+                .spacer_tail, .spacer_head => continue,
+            };
+            const cp = cell.codepoint();
+            const ch: u32 = if (cp == 0) ' ' else cp;
+            self.text[n] = if (fold) foldCase(ch) else ch;
+            self.start_cols[n] = @intCast(x);
+            self.end_cols[n] = @intCast(@min(x + width, cells.len));
+            n += 1;
+        }
+        return n;
+    }
+};
+
+// ============================================================================
+// C API
+// ============================================================================
+
+/// Search scrollback and the active area for a literal codepoint sequence.
+/// Starts at `cursor` and writes up to `buf_size` matches. On return the
+/// cursor points at the next unreported match, or has `done` set once the
+/// last row was searched. At most `max_rows` rows (0 = unlimited) are
+/// scanned per call; when the budget runs out the cursor is left at the
+/// next row with `done` unset.
+/// Returns the number of matches written, or -1 on error.
+pub fn search(
+    ptr: ?*anyopaque,
+    query: [*]const u32,
+    query_len: usize,
+    flags: u32,
+    cursor: *GhosttySearchCursor,
+    out: [*]GhosttySearchMatch,
+    buf_size: usize,
+    max_rows: u32,
+) callconv(.c) c_int {
+    const wrapper: *const TerminalWrapper = @ptrCast(@alignCast(ptr orelse return -1));
+    if (query_len == 0) return -1;
+    if (cursor.done != 0) return 0;
+
+    const pages = &wrapper.terminal.screens.active.pages;
+    const cols: usize = pages.cols;
+    if (query_len > cols) {
+        cursor.done = 1;
+        return 0;
+    }
+
+    const alloc = wrapper.alloc;
+    const codepoints = alloc.alloc(u32, query_len + cols) catch return -1;
+    defer alloc.free(codepoints);
+    const spans = alloc.alloc(u16, cols * 2) catch return -1;
+    defer alloc.free(spans);
+
+    const fold = flags & flag.case_insensitive != 0;
+    const needle = codepoints[0..query_len];
+    for (query[0..query_len], needle) |cp, *n| {
+        n.* = if (fold) foldCase(cp) else cp;
+    }
+    const row: RowText = .{
+        .text = codepoints[query_len..],
+        .start_cols = spans[0..cols],
+        .end_cols = spans[cols..],
+    };
+
+    var pin = pages.pin(.{ .screen = .{ .y = @intCast(cursor.line) } }) orelse {
+        cursor.done = 1;
+        return 0;
+    };
+    var line = cursor.line;
+    var from_col = cursor.col;
+    var count: usize = 0;
+    var rows: u32 = 0;
+
+    while (true) {
+        const len = row.load(pin, fold);
+        var i: usize = 0;
+        while (indexOf(row.text[0..len], i, needle)) |at| {
+            i = at + 1;
+            if (row.start_cols[at] < from_col) continue;
+            if (count >= buf_size) {
+                cursor.* = .{ .line = line, .col = row.start_cols[at], .done = 0 };
+                return @intCast(count);
+            }
+            out[count] = .{
+                .line = line,
+                .start_col = row.start_cols[at],
+                .end_col = row.end_cols[at + query_len - 1],
+            };
+            count += 1;
+        }
+
+        from_col = 0;
+        rows += 1;
+        const next = pin.down(1) orelse break;
+        if (max_rows != 0 and rows >= max_rows) {
+            cursor.* = .{ .line = line + 1, .col = 0, .done = 0 };
+            return @intCast(count);
+        }
+        pin = next;
+        line += 1;
+    }
+
+    cursor.* = .{ .line = line + 1, .col = 0, .done = 1 };
+    return @intCast(count);
+}
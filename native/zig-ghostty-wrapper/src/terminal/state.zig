@@ -22,4 +22,10 @@ pub const TerminalWrapper = struct {
     last_screen_is_alternate: bool = false,
     /// Desired scrollback limit in lines (0 = unlimited)
     scrollback_limit_lines: usize = 0,
+    /// Resolved style key -> index, reused by each compact export
+    style_index: std.AutoHashMapUnmanaged(u64, u16) = .empty,
+    /// Bumped whenever a kitty snapshot finds the active screen's images changed
+    kitty_generation: u64 = 0,
+    /// Screen the last kitty generation was taken on
+    kitty_alternate: bool = false,
 };
@@ -13,6 +13,26 @@ pub const GhosttyCell = extern struct {
     _pad: u8 = 0,
 };
 
+/// Compact cell: colors and attributes live in a per-frame style table.
+pub const GhosttyCompactCell = extern struct {
+    codepoint: u32,
+    style: u16,
+    width: u8,
+    grapheme_len: u8 = 0,
+};
+
+/// Resolved style shared by compact cells. attrs bit 0 = hyperlink.
+pub const GhosttyCellStyle = extern struct {
+    fg_r: u8,
+    fg_g: u8,
+    fg_b: u8,
+    bg_r: u8,
+    bg_g: u8,
+    bg_b: u8,
+    flags: u8,
+    attrs: u8 = 0,
+};
+
 pub const GhosttyDirty = enum(u8) {
     none = 0,
     partial = 1,
@@ -57,3 +77,24 @@ pub const GhosttyKittyPlacement = extern struct {
     rows: u32,
     z: i32,
 };
+
+pub const GhosttyKittySnapshot = extern struct {
+    generation: u64,
+    image_count: u32,
+    placement_count: u32,
+};
+
+/// Search match. Columns are cell columns; end_col is exclusive.
+pub const GhosttySearchMatch = extern struct {
+    line: u32,
+    start_col: u16,
+    end_col: u16,
+};
+
+/// Resume point for ghostty_terminal_search. Zero-initialize to start.
+pub const GhosttySearchCursor = extern struct {
+    line: u32,
+    col: u16,
+    done: u8,
+    _pad: u8 = 0,
+};
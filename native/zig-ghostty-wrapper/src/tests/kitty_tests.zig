@@ -71,3 +71,38 @@ test "regular: trimming removes kitty placements in dropped scrollback" {
     try testing.expectEqual(@as(c_int, 2), scrollback_len);
     try testing.expectEqual(@as(c_int, 0), terminal.getKittyPlacementCount(term));
 }
+
+test "regular: kitty snapshot exports images and placements by generation" {
+    const term = terminal.new(4, 4);
+    defer terminal.free(term);
+
+    var images: [4]terminal.GhosttyKittyImageInfo = undefined;
+    var placements: [4]terminal.GhosttyKittyPlacement = undefined;
+    var snapshot: terminal.GhosttyKittySnapshot = undefined;
+
+    const sequence = "\x1b_Ga=T,f=100,s=2,v=3,i=7;\x1b\\";
+    terminal.write(term, sequence, sequence.len);
+
+    // Too-small buffers report the required counts
+    try testing.expectEqual(@as(c_int, -1), terminal.getKittySnapshot(term, 0, &images, 0, &placements, 0, &snapshot));
+    try testing.expectEqual(@as(u32, 1), snapshot.image_count);
+    try testing.expectEqual(@as(u32, 1), snapshot.placement_count);
+
+    try testing.expectEqual(@as(c_int, 1), terminal.getKittySnapshot(term, 0, &images, images.len, &placements, placements.len, &snapshot));
+    const generation = snapshot.generation;
+    try testing.expect(generation > 0);
+    try testing.expectEqual(@as(u32, 7), images[0].id);
+    try testing.expectEqual(@as(u32, 3), images[0].height);
+    try testing.expectEqual(@as(u32, 7), placements[0].image_id);
+
+    // Unchanged: nothing written, same generation
+    try testing.expectEqual(@as(c_int, 0), terminal.getKittySnapshot(term, generation, &images, images.len, &placements, placements.len, &snapshot));
+    try testing.expectEqual(generation, snapshot.generation);
+
+    const delete = "\x1b_Ga=d,d=A\x1b\\";
+    terminal.write(term, delete, delete.len);
+    try testing.expectEqual(@as(c_int, 1), terminal.getKittySnapshot(term, generation, &images, images.len, &placements, placements.len, &snapshot));
+    try testing.expect(snapshot.generation > generation);
+    try testing.expectEqual(@as(u32, 0), snapshot.image_count);
+    try testing.expectEqual(@as(u32, 0), snapshot.placement_count);
+}
@@ -7,4 +7,6 @@ comptime {
     _ = @import("kitty_tests.zig");
     _ = @import("response_tests.zig");
     _ = @import("scrollback_tests.zig");
+    _ = @import("prefilter_tests.zig");
+    _ = @import("search_tests.zig");
 }
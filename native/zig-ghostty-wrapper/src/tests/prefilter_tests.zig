@@ -0,0 +1,139 @@
+const std = @import("std");
+const terminal = @import("../terminal.zig");
+const prefilter = @import("../terminal/prefilter.zig");
+
+const testing = std.testing;
+const scan_flag = prefilter.scan_flag;
+
+fn scan(filter: ?*anyopaque, data: []const u8) u32 {
+    return terminal.prefilterScan(filter, data.ptr, data.len);
+}
+
+test "prefilter: plain text reports nothing" {
+    const filter = terminal.prefilterNew();
+    defer terminal.prefilterFree(filter);
+
+    try testing.expectEqual(@as(u32, 0), scan(filter, "hello caf\xc3\xa9 \xc2\xa9 world\r\n"));
+}
+
+test "prefilter: title, cwd and notification" {
+    const filter = terminal.prefilterNew();
+    defer terminal.prefilterFree(filter);
+
+    const flags = scan(filter, "a\x1b]2;my title\x07b\x1b]7;file:///tmp\x1b\\\x1b]9;done\x07");
+    try testing.expect(flags & scan_flag.title != 0);
+    try testing.expect(flags & scan_flag.cwd != 0);
+    try testing.expect(flags & scan_flag.notification != 0);
+    try testing.expect(flags & scan_flag.query == 0);
+
+    // Codes are only recognized when they are plain numbers
+    try testing.expect(scan(filter, "\x1b]2x;not a title\x07") & scan_flag.title == 0);
+}
+
+test "prefilter: OSC split across chunks" {
+    const filter = terminal.prefilterNew();
+    defer terminal.prefilterFree(filter);
+
+    const first = scan(filter, "x\x1b]0;par");
+    try testing.expect(first & scan_flag.pending != 0);
+    try testing.expect(first & scan_flag.osc != 0);
+    try testing.expect(first & scan_flag.title == 0);
+
+    const second = scan(filter, "tial\x1b");
+    try testing.expect(second & scan_flag.osc != 0);
+    try testing.expect(second & scan_flag.pending != 0);
+
+    const third = scan(filter, "\\rest");
+    try testing.expect(third & scan_flag.title != 0);
+    try testing.expect(third & scan_flag.pending == 0);
+}
+
+test "prefilter: sync mode, focus tracking and ED 3" {
+    const filter = terminal.prefilterNew();
+    defer terminal.prefilterFree(filter);
+
+    const flags = scan(filter, "\x1b[?2026h\x1b[?1004l\x1b[?1004hframe\x1b[2;3J\x1b[?2026l");
+    try testing.expect(flags & scan_flag.sync != 0);
+    try testing.expect(flags & scan_flag.focus_tracking != 0);
+    try testing.expect(flags & scan_flag.focus_enabled != 0);
+    try testing.expect(flags & scan_flag.erase_scrollback != 0);
+
+    // The last focus tracking change in the chunk wins
+    const disabled = scan(filter, "\x1b[?1004h\x1b[?1004l");
+    try testing.expect(disabled & scan_flag.focus_tracking != 0);
+    try testing.expect(disabled & scan_flag.focus_enabled == 0);
+
+    // ED 2 alone does not erase scrollback
+    try testing.expect(scan(filter, "\x1b[2J\x1b[J") & scan_flag.erase_scrollback == 0);
+}
+
+test "prefilter: C1 forms and split C1 lead byte" {
+    const filter = terminal.prefilterNew();
+    defer terminal.prefilterFree(filter);
+
+    try testing.expect(scan(filter, "\xc2\x9b?1004h") & scan_flag.focus_tracking != 0);
+
+    const first = scan(filter, "text\xc2");
+    try testing.expect(first & scan_flag.pending != 0);
+    try testing.expect(scan(filter, "\x9b3J") & scan_flag.erase_scrollback != 0);
+}
+
+test "prefilter: terminal queries" {
+    const filter = terminal.prefilterNew();
+    defer terminal.prefilterFree(filter);
+
+    const queries = [_][]const u8{
+        "\x1b[6n",
+        "\x1b[c",
+        "\x1b[>0c",
+        "\x1b[>q",
+        "\x1b[?2004$p",
+        "\x1b[?u",
+        "\x1b[14t",
+        "\x1b]11;?\x07",
+        "\x1b]4;1;?\x1b\\",
+        "\x1bP+q544e\x1b\\",
+    };
+    for (queries) |query| {
+        try testing.expect(scan(filter, query) & scan_flag.query != 0);
+    }
+
+    const not_queries = [_][]const u8{
+        "\x1b[31mred\x1b[0m",
+        "\x1b[?25l",
+        "\x1b[2J",
+        "\x1b]11;#000000\x07",
+        "5n 6n 14t plain text",
+    };
+    for (not_queries) |data| {
+        try testing.expect(scan(filter, data) & scan_flag.query == 0);
+    }
+}
+
+test "prefilter: kitty APC detection" {
+    const filter = terminal.prefilterNew();
+    defer terminal.prefilterFree(filter);
+
+    const query = scan(filter, "\x1b_Ga=q,i=1;AAAA\x1b\\");
+    try testing.expect(query & scan_flag.kitty != 0);
+    try testing.expect(query & scan_flag.kitty_query != 0);
+
+    const transmit = scan(filter, "\x1b_Ga=T,f=100,i=2;");
+    try testing.expect(transmit & scan_flag.kitty != 0);
+    try testing.expect(transmit & scan_flag.kitty_query == 0);
+    try testing.expect(transmit & scan_flag.pending != 0);
+
+    const rest = scan(filter, "iVBORw0KGgo=\x1b\\done");
+    try testing.expect(rest & scan_flag.kitty != 0);
+    try testing.expect(rest & scan_flag.pending == 0);
+}
+
+test "prefilter: ESC aborts an unterminated string" {
+    const filter = terminal.prefilterNew();
+    defer terminal.prefilterFree(filter);
+
+    const flags = scan(filter, "\x1b]2;title\x1b[6n");
+    try testing.expect(flags & scan_flag.title == 0);
+    try testing.expect(flags & scan_flag.query != 0);
+    try testing.expect(flags & scan_flag.pending == 0);
+}
@@ -38,3 +38,47 @@ test "regular: scrollback trims to configured limit" {
     const len = terminal.getScrollbackLength(term);
     try testing.expectEqual(@as(c_int, 3), len);
 }
+
+test "regular: scrollback reports soft-wrapped rows" {
+    const term = terminal.new(4, 1);
+    defer terminal.free(term);
+
+    terminal.write(term, "ABCDEF\r\nG\r\n", 12);
+    _ = terminal.renderStateUpdate(term);
+
+    try testing.expect(terminal.getScrollbackLength(term) >= 3);
+    try testing.expect(terminal.isScrollbackRowWrapped(term, 0));
+    try testing.expect(!terminal.isScrollbackRowWrapped(term, 1));
+    try testing.expect(!terminal.isScrollbackRowWrapped(term, 2));
+    try testing.expect(!terminal.isScrollbackRowWrapped(term, -1));
+}
+
+test "regular: scrollback exports oldest rows compactly" {
+    const term = terminal.new(4, 1);
+    defer terminal.free(term);
+
+    terminal.write(term, "\x1b[31mABCDEF\x1b[0m\r\nG\r\n", 20);
+    _ = terminal.renderStateUpdate(term);
+    try testing.expect(terminal.getScrollbackLength(term) >= 3);
+
+    var cells: [4 * 3]terminal.GhosttyCompactCell = undefined;
+    var styles: [13]terminal.GhosttyCellStyle = undefined;
+    var style_count: u32 = 0;
+    var wrapped: [3]u8 = undefined;
+
+    const count = terminal.getScrollbackCompact(term, 3, &cells, cells.len, &styles, styles.len, &style_count, &wrapped);
+    try testing.expectEqual(@as(c_int, 3), count);
+    try testing.expectEqual(@as(u32, 'A'), cells[0].codepoint);
+    try testing.expectEqual(@as(u32, 'E'), cells[4].codepoint);
+    try testing.expectEqual(@as(u32, 'G'), cells[8].codepoint);
+    try testing.expectEqual([3]u8{ 1, 0, 0 }, wrapped);
+
+    // Red text, and the default style of the blanks after it
+    try testing.expectEqual(@as(u32, 2), style_count);
+    try testing.expectEqual(cells[0].style, cells[5].style);
+    try testing.expect(cells[0].style != cells[8].style);
+
+    // Bounded by max_rows and by the cell buffer
+    try testing.expectEqual(@as(c_int, 1), terminal.getScrollbackCompact(term, 1, &cells, cells.len, &styles, styles.len, &style_count, &wrapped));
+    try testing.expectEqual(@as(c_int, 2), terminal.getScrollbackCompact(term, 3, &cells, 9, &styles, styles.len, &style_count, &wrapped));
+}
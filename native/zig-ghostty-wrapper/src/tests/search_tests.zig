@@ -0,0 +1,252 @@
+const std = @import("std");
+const terminal = @import("../terminal.zig");
+const text_search = @import("../terminal/search.zig");
+
+const testing = std.testing;
+const flag = text_search.flag;
+
+fn codepoints(comptime text: []const u8) [std.unicode.utf8CountCodepoints(text) catch unreachable]u32 {
+    var out: [std.unicode.utf8CountCodepoints(text) catch unreachable]u32 = undefined;
+    var it = (std.unicode.Utf8View.init(text) catch unreachable).iterator();
+    var i: usize = 0;
+    while (it.nextCodepoint()) |cp| : (i += 1) out[i] = cp;
+    return out;
+}
+
+fn search(
+    term: ?*anyopaque,
+    query: []const u32,
+    flags: u32,
+    cursor: *terminal.GhosttySearchCursor,
+    buf: []terminal.GhosttySearchMatch,
+) []terminal.GhosttySearchMatch {
+    const count = terminal.search(term, query.ptr, query.len, flags, cursor, buf.ptr, buf.len, 0);
+    return buf[0..@intCast(@max(count, 0))];
+}
+
+test "search: indexOf finds needles across vector boundaries" {
+    var hay: [37]u32 = undefined;
+    for (&hay, 0..) |*cp, i| cp.* = 'a' + @as(u32, @intCast(i % 3));
+    hay[33] = 'x';
+    hay[34] = 'y';
+
+    const needle = [_]u32{ 'x', 'y' };
+    try testing.expectEqual(@as(?usize, 33), text_search.indexOf(&hay, 0, &needle));
+    try testing.expectEqual(@as(?usize, null), text_search.indexOf(&hay, 34, &needle));
+    try testing.expectEqual(@as(?usize, 3), text_search.indexOf(&hay, 1, &[_]u32{ 'a', 'b', 'c' }));
+    try testing.expectEqual(@as(?usize, null), text_search.indexOf(hay[0..1], 0, &needle));
+}
+
+test "search: literal and case-insensitive matches" {
+    const term = terminal.new(20, 3);
+    defer terminal.free(term);
+
+    terminal.write(term, "hello world\r\nfoo Hello\r\n", 24);
+
+    var buf: [8]terminal.GhosttySearchMatch = undefined;
+    var cursor = std.mem.zeroes(terminal.GhosttySearchCursor);
+    const query = codepoints("hello");
+    const exact = search(term, &query, 0, &cursor, &buf);
+    try testing.expectEqual(@as(usize, 1), exact.len);
+    try testing.expectEqual(@as(u32, 0), exact[0].line);
+    try testing.expectEqual(@as(u16, 0), exact[0].start_col);
+    try testing.expectEqual(@as(u16, 5), exact[0].end_col);
+    try testing.expect(cursor.done != 0);
+
+    cursor = std.mem.zeroes(terminal.GhosttySearchCursor);
+    const upper = codepoints("HELLO");
+    const folded = search(term, &upper, flag.case_insensitive, &cursor, &buf);
+    try testing.expectEqual(@as(usize, 2), folded.len);
+    try testing.expectEqual(@as(u32, 1), folded[1].line);
+    try testing.expectEqual(@as(u16, 4), folded[1].start_col);
+}
+
+test "search: resumes from the cursor when the buffer fills" {
+    const term = terminal.new(20, 3);
+    defer terminal.free(term);
+
+    terminal.write(term, "ab ab\r\nab\r\n", 11);
+
+    var buf: [1]terminal.GhosttySearchMatch = undefined;
+    var cursor = std.mem.zeroes(terminal.GhosttySearchCursor);
+    const query = codepoints("ab");
+
+    const first = search(term, &query, 0, &cursor, &buf);
+    try testing.expectEqual(@as(usize, 1), first.len);
+    try testing.expectEqual(@as(u16, 0), first[0].start_col);
+    try testing.expectEqual(@as(u8, 0), cursor.done);
+    try testing.expectEqual(@as(u32, 0), cursor.line);
+    try testing.expectEqual(@as(u16, 3), cursor.col);
+
+    const second = search(term, &query, 0, &cursor, &buf);
+    try testing.expectEqual(@as(u16, 3), second[0].start_col);
+
+    const third = search(term, &query, 0, &cursor, &buf);
+    try testing.expectEqual(@as(u32, 1), third[0].line);
+
+    const rest = search(term, &query, 0, &cursor, &buf);
+    try testing.expectEqual(@as(usize, 0), rest.len);
+    try testing.expect(cursor.done != 0);
+}
+
+test "search: wide characters report cell columns" {
+    const term = terminal.new(20, 2);
+    defer terminal.free(term);
+
+    const text = "\xe6\x97\xa5\xe6\x9c\xac abc";
+    terminal.write(term, text, text.len);
+
+    var buf: [4]terminal.GhosttySearchMatch = undefined;
+    var cursor = std.mem.zeroes(terminal.GhosttySearchCursor);
+    const wide = codepoints("\xe6\x9c\xac");
+    const wide_match = search(term, &wide, 0, &cursor, &buf);
+    try testing.expectEqual(@as(usize, 1), wide_match.len);
+    try testing.expectEqual(@as(u16, 2), wide_match[0].start_col);
+    try testing.expectEqual(@as(u16, 4), wide_match[0].end_col);
+
+    cursor = std.mem.zeroes(terminal.GhosttySearchCursor);
+    const query = codepoints("abc");
+    const narrow = search(term, &query, 0, &cursor, &buf);
+    try testing.expectEqual(@as(u16, 5), narrow[0].start_col);
+    try testing.expectEqual(@as(u16, 8), narrow[0].end_col);
+}
+
+test "search: scrollback lines come first" {
+    const term = terminal.new(10, 2);
+    defer terminal.free(term);
+
+    const text = "a1\r\nneedle\r\nb2\r\nc3\r\nneedle";
+    terminal.write(term, text, text.len);
+    try testing.expectEqual(@as(c_int, 3), terminal.getScrollbackLength(term));
+
+    var buf: [4]terminal.GhosttySearchMatch = undefined;
+    var cursor = std.mem.zeroes(terminal.GhosttySearchCursor);
+    const query = codepoints("needle");
+    const matches = search(term, &query, 0, &cursor, &buf);
+    try testing.expectEqual(@as(usize, 2), matches.len);
+    try testing.expectEqual(@as(u32, 1), matches[0].line);
+    try testing.expectEqual(@as(u32, 4), matches[1].line);
+}
+
+test "search: row budget bounds each call" {
+    const term = terminal.new(10, 4);
+    defer terminal.free(term);
+
+    const text = "ab\r\ncd\r\nab\r\nab";
+    terminal.write(term, text, text.len);
+
+    var buf: [4]terminal.GhosttySearchMatch = undefined;
+    var cursor = std.mem.zeroes(terminal.GhosttySearchCursor);
+    const query = codepoints("ab");
+
+    const first_count = terminal.search(term, &query, query.len, 0, &cursor, &buf, buf.len, 2);
+    try testing.expectEqual(@as(c_int, 1), first_count);
+    try testing.expectEqual(@as(u8, 0), cursor.done);
+    try testing.expectEqual(@as(u32, 2), cursor.line);
+
+    const rest_count = terminal.search(term, &query, query.len, 0, &cursor, &buf, buf.len, 2);
+    try testing.expectEqual(@as(c_int, 2), rest_count);
+    try testing.expectEqual(@as(u32, 3), buf[1].line);
+    try testing.expect(cursor.done != 0);
+}
+
+fn searchRegex(
+    term: ?*anyopaque,
+    regex: ?*anyopaque,
+    cursor: *terminal.GhosttySearchCursor,
+    buf: []terminal.GhosttySearchMatch,
+    max_rows: u32,
+) []terminal.GhosttySearchMatch {
+    const count = terminal.searchRegex(term, regex, cursor, buf.ptr, buf.len, max_rows);
+    return buf[0..@intCast(@max(count, 0))];
+}
+
+test "regex: matches patterns per line and rejects invalid ones" {
+    const term = terminal.new(20, 3);
+    defer terminal.free(term);
+
+    const text = "id REQ-123 ok\r\nreq-9\r\n";
+    terminal.write(term, text, text.len);
+
+    const pattern = "req-[0-9]+$|req-[0-9]+ ";
+    const regex = terminal.regexNew(pattern, pattern.len, 1);
+    try testing.expect(regex != null);
+    defer terminal.regexFree(regex);
+
+    var buf: [4]terminal.GhosttySearchMatch = undefined;
+    var cursor = std.mem.zeroes(terminal.GhosttySearchCursor);
+    const matches = searchRegex(term, regex, &cursor, &buf, 0);
+    try testing.expectEqual(@as(usize, 2), matches.len);
+    try testing.expectEqual(@as(u16, 3), matches[0].start_col);
+    try testing.expectEqual(@as(u16, 11), matches[0].end_col);
+    try testing.expectEqual(@as(u32, 1), matches[1].line);
+    try testing.expectEqual(@as(u16, 5), matches[1].end_col);
+
+    try testing.expect(terminal.regexNew("(", 1, 0) == null);
+}
+
+test "regex: matches across soft-wrapped rows" {
+    const term = terminal.new(10, 3);
+    defer terminal.free(term);
+
+    const text = "0123456789abcdef";
+    terminal.write(term, text, text.len);
+
+    const pattern = "89ab";
+    const regex = terminal.regexNew(pattern, pattern.len, 0);
+    defer terminal.regexFree(regex);
+
+    var buf: [4]terminal.GhosttySearchMatch = undefined;
+    var cursor = std.mem.zeroes(terminal.GhosttySearchCursor);
+    const matches = searchRegex(term, regex, &cursor, &buf, 0);
+    try testing.expectEqual(@as(usize, 2), matches.len);
+    try testing.expectEqual(@as(u32, 0), matches[0].line);
+    try testing.expectEqual(@as(u16, 8), matches[0].start_col);
+    try testing.expectEqual(@as(u16, 10), matches[0].end_col);
+    try testing.expectEqual(@as(u32, 1), matches[1].line);
+    try testing.expectEqual(@as(u16, 0), matches[1].start_col);
+    try testing.expectEqual(@as(u16, 2), matches[1].end_col);
+}
+
+test "regex: row budget returns early and resumes" {
+    const term = terminal.new(10, 4);
+    defer terminal.free(term);
+
+    const text = "a\r\nb\r\nc\r\nneedle";
+    terminal.write(term, text, text.len);
+
+    const pattern = "ne+dle";
+    const regex = terminal.regexNew(pattern, pattern.len, 0);
+    defer terminal.regexFree(regex);
+
+    var buf: [4]terminal.GhosttySearchMatch = undefined;
+    var cursor = std.mem.zeroes(terminal.GhosttySearchCursor);
+    var found: usize = 0;
+    var calls: usize = 0;
+    while (cursor.done == 0) : (calls += 1) {
+        const matches = searchRegex(term, regex, &cursor, &buf, 1);
+        for (matches) |match| {
+            try testing.expectEqual(@as(u32, 3), match.line);
+            found += 1;
+        }
+    }
+    try testing.expectEqual(@as(usize, 1), found);
+    try testing.expect(calls >= 4);
+}
+
+test "regex: searches host-joined text by byte range" {
+    const pattern = "b+|é";
+    const regex = terminal.regexNew(pattern, pattern.len, 0);
+    try testing.expect(regex != null);
+    defer terminal.regexFree(regex);
+
+    const text = "abbcébb";
+    var ranges: [4]u32 = undefined;
+    try testing.expectEqual(@as(c_int, 2), terminal.regexSearchText(regex, text, text.len, 0, &ranges, 2));
+    try testing.expectEqualSlices(u32, &.{ 1, 3, 4, 6 }, &ranges);
+
+    // Resumes from the last end
+    try testing.expectEqual(@as(c_int, 1), terminal.regexSearchText(regex, text, text.len, 6, &ranges, 2));
+    try testing.expectEqual(@as(u32, 6), ranges[0]);
+    try testing.expectEqual(@as(u32, 8), ranges[1]);
+}
@@ -29,3 +29,73 @@ test "terminal write and read via render state" {
     try testing.expectEqual(@as(u32, 'l'), cells[3].codepoint);
     try testing.expectEqual(@as(u32, 'o'), cells[4].codepoint);
 }
+
+test "render state dirty rows export only changed rows" {
+    const term = terminal.new(20, 6);
+    defer terminal.free(term);
+
+    var rows: [6]u32 = undefined;
+    var cells: [20 * 6]terminal.GhosttyCell = undefined;
+
+    // First update is fully dirty: every row is reported
+    _ = terminal.renderStateUpdate(term);
+    try testing.expectEqual(@as(c_int, 6), terminal.renderStateGetDirtyRows(term, &rows, rows.len, &cells, cells.len));
+    terminal.renderStateMarkClean(term);
+
+    _ = terminal.renderStateUpdate(term);
+    try testing.expectEqual(@as(c_int, 0), terminal.renderStateGetDirtyRows(term, &rows, rows.len, &cells, cells.len));
+    terminal.renderStateMarkClean(term);
+
+    terminal.write(term, "\x1b[3;1HHi", 8);
+    _ = terminal.renderStateUpdate(term);
+    const count = terminal.renderStateGetDirtyRows(term, &rows, rows.len, &cells, cells.len);
+    try testing.expect(count >= 1 and count < 6);
+
+    var found = false;
+    for (rows[0..@intCast(count)], 0..) |row, i| {
+        if (row != 2) continue;
+        found = true;
+        try testing.expectEqual(@as(u32, 'H'), cells[i * 20].codepoint);
+        try testing.expectEqual(@as(u32, 'i'), cells[i * 20 + 1].codepoint);
+    }
+    try testing.expect(found);
+
+    // Buffers too small for the dirty rows are rejected
+    try testing.expectEqual(@as(c_int, -1), terminal.renderStateGetDirtyRows(term, &rows, rows.len, &cells, 10));
+}
+
+test "render state compact viewport interns styles" {
+    const term = terminal.new(10, 3);
+    defer terminal.free(term);
+
+    terminal.write(term, "\x1b[31mab\x1b[0mc\r\n\x1b[31md", 20);
+    _ = terminal.renderStateUpdate(term);
+
+    var rows: [3]u32 = undefined;
+    var cells: [10 * 3]terminal.GhosttyCompactCell = undefined;
+    var styles: [31]terminal.GhosttyCellStyle = undefined;
+    var style_count: u32 = 0;
+
+    const count = terminal.renderStateGetViewportCompact(term, false, &rows, rows.len, &cells, cells.len, &styles, styles.len, &style_count);
+    try testing.expectEqual(@as(c_int, 3), count);
+    try testing.expectEqual(@as(u32, 1), rows[1]);
+
+    // Red text and default text: exactly two styles for the whole viewport
+    try testing.expectEqual(@as(u32, 2), style_count);
+    try testing.expectEqual(@as(u32, 'a'), cells[0].codepoint);
+    try testing.expectEqual(cells[0].style, cells[1].style);
+    try testing.expect(cells[0].style != cells[2].style);
+    try testing.expectEqual(cells[2].style, cells[3].style);
+    try testing.expectEqual(cells[0].style, cells[10].style);
+
+    const red = styles[cells[0].style];
+    const plain = styles[cells[2].style];
+    try testing.expect(red.fg_r != plain.fg_r or red.fg_g != plain.fg_g or red.fg_b != plain.fg_b);
+
+    // A table too small for the styles is rejected
+    try testing.expectEqual(@as(c_int, -1), terminal.renderStateGetViewportCompact(term, false, &rows, rows.len, &cells, cells.len, &styles, 1, &style_count));
+
+    terminal.renderStateMarkClean(term);
+    _ = terminal.renderStateUpdate(term);
+    try testing.expectEqual(@as(c_int, 0), terminal.renderStateGetViewportCompact(term, true, &rows, rows.len, &cells, cells.len, &styles, styles.len, &style_count));
+}
@@ -19,6 +19,10 @@ pub const Pty = struct {
     stopping: std.atomic.Value(bool),
     ring: RingBuffer,
     reader_thread: ?std.Thread,
+    // Readiness pipe: the reader thread writes a byte after each ring buffer
+    // push so consumers can wait on notify_read_fd instead of polling.
+    notify_read_fd: c_int,
+    notify_write_fd: c_int,
 
     pub fn init(
         master_fd: c_int,
@@ -40,10 +44,14 @@ pub const Pty = struct {
             .stopping = std.atomic.Value(bool).init(false),
             .ring = RingBuffer.init(),
             .reader_thread = null,
+            .notify_read_fd = -1,
+            .notify_write_fd = -1,
         };
     }
 
     pub fn startReader(self: *Pty) bool {
+        // A missing notify pipe is not fatal: consumers fall back to polling.
+        self.openNotifyPipe();
         self.reader_thread = std.Thread.spawn(.{}, readerLoop, .{self}) catch return false;
         return true;
     }
@@ -93,6 +101,7 @@ pub const Pty = struct {
                         if (self.stopping.load(.acquire)) break;
                     } else {
                         written += w;
+                        self.signalReadable();
                     }
                 }
             } else if (n == 0) {
@@ -110,6 +119,43 @@ pub const Pty = struct {
 
         // Final child check
         self.checkChild();
+        // Wake the consumer so it observes EOF/exit without polling.
+        self.signalReadable();
+    }
+
+    fn openNotifyPipe(self: *Pty) void {
+        var fds: [2]c_int = undefined;
+        if (c.pipe(&fds) != 0) return;
+
+        // Both ends are non-blocking and close-on-exec: the read end is
+        // watched by the JS event loop, and a full pipe on the write end
+        // already means a wakeup is pending.
+        for (fds) |fd| {
+            const fd_flags = c.fcntl(fd, c.F_GETFD);
+            const fl_flags = c.fcntl(fd, c.F_GETFL);
+            if (fd_flags < 0 or fl_flags < 0 or
+                c.fcntl(fd, c.F_SETFD, fd_flags | c.FD_CLOEXEC) < 0 or
+                c.fcntl(fd, c.F_SETFL, fl_flags | c.O_NONBLOCK) < 0)
+            {
+                _ = c.close(fds[0]);
+                _ = c.close(fds[1]);
+                return;
+            }
+        }
+
+        self.notify_read_fd = fds[0];
+        self.notify_write_fd = fds[1];
+    }
+
+    fn signalReadable(self: *Pty) void {
+        if (self.notify_write_fd < 0) return;
+        const byte: u8 = 1;
+        while (true) {
+            const n = c.write(self.notify_write_fd, &byte, 1);
+            if (n == -1 and std.c._errno().* == c.EINTR) continue;
+            // EAGAIN means the pipe is full, so the consumer is already due a wakeup.
+            return;
+        }
     }
 
     pub fn checkChild(self: *Pty) void {
@@ -237,6 +283,15 @@ pub const Pty = struct {
             self.master_fd = -1;
         }
 
+        if (self.notify_write_fd >= 0) {
+            _ = c.close(self.notify_write_fd);
+            self.notify_write_fd = -1;
+        }
+        if (self.notify_read_fd >= 0) {
+            _ = c.close(self.notify_read_fd);
+            self.notify_read_fd = -1;
+        }
+
         // Try non-blocking reap first (WNOHANG)
         // If process hasn't exited yet, spawn a reaper thread to prevent zombies
         if (self.pid > 0 and !self.exited.load(.acquire)) {
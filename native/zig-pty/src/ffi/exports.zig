@@ -57,6 +57,10 @@ pub fn bun_pty_read(handle: c_int, buf: [*]u8, len: c_int) c_int {
     return pty_ops.read(handle, buf, len);
 }
 
+pub fn bun_pty_get_notify_fd(handle: c_int) c_int {
+    return pty_ops.getNotifyFd(handle);
+}
+
 pub fn bun_pty_write(handle: c_int, data: [*]const u8, len: c_int) c_int {
     return pty_ops.write(handle, data, len);
 }
@@ -31,6 +31,27 @@ pub fn read(handle: c_int, buf: [*]u8, len: c_int) c_int {
     return pty.readAvailable(buf, @intCast(len));
 }
 
+/// Get the readiness fd for a PTY. The fd becomes readable whenever the
+/// reader thread pushes output into the ring buffer or the child exits,
+/// and reports EOF once close() has closed the write end.
+/// Returns a close-on-exec duplicate owned by the caller, so a consumer
+/// that tears down its watcher asynchronously never observes the number
+/// being closed and reused underneath it. The caller must close it.
+/// Returns: fd (>= 0) or ERROR (-1) if unavailable.
+pub fn getNotifyFd(handle: c_int) c_int {
+    if (handle <= 0) {
+        return constants.ERROR;
+    }
+
+    const h: u32 = @intCast(handle);
+    const pty = handle_registry.acquireHandle(h) orelse return constants.ERROR;
+    defer handle_registry.releaseHandle(h);
+
+    if (pty.notify_read_fd < 0) return constants.ERROR;
+    const fd = c.fcntl(pty.notify_read_fd, c.F_DUPFD_CLOEXEC, @as(c_int, 0));
+    return if (fd >= 0) fd else constants.ERROR;
+}
+
 /// Write data to PTY.
 /// Returns: bytes written (>= 0), or ERROR (-1) on failure.
 pub fn write(handle: c_int, data: [*]const u8, len: c_int) c_int {
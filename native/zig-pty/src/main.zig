@@ -6,7 +6,8 @@
 //! Architecture:
 //! - Background reader thread does blocking reads for natural data coalescing
 //! - Ring buffer allows lock-free producer/consumer pattern
-//! - JS polls the ring buffer, getting complete chunks
+//! - A per-PTY notify pipe signals ring buffer pushes; JS waits on it and
+//!   drains complete chunks instead of polling
 //!
 //! Module structure:
 //! - core/           Core PTY implementation
@@ -63,6 +64,10 @@ export fn bun_pty_read(handle: c_int, buf: [*]u8, len: c_int) c_int {
     return exports.bun_pty_read(handle, buf, len);
 }
 
+export fn bun_pty_get_notify_fd(handle: c_int) c_int {
+    return exports.bun_pty_get_notify_fd(handle);
+}
+
 export fn bun_pty_write(handle: c_int, data: [*]const u8, len: c_int) c_int {
     return exports.bun_pty_write(handle, data, len);
 }
@@ -230,3 +230,88 @@ test "read returns child exited even with no output" {
 
     try std.testing.expect(saw_exit);
 }
+
+// ============================================================================
+// Readiness Notification Tests
+// ============================================================================
+
+test "notify fd becomes readable when output arrives" {
+    const handle = spawn_module.spawnPty("echo notify", "", "", 80, 24);
+    try std.testing.expect(handle > 0);
+    defer exports.bun_pty_close(handle);
+
+    const fd = exports.bun_pty_get_notify_fd(handle);
+    try std.testing.expect(fd >= 0);
+    defer _ = c.close(fd);
+
+    var pfd = [_]c.pollfd{.{ .fd = fd, .events = c.POLLIN, .revents = 0 }};
+    const rc = c.poll(&pfd, 1, 2000);
+    try std.testing.expect(rc == 1);
+    try std.testing.expect((pfd[0].revents & c.POLLIN) != 0);
+
+    // Drain notifications, then the ring buffer holds the output.
+    var drain: [64]u8 = undefined;
+    while (c.read(fd, &drain, drain.len) > 0) {}
+
+    var buf: [1024]u8 = undefined;
+    const n = exports.bun_pty_read(handle, &buf, buf.len);
+    try std.testing.expect(n > 0 or n == constants.CHILD_EXITED);
+}
+
+test "notify fd signals child exit without output" {
+    const handle = spawn_module.spawnPty("true", "", "", 80, 24);
+    try std.testing.expect(handle > 0);
+    defer exports.bun_pty_close(handle);
+
+    const fd = exports.bun_pty_get_notify_fd(handle);
+    try std.testing.expect(fd >= 0);
+    defer _ = c.close(fd);
+
+    var buf: [256]u8 = undefined;
+    var saw_exit = false;
+    var attempts: usize = 0;
+    while (attempts < 20) : (attempts += 1) {
+        var pfd = [_]c.pollfd{.{ .fd = fd, .events = c.POLLIN, .revents = 0 }};
+        _ = c.poll(&pfd, 1, 500);
+        var drain: [64]u8 = undefined;
+        while (c.read(fd, &drain, drain.len) > 0) {}
+
+        const n = exports.bun_pty_read(handle, &buf, buf.len);
+        if (n == constants.CHILD_EXITED) {
+            saw_exit = true;
+            break;
+        }
+    }
+
+    try std.testing.expect(saw_exit);
+}
+
+test "notify fd is a caller-owned duplicate that sees EOF on close" {
+    const handle = spawn_module.spawnPty("true", "", "", 80, 24);
+    try std.testing.expect(handle > 0);
+
+    const fd = exports.bun_pty_get_notify_fd(handle);
+    try std.testing.expect(fd >= 0);
+    defer _ = c.close(fd);
+    const other = exports.bun_pty_get_notify_fd(handle);
+    try std.testing.expect(other >= 0 and other != fd);
+    _ = c.close(other);
+
+    exports.bun_pty_close(handle);
+
+    // Our copy stays open after close() and drains to EOF.
+    try std.testing.expect(c.fcntl(fd, c.F_GETFD) >= 0);
+    var drain: [64]u8 = undefined;
+    var attempts: usize = 0;
+    var eof = false;
+    while (attempts < 20) : (attempts += 1) {
+        var pfd = [_]c.pollfd{.{ .fd = fd, .events = c.POLLIN, .revents = 0 }};
+        _ = c.poll(&pfd, 1, 500);
+        const n = c.read(fd, &drain, drain.len);
+        if (n == 0) {
+            eof = true;
+            break;
+        }
+    }
+    try std.testing.expect(eof);
+}
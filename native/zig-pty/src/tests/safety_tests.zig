@@ -27,6 +27,7 @@ test "operations on closed handle return error" {
     try std.testing.expectEqual(constants.ERROR, exports.bun_pty_get_pid(handle));
     try std.testing.expectEqual(constants.ERROR, exports.bun_pty_get_exit_code(handle));
     try std.testing.expectEqual(constants.ERROR, exports.bun_pty_get_foreground_pid(handle));
+    try std.testing.expectEqual(constants.ERROR, exports.bun_pty_get_notify_fd(handle));
 }
 
 test "double close is safe" {
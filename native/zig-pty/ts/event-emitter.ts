@@ -23,6 +23,10 @@ export class EventEmitter<T> {
     };
   };
 
+  get hasListeners(): boolean {
+    return this.listeners.length > 0;
+  }
+
   fire(data: T) {
     for (const listener of this.listeners) {
       listener(data);
@@ -78,6 +78,7 @@ export const lib = dlopen(libPath, {
     args: [FFIType.i32, FFIType.pointer, FFIType.i32],
     returns: FFIType.i32,
   },
+  bun_pty_get_notify_fd: { args: [FFIType.i32], returns: FFIType.i32 },
   bun_pty_resize: {
     args: [FFIType.i32, FFIType.i32, FFIType.i32],
     returns: FFIType.i32,
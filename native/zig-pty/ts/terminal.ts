@@ -3,11 +3,28 @@
  */
 
 import { ptr } from "bun:ffi";
+import fs from "node:fs";
 import { lib } from "./lib-loader";
 import { EventEmitter } from "./event-emitter";
 import type { IPty, IPtyForkOptions, IExitEvent } from "./types";
 import { DEFAULT_COLS, DEFAULT_ROWS, DEFAULT_FILE } from "./types";
 
+/**
+ * Length of the prefix of `bytes` that ends on a UTF-8 character boundary.
+ */
+function utf8CompleteLength(bytes: Uint8Array): number {
+  const length = bytes.length;
+  let i = length - 1;
+  const stop = Math.max(0, length - 4);
+  while (i >= stop && (bytes[i] & 0xc0) === 0x80) i--;
+  if (i < stop) return length;
+
+  const lead = bytes[i];
+  if (lead < 0xc0 || lead >= 0xf8) return length;
+  const needed = lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : 2;
+  return length - i >= needed ? length : i;
+}
+
 function shQuote(s: string): string {
   if (s.length === 0) return "''";
   return `'${s.replace(/'/g, `'\\''`)}'`;
@@ -22,9 +39,16 @@ export class Terminal implements IPty {
   private _closing: boolean = false;
   private _exitFired: boolean = false;
   private _onData = new EventEmitter<string>();
+  private _onBinaryData = new EventEmitter<Uint8Array>();
   private _onExit = new EventEmitter<IExitEvent>();
   // Streaming TextDecoder handles incomplete UTF-8 sequences across reads
   private _decoder = new TextDecoder("utf-8", { fatal: false });
+  // Trailing bytes of a UTF-8 character split across reads (binary listeners)
+  private _pendingBytes: Uint8Array | null = null;
+  // Reader for the native readiness pipe (null = fall back to polling)
+  private _notifyReader: ReadableStreamDefaultReader<Uint8Array> | null = null;
+  // Our duplicate of the readiness fd, closed once the reader is torn down
+  private _notifyFd: number = -1;
 
   /**
    * Create a Terminal from an already-spawned handle (used by spawnAsync)
@@ -39,8 +63,12 @@ export class Terminal implements IPty {
     term._closing = false;
     term._exitFired = false;
     term._onData = new EventEmitter<string>();
+    term._onBinaryData = new EventEmitter<Uint8Array>();
     term._onExit = new EventEmitter<IExitEvent>();
     term._decoder = new TextDecoder("utf-8", { fatal: false });
+    term._pendingBytes = null;
+    term._notifyReader = null;
+    term._notifyFd = -1;
     term._startReadLoop();
     return term;
   }
@@ -98,6 +126,10 @@ export class Terminal implements IPty {
     return this._onData.event;
   }
 
+  get onBinaryData() {
+    return this._onBinaryData.event;
+  }
+
   get onExit() {
     return this._onExit.event;
   }
@@ -125,6 +157,7 @@ export class Terminal implements IPty {
   kill(signal: string = "SIGTERM"): void {
     if (this._closing) return;
     this._closing = true;
+    this._closeNotifyReader();
     lib.symbols.bun_pty_kill(this.handle);
     lib.symbols.bun_pty_close(this.handle);
     this.handle = -1;
@@ -196,6 +229,99 @@ export class Terminal implements IPty {
     return this.getProcessName(fgPid);
   }
 
+  private _openNotifyReader(): ReadableStreamDefaultReader<Uint8Array> | null {
+    // A duplicate owned by this terminal: bun_pty_close() only closes the
+    // native copy, so the fd number can't be reused while the stream still
+    // watches it.
+    const fd = lib.symbols.bun_pty_get_notify_fd(this.handle);
+    if (fd < 0) return null;
+    try {
+      const reader = Bun.file(fd).stream().getReader();
+      this._notifyFd = fd;
+      return reader;
+    } catch {
+      fs.closeSync(fd);
+      return null;
+    }
+  }
+
+  private _closeNotifyReader(): void {
+    const reader = this._notifyReader;
+    const fd = this._notifyFd;
+    this._notifyReader = null;
+    this._notifyFd = -1;
+    if (fd < 0) return;
+    // Close our fd only after the stream has stopped watching it
+    const release = () => {
+      try {
+        fs.closeSync(fd);
+      } catch {
+        // ignore
+      }
+    };
+    if (reader) {
+      reader.cancel().catch(() => {}).finally(release);
+    } else {
+      release();
+    }
+  }
+
+  /**
+   * Wait until the native reader thread signals new ring buffer data (or
+   * child exit). Falls back to a 1ms poll if the notify pipe is unavailable.
+   */
+  private async _waitForData(): Promise<void> {
+    const reader = this._notifyReader;
+    if (!reader) {
+      await Bun.sleep(1);
+      return;
+    }
+    try {
+      const { done } = await reader.read();
+      if (done && this._notifyReader === reader) {
+        this._notifyReader = null;
+      }
+    } catch {
+      if (this._notifyReader === reader) {
+        this._notifyReader = null;
+      }
+    }
+  }
+
+  /**
+   * Copy `n` bytes out of the reusable read buffer and emit them, holding back
+   * an incomplete trailing UTF-8 character until the next read.
+   */
+  private _emitBinary(buf: Buffer, n: number): void {
+    const pending = this._pendingBytes;
+    const total = (pending?.length ?? 0) + n;
+    const chunk = new Uint8Array(total);
+    let offset = 0;
+    if (pending) {
+      chunk.set(pending, 0);
+      offset = pending.length;
+    }
+    chunk.set(buf.subarray(0, n), offset);
+
+    const complete = utf8CompleteLength(chunk);
+    this._pendingBytes = complete < total ? chunk.slice(complete) : null;
+    if (complete > 0) {
+      this._onBinaryData.fire(complete < total ? chunk.subarray(0, complete) : chunk);
+    }
+  }
+
+  private _finishExit(): void {
+    this._closing = true;
+    this._closeNotifyReader();
+    const exitCode = lib.symbols.bun_pty_get_exit_code(this.handle);
+    lib.symbols.bun_pty_close(this.handle);
+    this.handle = -1;
+    if (!this._exitFired) {
+      this._exitFired = true;
+      this._onExit.fire({ exitCode });
+    }
+  }
+
   private async _startReadLoop(): Promise<void> {
     if (this._readLoop) return;
     this._readLoop = true;
@@ -203,46 +329,44 @@ export class Terminal implements IPty {
 
     // The Zig side has a background thread that reads from the PTY and fills
     // a ring buffer. This naturally coalesces data because blocking reads
-    // wait for data to be available. We just need to drain the ring buffer.
+    // wait for data to be available. Every push also writes to a notify pipe,
+    // so an idle pane just waits on that fd and costs no wakeups.
+    this._notifyReader = this._openNotifyReader();
 
     while (this._readLoop && !this._closing) {
       const n = lib.symbols.bun_pty_read(this.handle, ptr(buf), buf.length);
 
       if (n > 0) {
-        // Got data from ring buffer - decode and emit
-        const data = this._decoder.decode(buf.subarray(0, n), { stream: true });
-        if (data.length > 0) {
-          this._onData.fire(data);
+        // Got data from ring buffer - emit raw bytes, and decode only if
+        // someone still listens for strings
+        if (this._onBinaryData.hasListeners) {
+          this._emitBinary(buf, n);
+        }
+        if (this._onData.hasListeners) {
+          const data = this._decoder.decode(buf.subarray(0, n), { stream: true });
+          if (data.length > 0) {
+            this._onData.fire(data);
+          }
         }
         // Yield briefly to let UI render
         await Bun.sleep(0);
       } else if (n === -2) {
-        // Child exited - flush decoder, close handle, and fire exit
-        this._closing = true;
+        // Child exited - flush pending bytes/decoder, close handle, and fire exit
+        if (this._pendingBytes) {
+          this._onBinaryData.fire(this._pendingBytes);
+          this._pendingBytes = null;
+        }
         const remaining = this._decoder.decode();
         if (remaining.length > 0) this._onData.fire(remaining);
-        const exitCode = lib.symbols.bun_pty_get_exit_code(this.handle);
-        lib.symbols.bun_pty_close(this.handle);
-        this.handle = -1;
-        if (!this._exitFired) {
-          this._exitFired = true;
-          this._onExit.fire({ exitCode });
-        }
+        this._finishExit();
         return;
       } else if (n < 0) {
         // Error - treat as exit to avoid hanging panes
-        this._closing = true;
-        const exitCode = lib.symbols.bun_pty_get_exit_code(this.handle);
-        lib.symbols.bun_pty_close(this.handle);
-        this.handle = -1;
-        if (!this._exitFired) {
-          this._exitFired = true;
-          this._onExit.fire({ exitCode });
-        }
+        this._finishExit();
         return;
       } else {
-        // No data in ring buffer - sleep briefly before polling again
-        await Bun.sleep(1);
+        // Ring buffer drained - wait for the reader thread to signal more
+        await this._waitForData();
       }
     }
   }
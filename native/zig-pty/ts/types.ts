@@ -25,6 +25,11 @@ export interface IPty {
   readonly rows: number;
   readonly process: string;
   readonly onData: (listener: (data: string) => void) => IDisposable;
+  /**
+   * Raw UTF-8 output. Each chunk is a fresh buffer that ends on a character
+   * boundary, so it can be queued or decoded independently.
+   */
+  readonly onBinaryData: (listener: (data: Uint8Array) => void) => IDisposable;
   readonly onExit: (listener: (event: IExitEvent) => void) => IDisposable;
   write(data: string): void;
   resize(columns: number, rows: number): void;
@@ -30,6 +30,13 @@ const content = [
   toml,
   '```',
   '',
+  '## Environment',
+  '',
+  '- `OPENMUX_SHIM_SHARED=1` attaches to the running background shim as a',
+  '  shared viewer alongside the UI already attached, instead of detaching',
+  '  it. Every attached UI receives pty events; each one is only sent',
+  '  terminal output for the panes it is showing.',
+  '',
 ].join('\n');
 
 fs.writeFileSync(outputPath, content, 'utf8');
@@ -77,7 +77,7 @@ function AppContent() {
   const selection = useSelection();
   const { clearAllSelections } = selection;
   const search = useSearch();
-  const { enterSearchMode, exitSearchMode, setSearchQuery, nextMatch, prevMatch } = search;
+  const { enterSearchMode, exitSearchMode, setSearchQuery, toggleSearchRegex, nextMatch, prevMatch } = search;
   const copyMode = useCopyMode();
   const { state: aggregateState, openAggregateView } = useAggregateView();
   const keyboardState = useKeyboardState();
@@ -335,6 +335,7 @@ function AppContent() {
     keyboardExitSearchMode,
     exitSearchMode,
     setSearchQuery,
+    toggleSearchRegex,
     nextMatch,
     prevMatch,
     getSearchState: () => search.searchState,
@@ -49,13 +49,13 @@ export function SearchOverlay(props: SearchOverlayProps) {
   const matchDisplay = () => {
     const state = search.searchState;
     if (!state) return '';
-    const { query, matches, currentMatchIndex } = state;
+    const { query, matches, currentMatchIndex, searching } = state;
     if (query === '') {
       return '';
     } else if (matches.length === 0) {
-      return '0 matches';
+      return searching ? 'searching…' : '0 matches';
     } else {
-      return `${currentMatchIndex + 1}/${matches.length}`;
+      return `${currentMatchIndex + 1}/${matches.length}${searching ? '…' : ''}`;
     }
   };
 
@@ -73,7 +73,7 @@ export function SearchOverlay(props: SearchOverlayProps) {
     return `${nav}:nav ${cancel}:cancel`;
   };
 
-  const promptText = '/ ';
+  const promptText = () => (search.searchState?.regex ? 're/ ' : '/ ');
   const spacerText = ' ';
   const cursorText = '_';
 
@@ -81,7 +81,7 @@ export function SearchOverlay(props: SearchOverlayProps) {
 
   const hintWidth = () => {
     const reserved =
-      promptText.length +
+      promptText().length +
       spacerText.length * 2 +
       cursorText.length +
       matchDisplay().length +
@@ -114,7 +114,7 @@ export function SearchOverlay(props: SearchOverlayProps) {
           titleAlignment="center"
         >
           <box style={{ flexDirection: 'row', height: 1 }}>
-            <text fg={accentColor()}>{promptText}</text>
+            <text fg={accentColor()}>{promptText()}</text>
             <text fg={overlayFg()}>{queryDisplay(state().query)}</text>
             <text fg={accentColor()}>{cursorText}</text>
             <text fg={overlaySeparator()}>{spacerText}</text>
@@ -24,6 +24,7 @@ export function setupKeyboardRouting(params: {
   keyboardExitSearchMode: () => void;
   exitSearchMode: () => void;
   setSearchQuery: (query: string) => void;
+  toggleSearchRegex: () => void;
   nextMatch: () => void;
   prevMatch: () => void;
   getSearchState: () => SearchState | null;
@@ -43,6 +44,7 @@ export function setupKeyboardRouting(params: {
     keyboardExitSearchMode,
     exitSearchMode,
     setSearchQuery,
+    toggleSearchRegex,
     nextMatch,
     prevMatch,
     getSearchState,
@@ -89,6 +91,7 @@ export function setupKeyboardRouting(params: {
           exitSearchMode,
           keyboardExitSearchMode,
           setSearchQuery,
+          toggleSearchRegex,
           nextMatch,
           prevMatch,
           getSearchState,
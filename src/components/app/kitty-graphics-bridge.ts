@@ -69,16 +69,13 @@ export function createKittyGraphicsBridge(params: {
     let unsubscribeTransmit: (() => void) | null = null;
     let unsubscribeKittyUpdate: (() => void) | null = null;
     if (isShimClient()) {
+      // Relayed transmits and image updates go out with the next frame's
+      // synchronized write; queued transmits request that frame through the
+      // broker's flush scheduler
       unsubscribeTransmit = subscribeKittyTransmit((event) => {
         kittyBroker.handleSequence(event.ptyId, event.sequence);
-        queueMicrotask(() => {
-          kittyBroker.flushPending();
-        });
       });
       unsubscribeKittyUpdate = subscribeKittyUpdate(() => {
-        queueMicrotask(() => {
-          kittyRenderer.flush(rendererAny);
-        });
         rendererAny.requestRender?.();
       });
     }
@@ -16,6 +16,7 @@ export interface SearchKeyboardDeps {
   exitSearchMode: (restore: boolean) => void;
   keyboardExitSearchMode: () => void;
   setSearchQuery: (query: string) => void;
+  toggleSearchRegex: () => void;
   nextMatch: () => void;
   prevMatch: () => void;
   getSearchState: () => SearchState | null;
@@ -79,6 +80,11 @@ export function handleSearchKeyboard(event: KeyboardEvent, deps: SearchKeyboardD
       return true;
     }
 
+    if (action === 'search.toggleRegex') {
+      deps.toggleSearchRegex();
+      return true;
+    }
+
     if (action === 'search.delete') {
       deps.setSearchQuery(currentSearchState.query.slice(0, -1));
       return true;
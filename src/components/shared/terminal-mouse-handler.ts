@@ -6,6 +6,7 @@
 import type { TerminalCell } from '../../core/types';
 import type { ITerminalEmulator } from '../../terminal/emulator-interface';
 import type { TerminalState } from '../../core/types';
+import { rowToCells } from '../../terminal/terminal-row';
 
 // Selection state type (matching SelectionContext)
 export interface SelectionState {
@@ -169,7 +170,8 @@ export function createTerminalMouseHandler(deps: TerminalMouseDeps) {
         return emulator?.getScrollbackLine(absoluteY) ?? null;
       } else {
         const liveY = absoluteY - scrollbackLength;
-        return state?.cells[liveY] ?? null;
+        const row = state?.cells[liveY];
+        return row ? rowToCells(row) : null;
       }
     };
 
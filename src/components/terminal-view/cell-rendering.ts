@@ -2,7 +2,9 @@
  * Cell Rendering - utilities for rendering terminal cells with styling
  */
 import type { RGBA, OptimizedBuffer } from '@opentui/core'
-import type { TerminalCell } from '../../core/types'
+import type { TerminalCell, TerminalRow } from '../../core/types'
+import { RowFlags, cellRowFlags, codepointString, packRgb } from '../../terminal/terminal-row'
+import type { RenderRow } from './row-fetching'
 import {
   WHITE,
   BLACK,
@@ -47,9 +49,18 @@ export interface CellRenderingOptions {
   copyCursorBg: RGBA
 }
 
+export interface CellColors {
+  fg: RGBA
+  bg: RGBA
+  attributes: number
+}
+
+const cellColors: CellColors = { fg: BLACK, bg: BLACK, attributes: 0 }
+
 /**
  * Render a single terminal cell with appropriate styling
- * Returns the colors to use for the cell
+ * Returns the colors to use for the cell. The returned object is reused by
+ * the next call.
  */
 export function getCellColors(
   cell: TerminalCell,
@@ -58,7 +69,32 @@ export function getCellColors(
   screenY: number,
   options: CellRenderingOptions,
   deps: CellRenderingDeps
-): { fg: RGBA; bg: RGBA; attributes: number } {
+): CellColors {
+  return resolveCellColors(
+    packRgb(cell.fg.r, cell.fg.g, cell.fg.b),
+    packRgb(cell.bg.r, cell.bg.g, cell.bg.b),
+    cellRowFlags(cell),
+    x,
+    absoluteY,
+    screenY,
+    options,
+    deps
+  )
+}
+
+/**
+ * Resolve the colors of a cell given its packed 0xRRGGBB colors and RowFlags.
+ */
+function resolveCellColors(
+  cellFg: number,
+  cellBg: number,
+  flags: number,
+  x: number,
+  absoluteY: number,
+  screenY: number,
+  options: CellRenderingOptions,
+  deps: CellRenderingDeps
+): CellColors {
   const {
     ptyId,
     hasSelection,
@@ -92,18 +128,18 @@ export function getCellColors(
   const isCurrent = hasSearch && deps.isCurrentMatch(ptyId, x, absoluteY)
 
   // Determine cell colors
-  let fgR = cell.fg.r, fgG = cell.fg.g, fgB = cell.fg.b
-  let bgR = cell.bg.r, bgG = cell.bg.g, bgB = cell.bg.b
+  let fgR = (cellFg >> 16) & 0xff, fgG = (cellFg >> 8) & 0xff, fgB = cellFg & 0xff
+  let bgR = (cellBg >> 16) & 0xff, bgG = (cellBg >> 8) & 0xff, bgB = cellBg & 0xff
 
   // Apply dim effect
-  if (cell.dim) {
+  if (flags & RowFlags.DIM) {
     fgR = Math.floor(fgR * 0.5)
     fgG = Math.floor(fgG * 0.5)
     fgB = Math.floor(fgB * 0.5)
   }
 
   // Apply inverse (avoid array destructuring for performance)
-  if (cell.inverse) {
+  if (flags & RowFlags.INVERSE) {
     const tmpR = fgR; fgR = bgR; bgR = tmpR
     const tmpG = fgG; fgG = bgG; bgG = tmpG
     const tmpB = fgB; fgB = bgB; bgB = tmpB
@@ -141,20 +177,24 @@ export function getCellColors(
 
   // Calculate attributes
   let attributes = 0
-  if (cell.bold) attributes |= ATTR_BOLD
-  if (cell.italic) attributes |= ATTR_ITALIC
-  if (cell.underline) attributes |= ATTR_UNDERLINE
-  if (cell.strikethrough) attributes |= ATTR_STRIKETHROUGH
+  if (flags & RowFlags.BOLD) attributes |= ATTR_BOLD
+  if (flags & RowFlags.ITALIC) attributes |= ATTR_ITALIC
+  if (flags & RowFlags.UNDERLINE) attributes |= ATTR_UNDERLINE
+  if (flags & RowFlags.STRIKETHROUGH) attributes |= ATTR_STRIKETHROUGH
 
-  return { fg, bg, attributes }
+  cellColors.fg = fg
+  cellColors.bg = bg
+  cellColors.attributes = attributes
+  return cellColors
 }
 
 /**
- * Render a row of terminal cells to the buffer
+ * Render a row of terminal cells to the buffer.
+ * Live rows are packed TerminalRows; scrollback rows are cell arrays.
  */
 export function renderRow(
   buffer: OptimizedBuffer,
-  row: TerminalCell[] | null,
+  row: RenderRow | null,
   rowIndex: number,
   cols: number,
   offsetX: number,
@@ -169,14 +209,18 @@ export function renderRow(
   // Calculate absolute Y for selection check (accounts for scrollback)
   const absoluteY = scrollbackLength - viewportOffset + rowIndex
 
+  const cells = Array.isArray(row) ? row : null
+  const packed = row && !cells ? row as TerminalRow : null
+  const packedCols = packed ? packed.codepoints.length : 0
+
   // Track the previous cell to detect spacer cells after wide characters
   let prevCellWasWide = false
   let prevCellBg: RGBA | null = null
 
   for (let x = 0; x < cols; x++) {
-    const cell = row?.[x] ?? null
+    const cell = cells ? cells[x] ?? null : null
 
-    if (!cell) {
+    if (!cell && x >= packedCols) {
       // No cell data - use fallback
       buffer.setCell(x + offsetX, rowIndex + offsetY, ' ', fallbackFg, fallbackBg, 0)
       prevCellWasWide = false
@@ -193,21 +237,27 @@ export function renderRow(
       continue
     }
 
-    const { fg, bg, attributes } = getCellColors(
-      cell,
-      x,
-      absoluteY,
-      rowIndex,
-      options,
-      deps
-    )
+    let char: string
+    let width: number
+    let colors: CellColors
+    if (cell) {
+      colors = getCellColors(cell, x, absoluteY, rowIndex, options, deps)
+      char = cell.char
+      width = cell.width
+    } else {
+      const p = packed!
+      colors = resolveCellColors(p.fg[x], p.bg[x], p.flags[x], x, absoluteY, rowIndex, options, deps)
+      char = codepointString(p.codepoints[x])
+      width = p.widths[x]
+    }
+    const { fg, bg, attributes } = colors
 
     // Write cell directly to buffer (with offset for pane position)
     // Use fallback space if char is empty to ensure cell is always overwritten
-    buffer.setCell(x + offsetX, rowIndex + offsetY, cell.char || ' ', fg, bg, attributes)
+    buffer.setCell(x + offsetX, rowIndex + offsetY, char || ' ', fg, bg, attributes)
 
     // Track if this cell was wide for next iteration
-    prevCellWasWide = cell.width === 2
+    prevCellWasWide = width === 2
     prevCellBg = prevCellWasWide ? bg : null
   }
 }
@@ -6,6 +6,7 @@
 export {
   getCellColors,
   renderRow,
+  type CellColors,
   type CellRenderingDeps,
   type CellRenderingOptions,
 } from './cell-rendering'
@@ -21,6 +22,7 @@ export {
   calculatePrefetchRequest,
   type RowFetchingOptions,
   type RowFetchResult,
+  type RenderRow,
   type PrefetchRequest,
 } from './row-fetching'
 
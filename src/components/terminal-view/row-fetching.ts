@@ -1,9 +1,12 @@
 /**
  * Row Fetching - handles fetching rows for terminal rendering with scrollback
  */
-import type { TerminalCell, TerminalState } from '../../core/types'
+import type { TerminalCell, TerminalRow, TerminalState } from '../../core/types'
 import type { ITerminalEmulator } from '../../terminal/emulator-interface'
 
+/** A row to render: packed for the live screen, cell objects for scrollback */
+export type RenderRow = TerminalRow | TerminalCell[]
+
 export interface RowFetchingOptions {
   viewportOffset: number
   scrollbackLength: number
@@ -11,7 +14,7 @@ export interface RowFetchingOptions {
 }
 
 export interface RowFetchResult {
-  rowCache: (TerminalCell[] | null)[]
+  rowCache: (RenderRow | null)[]
   firstMissingOffset: number
   lastMissingOffset: number
 }
@@ -28,7 +31,7 @@ export function fetchRowsForRendering(
   const { viewportOffset, scrollbackLength, rows } = options
 
   const currentEmulator = viewportOffset > 0 ? emulator : null
-  const rowCache: (TerminalCell[] | null)[] = new Array(rows)
+  const rowCache: (RenderRow | null)[] = new Array(rows)
 
   // Track missing scrollback lines for prefetching
   let firstMissingOffset = -1
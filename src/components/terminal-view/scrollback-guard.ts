@@ -1,4 +1,4 @@
-import type { TerminalCell } from '../../core/types'
+import type { RenderRow } from './row-fetching'
 
 /**
  * Scrollback render guard
@@ -11,7 +11,7 @@ export interface ScrollbackGuardOptions {
   desiredViewportOffset: number
   desiredScrollbackLength: number
   rows: number
-  desiredRowCache: (TerminalCell[] | null)[]
+  desiredRowCache: (RenderRow | null)[]
   lastStableViewportOffset: number
   lastStableScrollbackLength: number
   lastObservedViewportOffset: number
@@ -23,7 +23,7 @@ export interface ScrollbackGuardResult {
   isUserScroll: boolean
   renderViewportOffset: number
   renderScrollbackLength: number
-  renderRowCache: (TerminalCell[] | null)[]
+  renderRowCache: (RenderRow | null)[]
   hasMissingScrollback: boolean
 }
 
@@ -49,7 +49,7 @@ export function guardScrollbackRender(
   const isUserScroll = desiredViewportOffset !== expectedViewportOffset
 
   let hasMissingScrollback = false
-  const renderRowCache: (TerminalCell[] | null)[] = new Array(rows)
+  const renderRowCache: (RenderRow | null)[] = new Array(rows)
   for (let y = 0; y < rows; y++) {
     const absoluteY = desiredScrollbackLength - desiredViewportOffset + y
     const row = desiredRowCache[y]
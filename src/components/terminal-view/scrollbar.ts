@@ -2,10 +2,11 @@
  * Scrollbar Rendering - renders the scrollbar overlay for terminal
  */
 import { RGBA, type OptimizedBuffer } from '@opentui/core'
-import type { TerminalCell } from '../../core/types'
 import { getCachedRGBA, SELECTION_BG } from '../../terminal/rendering'
 import { getDefaultColors, getHostColors } from '../../terminal/terminal-colors'
 import { mixColor, luminance, toRgba } from '../../terminal/color-utils'
+import { codepointString } from '../../terminal/terminal-row'
+import type { RenderRow } from './row-fetching'
 
 const TRANSPARENT_BG = RGBA.fromInts(0, 0, 0, 0)
 const TRACK_ALPHA = 160
@@ -47,7 +48,7 @@ export interface ScrollbarOptions {
  */
 export function renderScrollbar(
   buffer: OptimizedBuffer,
-  rowCache: (TerminalCell[] | null)[],
+  rowCache: (RenderRow | null)[],
   options: ScrollbarOptions,
   fallbackFg: RGBA
 ): void {
@@ -95,9 +96,21 @@ export function renderScrollbar(
     const isThumb = y >= thumbPosition && y < thumbPosition + thumbHeight
     // Get the underlying cell to preserve its character
     const row = rowCache[y]
-    const cell = contentCol >= 0 ? row?.[contentCol] : null
-    const underlyingChar = cell?.char || ' '
-    const underlyingFg = cell ? getCachedRGBA(cell.fg.r, cell.fg.g, cell.fg.b) : fallbackFg
+    let underlyingChar = ' '
+    let underlyingFg = fallbackFg
+    if (row && contentCol >= 0) {
+      if (Array.isArray(row)) {
+        const cell = row[contentCol]
+        if (cell) {
+          underlyingChar = cell.char || ' '
+          underlyingFg = getCachedRGBA(cell.fg.r, cell.fg.g, cell.fg.b)
+        }
+      } else if (contentCol < row.codepoints.length) {
+        const fg = row.fg[contentCol]
+        underlyingChar = codepointString(row.codepoints[contentCol])
+        underlyingFg = getCachedRGBA((fg >> 16) & 0xff, (fg >> 8) & 0xff, fg & 0xff)
+      }
+    }
     const overlayBg = isThumb ? colors.thumb : colors.track
     if (ptyId) {
       const absY = scrollbackLength - viewportOffset + y
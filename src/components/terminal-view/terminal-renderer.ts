@@ -88,8 +88,9 @@ export function createTerminalRenderer(params: {
 
     const rows = Math.min(state.rows, height);
     const cols = Math.min(state.cols, width);
-    const fallbackBgColor = state.cells?.[0]?.[0]?.bg ?? { r: 0, g: 0, b: 0 };
-    const fallbackBg = getCachedRGBA(fallbackBgColor.r, fallbackBgColor.g, fallbackBgColor.b);
+    const firstRow = state.cells?.[0];
+    const fallbackBgColor = firstRow && firstRow.bg.length > 0 ? firstRow.bg[0] : 0;
+    const fallbackBg = getCachedRGBA((fallbackBgColor >> 16) & 0xff, (fallbackBgColor >> 8) & 0xff, fallbackBgColor & 0xff);
     const fallbackFg = BLACK;
 
     const {
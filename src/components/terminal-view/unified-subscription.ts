@@ -1,5 +1,5 @@
 import { createEffect, on, onCleanup } from 'solid-js';
-import type { TerminalCell, UnifiedTerminalUpdate } from '../../core/types';
+import type { TerminalRow, UnifiedTerminalUpdate } from '../../core/types';
 import { subscribeUnifiedToPty, getEmulator } from '../../effect/bridge';
 import { deferMacrotask } from '../../core/scheduling';
 import { getKittyGraphicsRenderer } from '../../terminal/kitty-graphics';
@@ -42,7 +42,7 @@ export function setupUnifiedSubscription(deps: UnifiedSubscriptionDeps): void {
         let renderRequested = false;
 
         // Cache for terminal rows (structural sharing).
-        let cachedRows: TerminalCell[][] = [];
+        let cachedRows: TerminalRow[] = [];
 
         const requestRenderFrame = () => {
           if (!renderRequested && mounted) {
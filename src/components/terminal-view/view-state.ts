@@ -1,6 +1,6 @@
-import type { TerminalCell, TerminalState, TerminalScrollState } from '../../core/types';
+import type { TerminalState, TerminalScrollState } from '../../core/types';
 import type { ITerminalEmulator } from '../../terminal/emulator-interface';
-import type { PrefetchRequest } from './row-fetching';
+import type { PrefetchRequest, RenderRow } from './row-fetching';
 
 export interface TerminalViewState {
   terminalState: TerminalState | null;
@@ -12,7 +12,7 @@ export interface TerminalViewState {
   executePrefetchFn: (() => void) | null;
   lastStableViewportOffset: number;
   lastStableScrollbackLength: number;
-  lastStableRowCache: (TerminalCell[] | null)[] | null;
+  lastStableRowCache: (RenderRow | null)[] | null;
   lastObservedViewportOffset: number;
   lastObservedScrollbackLength: number;
 }
@@ -13,6 +13,7 @@ import {
 import type { TerminalCell } from '../core/types';
 import { isCellInRange, extractSelectedText } from '../core/coordinates';
 import { copyToClipboard } from '../effect/bridge';
+import { rowToCells } from '../terminal/terminal-row';
 import { useTerminal } from './TerminalContext';
 import { useSelection } from './SelectionContext';
 import type {
@@ -210,7 +211,8 @@ export function CopyModeProvider(props: CopyModeProviderProps) {
       return meta.emulator?.getScrollbackLine(absY) ?? null;
     }
     const liveY = absY - meta.scrollbackLength;
-    return meta.terminalState.cells[liveY] ?? null;
+    const row = meta.terminalState.cells[liveY];
+    return row ? rowToCells(row) : null;
   };
 
   const getLineAccessor = (ptyId: string): LineAccessor | null => {
@@ -222,7 +224,8 @@ export function CopyModeProvider(props: CopyModeProviderProps) {
         return meta.emulator?.getScrollbackLine(absY) ?? null;
       }
       const liveY = absY - meta.scrollbackLength;
-      return meta.terminalState?.cells[liveY] ?? null;
+      const row = meta.terminalState?.cells[liveY];
+      return row ? rowToCells(row) : null;
     };
     return { maxAbsY, getLine };
   };
@@ -2,7 +2,9 @@
  * SearchContext - manages terminal search state
  *
  * Provides vim-style search functionality with:
- * - Case-insensitive substring search
+ * - Case-insensitive substring or regex search
+ * - Streamed results, nearest to the viewport first
+ * - Incremental updates as new output arrives
  * - Match highlighting (all matches + current match)
  * - Navigation between matches with auto-scroll
  */
@@ -20,12 +22,17 @@ import { getEmulator, getTerminalState, getScrollState } from '../effect/bridge'
 import { useTerminal } from './TerminalContext';
 import { runStream } from '../effect/stream-utils';
 import type { VimInputMode } from '../core/vim-sequences';
+import type { ITerminalEmulator, LineNumbering, SearchResult } from '../terminal/emulator-interface';
+import { DEFAULT_SEARCH_LIMIT } from '../terminal/search-job';
 
 // Import extracted search utilities
-import type { SearchState, SearchContextValue } from './search/types';
+import type { SearchMatch, SearchState, SearchContextValue } from './search/types';
 import {
   isCellInMatch,
   calculateScrollOffset,
+  getViewportCenterLine,
+  mergeMatches,
+  findNearestMatchIndex,
   buildMatchLookup,
 } from './search/helpers';
 
@@ -41,8 +48,12 @@ const SearchContext = createContext<SearchContextValue | null>(null);
 
 interface SearchProviderProps extends ParentProps {}
 
-// Search debounce delay in ms
+// Search debounce delay in ms (also used to batch output-driven refreshes)
 const SEARCH_DEBOUNCE_MS = 150;
+// Matches kept while following new output; the oldest are dropped past this
+const SEARCH_MATCH_CAP = DEFAULT_SEARCH_LIMIT;
+// Refresh searches re-run when lines are dropped mid-search before starting over
+const MAX_FOLLOW_ATTEMPTS = 2;
 
 export function SearchProvider(props: SearchProviderProps) {
   // Get setScrollOffset from TerminalContext (updates cache for immediate rendering)
@@ -56,6 +67,19 @@ export function SearchProvider(props: SearchProviderProps) {
   const [searchVersion, setSearchVersion] = createSignal(0);
 
   let queryEmitter: ((query: string) => void) | null = null;
+  // In-flight search job; aborted as soon as the query or mode changes
+  let searchAbort: AbortController | null = null;
+  // Stops searching new output for the current query
+  let stopFollowing: (() => void) | null = null;
+  // Query last searched again because lines were renumbered mid-search
+  let renumberedQuery: string | null = null;
+
+  const cancelSearch = () => {
+    searchAbort?.abort();
+    searchAbort = null;
+    stopFollowing?.();
+    stopFollowing = null;
+  };
 
   // Spatial index for O(1) match lookup by line
   // Map<lineIndex, Array<{startCol, endCol}>>
@@ -72,6 +96,230 @@ export function SearchProvider(props: SearchProviderProps) {
       : new Map();
   };
 
+  // Scroll so a match sits in the middle of the area above the overlay
+  const scrollToMatch = (state: SearchState, match: SearchMatch) => {
+    if (!state.terminalState) return;
+    const offset = calculateScrollOffset(
+      match.lineIndex,
+      state.scrollbackLength,
+      state.terminalState.rows
+    );
+    setScrollOffset(state.ptyId, offset);
+  };
+
+  /**
+   * Keep matches current as output arrives. Only lines from `liveStart` (the
+   * top of the screen when they were last searched) onward can change, so
+   * each refresh searches just those and replaces the matches found there.
+   * Lines dropped from the top of the scrollback shift the kept matches up;
+   * any other renumbering starts the search over.
+   * Returns a function that runs any refresh held back by an in-flight
+   * search, given the numbering that search's matches refer to.
+   */
+  const followOutput = (
+    emulator: ITerminalEmulator,
+    query: string,
+    regex: boolean,
+    liveStart: number
+  ): ((numbering?: LineNumbering) => void) => {
+    let dirty = false;
+    let timer: ReturnType<typeof setTimeout> | null = null;
+    // Numbering the current matches refer to (unknown for emulators that don't report it)
+    let known: LineNumbering | undefined;
+
+    const refresh = async () => {
+      timer = null;
+      const state = searchState();
+      if (!state || state.query !== query || state.regex !== regex) return;
+      dirty = false;
+
+      const scrollbackLength = emulator.getScrollbackLength();
+      if (!known && scrollbackLength < liveStart) {
+        // Scrollback was trimmed and line indexes shifted: search again
+        queryEmitter?.(query);
+        return;
+      }
+
+      const controller = new AbortController();
+      searchAbort = controller;
+      try {
+        // Lines dropped since `known`; kept matches and liveStart move up by as many
+        let shift = 0;
+        let result: SearchResult;
+        for (let attempt = 0; ; attempt++) {
+          result = await emulator.search(query, {
+            regex,
+            startLine: Math.max(0, liveStart - shift),
+            signal: controller.signal,
+          });
+          if (controller.signal.aborted) return;
+          if (!known) break;
+          const numbering = result.numbering;
+          if (
+            !numbering ||
+            result.renumbered ||
+            numbering.epoch !== known.epoch ||
+            attempt >= MAX_FOLLOW_ATTEMPTS
+          ) {
+            queryEmitter?.(query);
+            return;
+          }
+          const dropped = numbering.dropped - known.dropped;
+          if (dropped === shift) break;
+          // More lines were dropped than the search started from accounted for
+          shift = dropped;
+        }
+        const latest = searchState();
+        if (!latest || latest.query !== query) return;
+
+        const current = latest.matches[latest.currentMatchIndex];
+        const kept: SearchMatch[] = [];
+        let currentKept: SearchMatch | undefined;
+        for (const match of latest.matches) {
+          if (match.lineIndex >= liveStart || match.lineIndex < shift) continue;
+          const moved = shift > 0 ? { ...match, lineIndex: match.lineIndex - shift } : match;
+          if (match === current) currentKept = moved;
+          kept.push(moved);
+        }
+        if (known && result.numbering) known = result.numbering;
+        let matches = mergeMatches(kept, result.matches);
+        let hasMore = latest.hasMore || result.hasMore;
+        if (matches.length > SEARCH_MATCH_CAP) {
+          matches = matches.slice(matches.length - SEARCH_MATCH_CAP);
+          hasMore = true;
+        }
+        let currentMatchIndex = currentKept ? matches.indexOf(currentKept) : -1;
+        if (currentMatchIndex < 0) {
+          currentMatchIndex = findNearestMatchIndex(
+            matches,
+            current ? current.lineIndex - shift : scrollbackLength
+          );
+        }
+
+        updateSearchState({
+          ...latest,
+          matches,
+          hasMore,
+          currentMatchIndex,
+          scrollbackLength,
+        });
+        // The length was read before the search; lines dropped since only move it up
+        liveStart = Math.max(0, scrollbackLength - shift);
+      } finally {
+        if (searchAbort === controller) searchAbort = null;
+      }
+      if (dirty) schedule();
+    };
+
+    const schedule = () => {
+      dirty = true;
+      if (timer || searchAbort) return;
+      timer = setTimeout(() => {
+        void refresh().catch(() => {});
+      }, SEARCH_DEBOUNCE_MS);
+    };
+
+    const unsubscribe = emulator.onUpdate(schedule);
+    stopFollowing = () => {
+      unsubscribe();
+      if (timer) clearTimeout(timer);
+      timer = null;
+    };
+
+    return (numbering) => {
+      known = numbering;
+      if (dirty) schedule();
+    };
+  };
+
+  /**
+   * Run a search job for the current query. Matches stream in nearest to
+   * the viewport first; the first batch picks and scrolls to the current
+   * match while the rest of the scrollback is still being scanned.
+   */
+  const runSearch = async (query: string) => {
+    const state = searchState();
+    if (!state || !state.emulator || !state.terminalState) return;
+    if (state.query !== query) return;
+
+    cancelSearch();
+    const controller = new AbortController();
+    searchAbort = controller;
+
+    const { emulator, regex } = state;
+    const scrollbackLength = emulator.getScrollbackLength();
+    const scrollState = await getScrollState(state.ptyId);
+    if (controller.signal.aborted) return;
+    const anchor = getViewportCenterLine(
+      scrollbackLength,
+      scrollState?.viewportOffset ?? 0,
+      state.terminalState.rows
+    );
+
+    let first = true;
+    const onMatches = (batch: SearchMatch[]) => {
+      if (controller.signal.aborted) return;
+      const latest = searchState();
+      if (!latest || latest.query !== query) return;
+
+      if (first) {
+        // Replaces the previous query's matches, kept until now to avoid flicker
+        first = false;
+        const matches = mergeMatches([], batch);
+        const currentMatchIndex = findNearestMatchIndex(matches, anchor);
+        const next = { ...latest, matches, currentMatchIndex, scrollbackLength };
+        updateSearchState(next);
+        scrollToMatch(next, matches[currentMatchIndex]);
+        return;
+      }
+
+      const current = latest.matches[latest.currentMatchIndex];
+      const matches = mergeMatches(latest.matches, batch);
+      updateSearchState({
+        ...latest,
+        matches,
+        currentMatchIndex: current ? matches.indexOf(current) : -1,
+      });
+    };
+
+    updateSearchState({ ...state, hasMore: false, searching: true });
+    const resumeFollowing = followOutput(emulator, query, regex, scrollbackLength);
+
+    let numbering: LineNumbering | undefined;
+    try {
+      const result = await emulator.search(query, {
+        regex,
+        anchor,
+        signal: controller.signal,
+        onMatches,
+      });
+      if (controller.signal.aborted) return;
+      if (result.renumbered && renumberedQuery !== query) {
+        // Matches straddle a renumbering; search once more rather than keep them
+        renumberedQuery = query;
+        queryEmitter?.(query);
+        return;
+      }
+      renumberedQuery = null;
+      numbering = result.numbering;
+      const { hasMore } = result;
+
+      const latest = searchState();
+      if (!latest || latest.query !== query) return;
+      updateSearchState({
+        ...latest,
+        // No batch arrived, so there are no matches
+        ...(first ? { matches: [], currentMatchIndex: -1 } : {}),
+        hasMore,
+        searching: false,
+        scrollbackLength,
+      });
+    } finally {
+      if (searchAbort === controller) searchAbort = null;
+    }
+    resumeFollowing(numbering);
+  };
+
   const searchStream = Stream.async<string>((emit) => {
     queryEmitter = (query) => {
       void emit.single(query);
@@ -81,41 +329,13 @@ export function SearchProvider(props: SearchProviderProps) {
     });
   }).pipe(
     Stream.debounce(Duration.millis(SEARCH_DEBOUNCE_MS)),
-    Stream.tap((query) =>
-      Effect.tryPromise(async () => {
-        const currentState = searchState();
-        if (!currentState || !currentState.emulator || !currentState.terminalState) return;
-        if (currentState.query !== query) return;
-
-        const { matches, hasMore } = await currentState.emulator.search(query);
-        const latestState = searchState();
-        if (!latestState || !latestState.terminalState || latestState.query !== query) return;
-
-        const initialIndex = matches.length > 0 ? matches.length - 1 : -1;
-        updateSearchState({
-          ...latestState,
-          query,
-          matches,
-          hasMore,
-          currentMatchIndex: initialIndex,
-        });
-
-        if (matches.length > 0) {
-          const match = matches[initialIndex];
-          const offset = calculateScrollOffset(
-            match.lineIndex,
-            latestState.scrollbackLength,
-            latestState.terminalState.rows
-          );
-          setScrollOffset(latestState.ptyId, offset);
-        }
-      })
-    )
+    Stream.tap((query) => Effect.tryPromise(() => runSearch(query)))
   );
 
   // Cleanup on unmount
   let stopSearchStream: (() => void) | null = null;
   onCleanup(() => {
+    cancelSearch();
     stopSearchStream?.();
   });
 
@@ -139,7 +359,9 @@ export function SearchProvider(props: SearchProviderProps) {
       query: '',
       matches: [],
       hasMore: false,
+      searching: false,
       currentMatchIndex: -1,
+      regex: false,
       ptyId,
       emulator,
       terminalState,
@@ -154,6 +376,7 @@ export function SearchProvider(props: SearchProviderProps) {
     if (!state) return;
 
     setVimMode('normal');
+    cancelSearch();
 
     // Restore original scroll position if requested (on Escape)
     if (restorePosition && state.originalScrollOffset !== undefined) {
@@ -168,6 +391,8 @@ export function SearchProvider(props: SearchProviderProps) {
     const state = searchState();
     if (!state || !state.emulator || !state.terminalState) return;
 
+    cancelSearch();
+
     // Update query immediately for display (show typing instantly)
     updateSearchState({
       ...state,
@@ -178,6 +403,20 @@ export function SearchProvider(props: SearchProviderProps) {
     queryEmitter?.(query);
   };
 
+  // Switch between substring and regex matching, re-running the query
+  const toggleSearchRegex = () => {
+    const state = searchState();
+    if (!state || !state.emulator || !state.terminalState) return;
+
+    cancelSearch();
+    updateSearchState({
+      ...state,
+      regex: !state.regex,
+    });
+
+    queryEmitter?.(state.query);
+  };
+
   // Navigate to next match
   const nextMatch = () => {
     const state = searchState();
@@ -192,12 +431,7 @@ export function SearchProvider(props: SearchProviderProps) {
     });
 
     // Scroll to show match
-    const offset = calculateScrollOffset(
-      match.lineIndex,
-      state.scrollbackLength,
-      state.terminalState.rows
-    );
-    setScrollOffset(state.ptyId, offset);
+    scrollToMatch(state, match);
   };
 
   // Navigate to previous match
@@ -216,12 +450,7 @@ export function SearchProvider(props: SearchProviderProps) {
     });
 
     // Scroll to show match
-    const offset = calculateScrollOffset(
-      match.lineIndex,
-      state.scrollbackLength,
-      state.terminalState.rows
-    );
-    setScrollOffset(state.ptyId, offset);
+    scrollToMatch(state, match);
   };
 
   // Check if cell is any search match (optimized with spatial index)
@@ -266,6 +495,7 @@ export function SearchProvider(props: SearchProviderProps) {
     enterSearchMode,
     exitSearchMode,
     setSearchQuery,
+    toggleSearchRegex,
     nextMatch,
     prevMatch,
     isSearchMatch,
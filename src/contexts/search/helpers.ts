@@ -3,6 +3,8 @@
  */
 import type { TerminalCell, TerminalState } from '../../core/types';
 import type { ITerminalEmulator } from '../../terminal/emulator-interface';
+import { extractRowText } from '../../terminal/terminal-row';
+import { compareSearchMatches } from '../../terminal/search-job';
 import type { SearchMatch } from './types';
 
 /**
@@ -68,7 +70,7 @@ export function performSearch(
     const cells = terminalState.cells[row];
     if (!cells) continue;
 
-    const lineText = extractLineText(cells).toLowerCase();
+    const lineText = extractRowText(cells).toLowerCase();
     let searchPos = 0;
 
     while (true) {
@@ -130,6 +132,57 @@ export function calculateScrollOffset(
   return Math.max(0, Math.min(targetOffset, scrollbackLength));
 }
 
+/**
+ * Absolute line at the middle of the viewport; searches start there so the
+ * nearest matches arrive first
+ */
+export function getViewportCenterLine(
+  scrollbackLength: number,
+  viewportOffset: number,
+  terminalRows: number
+): number {
+  return Math.max(0, scrollbackLength - viewportOffset + Math.floor(terminalRows / 2));
+}
+
+/**
+ * Merge a batch of matches (in any order) into a list sorted oldest to newest
+ */
+export function mergeMatches(matches: SearchMatch[], batch: SearchMatch[]): SearchMatch[] {
+  const sorted = [...batch].sort(compareSearchMatches);
+  const merged: SearchMatch[] = [];
+  let i = 0;
+  let j = 0;
+  while (i < matches.length && j < sorted.length) {
+    merged.push(compareSearchMatches(matches[i], sorted[j]) <= 0 ? matches[i++] : sorted[j++]);
+  }
+  while (i < matches.length) merged.push(matches[i++]);
+  while (j < sorted.length) merged.push(sorted[j++]);
+  return merged;
+}
+
+/**
+ * Index of the match closest to a line, preferring the later one on ties
+ * (-1 if there are no matches)
+ */
+export function findNearestMatchIndex(matches: SearchMatch[], lineIndex: number): number {
+  if (matches.length === 0) return -1;
+
+  // First match at or after lineIndex
+  let lo = 0;
+  let hi = matches.length;
+  while (lo < hi) {
+    const mid = (lo + hi) >> 1;
+    if (matches[mid].lineIndex < lineIndex) lo = mid + 1;
+    else hi = mid;
+  }
+
+  if (lo === matches.length) return lo - 1;
+  if (lo === 0) return 0;
+  const before = lineIndex - matches[lo - 1].lineIndex;
+  const after = matches[lo].lineIndex - lineIndex;
+  return after <= before ? lo : lo - 1;
+}
+
 /**
  * Build spatial index for O(1) match lookup by line
  * Returns Map<lineIndex, Array<{startCol, endCol}>>
@@ -8,5 +8,8 @@ export {
   performSearch,
   isCellInMatch,
   calculateScrollOffset,
+  getViewportCenterLine,
+  mergeMatches,
+  findNearestMatchIndex,
   buildMatchLookup,
 } from './helpers';
@@ -27,15 +27,19 @@ export interface SearchState {
   matches: SearchMatch[];
   /** Whether more matches exist beyond the limit */
   hasMore: boolean;
+  /** Whether a search job is still streaming matches in */
+  searching: boolean;
   /** Index of currently highlighted match (-1 if no matches) */
   currentMatchIndex: number;
+  /** Whether the query is a regular expression */
+  regex: boolean;
   /** The ptyId being searched */
   ptyId: string;
   /** Cached emulator for scrollback access */
   emulator: ITerminalEmulator | null;
   /** Cached terminal state */
   terminalState: TerminalState | null;
-  /** Total scrollback length at search time */
+  /** Scrollback length when matches were last updated */
   scrollbackLength: number;
   /** Original scroll offset before search started (to restore on cancel) */
   originalScrollOffset: number;
@@ -57,6 +61,8 @@ export interface SearchContextValue {
   exitSearchMode: (restorePosition?: boolean) => void;
   /** Update search query (triggers re-search) */
   setSearchQuery: (query: string) => void;
+  /** Toggle regex matching (triggers re-search) */
+  toggleSearchRegex: () => void;
   /** Navigate to next match */
   nextMatch: () => void;
   /** Navigate to previous match */
@@ -1,6 +1,7 @@
-import type { TerminalCell } from '../core/types';
+import type { TerminalCell, TerminalRow } from '../core/types';
 import type { ITerminalEmulator } from '../terminal/emulator-interface';
 import { extractLineText } from '../terminal/ghostty-vt/utils';
+import { extractRowText, rowToCells } from '../terminal/terminal-row';
 
 export type CaptureFormat = 'text' | 'ansi';
 
@@ -23,10 +24,27 @@ type StyleState = {
 
 const RESET = '\u001b[0m';
 
+/** Scrollback lines are cell arrays; live lines are packed rows */
+type CaptureLine = TerminalCell[] | TerminalRow;
+
 function rgbToKey(color: { r: number; g: number; b: number }): string {
   return `${color.r};${color.g};${color.b}`;
 }
 
+function findLastRowContentIndex(row: TerminalRow): number {
+  const { codepoints, widths } = row;
+  let last = -1;
+  for (let i = 0; i < codepoints.length; i++) {
+    if (codepoints[i] !== 0 && codepoints[i] !== 0x20) {
+      last = i;
+    }
+    if (widths[i] === 2) {
+      i++;
+    }
+  }
+  return last;
+}
+
 function findLastContentIndex(cells: TerminalCell[]): number {
   let last = -1;
   for (let i = 0; i < cells.length; i++) {
@@ -41,9 +59,11 @@ function findLastContentIndex(cells: TerminalCell[]): number {
   return last;
 }
 
-function hasLineContent(cells: TerminalCell[] | null): boolean {
-  if (!cells || cells.length === 0) return false;
-  return findLastContentIndex(cells) >= 0;
+function hasLineContent(line: CaptureLine | null): boolean {
+  if (!line) return false;
+  if (!Array.isArray(line)) return findLastRowContentIndex(line) >= 0;
+  if (line.length === 0) return false;
+  return findLastContentIndex(line) >= 0;
 }
 
 function getLineCells(
@@ -51,7 +71,7 @@ function getLineCells(
   state: ReturnType<ITerminalEmulator['getTerminalState']>,
   scrollbackLength: number,
   index: number
-): TerminalCell[] | null {
+): CaptureLine | null {
   if (index < scrollbackLength) {
     return emulator.getScrollbackLine(index);
   }
@@ -59,8 +79,8 @@ function getLineCells(
   return state.cells[liveIndex] ?? null;
 }
 
-function renderTextLine(cells: TerminalCell[], trimTrailing: boolean): string {
-  const raw = extractLineText(cells);
+function renderTextLine(line: CaptureLine, trimTrailing: boolean): string {
+  const raw = Array.isArray(line) ? extractLineText(line) : extractRowText(line);
   return trimTrailing ? raw.replace(/[\s\u00a0]+$/u, '') : raw;
 }
 
@@ -192,16 +212,16 @@ export function captureEmulator(emulator: ITerminalEmulator, options: CaptureOpt
   const rows: string[] = [];
 
   for (let index = start; index <= end; index++) {
-    const cells = getLineCells(emulator, state, scrollbackLength, index);
+    const line = getLineCells(emulator, state, scrollbackLength, index);
 
-    if (!cells) {
+    if (!line) {
       rows.push('');
       continue;
     }
 
     rows.push(format === 'ansi'
-      ? renderAnsiLine(cells, trimTrailing)
-      : renderTextLine(cells, trimTrailing));
+      ? renderAnsiLine(Array.isArray(line) ? line : rowToCells(line), trimTrailing)
+      : renderTextLine(line, trimTrailing));
   }
 
   return rows.join('\n');
@@ -70,6 +70,7 @@ export const DEFAULT_KEYBINDINGS: KeybindingsConfig = {
   search: {
     'ctrl+n': 'search.next',
     'ctrl+p': 'search.prev',
+    'ctrl+r': 'search.toggleRegex',
     'enter': 'search.confirm',
     'escape': 'search.cancel',
     'backspace': 'search.delete',
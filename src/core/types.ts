@@ -123,6 +123,21 @@ export interface TerminalCell {
   hyperlinkId?: number;
 }
 
+/**
+ * Terminal row stored as parallel typed arrays (one entry per column)
+ * instead of a TerminalCell object per column. Colors are packed 0xRRGGBB,
+ * flags are RowFlags bits, and codepoints are already normalized for
+ * display. See src/terminal/terminal-row.ts for accessors.
+ */
+export interface TerminalRow {
+  codepoints: Uint32Array;
+  fg: Uint32Array;
+  bg: Uint32Array;
+  hyperlinks: Uint16Array;
+  flags: Uint8Array;
+  widths: Uint8Array;
+}
+
 /**
  * Terminal cursor state
  */
@@ -139,7 +154,7 @@ export interface TerminalCursor {
 export interface TerminalState {
   cols: number;
   rows: number;
-  cells: TerminalCell[][];
+  cells: TerminalRow[];
   /** Version numbers for each row (for efficient React change detection) */
   rowVersions?: number[];
   cursor: TerminalCursor;
@@ -172,7 +187,7 @@ export interface TerminalScrollState {
  */
 export interface DirtyTerminalUpdate {
   /** Map of row index -> new row cells (only dirty rows included) */
-  dirtyRows: Map<number, TerminalCell[]>;
+  dirtyRows: Map<number, TerminalRow>;
   /** Current cursor state (always included - cheap) */
   cursor: TerminalCursor;
   /** Scroll state (always included - cheap) */
@@ -1,49 +1,139 @@
 /**
  * PTY data handler factory - creates the data processing pipeline
  * Handles sync mode parsing and query passthrough.
+ *
+ * PTY output stays as raw UTF-8 bytes through every stage; segments are
+ * handed to the emulator as Uint8Array views without string transcoding.
+ * When the native pre-filter is available, one scan per chunk decides which
+ * stages need to run; otherwise small JS probes provide the same signals.
  */
 import type { SyncModeParser } from "../../../terminal/sync-mode-parser"
+import { PrefilterScanFlags } from "../../../terminal/ghostty-vt/types"
 import type { InternalPtySession } from "./types"
 import { deferMacrotask } from "../../../core/scheduling"
 import { tracePtyChunk, tracePtyEvent } from "../../../terminal/pty-trace"
+import {
+  boundaryBytes,
+  concatBytes,
+  encodeUtf8,
+  includesBytes,
+  lastIndexOfBytes,
+  retainTail,
+  toBytes,
+  BYTE_C1_LEAD,
+  BYTE_ESC,
+  EMPTY_BYTES,
+} from "../../../terminal/byte-utils"
+
+/** Native output scanner (GhosttyPrefilter) */
+interface PrefilterScanner {
+  scan: (data: Uint8Array) => number
+}
 
 interface DataHandlerOptions {
   session: InternalPtySession
   syncParser: SyncModeParser
-  commandParser?: { processData: (data: string) => void }
+  commandParser?: { processData: (data: Uint8Array) => void }
+  /** JS probes are used when absent */
+  prefilter?: PrefilterScanner | null
   syncTimeoutMs?: number
 }
 
+/** What a chunk of PTY output contains, as far as the pipeline cares */
+interface ChunkSignals {
+  hasKittyApc: boolean
+  hasKittyQuery: boolean
+  /** Focus tracking state set by the chunk, or null if unchanged */
+  focusTracking: boolean | null
+  eraseScrollback: boolean
+  /** False only when the chunk has no queries, kitty APCs or unterminated sequences */
+  mayNeedPassthrough: boolean
+  /** False only when the chunk contains no part of an OSC sequence */
+  mayContainOsc: boolean
+  /** False only when the chunk has no sync mode toggle and ends outside any escape sequence */
+  mayContainSync: boolean
+}
+
 interface DataHandlerState {
-  pendingSegments: string[]
+  pendingSegments: Uint8Array[]
   syncTimeout: ReturnType<typeof setTimeout> | null
   pendingResponses: { fence: number; responses: string[] }[]
   segmentCounter: number
   processedCounter: number
 }
 
-const ESC = "\x1b"
-const APC_C1 = "\x9f"
-const FOCUS_TRACKING_ENABLE = "\x1b[?1004h"
-const FOCUS_TRACKING_DISABLE = "\x1b[?1004l"
-const FOCUS_TRACKING_ENABLE_C1 = "\x9b?1004h"
-const FOCUS_TRACKING_DISABLE_C1 = "\x9b?1004l"
+const KITTY_APC = encodeUtf8("\x1b_G")
+const KITTY_APC_C1 = encodeUtf8("\x9fG")
+const KITTY_QUERY = encodeUtf8("a=q")
+const FOCUS_TRACKING_ENABLE = encodeUtf8("\x1b[?1004h")
+const FOCUS_TRACKING_DISABLE = encodeUtf8("\x1b[?1004l")
+const FOCUS_TRACKING_ENABLE_C1 = encodeUtf8("\x9b?1004h")
+const FOCUS_TRACKING_DISABLE_C1 = encodeUtf8("\x9b?1004l")
 const FOCUS_IN_SEQUENCE = "\x1b[I"
 const FOCUS_OUT_SEQUENCE = "\x1b[O"
+const KITTY_PROBE_LEN = 256
 const FOCUS_TRACKING_PROBE_LEN = 16
 const SCROLLBACK_CLEAR_PROBE_LEN = 128
-const SCROLLBACK_CLEAR_REGEX = /\x1b\[([0-9;]*)J/g
-const SCROLLBACK_CLEAR_C1_REGEX = /\x9b([0-9;]*)J/g
-
-function hasScrollbackEraseSequence(text: string, regex: RegExp): boolean {
-  regex.lastIndex = 0
-  let match: RegExpExecArray | null
-  while ((match = regex.exec(text)) !== null) {
-    const params = match[1] ?? ""
-    const parts = params.split(";").filter(Boolean)
-    if (parts.includes("3")) return true
+const CSI_BRACKET = 0x5b // '['
+const CSI_C1 = 0x9b
+const ED_FINAL = 0x4a // 'J'
+const PARAM_SEPARATOR = 0x3b // ';'
+const DIGIT_THREE = 0x33 // '3'
+
+/**
+ * Check for ED 3 (CSI ... 3 ... J) in raw output, counting only sequences
+ * that end after `minEnd` so a match in an already-seen tail is not re-reported.
+ */
+function hasScrollbackEraseSequence(data: Uint8Array, minEnd = 0): boolean {
+  const scanFrom = (lead: number, second: number): boolean => {
+    let i = data.indexOf(lead)
+    while (i !== -1) {
+      if (data[i + 1] === second) {
+        let pos = i + 2
+        let partLen = 0
+        let partIsThree = false
+        let sawThree = false
+        while (pos < data.length) {
+          const b = data[pos]
+          if (b >= 0x30 && b <= 0x39) {
+            partIsThree = partLen === 0 && b === DIGIT_THREE
+            partLen += 1
+          } else if (b === PARAM_SEPARATOR) {
+            if (partIsThree && partLen === 1) sawThree = true
+            partLen = 0
+            partIsThree = false
+          } else {
+            break
+          }
+          pos += 1
+        }
+        if (partIsThree && partLen === 1) sawThree = true
+        if (sawThree && data[pos] === ED_FINAL && pos + 1 > minEnd) return true
+      }
+      i = data.indexOf(lead, i + 1)
+    }
+    return false
   }
-  return false
+  return scanFrom(BYTE_ESC, CSI_BRACKET) || scanFrom(BYTE_C1_LEAD, CSI_C1)
+}
+
+/** Last index of `needle` in `tail + data`, as an offset into that combined view. */
+function lastIndexAcross(tail: Uint8Array, data: Uint8Array, needle: Uint8Array): number {
+  const index = lastIndexOfBytes(data, needle)
+  if (index !== -1) return tail.length + index
+  return lastIndexOfBytes(boundaryBytes(tail, data, needle.length - 1), needle)
+}
+
+/** Whether `tail + data` can contain an escape sequence at all (ESC or C1 lead byte). */
+function mayContainEscapes(tail: Uint8Array, data: Uint8Array): boolean {
+  return data.indexOf(BYTE_ESC) !== -1 || data.indexOf(BYTE_C1_LEAD) !== -1 ||
+    tail.indexOf(BYTE_ESC) !== -1 || tail.indexOf(BYTE_C1_LEAD) !== -1
+}
+
+/** Whether `tail + data` contains `needle`. */
+function includesAcross(tail: Uint8Array, data: Uint8Array, needle: Uint8Array): boolean {
+  return includesBytes(data, needle) ||
+    includesBytes(boundaryBytes(tail, data, needle.length - 1), needle)
 }
 
 /**
@@ -51,9 +141,9 @@ function hasScrollbackEraseSequence(text: string, regex: RegExp): boolean {
  * Returns the data handler function and cleanup function
  */
 export function createDataHandler(options: DataHandlerOptions) {
-  const { session, syncParser, commandParser, syncTimeoutMs = 100 } = options
+  const { session, syncParser, commandParser, prefilter, syncTimeoutMs = 100 } = options
   const maxSegmentsPerTick = 8
-  const maxCharsPerTick = 32_768
+  const maxBytesPerTick = 32_768
   const maxBudgetMs = 4
   const now = () => (typeof performance !== "undefined" ? performance.now() : Date.now())
 
@@ -64,65 +154,127 @@ export function createDataHandler(options: DataHandlerOptions) {
     segmentCounter: 0,
     processedCounter: 0,
   }
-  let kittyProbeBuffer = ""
-  let focusProbeBuffer = ""
-  let scrollbackClearBuffer = ""
-
-  const analyzeKitty = (data: string): { hasKittyApc: boolean; hasKittyQuery: boolean } => {
+  let kittyProbeBuffer: Uint8Array = EMPTY_BYTES
+  let focusProbeBuffer: Uint8Array = EMPTY_BYTES
+  let scrollbackClearBuffer: Uint8Array = EMPTY_BYTES
+  // Segments whose write must be preceded by a scrollback archive reset (ED 3)
+  const eraseSegments = new WeakSet<Uint8Array>()
+  // ED 3 seen while sync output was buffering; applies to the next segments
+  let pendingScrollbackErase = false
+  // Segments that may carry OSC bytes; the emulator skips title/OSC scans for the rest
+  const oscSegments = new WeakSet<Uint8Array>()
+  // OSC seen since the sync parser last released everything it held
+  let pendingOsc = false
+  // The previous chunk may have left a partial sync toggle in the sync parser
+  let syncCarry = false
+
+  const analyzeKitty = (data: Uint8Array): { hasKittyApc: boolean; hasKittyQuery: boolean } => {
     if (data.length === 0) return { hasKittyApc: false, hasKittyQuery: false }
-    const combined = kittyProbeBuffer + data
-    kittyProbeBuffer = combined.slice(-256)
-    const hasKittyApc = combined.includes(`${ESC}_G`) || combined.includes(`${APC_C1}G`)
-    const hasKittyQuery = hasKittyApc && combined.includes("a=q")
+    const tail = kittyProbeBuffer
+    kittyProbeBuffer = retainTail(tail, data, KITTY_PROBE_LEN)
+    if (!mayContainEscapes(tail, data)) return { hasKittyApc: false, hasKittyQuery: false }
+    const hasKittyApc = includesAcross(tail, data, KITTY_APC) ||
+      includesAcross(tail, data, KITTY_APC_C1)
+    const hasKittyQuery = hasKittyApc && includesAcross(tail, data, KITTY_QUERY)
     return { hasKittyApc, hasKittyQuery }
   }
 
-  const updateFocusTracking = (data: string) => {
-    if (data.length === 0) return
-    const combined = focusProbeBuffer + data
+  const probeFocusTracking = (data: Uint8Array): boolean | null => {
+    if (data.length === 0) return null
+    const tail = focusProbeBuffer
+    focusProbeBuffer = retainTail(tail, data, FOCUS_TRACKING_PROBE_LEN)
+    if (!mayContainEscapes(tail, data)) return null
 
     const lastEnable = Math.max(
-      combined.lastIndexOf(FOCUS_TRACKING_ENABLE),
-      combined.lastIndexOf(FOCUS_TRACKING_ENABLE_C1)
+      lastIndexAcross(tail, data, FOCUS_TRACKING_ENABLE),
+      lastIndexAcross(tail, data, FOCUS_TRACKING_ENABLE_C1)
     )
     const lastDisable = Math.max(
-      combined.lastIndexOf(FOCUS_TRACKING_DISABLE),
-      combined.lastIndexOf(FOCUS_TRACKING_DISABLE_C1)
+      lastIndexAcross(tail, data, FOCUS_TRACKING_DISABLE),
+      lastIndexAcross(tail, data, FOCUS_TRACKING_DISABLE_C1)
     )
 
-    if (lastEnable !== -1 || lastDisable !== -1) {
-      const wasEnabled = session.focusTrackingEnabled
-      session.focusTrackingEnabled = lastEnable > lastDisable
+    if (lastEnable === -1 && lastDisable === -1) return null
+    return lastEnable > lastDisable
+  }
 
-      if (session.focusTrackingEnabled !== wasEnabled) {
-        tracePtyEvent("pty-focus-tracking", {
-          ptyId: session.id,
-          enabled: session.focusTrackingEnabled,
-        })
-      }
+  const applyFocusTracking = (enabled: boolean | null) => {
+    if (enabled === null) return
+    const wasEnabled = session.focusTrackingEnabled
+    session.focusTrackingEnabled = enabled
 
-      if (!wasEnabled && session.focusTrackingEnabled) {
-        tracePtyEvent("pty-focus-sync", {
-          ptyId: session.id,
-          focused: session.focusState,
-        })
-        session.pty.write(session.focusState ? FOCUS_IN_SEQUENCE : FOCUS_OUT_SEQUENCE)
-      }
+    if (session.focusTrackingEnabled !== wasEnabled) {
+      tracePtyEvent("pty-focus-tracking", {
+        ptyId: session.id,
+        enabled: session.focusTrackingEnabled,
+      })
     }
 
-    focusProbeBuffer = combined.slice(-FOCUS_TRACKING_PROBE_LEN)
+    if (!wasEnabled && session.focusTrackingEnabled) {
+      tracePtyEvent("pty-focus-sync", {
+        ptyId: session.id,
+        focused: session.focusState,
+      })
+      session.pty.write(session.focusState ? FOCUS_IN_SEQUENCE : FOCUS_OUT_SEQUENCE)
+    }
   }
 
-  const shouldClearScrollback = (data: string): boolean => {
+  const probeScrollbackErase = (data: Uint8Array): boolean => {
     if (data.length === 0) return false
-    let combined = scrollbackClearBuffer + data
-    if (combined.length > 2048) {
-      combined = combined.slice(-2048)
+    const tail = scrollbackClearBuffer
+    scrollbackClearBuffer = retainTail(tail, data, SCROLLBACK_CLEAR_PROBE_LEN)
+
+    return hasScrollbackEraseSequence(data) ||
+      hasScrollbackEraseSequence(boundaryBytes(tail, data, SCROLLBACK_CLEAR_PROBE_LEN), tail.length)
+  }
+
+  /** Signals from the JS probes (each keeps a small tail for split sequences). */
+  const probeChunk = (data: Uint8Array): ChunkSignals => {
+    const kitty = analyzeKitty(data)
+    return {
+      hasKittyApc: kitty.hasKittyApc,
+      hasKittyQuery: kitty.hasKittyQuery,
+      focusTracking: probeFocusTracking(data),
+      eraseScrollback: probeScrollbackErase(data),
+      mayNeedPassthrough: true,
+      mayContainOsc: true,
+      mayContainSync: true,
+    }
+  }
+
+  /** Signals from one native scan of the chunk. */
+  const scanChunk = (scanner: PrefilterScanner, data: Uint8Array): ChunkSignals => {
+    const flags = scanner.scan(data)
+    return {
+      hasKittyApc: (flags & PrefilterScanFlags.KITTY) !== 0,
+      hasKittyQuery: (flags & PrefilterScanFlags.KITTY_QUERY) !== 0,
+      focusTracking: flags & PrefilterScanFlags.FOCUS_TRACKING
+        ? (flags & PrefilterScanFlags.FOCUS_ENABLED) !== 0
+        : null,
+      eraseScrollback: (flags & PrefilterScanFlags.ERASE_SCROLLBACK) !== 0,
+      mayNeedPassthrough: (flags & (
+        PrefilterScanFlags.QUERY | PrefilterScanFlags.KITTY | PrefilterScanFlags.PENDING
+      )) !== 0,
+      mayContainOsc: (flags & PrefilterScanFlags.OSC) !== 0,
+      mayContainSync: (flags & (PrefilterScanFlags.SYNC | PrefilterScanFlags.PENDING)) !== 0,
+    }
+  }
+
+  const markOsc = (segments: readonly Uint8Array[]) => {
+    if (!pendingOsc) return
+    for (const segment of segments) {
+      if (segment.length > 0) oscSegments.add(segment)
     }
-    scrollbackClearBuffer = combined.slice(-SCROLLBACK_CLEAR_PROBE_LEN)
+  }
 
-    return hasScrollbackEraseSequence(combined, SCROLLBACK_CLEAR_REGEX) ||
-      hasScrollbackEraseSequence(combined, SCROLLBACK_CLEAR_C1_REGEX)
+  const markScrollbackErase = (segments: readonly Uint8Array[]): boolean => {
+    let marked = false
+    for (const segment of segments) {
+      if (segment.length === 0) continue
+      eraseSegments.add(segment)
+      marked = true
+    }
+    return marked
   }
 
   const resetScrollbackState = () => {
@@ -160,19 +312,21 @@ export function createDataHandler(options: DataHandlerOptions) {
 
     const force = options?.force ?? false
     const start = now()
-    let batch = ""
+    const batchParts: Uint8Array[] = []
     let batchLen = 0
+    let batchErases = false
+    let batchOsc = false
     let segmentsProcessed = 0
     let wrote = false
 
     if (force) {
       while (state.pendingSegments.length > 0) {
-        const segment = state.pendingSegments.shift() ?? ""
+        const segment = state.pendingSegments.shift() ?? EMPTY_BYTES
         if (segment.length === 0) continue
-        if (shouldClearScrollback(segment)) {
+        if (eraseSegments.has(segment)) {
           resetScrollbackState()
         }
-        session.emulator.write(segment)
+        session.emulator.write(segment, { mayContainOsc: oscSegments.has(segment) })
         wrote = true
         segmentsProcessed += 1
       }
@@ -184,29 +338,30 @@ export function createDataHandler(options: DataHandlerOptions) {
           continue
         }
 
-        if (batchLen > 0 && batchLen + segment.length > maxCharsPerTick) {
+        if (batchLen > 0 && batchLen + segment.length > maxBytesPerTick) {
           break
         }
 
-        batch += segment
+        batchParts.push(segment)
         batchLen += segment.length
+        batchErases ||= eraseSegments.has(segment)
+        batchOsc ||= oscSegments.has(segment)
         segmentsProcessed += 1
         state.pendingSegments.shift()
 
         if (segmentsProcessed >= maxSegmentsPerTick) break
-        if (batchLen >= maxCharsPerTick) break
+        if (batchLen >= maxBytesPerTick) break
         if (now() - start >= maxBudgetMs) break
       }
 
-      if (batchLen === 0 && state.pendingSegments.length > 0) {
-        batch = state.pendingSegments.shift() ?? ""
-      }
+      // Single allocation for the whole batch (a lone segment is passed through as-is)
+      const batch = concatBytes(batchParts, batchLen)
 
       if (batch.length > 0) {
-        if (shouldClearScrollback(batch)) {
+        if (batchErases) {
           resetScrollbackState()
         }
-        session.emulator.write(batch)
+        session.emulator.write(batch, { mayContainOsc: batchOsc })
         wrote = true
       }
     }
@@ -244,30 +399,42 @@ export function createDataHandler(options: DataHandlerOptions) {
   }
 
   // The data handler function
-  const handleData = (data: string) => {
+  // Accepts raw UTF-8 chunks (each ending on a character boundary); strings
+  // are encoded once for callers that still produce text.
+  const handleData = (input: string | Uint8Array) => {
+    const data = toBytes(input)
     tracePtyChunk("pty-in", data, { ptyId: session.id })
-    updateFocusTracking(data)
-    const kittySignals = analyzeKitty(data)
-    const hasKittyQuery = kittySignals.hasKittyQuery
-    let textData: string
+    const signals = prefilter ? scanChunk(prefilter, data) : probeChunk(data)
+    applyFocusTracking(signals.focusTracking)
+    let outputData: Uint8Array
     let deferredResponses: string[] | null = null
 
     // Handle terminal queries (cursor position, device attributes, colors, etc.)
-    if (hasKittyQuery && "processWithResponses" in session.queryPassthrough) {
-      const processed = session.queryPassthrough.processWithResponses(data)
-      textData = processed.text
+    if (signals.hasKittyQuery) {
+      const processed = session.queryPassthrough.processBytesWithResponses(data)
+      outputData = processed.data
       deferredResponses = processed.responses
     } else {
-      textData = session.queryPassthrough.process(data)
+      outputData = session.queryPassthrough.processBytes(data, !signals.mayNeedPassthrough)
     }
 
-    if (commandParser) {
-      commandParser.processData(textData)
+    if (commandParser && signals.mayContainOsc) {
+      commandParser.processData(outputData)
     }
 
     // Process through sync mode parser to respect frame boundaries
     // This buffers content between CSI ? 2026 h and CSI ? 2026 l
-    const { readySegments, isBuffering } = syncParser.process(textData)
+    // (skipped when nothing can toggle sync mode or complete a split toggle)
+    const { readySegments, isBuffering } =
+      signals.mayContainSync || syncCarry || syncParser.isInSyncMode()
+        ? syncParser.process(outputData)
+        : { readySegments: [outputData], isBuffering: false }
+    syncCarry = signals.mayContainSync
+
+    // Buffered output may hold OSC bytes from earlier chunks until it is released
+    pendingOsc ||= signals.mayContainOsc
+    markOsc(readySegments)
+    if (!isBuffering) pendingOsc = false
 
     // Handle sync buffering timeout (safety valve)
     if (isBuffering) {
@@ -275,7 +442,12 @@ export function createDataHandler(options: DataHandlerOptions) {
         state.syncTimeout = setTimeout(() => {
           // Safety flush - sync mode took too long (app may have crashed)
           const flushed = syncParser.flush()
+          markOsc([flushed])
+          pendingOsc = false
           if (flushed.length > 0) {
+            if (pendingScrollbackErase && markScrollbackErase([flushed])) {
+              pendingScrollbackErase = false
+            }
             state.pendingSegments.push(flushed)
             scheduleNotify()
           }
@@ -287,6 +459,11 @@ export function createDataHandler(options: DataHandlerOptions) {
       state.syncTimeout = null
     }
 
+    // ED 3 resets the archive right before the segments carrying it are written
+    if (signals.eraseScrollback || pendingScrollbackErase) {
+      pendingScrollbackErase = !markScrollbackErase(readySegments)
+    }
+
     // Add ready segments to pending queue
     let segmentsAdded = 0
     for (const segment of readySegments) {
@@ -318,7 +495,7 @@ export function createDataHandler(options: DataHandlerOptions) {
     // Only schedule notification if we have data and aren't buffering
     // When buffering, we wait for the complete frame before notifying
     if (!isBuffering && state.pendingSegments.length > 0) {
-      if (kittySignals.hasKittyApc) {
+      if (signals.hasKittyApc) {
         drainPending({ force: true })
       } else {
         scheduleNotify()
@@ -133,6 +133,7 @@ export function createOperations(deps: OperationsDeps) {
       session.emulator.dispose()
       session.kittyRelayDispose?.()
       session.queryPassthrough.dispose()
+      session.prefilter?.free()
 
       // Remove from map BEFORE emitting lifecycle event
       yield* Ref.update(sessionsRef, HashMap.remove(id))
@@ -1,11 +1,17 @@
 /**
  * Scrollback archiver - spills live scrollback into a disk archive.
+ *
+ * Batches are exported from the emulator as packed rows in one call where
+ * it supports that, and encoded into archive records without cell objects.
  */
 import type { InternalPtySession } from "./types"
 import type { ITerminalEmulator } from "../../../terminal/emulator-interface"
-import type { TerminalCell } from "../../../core/types"
+import type { TerminalRow } from "../../../core/types"
 import { HOT_SCROLLBACK_LIMIT } from "../../../terminal/scrollback-config"
 import { deferMacrotask } from "../../../core/scheduling"
+import { rowFromCells } from "../../../terminal/terminal-row"
+
+type CapturedRows = { rows: TerminalRow[]; wrapped: boolean[] }
 
 const ARCHIVE_BATCH_LINES = 256
 const MAX_BATCHES_PER_RUN = 4
@@ -54,16 +60,16 @@ export class ScrollbackArchiver {
         if (overflow <= 0) break
 
         const batchSize = Math.min(overflow, ARCHIVE_BATCH_LINES)
-        const lines = this.captureLines(batchSize)
-        if (lines.length === 0) break
+        const { rows, wrapped } = this.liveEmulator.getOldestScrollbackRows?.(batchSize) ?? this.captureLines(batchSize)
+        if (rows.length === 0) break
 
-        await this.session.scrollbackArchive.appendLines(lines)
+        await this.session.scrollbackArchive.appendRows(rows, wrapped)
 
         if ("trimScrollback" in this.liveEmulator) {
           const trimmer = this.liveEmulator as ITerminalEmulator & {
             trimScrollback?: (lines: number) => void
           }
-          trimmer.trimScrollback?.(lines.length)
+          trimmer.trimScrollback?.(rows.length)
         } else {
           break
         }
@@ -84,13 +90,16 @@ export class ScrollbackArchiver {
     }
   }
 
-  private captureLines(count: number): TerminalCell[][] {
-    const lines: TerminalCell[][] = []
+  /** Per-line fallback for emulators without a bulk export. */
+  private captureLines(count: number): CapturedRows {
+    const rows: TerminalRow[] = []
+    const wrapped: boolean[] = []
     for (let i = 0; i < count; i++) {
       const line = this.liveEmulator.getScrollbackLine(i)
       if (!line) break
-      lines.push(line)
+      rows.push(rowFromCells(line))
+      wrapped.push(this.liveEmulator.isScrollbackLineWrapped?.(i) ?? false)
     }
-    return lines
+    return { rows, wrapped }
   }
 }
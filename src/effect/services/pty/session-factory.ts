@@ -5,6 +5,7 @@ import { Effect } from "effect"
 import path from "node:path"
 import { spawnAsync } from "../../../../native/zig-pty/ts/index"
 import { createGhosttyVTEmulator } from "../../../terminal/ghostty-vt/emulator"
+import { GhosttyPrefilter } from "../../../terminal/ghostty-vt/prefilter"
 import { ArchivedTerminalEmulator } from "../../../terminal/archived-emulator"
 import { TerminalQueryPassthrough } from "../../../terminal/terminal-query-passthrough"
 import { createSyncModeParser } from "../../../terminal/sync-mode-parser"
@@ -137,6 +138,7 @@ export function createSession(
       scrollbackArchive,
       scrollbackArchiver: null as unknown as ScrollbackArchiver,
       queryPassthrough,
+      prefilter: GhosttyPrefilter.create(),
       kittyRelayDispose: undefined,
       cols,
       rows,
@@ -226,10 +228,11 @@ export function createSession(
       session,
       syncParser,
       commandParser,
+      prefilter: session.prefilter,
     })
 
-    // Wire up PTY data handler
-    pty.onData(handleData)
+    // Wire up PTY data handler (raw bytes, no string decoding)
+    pty.onBinaryData(handleData)
 
     // Wire up mode change handler for DECSET 2048 (in-band resize notifications)
     emulator.onModeChange((modes, prevModes) => {
@@ -6,6 +6,7 @@ import type { IPty } from "../../../../native/zig-pty/ts/index"
 import type { TerminalState, UnifiedTerminalUpdate } from "../../../core/types"
 import type { ITerminalEmulator } from "../../../terminal/emulator-interface"
 import type { TerminalQueryPassthrough } from "../../../terminal/terminal-query-passthrough"
+import type { GhosttyPrefilter } from "../../../terminal/ghostty-vt/prefilter"
 import type { PtyId } from "../../types"
 import type { ScrollbackArchive } from "../../../terminal/scrollback-archive"
 import type { ScrollbackArchiver } from "./scrollback-archiver"
@@ -24,6 +25,8 @@ export interface InternalPtySession {
   /** Archiver for spilling scrollback to disk */
   scrollbackArchiver: ScrollbackArchiver
   queryPassthrough: TerminalQueryPassthrough
+  /** Native output pre-filter (null when the scanner is unavailable) */
+  prefilter: GhosttyPrefilter | null
   kittyRelayDispose?: () => void
   cols: number
   rows: number
@@ -1,17 +1,19 @@
 import type { TerminalCell, TerminalScrollState, TerminalState } from '../core/types';
-import type { SearchResult } from '../terminal/emulator-interface';
+import type { SearchMatch, SearchOptions, SearchResult } from '../terminal/emulator-interface';
 import type { TerminalColors } from '../terminal/terminal-colors';
 import type { GitInfo } from '../effect/services/pty/helpers';
 import { unpackRow, unpackTerminalState, CELL_SIZE } from '../terminal/cell-serialization';
 import { RemoteEmulator } from './client/emulator';
-import { sendRequest } from './client/connection';
+import { rememberPtyFilter, sendRequest } from './client/connection';
 import { bufferToArrayBuffer } from './client/utils';
 import {
   getKittyState,
   getPtyState,
   handlePtyTitle,
+  onUnifiedSubscriptionsChange,
   registerEmulatorFactory,
   setPtyState,
+  subscribeUnified,
 } from './client/state';
 
 export async function createPty(options: {
@@ -51,6 +53,12 @@ export async function destroyAllPtys(): Promise<void> {
   await sendRequest('destroyAll');
 }
 
+/** Limit pty output from the shim to these ptys; null receives all. */
+export async function setPtyFilter(ptyIds: string[] | null): Promise<void> {
+  rememberPtyFilter(ptyIds);
+  await sendRequest('setPtyFilter', { ptyIds });
+}
+
 export async function setHostColors(colors: TerminalColors): Promise<void> {
   await sendRequest('setHostColors', { colors });
 }
@@ -131,10 +139,10 @@ export async function getScrollbackLines(
   }
 
   const lines = new Map<number, TerminalCell[]>();
+  const buffer = bufferToArrayBuffer(payload);
   let offset = 0;
   for (const lineOffset of lineOffsets) {
-    const slice = payload.subarray(offset);
-    const row = unpackRow(bufferToArrayBuffer(slice));
+    const row = unpackRow(buffer, offset);
     lines.set(lineOffset, row);
     offset += 4 + row.length * CELL_SIZE;
   }
@@ -159,10 +167,33 @@ export async function capturePty(
 export async function searchPty(
   ptyId: string,
   query: string,
-  options?: { limit?: number }
+  options?: SearchOptions
 ): Promise<SearchResult> {
-  const response = await sendRequest('search', { ptyId, query, limit: options?.limit });
-  return (response.header.result as SearchResult) ?? { matches: [], hasMore: false };
+  const signal = options?.signal;
+  if (signal?.aborted) return { matches: [], hasMore: true };
+  const cancel = () => {
+    void sendRequest('cancelSearch').catch(() => {});
+  };
+  signal?.addEventListener('abort', cancel, { once: true });
+  try {
+    const onMatches = options?.onMatches;
+    const response = await sendRequest('search', {
+      ptyId,
+      query,
+      limit: options?.limit,
+      regex: options?.regex ?? false,
+      anchor: options?.anchor,
+      startLine: options?.startLine,
+      endLine: options?.endLine,
+      stream: onMatches !== undefined,
+    }, [], onMatches && ((result) => {
+      const batch = (result as { matches?: SearchMatch[] } | undefined)?.matches;
+      if (batch && !signal?.aborted) onMatches(batch);
+    }));
+    return (response.header.result as SearchResult) ?? { matches: [], hasMore: false };
+  } finally {
+    signal?.removeEventListener('abort', cancel);
+  }
 }
 
 export async function listAllPtys(): Promise<string[]> {
@@ -278,11 +309,17 @@ function createRemoteEmulator(ptyId: string): RemoteEmulator {
     getKittyState,
     fetchScrollbackLines: getScrollbackLines,
     searchPty,
+    subscribeUnified,
   });
 }
 
 registerEmulatorFactory(createRemoteEmulator);
 
+// Only the ptys something in this client is watching need their output
+onUnifiedSubscriptionsChange((ptyIds) => {
+  setPtyFilter(ptyIds).catch(() => {});
+});
+
 export {
   getEmulator,
   subscribeExit,
@@ -4,17 +4,26 @@ import { spawn } from 'child_process';
 import type { Buffer } from 'buffer';
 
 import { getHostColors } from '../../terminal/terminal-colors';
-import { encodeFrame, FrameReader, SHIM_SOCKET_DIR, SHIM_SOCKET_PATH, type ShimHeader } from '../protocol';
+import {
+  encodeRequestFrame,
+  FrameReader,
+  SHIM_PROTOCOL_MISMATCH,
+  SHIM_PROTOCOL_VERSION,
+  SHIM_SOCKET_DIR,
+  SHIM_SOCKET_PATH,
+  type ShimHeader,
+} from '../protocol';
 import { runStream } from '../../effect/stream-utils';
 import { createFrameHandler, type FrameHandlerDeps } from './frame-handler';
 import { createSocketDataStream } from './socket-stream';
 
-const CLIENT_VERSION = 1;
+const SHARED_ATTACH = ['1', 'true', 'on'].includes((process.env.OPENMUX_SHIM_SHARED ?? '').toLowerCase());
 const CLIENT_ID = `client_${Date.now()}_${Math.random().toString(16).slice(2)}`;
 
 type PendingRequest = {
   resolve: (value: { header: ShimHeader; payloads: Buffer[] }) => void;
   reject: (error: Error) => void;
+  onProgress?: (result: unknown) => void;
 };
 
 const pendingRequests = new Map<number, PendingRequest>();
@@ -26,10 +35,29 @@ let spawnAttempted = false;
 let shimPid: number | null = null;
 let detached = false;
 let socketDataStop: (() => void) | null = null;
+/** Ptys this client wants output for, resent whenever it (re)connects. */
+let ptyFilter: string[] | null = null;
 
 const detachedSubscribers = new Set<() => void>();
 
+/**
+ * The running shim speaks another protocol version. Spawning or retrying
+ * can't help while it owns the socket, so this surfaces to the user.
+ */
+export class ShimProtocolMismatchError extends Error {
+  constructor(detail: string, pid: number | null) {
+    super(
+      `${detail}. Quit openmux and stop the running shim${pid ? ` (pid ${pid})` : ''} to finish upgrading.`
+    );
+    this.name = 'ShimProtocolMismatchError';
+  }
+}
+
 function handleResponseFrame(header: ShimHeader, payloads: Buffer[]): boolean {
+  if (header.type === 'progress' && header.requestId !== undefined) {
+    pendingRequests.get(header.requestId)?.onProgress?.(header.result);
+    return true;
+  }
   if (header.type !== 'response' || header.requestId === undefined) {
     return false;
   }
@@ -89,8 +117,17 @@ async function connectSocket(): Promise<void> {
 
   let hello: { header: ShimHeader; payloads: Buffer[] };
   try {
-    hello = await sendRequest('hello', { clientId: CLIENT_ID, version: CLIENT_VERSION });
+    hello = await sendRequest('hello', {
+      clientId: CLIENT_ID,
+      version: SHIM_PROTOCOL_VERSION,
+      // Attach as a viewer alongside the current UI instead of replacing it
+      shared: SHARED_ATTACH,
+    });
   } catch (error) {
+    if (error instanceof Error && error.message.startsWith(SHIM_PROTOCOL_MISMATCH)) {
+      dropMismatchedSocket();
+      throw new ShimProtocolMismatchError(error.message, shimPid);
+    }
     if (error instanceof Error && error.message.toLowerCase().includes('detached')) {
       socket?.destroy();
       socket = null;
@@ -99,15 +136,41 @@ async function connectSocket(): Promise<void> {
     }
     throw error;
   }
-  const helloResult = hello.header.result as { pid?: number } | undefined;
+  const helloResult = hello.header.result as { pid?: number; version?: number } | undefined;
   if (helloResult && typeof helloResult.pid === 'number') {
     shimPid = helloResult.pid;
   }
+  // Shims from before versioning accept any hello and never report one
+  if (helloResult?.version !== SHIM_PROTOCOL_VERSION) {
+    dropMismatchedSocket();
+    throw new ShimProtocolMismatchError(
+      `${SHIM_PROTOCOL_MISMATCH}: client ${SHIM_PROTOCOL_VERSION}, shim ${helloResult?.version ?? 'unversioned'}`,
+      shimPid
+    );
+  }
 
   const colors = getHostColors();
   if (colors) {
     await sendRequest('setHostColors', { colors });
   }
+  if (ptyFilter) {
+    await sendRequest('setPtyFilter', { ptyIds: ptyFilter });
+  }
+}
+
+/** Record the pty filter to restore on reconnect; null receives all ptys. */
+export function rememberPtyFilter(ptyIds: string[] | null): void {
+  ptyFilter = ptyIds;
+}
+
+/** Close a socket to an incompatible shim without reporting a detach. */
+function dropMismatchedSocket(): void {
+  socket?.removeAllListeners('close');
+  socket?.destroy();
+  socketDataStop?.();
+  socketDataStop = null;
+  socket = null;
+  reader = null;
 }
 
 function spawnShimProcess(): void {
@@ -144,6 +207,7 @@ async function connectWithRetry(attempts = 25, delayMs = 120): Promise<void> {
       await connectSocket();
       return;
     } catch (error) {
+      if (error instanceof ShimProtocolMismatchError) throw error;
       lastError = error instanceof Error ? error : new Error('Failed to connect to shim');
       await new Promise((resolve) => setTimeout(resolve, delayMs));
     }
@@ -175,7 +239,7 @@ async function ensureConnected(): Promise<void> {
       try {
         await connectSocket();
       } catch (error) {
-        if (detached) {
+        if (detached || error instanceof ShimProtocolMismatchError) {
           throw error;
         }
         spawnShimProcess();
@@ -199,13 +263,7 @@ export async function sendRequestDirect(
   }
 
   const requestId = nextRequestId++;
-  const header: ShimHeader = {
-    type: 'request',
-    requestId,
-    method,
-    params,
-    payloadLengths: payloads.map((payload) => payload.byteLength),
-  };
+  const frame = encodeRequestFrame(requestId, method, params, payloads);
 
   return new Promise((resolve, reject) => {
     pendingRequests.set(requestId, { resolve, reject });
@@ -217,7 +275,7 @@ export async function sendRequestDirect(
         }
       }, timeoutMs);
     }
-    socket?.write(encodeFrame(header, payloads), (err) => {
+    socket?.write(frame, (err) => {
       if (err) {
         pendingRequests.delete(requestId);
         reject(err);
@@ -229,7 +287,8 @@ export async function sendRequestDirect(
 export async function sendRequest(
   method: string,
   params?: Record<string, unknown>,
-  payloads: ArrayBuffer[] = []
+  payloads: ArrayBuffer[] = [],
+  onProgress?: (result: unknown) => void
 ): Promise<{ header: ShimHeader; payloads: Buffer[] }> {
   await ensureConnected();
   if (!socket) {
@@ -237,17 +296,11 @@ export async function sendRequest(
   }
 
   const requestId = nextRequestId++;
-  const header: ShimHeader = {
-    type: 'request',
-    requestId,
-    method,
-    params,
-    payloadLengths: payloads.map((payload) => payload.byteLength),
-  };
+  const frame = encodeRequestFrame(requestId, method, params, payloads);
 
   return new Promise((resolve, reject) => {
-    pendingRequests.set(requestId, { resolve, reject });
-    socket?.write(encodeFrame(header, payloads));
+    pendingRequests.set(requestId, { resolve, reject, onProgress });
+    socket?.write(frame);
   });
 }
 
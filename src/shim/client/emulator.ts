@@ -1,5 +1,12 @@
-import type { TerminalCell, TerminalState, TerminalScrollState } from '../../core/types';
 import type {
+  TerminalCell,
+  TerminalRow,
+  TerminalState,
+  TerminalScrollState,
+  UnifiedTerminalUpdate,
+} from '../../core/types';
+import type {
+  SearchOptions,
   SearchResult,
   ITerminalEmulator,
   KittyGraphicsImageInfo,
@@ -24,8 +31,9 @@ export type RemoteEmulatorDeps = {
   searchPty: (
     ptyId: string,
     query: string,
-    options?: { limit?: number }
+    options?: SearchOptions
   ) => Promise<SearchResult>;
+  subscribeUnified: (ptyId: string, callback: (update: UnifiedTerminalUpdate) => void) => () => void;
 };
 
 export class RemoteEmulator implements ITerminalEmulator {
@@ -85,7 +93,7 @@ export class RemoteEmulator implements ITerminalEmulator {
     const state = this.deps.getPtyState(this.ptyId)?.terminalState;
     const cursor = state?.cursor ?? { x: 0, y: 0, visible: true };
     return {
-      dirtyRows: new Map<number, TerminalCell[]>(),
+      dirtyRows: new Map<number, TerminalRow>(),
       cursor,
       scrollState,
       cols: state?.cols ?? 0,
@@ -188,15 +196,22 @@ export class RemoteEmulator implements ITerminalEmulator {
     return () => {};
   }
 
-  onUpdate(_callback: () => void): () => void {
-    return () => {};
+  onUpdate(callback: () => void): () => void {
+    // subscribeUnified replays the cached state synchronously; only later
+    // updates count as new output
+    let subscribed = false;
+    const unsubscribe = this.deps.subscribeUnified(this.ptyId, () => {
+      if (subscribed) callback();
+    });
+    subscribed = true;
+    return unsubscribe;
   }
 
   onModeChange(_callback: (modes: { mouseTracking: boolean; cursorKeyMode: 'normal' | 'application'; alternateScreen: boolean; inBandResize: boolean }) => void): () => void {
     return () => {};
   }
 
-  async search(query: string, options?: { limit?: number }): Promise<SearchResult> {
+  async search(query: string, options?: SearchOptions): Promise<SearchResult> {
     return this.deps.searchPty(this.ptyId, query, options);
   }
 
@@ -8,6 +8,7 @@ import { sendDesktopNotification, sendMacOsNotification } from '../../terminal/d
 import { unpackDirtyUpdate } from '../../terminal/cell-serialization';
 import type { DesktopNotification } from '../../terminal/command-parser';
 import { bufferToArrayBuffer } from './utils';
+import { readKittyShm, type KittyShmRef } from '../kitty-shm';
 import {
   handlePtyExit,
   handlePtyLifecycle,
@@ -175,6 +176,7 @@ export function createFrameHandler(deps: FrameHandlerDeps): (header: ShimHeader,
         }>;
         removedImageIds?: number[];
         imageDataIds?: number[];
+        sharedImages?: KittyShmRef[];
         alternateScreen?: boolean;
       } | undefined;
 
@@ -187,6 +189,12 @@ export function createFrameHandler(deps: FrameHandlerDeps): (header: ShimHeader,
         if (!payload) continue;
         imageData.set(imageDataIds[i], payload);
       }
+      for (const ref of kitty.sharedImages ?? []) {
+        const data = readKittyShm(ref);
+        if (data) {
+          imageData.set(ref.id, data);
+        }
+      }
 
       const images = (kitty.images ?? []).map((info) => ({
         id: info.id,
@@ -1,5 +1,5 @@
 import type {
-  TerminalCell,
+  TerminalRow,
   TerminalScrollState,
   TerminalState,
   UnifiedTerminalUpdate,
@@ -17,7 +17,7 @@ type ScrollbackAwareEmulator = ITerminalEmulator & {
 
 export type PtyState = {
   terminalState: TerminalState | null;
-  cachedRows: TerminalCell[][];
+  cachedRows: TerminalRow[];
   scrollState: TerminalScrollState;
   title: string;
 };
@@ -58,13 +58,17 @@ const lifecycleSubscribers = new Set<(event: LifecycleEvent) => void>();
 const kittyTransmitSubscribers = new Set<(event: KittyTransmitEvent) => void>();
 const kittyUpdateSubscribers = new Set<(event: KittyUpdateEvent) => void>();
 
+const subscriptionListeners = new Set<(ptyIds: string[]) => void>();
+let subscribedPtys = new Set<string>();
+let subscriptionSyncScheduled = false;
+
 const ptyStates = new Map<string, PtyState>();
 const emulatorCache = new Map<string, ScrollbackAwareEmulator>();
 let emulatorFactory: ((ptyId: string) => ScrollbackAwareEmulator) | null = null;
 const kittyStates = new Map<string, KittyScreenState>();
 
 function clearPtySubscribers(ptyId: string): void {
-  unifiedSubscribers.delete(ptyId);
+  if (unifiedSubscribers.delete(ptyId)) scheduleSubscriptionSync();
   stateSubscribers.delete(ptyId);
   scrollSubscribers.delete(ptyId);
   exitSubscribers.delete(ptyId);
@@ -222,9 +226,13 @@ export function getKittyState(ptyId: string, alternateScreen: boolean = false):
 }
 
 export function subscribeUnified(ptyId: string, callback: UnifiedSubscriber): () => void {
-  const set = unifiedSubscribers.get(ptyId) ?? new Set<UnifiedSubscriber>();
+  let set = unifiedSubscribers.get(ptyId);
+  if (!set) {
+    set = new Set<UnifiedSubscriber>();
+    unifiedSubscribers.set(ptyId, set);
+    scheduleSubscriptionSync();
+  }
   set.add(callback);
-  unifiedSubscribers.set(ptyId, set);
 
   const cached = ptyStates.get(ptyId);
   if (cached?.terminalState) {
@@ -252,12 +260,51 @@ export function subscribeUnified(ptyId: string, callback: UnifiedSubscriber): ()
 
   return () => {
     set.delete(callback);
-    if (set.size === 0) {
+    if (set.size === 0 && unifiedSubscribers.get(ptyId) === set) {
       unifiedSubscribers.delete(ptyId);
+      scheduleSubscriptionSync();
     }
   };
 }
 
+/**
+ * Call `callback` with the ptys that have unified subscribers whenever that
+ * set changes, batched per tick so a remount doesn't flap it.
+ */
+export function onUnifiedSubscriptionsChange(callback: (ptyIds: string[]) => void): () => void {
+  subscriptionListeners.add(callback);
+  return () => {
+    subscriptionListeners.delete(callback);
+  };
+}
+
+function scheduleSubscriptionSync(): void {
+  if (subscriptionSyncScheduled) return;
+  subscriptionSyncScheduled = true;
+  queueMicrotask(() => {
+    subscriptionSyncScheduled = false;
+    const next = new Set(unifiedSubscribers.keys());
+    if (next.size === subscribedPtys.size && Array.from(next).every((ptyId) => subscribedPtys.has(ptyId))) {
+      return;
+    }
+    // Output stops arriving for ptys nobody watches, so their cached screen
+    // would go stale; a snapshot follows when they are watched again
+    for (const ptyId of subscribedPtys) {
+      if (next.has(ptyId)) continue;
+      const state = ptyStates.get(ptyId);
+      if (state) {
+        ptyStates.set(ptyId, { ...state, terminalState: null, cachedRows: [] });
+      }
+      kittyStates.delete(ptyId);
+    }
+    subscribedPtys = next;
+    const ptyIds = Array.from(next);
+    for (const listener of subscriptionListeners) {
+      listener(ptyIds);
+    }
+  });
+}
+
 export function subscribeState(ptyId: string, callback: (state: TerminalState) => void): () => void {
   const set = stateSubscribers.get(ptyId) ?? new Set<(state: TerminalState) => void>();
   set.add(callback);
@@ -0,0 +1,185 @@
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import type { KittyGraphicsImageInfo } from '../terminal/emulator-interface';
+
+/**
+ * Shared-memory transport for kitty image data between the shim server and
+ * its clients, which always run on the same host.
+ *
+ * Large image payloads are written to segments under /dev/shm (the tmpfs
+ * backing POSIX shm_open) instead of being framed over the socket; the
+ * ptyKitty event carries only the segment path and length. Clients map the
+ * segment (Bun.mmap) rather than copy it, so they share its pages with the
+ * server's copy.
+ *
+ * The server owns each segment for as long as its image exists, so every
+ * attached client can map it, and unlinks it when the image changes or goes
+ * away. Segments are never rewritten in place: a changed image gets a new
+ * one. A client's mapping stays valid after the unlink and keeps the pages
+ * alive until the client drops the image, so the tmpfs footprint is bounded
+ * by the images the server and its clients currently hold.
+ */
+
+/** Images smaller than this are cheaper to send inline. */
+export const KITTY_SHM_THRESHOLD_BYTES = 64 * 1024;
+
+const SEGMENT_PREFIX = 'openmux-kitty-';
+
+export type KittyShmRef = {
+  id: number;
+  path: string;
+  byteLength: number;
+};
+
+type Segment = {
+  path: string;
+  info: KittyGraphicsImageInfo;
+};
+
+function resolveShmDir(): string {
+  try {
+    fs.accessSync('/dev/shm', fs.constants.W_OK);
+    return '/dev/shm';
+  } catch {
+    // macOS has no shm filesystem; the temp dir stays in the page cache
+    return os.tmpdir();
+  }
+}
+
+/** Remove segments left behind by servers that died without cleaning up. */
+function removeStaleSegments(dir: string): void {
+  let names: string[];
+  try {
+    names = fs.readdirSync(dir);
+  } catch {
+    return;
+  }
+  for (const name of names) {
+    if (!name.startsWith(SEGMENT_PREFIX)) continue;
+    const pid = Number.parseInt(name.slice(SEGMENT_PREFIX.length), 10);
+    if (!Number.isFinite(pid) || pid === process.pid || isProcessAlive(pid)) continue;
+    try {
+      fs.unlinkSync(path.join(dir, name));
+    } catch {
+      // ignore
+    }
+  }
+}
+
+function isProcessAlive(pid: number): boolean {
+  try {
+    process.kill(pid, 0);
+    return true;
+  } catch (error) {
+    return (error as NodeJS.ErrnoException).code === 'EPERM';
+  }
+}
+
+const isSameImage = (a: KittyGraphicsImageInfo, b: KittyGraphicsImageInfo) => (
+  a.transmitTime === b.transmitTime &&
+  a.dataLength === b.dataLength &&
+  a.width === b.width &&
+  a.height === b.height &&
+  a.format === b.format &&
+  a.compression === b.compression
+);
+
+export class KittyShmSegments {
+  private segments = new Map<string, Segment>();
+  private dir: string | null = null;
+  private counter = 0;
+
+  /**
+   * Publish image data, reusing the image's current segment when the image
+   * is unchanged. Returns null when the segment can't be written, in which
+   * case the caller sends the data inline.
+   */
+  publish(ptyId: string, screen: string, info: KittyGraphicsImageInfo, data: Uint8Array): string | null {
+    const key = `${ptyId}:${screen}:${info.id}`;
+    const existing = this.segments.get(key);
+    if (existing && isSameImage(existing.info, info)) {
+      return existing.path;
+    }
+    if (existing) {
+      this.unlink(key, existing);
+    }
+
+    if (!this.dir) {
+      this.dir = resolveShmDir();
+      removeStaleSegments(this.dir);
+    }
+    const filePath = path.join(this.dir, `${SEGMENT_PREFIX}${process.pid}-${this.counter++}`);
+    try {
+      fs.writeFileSync(filePath, data, { mode: 0o600 });
+    } catch {
+      try {
+        fs.unlinkSync(filePath);
+      } catch {
+        // ignore
+      }
+      return null;
+    }
+    this.segments.set(key, { path: filePath, info });
+    return filePath;
+  }
+
+  /** Path of the segment already published for this exact image, or null. */
+  lookup(ptyId: string, screen: string, info: KittyGraphicsImageInfo): string | null {
+    const existing = this.segments.get(`${ptyId}:${screen}:${info.id}`);
+    return existing && isSameImage(existing.info, info) ? existing.path : null;
+  }
+
+  release(ptyId: string, screen: string, imageId: number): void {
+    const key = `${ptyId}:${screen}:${imageId}`;
+    const segment = this.segments.get(key);
+    if (segment) {
+      this.unlink(key, segment);
+    }
+  }
+
+  releasePty(ptyId: string): void {
+    const prefix = `${ptyId}:`;
+    for (const [key, segment] of this.segments) {
+      if (key.startsWith(prefix)) {
+        this.unlink(key, segment);
+      }
+    }
+  }
+
+  dispose(): void {
+    for (const [key, segment] of this.segments) {
+      this.unlink(key, segment);
+    }
+  }
+
+  private unlink(key: string, segment: Segment): void {
+    this.segments.delete(key);
+    try {
+      fs.unlinkSync(segment.path);
+    } catch {
+      // ignore
+    }
+  }
+}
+
+/**
+ * Map a segment published by the server (read into memory where mmap isn't
+ * available). Null when it is gone (the image was replaced or removed
+ * before this client got to it) or malformed.
+ */
+export function readKittyShm(ref: KittyShmRef): Uint8Array | null {
+  if (!path.basename(ref.path).startsWith(SEGMENT_PREFIX)) return null;
+  try {
+    if (typeof Bun !== 'undefined' && typeof Bun.mmap === 'function') {
+      // Private mapping: the pages are shared until written, which nothing does
+      const mapped = Bun.mmap(ref.path, { shared: false });
+      return mapped.byteLength === ref.byteLength ? mapped : null;
+    }
+    const data = fs.readFileSync(ref.path);
+    if (data.byteLength !== ref.byteLength) return null;
+    return new Uint8Array(data.buffer, data.byteOffset, data.byteLength);
+  } catch {
+    return null;
+  }
+}
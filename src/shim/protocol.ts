@@ -2,9 +2,18 @@ import { homedir } from 'os';
 import { join } from 'path';
 import { Buffer } from 'buffer';
 
+import type { SerializedDirtyUpdate } from '../terminal/emulator-interface';
+import { tracePtyEvent } from '../terminal/pty-trace';
+
 export const SHIM_SOCKET_DIR = join(homedir(), '.config', 'openmux', 'sockets');
 export const SHIM_SOCKET_PATH = join(SHIM_SOCKET_DIR, 'openmux.sock');
 
+/** Wire protocol version, checked by both sides on hello. */
+export const SHIM_PROTOCOL_VERSION = 2;
+
+/** Prefix of the hello error a shim returns to clients of another version. */
+export const SHIM_PROTOCOL_MISMATCH = 'Shim protocol mismatch';
+
 export type ShimHeader = {
   type: string;
   requestId?: number;
@@ -17,6 +26,91 @@ export type ShimHeader = {
   [key: string]: unknown;
 };
 
+/**
+ * Frame layout: u32 BE frame length, then a u32 BE tag, then the body.
+ *
+ * JSON frames (rare control messages): the tag is the byte length of a JSON
+ * header, followed by the header and the payloads split by payloadLengths.
+ *
+ * Binary frames (hot paths: ptyUpdate, write, resize, getScrollbackLines and
+ * their responses): the tag has the high bit set and carries the schema
+ * version and kind. Fields sit at fixed little-endian offsets after the tag,
+ * followed by the ptyId (u16 length + utf8) and the payload bytes. The
+ * reader decodes them into the same ShimHeader shape as JSON frames.
+ */
+const BINARY_FRAME_FLAG = 0x80000000;
+const BINARY_FRAME_VERSION = 1;
+
+const enum BinaryFrameKind {
+  PTY_UPDATE = 1,
+  WRITE = 2,
+  RESIZE = 3,
+  GET_SCROLLBACK_LINES = 4,
+  RESPONSE_ACK = 5,
+  RESPONSE_SCROLLBACK_LINES = 6,
+}
+
+const enum PtyUpdateFlags {
+  CURSOR_VISIBLE = 1 << 0,
+  IS_FULL = 1 << 1,
+  ALTERNATE_SCREEN = 1 << 2,
+  MOUSE_TRACKING = 1 << 3,
+  IN_BAND_RESIZE = 1 << 4,
+  AT_BOTTOM = 1 << 5,
+}
+
+const enum ResizeFlags {
+  HAS_PIXEL_WIDTH = 1 << 0,
+  HAS_PIXEL_HEIGHT = 1 << 1,
+}
+
+// Fixed field sizes, counted from the start of the tag
+const PTY_UPDATE_FIXED = 38;
+const WRITE_FIXED = 10;
+const RESIZE_FIXED = 24;
+const GET_SCROLLBACK_LINES_FIXED = 18;
+const RESPONSE_ACK_FIXED = 8;
+const RESPONSE_SCROLLBACK_LINES_FIXED = 12;
+
+const INITIAL_READ_CAPACITY = 64 * 1024;
+/** Larger split-frame buffers are dropped once their frame is taken. */
+const MAX_RETAINED_READ_CAPACITY = 1024 * 1024;
+
+function binaryTag(kind: BinaryFrameKind): number {
+  return (BINARY_FRAME_FLAG | (BINARY_FRAME_VERSION << 8) | kind) >>> 0;
+}
+
+/**
+ * Allocate a frame with its length prefix and tag written. Encoders write
+ * fields through frame.subarray(4) so offsets match the decoder's.
+ */
+function allocBinaryFrame(kind: BinaryFrameKind, bodyLength: number): Buffer {
+  const buffer = Buffer.allocUnsafe(4 + bodyLength);
+  buffer.writeUInt32BE(bodyLength, 0);
+  buffer.writeUInt32BE(binaryTag(kind), 4);
+  return buffer;
+}
+
+function writePtyId(buffer: Buffer, offset: number, ptyId: Buffer): number {
+  buffer.writeUInt16LE(ptyId.length, offset);
+  ptyId.copy(buffer, offset + 2);
+  return offset + 2 + ptyId.length;
+}
+
+function readPtyId(frame: Buffer, offset: number): { ptyId: string; end: number } {
+  const length = frame.readUInt16LE(offset);
+  const end = offset + 2 + length;
+  return { ptyId: frame.toString('utf8', offset + 2, end), end };
+}
+
+function copyBytes(target: Buffer, offset: number, source: ArrayBufferView | ArrayBuffer): number {
+  const bytes = ArrayBuffer.isView(source)
+    ? new Uint8Array(source.buffer, source.byteOffset, source.byteLength)
+    : new Uint8Array(source);
+  target.set(bytes, offset);
+  return offset + bytes.byteLength;
+}
+
 export function encodeFrame(header: ShimHeader, payloads: ArrayBuffer[] = []): Buffer {
   const headerJson = JSON.stringify(header);
   const headerBuffer = Buffer.from(headerJson, 'utf8');
@@ -38,44 +132,492 @@ export function encodeFrame(header: ShimHeader, payloads: ArrayBuffer[] = []): B
   return buffer;
 }
 
+/**
+ * Encode a ptyUpdate event. Payloads are dirty row indices, dirty row data
+ * and full state data, copied straight from the packed update.
+ */
+export function encodePtyUpdateFrame(
+  ptyId: string,
+  packed: SerializedDirtyUpdate,
+  scrollState: { viewportOffset: number; isAtBottom: boolean }
+): Buffer {
+  const id = Buffer.from(ptyId, 'utf8');
+  const indicesLength = packed.dirtyRowIndices.byteLength;
+  const rowDataLength = packed.dirtyRowData.byteLength;
+  const fullStateLength = packed.fullStateData?.byteLength ?? 0;
+  const frame = allocBinaryFrame(
+    BinaryFrameKind.PTY_UPDATE,
+    PTY_UPDATE_FIXED + id.length + indicesLength + rowDataLength + fullStateLength
+  );
+
+  let flags = 0;
+  if (packed.cursor.visible) flags |= PtyUpdateFlags.CURSOR_VISIBLE;
+  if (packed.isFull) flags |= PtyUpdateFlags.IS_FULL;
+  if (packed.alternateScreen) flags |= PtyUpdateFlags.ALTERNATE_SCREEN;
+  if (packed.mouseTracking) flags |= PtyUpdateFlags.MOUSE_TRACKING;
+  if (packed.inBandResize) flags |= PtyUpdateFlags.IN_BAND_RESIZE;
+  if (scrollState.isAtBottom) flags |= PtyUpdateFlags.AT_BOTTOM;
+
+  const body = frame.subarray(4);
+  body.writeUInt32LE(indicesLength, 4);
+  body.writeUInt32LE(rowDataLength, 8);
+  body.writeUInt32LE(fullStateLength, 12);
+  body.writeUInt32LE(packed.scrollbackLength, 16);
+  body.writeUInt32LE(scrollState.viewportOffset, 20);
+  body.writeUInt16LE(packed.cursor.x, 24);
+  body.writeUInt16LE(packed.cursor.y, 26);
+  body.writeUInt16LE(packed.cols, 28);
+  body.writeUInt16LE(packed.rows, 30);
+  body.writeUInt8((packed.kittyKeyboardFlags ?? 0) & 0xff, 32);
+  body.writeUInt8(packed.cursorKeyMode, 33);
+  body.writeUInt8(flags, 34);
+  body.writeUInt8(0, 35);
+
+  let offset = writePtyId(body, 36, id);
+  offset = copyBytes(body, offset, packed.dirtyRowIndices);
+  offset = copyBytes(body, offset, packed.dirtyRowData);
+  if (packed.fullStateData) {
+    copyBytes(body, offset, packed.fullStateData);
+  }
+  return frame;
+}
+
+/**
+ * Encode a request. write, resize and getScrollbackLines use fixed binary
+ * schemas; everything else (and requests carrying payloads) stays JSON.
+ */
+export function encodeRequestFrame(
+  requestId: number,
+  method: string,
+  params?: Record<string, unknown>,
+  payloads: ArrayBuffer[] = []
+): Buffer {
+  const ptyId = params?.ptyId;
+  if (payloads.length === 0 && typeof ptyId === 'string') {
+    if (method === 'write' && typeof params?.data === 'string') {
+      return encodeWriteFrame(requestId, ptyId, params.data);
+    }
+    if (method === 'resize' && typeof params?.cols === 'number' && typeof params.rows === 'number') {
+      return encodeResizeFrame(
+        requestId,
+        ptyId,
+        params.cols,
+        params.rows,
+        params.pixelWidth as number | undefined,
+        params.pixelHeight as number | undefined
+      );
+    }
+    if (
+      method === 'getScrollbackLines' &&
+      typeof params?.startOffset === 'number' &&
+      typeof params.count === 'number'
+    ) {
+      return encodeGetScrollbackLinesFrame(requestId, ptyId, params.startOffset, params.count);
+    }
+  }
+
+  return encodeFrame({
+    type: 'request',
+    requestId,
+    method,
+    params,
+    payloadLengths: payloads.map((payload) => payload.byteLength),
+  }, payloads);
+}
+
+function encodeWriteFrame(requestId: number, ptyId: string, data: string): Buffer {
+  const id = Buffer.from(ptyId, 'utf8');
+  const dataLength = Buffer.byteLength(data, 'utf8');
+  const frame = allocBinaryFrame(BinaryFrameKind.WRITE, WRITE_FIXED + id.length + dataLength);
+  const body = frame.subarray(4);
+  body.writeUInt32LE(requestId, 4);
+  const offset = writePtyId(body, 8, id);
+  body.write(data, offset, 'utf8');
+  return frame;
+}
+
+function encodeResizeFrame(
+  requestId: number,
+  ptyId: string,
+  cols: number,
+  rows: number,
+  pixelWidth?: number,
+  pixelHeight?: number
+): Buffer {
+  const id = Buffer.from(ptyId, 'utf8');
+  const frame = allocBinaryFrame(BinaryFrameKind.RESIZE, RESIZE_FIXED + id.length);
+  let flags = 0;
+  if (typeof pixelWidth === 'number') flags |= ResizeFlags.HAS_PIXEL_WIDTH;
+  if (typeof pixelHeight === 'number') flags |= ResizeFlags.HAS_PIXEL_HEIGHT;
+
+  const body = frame.subarray(4);
+  body.writeUInt32LE(requestId, 4);
+  body.writeUInt16LE(cols, 8);
+  body.writeUInt16LE(rows, 10);
+  body.writeUInt32LE(pixelWidth ?? 0, 12);
+  body.writeUInt32LE(pixelHeight ?? 0, 16);
+  body.writeUInt8(flags, 20);
+  body.writeUInt8(0, 21);
+  writePtyId(body, 22, id);
+  return frame;
+}
+
+function encodeGetScrollbackLinesFrame(
+  requestId: number,
+  ptyId: string,
+  startOffset: number,
+  count: number
+): Buffer {
+  const id = Buffer.from(ptyId, 'utf8');
+  const frame = allocBinaryFrame(BinaryFrameKind.GET_SCROLLBACK_LINES, GET_SCROLLBACK_LINES_FIXED + id.length);
+  const body = frame.subarray(4);
+  body.writeUInt32LE(requestId, 4);
+  body.writeUInt32LE(startOffset, 8);
+  body.writeUInt32LE(count, 12);
+  writePtyId(body, 16, id);
+  return frame;
+}
+
+/** Encode a successful response with no result or payloads. */
+export function encodeAckFrame(requestId: number): Buffer {
+  const frame = allocBinaryFrame(BinaryFrameKind.RESPONSE_ACK, RESPONSE_ACK_FIXED);
+  frame.subarray(4).writeUInt32LE(requestId, 4);
+  return frame;
+}
+
+/**
+ * Encode a getScrollbackLines response: the line offsets followed by the
+ * packed rows, written back to back without an intermediate combined buffer.
+ */
+export function encodeScrollbackLinesFrame(
+  requestId: number,
+  lineOffsets: number[],
+  rows: ArrayBuffer[]
+): Buffer {
+  const rowsLength = rows.reduce((sum, row) => sum + row.byteLength, 0);
+  const frame = allocBinaryFrame(
+    BinaryFrameKind.RESPONSE_SCROLLBACK_LINES,
+    RESPONSE_SCROLLBACK_LINES_FIXED + lineOffsets.length * 4 + rowsLength
+  );
+  const body = frame.subarray(4);
+  body.writeUInt32LE(requestId, 4);
+  body.writeUInt32LE(lineOffsets.length, 8);
+  let offset = RESPONSE_SCROLLBACK_LINES_FIXED;
+  for (const lineOffset of lineOffsets) {
+    body.writeUInt32LE(lineOffset, offset);
+    offset += 4;
+  }
+  for (const row of rows) {
+    offset = copyBytes(body, offset, row);
+  }
+  return frame;
+}
+
+type DecodedFrame = { header: ShimHeader; payloads: Buffer[] };
+
+function decodeJsonFrame(frame: Buffer, headerLength: number): DecodedFrame {
+  const headerEnd = 4 + headerLength;
+  const header = JSON.parse(frame.toString('utf8', 4, headerEnd)) as ShimHeader;
+
+  const payloads: Buffer[] = [];
+  let offset = headerEnd;
+  const payloadLengths = header.payloadLengths ?? [];
+
+  if (payloadLengths.length > 0) {
+    for (const length of payloadLengths) {
+      payloads.push(frame.subarray(offset, offset + length));
+      offset += length;
+    }
+  } else if (offset < frame.length) {
+    payloads.push(frame.subarray(offset));
+  }
+
+  return { header, payloads };
+}
+
+/**
+ * Decode a binary frame (offsets relative to the tag).
+ * Returns null for unknown versions or kinds, or truncated frames.
+ */
+function decodeBinaryFrame(frame: Buffer, tag: number): DecodedFrame | null {
+  if (((tag >>> 8) & 0xff) !== BINARY_FRAME_VERSION) {
+    return null;
+  }
+
+  switch ((tag & 0xff) as BinaryFrameKind) {
+    case BinaryFrameKind.PTY_UPDATE: {
+      if (frame.length < PTY_UPDATE_FIXED) return null;
+      const indicesLength = frame.readUInt32LE(4);
+      const rowDataLength = frame.readUInt32LE(8);
+      const fullStateLength = frame.readUInt32LE(12);
+      const flags = frame.readUInt8(34);
+      const { ptyId, end } = readPtyId(frame, 36);
+      const rowDataStart = end + indicesLength;
+      const fullStateStart = rowDataStart + rowDataLength;
+      if (fullStateStart + fullStateLength > frame.length) return null;
+
+      return {
+        header: {
+          type: 'ptyUpdate',
+          ptyId,
+          packed: {
+            cursor: {
+              x: frame.readUInt16LE(24),
+              y: frame.readUInt16LE(26),
+              visible: (flags & PtyUpdateFlags.CURSOR_VISIBLE) !== 0,
+            },
+            cols: frame.readUInt16LE(28),
+            rows: frame.readUInt16LE(30),
+            scrollbackLength: frame.readUInt32LE(16),
+            isFull: (flags & PtyUpdateFlags.IS_FULL) !== 0,
+            alternateScreen: (flags & PtyUpdateFlags.ALTERNATE_SCREEN) !== 0,
+            mouseTracking: (flags & PtyUpdateFlags.MOUSE_TRACKING) !== 0,
+            cursorKeyMode: frame.readUInt8(33),
+            kittyKeyboardFlags: frame.readUInt8(32),
+            inBandResize: (flags & PtyUpdateFlags.IN_BAND_RESIZE) !== 0,
+          },
+          scrollState: {
+            viewportOffset: frame.readUInt32LE(20),
+            isAtBottom: (flags & PtyUpdateFlags.AT_BOTTOM) !== 0,
+          },
+        },
+        payloads: [
+          frame.subarray(end, rowDataStart),
+          frame.subarray(rowDataStart, fullStateStart),
+          frame.subarray(fullStateStart, fullStateStart + fullStateLength),
+        ],
+      };
+    }
+
+    case BinaryFrameKind.WRITE: {
+      if (frame.length < WRITE_FIXED) return null;
+      const { ptyId, end } = readPtyId(frame, 8);
+      if (end > frame.length) return null;
+      return {
+        header: {
+          type: 'request',
+          requestId: frame.readUInt32LE(4),
+          method: 'write',
+          params: { ptyId, data: frame.toString('utf8', end) },
+        },
+        payloads: [],
+      };
+    }
+
+    case BinaryFrameKind.RESIZE: {
+      if (frame.length < RESIZE_FIXED) return null;
+      const flags = frame.readUInt8(20);
+      const { ptyId, end } = readPtyId(frame, 22);
+      if (end > frame.length) return null;
+      return {
+        header: {
+          type: 'request',
+          requestId: frame.readUInt32LE(4),
+          method: 'resize',
+          params: {
+            ptyId,
+            cols: frame.readUInt16LE(8),
+            rows: frame.readUInt16LE(10),
+            pixelWidth: (flags & ResizeFlags.HAS_PIXEL_WIDTH) !== 0 ? frame.readUInt32LE(12) : undefined,
+            pixelHeight: (flags & ResizeFlags.HAS_PIXEL_HEIGHT) !== 0 ? frame.readUInt32LE(16) : undefined,
+          },
+        },
+        payloads: [],
+      };
+    }
+
+    case BinaryFrameKind.GET_SCROLLBACK_LINES: {
+      if (frame.length < GET_SCROLLBACK_LINES_FIXED) return null;
+      const { ptyId, end } = readPtyId(frame, 16);
+      if (end > frame.length) return null;
+      return {
+        header: {
+          type: 'request',
+          requestId: frame.readUInt32LE(4),
+          method: 'getScrollbackLines',
+          params: {
+            ptyId,
+            startOffset: frame.readUInt32LE(8),
+            count: frame.readUInt32LE(12),
+          },
+        },
+        payloads: [],
+      };
+    }
+
+    case BinaryFrameKind.RESPONSE_ACK:
+      if (frame.length < RESPONSE_ACK_FIXED) return null;
+      return {
+        header: { type: 'response', requestId: frame.readUInt32LE(4), ok: true },
+        payloads: [],
+      };
+
+    case BinaryFrameKind.RESPONSE_SCROLLBACK_LINES: {
+      if (frame.length < RESPONSE_SCROLLBACK_LINES_FIXED) return null;
+      const count = frame.readUInt32LE(8);
+      const rowsStart = RESPONSE_SCROLLBACK_LINES_FIXED + count * 4;
+      if (rowsStart > frame.length) return null;
+      const lineOffsets: number[] = new Array(count);
+      for (let i = 0; i < count; i++) {
+        lineOffsets[i] = frame.readUInt32LE(RESPONSE_SCROLLBACK_LINES_FIXED + i * 4);
+      }
+      return {
+        header: {
+          type: 'response',
+          requestId: frame.readUInt32LE(4),
+          ok: true,
+          result: { lineOffsets },
+        },
+        payloads: [frame.subarray(rowsStart)],
+      };
+    }
+
+    default:
+      return null;
+  }
+}
+
+/**
+ * Failed response for a response frame that can't be decoded but still
+ * carries its request id, so the caller's pending request settles instead
+ * of waiting forever.
+ */
+function undecodableResponse(frame: Buffer): ShimHeader | null {
+  if (frame.length < 8) return null;
+  const tag = frame.readUInt32BE(0);
+  if ((tag & BINARY_FRAME_FLAG) === 0 || ((tag >>> 8) & 0xff) !== BINARY_FRAME_VERSION) {
+    return null;
+  }
+  const kind = (tag & 0xff) as BinaryFrameKind;
+  if (kind !== BinaryFrameKind.RESPONSE_ACK && kind !== BinaryFrameKind.RESPONSE_SCROLLBACK_LINES) {
+    return null;
+  }
+  return {
+    type: 'response',
+    requestId: frame.readUInt32LE(4),
+    ok: false,
+    error: 'Malformed shim response frame',
+  };
+}
+
+function decodeFrame(frame: Buffer): DecodedFrame | null {
+  if (frame.length < 4) {
+    return null;
+  }
+  const tag = frame.readUInt32BE(0);
+  if ((tag & BINARY_FRAME_FLAG) !== 0) {
+    return decodeBinaryFrame(frame, tag);
+  }
+  return decodeJsonFrame(frame, tag);
+}
+
+/**
+ * Splits a byte stream into frames.
+ *
+ * Frames that arrive whole are decoded in place from the incoming chunk.
+ * A frame split across chunks is assembled in a growable buffer that is
+ * reused for the life of the reader (shrunk again after an unusually large
+ * frame), then copied out once on completion, since handlers may hold on
+ * to payload slices.
+ */
 export class FrameReader {
-  private buffer = Buffer.alloc(0);
+  private pending = Buffer.alloc(0);
+  private pendingLength = 0;
 
   feed(chunk: Buffer, onFrame: (header: ShimHeader, payloads: Buffer[]) => void): void {
-    this.buffer = Buffer.concat([this.buffer, chunk]);
+    let offset = 0;
 
-    while (this.buffer.length >= 4) {
-      const frameLength = this.buffer.readUInt32BE(0);
-      if (this.buffer.length < 4 + frameLength) {
+    if (this.pendingLength > 0) {
+      offset = this.fillPending(chunk);
+      const frame = this.takePendingFrame();
+      if (!frame) {
         return;
       }
+      this.dispatch(frame, onFrame);
+    }
 
-      const frame = this.buffer.subarray(4, 4 + frameLength);
-      this.buffer = this.buffer.subarray(4 + frameLength);
-
-      if (frame.length < 4) {
-        continue;
+    while (chunk.length - offset >= 4) {
+      const frameLength = chunk.readUInt32BE(offset);
+      const frameEnd = offset + 4 + frameLength;
+      if (chunk.length < frameEnd) {
+        break;
       }
+      this.dispatch(chunk.subarray(offset + 4, frameEnd), onFrame);
+      offset = frameEnd;
+    }
+
+    if (offset < chunk.length) {
+      this.appendPending(chunk, offset, chunk.length);
+    }
+  }
 
-      const headerLength = frame.readUInt32BE(0);
-      const headerEnd = 4 + headerLength;
-      const headerJson = frame.subarray(4, headerEnd).toString('utf8');
-      const header = JSON.parse(headerJson) as ShimHeader;
-
-      const payloads: Buffer[] = [];
-      let offset = headerEnd;
-      const payloadLengths = header.payloadLengths ?? [];
-
-      if (payloadLengths.length > 0) {
-        for (const length of payloadLengths) {
-          payloads.push(frame.subarray(offset, offset + length));
-          offset += length;
-        }
-      } else if (offset < frame.length) {
-        payloads.push(frame.subarray(offset));
+  private dispatch(frame: Buffer, onFrame: (header: ShimHeader, payloads: Buffer[]) => void): void {
+    const decoded = decodeFrame(frame);
+    if (decoded) {
+      onFrame(decoded.header, decoded.payloads);
+      return;
+    }
+    const failed = undecodableResponse(frame);
+    if (failed) {
+      onFrame(failed, []);
+      return;
+    }
+    tracePtyEvent('shim-frame-dropped', {
+      tag: frame.length >= 4 ? frame.readUInt32BE(0) : null,
+      length: frame.length,
+    });
+  }
+
+  /**
+   * Copy bytes from the chunk into the pending buffer until it holds one
+   * complete frame (or the chunk runs out). Returns the chunk offset consumed.
+   */
+  private fillPending(chunk: Buffer): number {
+    let offset = 0;
+    if (this.pendingLength < 4) {
+      const take = Math.min(4 - this.pendingLength, chunk.length);
+      this.appendPending(chunk, 0, take);
+      offset = take;
+      if (this.pendingLength < 4) {
+        return offset;
       }
+    }
+
+    const needed = 4 + this.pending.readUInt32BE(0) - this.pendingLength;
+    const take = Math.min(needed, chunk.length - offset);
+    this.appendPending(chunk, offset, offset + take);
+    return offset + take;
+  }
 
-      onFrame(header, payloads);
+  private takePendingFrame(): Buffer | null {
+    if (this.pendingLength < 4) {
+      return null;
+    }
+    const frameLength = this.pending.readUInt32BE(0);
+    if (this.pendingLength < 4 + frameLength) {
+      return null;
+    }
+    const frame = Buffer.allocUnsafe(frameLength);
+    this.pending.copy(frame, 0, 4, 4 + frameLength);
+    this.pendingLength = 0;
+    if (this.pending.length > MAX_RETAINED_READ_CAPACITY) {
+      this.pending = Buffer.allocUnsafe(INITIAL_READ_CAPACITY);
+    }
+    return frame;
+  }
+
+  private appendPending(source: Buffer, start: number, end: number): void {
+    const required = this.pendingLength + (end - start);
+    if (required > this.pending.length) {
+      let capacity = Math.max(this.pending.length * 2, INITIAL_READ_CAPACITY);
+      while (capacity < required) {
+        capacity *= 2;
+      }
+      const grown = Buffer.allocUnsafe(capacity);
+      this.pending.copy(grown, 0, 0, this.pendingLength);
+      this.pending = grown;
     }
+    source.copy(this.pending, this.pendingLength, start, end);
+    this.pendingLength = required;
   }
 }
@@ -7,12 +7,22 @@ import type { UnifiedTerminalUpdate, TerminalScrollState, TerminalState, DirtyTe
 import { packDirtyUpdate } from '../terminal/cell-serialization';
 import type { ITerminalEmulator } from '../terminal/emulator-interface';
 import { setHostColors as setHostColorsDefault, type TerminalColors } from '../terminal/terminal-colors';
-import { SHIM_SOCKET_PATH, type ShimHeader } from './protocol';
+import { encodeFrame, encodePtyUpdateFrame, SHIM_SOCKET_PATH, type ShimHeader } from './protocol';
 import { setKittyTransmitForwarder, setKittyUpdateForwarder } from './kitty-forwarder';
 import { setNotificationForwarder } from './notification-forwarder';
-import type { ShimServerState } from './server-state';
+import type { ShimClient, ShimServerState } from './server-state';
 import { createRequestHandler } from './server-requests';
-import { sendFrame, sendResponse, sendError } from './server/frames';
+import { sendFrame, sendResponse, sendError, sendProgress, sendScrollbackLines } from './server/frames';
+import {
+  broadcastFrame,
+  broadcastPtyUpdate,
+  clientWantsPty,
+  createShimClient,
+  flushHeldFrames,
+  flushPendingUpdates,
+  sendClientFrame,
+  writeClientFrame,
+} from './server/clients';
 import { createKittyHandlers } from './server/kitty';
 
 export type WithPty = <A>(fn: (pty: any) => Effect.Effect<A, unknown, any> | A) => Promise<A>;
@@ -50,9 +60,29 @@ export function createServerHandlers(state: ShimServerState, options?: ShimServe
     await withPty((pty) => pty.setHostColors(colors));
   };
 
-  const sendEvent = (header: ShimHeader, payloads: ArrayBuffer[] = []) => {
-    if (!state.activeClient) return;
-    sendFrame(state.activeClient, header, payloads);
+  /**
+   * Send an event to one client, or encode it once and fan it out to every
+   * attached client. Kitty events only go to clients that want their pty;
+   * exits, titles and notifications go to all. Congested clients hold
+   * events until they drain; kitty events may be dropped and resynced.
+   */
+  const sendEvent = (header: ShimHeader, payloads: ArrayBuffer[] = [], target?: ShimClient) => {
+    if (state.clients.size === 0) return;
+    const frame = encodeFrame(header, payloads);
+    const ptyId = typeof header.ptyId === 'string' ? header.ptyId : undefined;
+    const kitty = header.type === 'ptyKitty' || header.type === 'ptyKittyTransmit';
+    if (target) {
+      sendClientFrame(target, frame, kitty ? ptyId : undefined);
+      return;
+    }
+    broadcastFrame(state, frame, kitty ? ptyId : undefined, kitty);
+  };
+
+  const encodePtyUpdate = (ptyId: string, update: DirtyTerminalUpdate, scrollState: TerminalScrollState) =>
+    encodePtyUpdateFrame(ptyId, packDirtyUpdate(update), scrollState);
+
+  const sendPtyUpdate = (ptyId: string, update: DirtyTerminalUpdate, scrollState: TerminalScrollState) => {
+    broadcastPtyUpdate(state, ptyId, update, scrollState, encodePtyUpdate);
   };
 
   const { sendKittyTransmit, sendKittyUpdate, queueKittyUpdate } = createKittyHandlers(state, sendEvent);
@@ -85,36 +115,7 @@ export function createServerHandlers(state: ShimServerState, options?: ShimServe
 
     const unifiedUnsub = await withPty<() => void>((pty) =>
       pty.subscribeUnified(PtyId.make(ptyId), (update: UnifiedTerminalUpdate) => {
-        const packed = packDirtyUpdate(update.terminalUpdate);
-        const payloads: ArrayBuffer[] = [
-          packed.dirtyRowIndices.buffer.slice(0) as ArrayBuffer,
-          packed.dirtyRowData as ArrayBuffer,
-          (packed.fullStateData ?? new ArrayBuffer(0)) as ArrayBuffer,
-        ];
-
-        const header: ShimHeader = {
-          type: 'ptyUpdate',
-          ptyId,
-          packed: {
-            cursor: packed.cursor,
-            cols: packed.cols,
-            rows: packed.rows,
-            scrollbackLength: packed.scrollbackLength,
-            isFull: packed.isFull,
-            alternateScreen: packed.alternateScreen,
-            mouseTracking: packed.mouseTracking,
-            cursorKeyMode: packed.cursorKeyMode,
-            kittyKeyboardFlags: packed.kittyKeyboardFlags,
-            inBandResize: packed.inBandResize,
-          },
-          scrollState: {
-            viewportOffset: update.scrollState.viewportOffset,
-            isAtBottom: update.scrollState.isAtBottom,
-          },
-          payloadLengths: payloads.map((payload) => payload.byteLength),
-        };
-
-        sendEvent(header, payloads);
+        sendPtyUpdate(ptyId, update.terminalUpdate, update.scrollState);
         const kittyEmulator = state.ptyEmulators.get(ptyId);
         if (kittyEmulator) {
           sendKittyUpdate(ptyId, kittyEmulator);
@@ -143,6 +144,7 @@ export function createServerHandlers(state: ShimServerState, options?: ShimServe
     state.kittyTransmitCache.delete(ptyId);
     state.kittyTransmitPending.delete(ptyId);
     state.kittyTransmitInvalidated.delete(ptyId);
+    state.kittyShm.releasePty(ptyId);
   }
 
   async function subscribeAllPtys(): Promise<string[]> {
@@ -152,6 +154,7 @@ export function createServerHandlers(state: ShimServerState, options?: ShimServe
   }
 
   async function handleLifecycle(): Promise<void> {
+    if (state.lifecycleUnsub) return;
     state.lifecycleUnsub = await withPty<() => void>((pty) => pty.subscribeToLifecycle((event: { type: 'created' | 'destroyed'; ptyId: string }) => {
       const ptyId = String(event.ptyId);
       if (event.type === 'created') {
@@ -165,13 +168,18 @@ export function createServerHandlers(state: ShimServerState, options?: ShimServe
   }
 
   async function handleTitles(): Promise<void> {
+    if (state.titleUnsub) return;
     state.titleUnsub = await withPty<() => void>((pty) => pty.subscribeToAllTitleChanges((event: { ptyId: string; title: string }) => {
       sendEvent({ type: 'ptyTitle', ptyId: String(event.ptyId), title: event.title });
     }));
   }
 
-  async function sendSnapshot(ptyId: string): Promise<void> {
-    if (!state.activeClient) return;
+  /**
+   * Send a full-state ptyUpdate to one client. On attach this also replays
+   * cached kitty transmits to it and forces a kitty refresh.
+   */
+  async function sendSnapshot(ptyId: string, client: ShimClient, includeKitty: boolean): Promise<void> {
+    if (!state.clients.has(client.socket) || !clientWantsPty(client, ptyId)) return;
     try {
       const result = await withPty((pty) =>
         Effect.gen(function* () {
@@ -196,61 +204,62 @@ export function createServerHandlers(state: ShimServerState, options?: ShimServe
         inBandResize: false,
       };
 
-      const packed = packDirtyUpdate(update);
-      const payloads: ArrayBuffer[] = [
-        packed.dirtyRowIndices.buffer.slice(0) as ArrayBuffer,
-        packed.dirtyRowData as ArrayBuffer,
-        (packed.fullStateData ?? new ArrayBuffer(0)) as ArrayBuffer,
-      ];
+      // The snapshot supersedes anything held back for this pty
+      client.pendingUpdates.delete(ptyId);
+      writeClientFrame(client, encodePtyUpdate(ptyId, update, result.scrollState));
+      if (!includeKitty) return;
 
-      sendEvent({
-        type: 'ptyUpdate',
-        ptyId,
-        packed: {
-          cursor: packed.cursor,
-          cols: packed.cols,
-          rows: packed.rows,
-          scrollbackLength: packed.scrollbackLength,
-          isFull: packed.isFull,
-          alternateScreen: packed.alternateScreen,
-          mouseTracking: packed.mouseTracking,
-          cursorKeyMode: packed.cursorKeyMode,
-          kittyKeyboardFlags: packed.kittyKeyboardFlags,
-          inBandResize: packed.inBandResize,
-        },
-        scrollState: {
-          viewportOffset: result.scrollState.viewportOffset,
-          isAtBottom: result.scrollState.isAtBottom,
-        },
-        payloadLengths: payloads.map((payload) => payload.byteLength),
-      }, payloads);
-
-      const emulator = state.ptyEmulators.get(ptyId) ??
-        await withPty((pty) => pty.getEmulator(PtyId.make(ptyId))) as ITerminalEmulator;
-      if (emulator) {
-        state.ptyEmulators.set(ptyId, emulator);
-        const cache = state.kittyTransmitCache.get(ptyId);
-        if (cache && cache.size > 0) {
-          for (const sequences of cache.values()) {
-            for (const seq of sequences) {
-              sendKittyTransmit(ptyId, seq);
-            }
-          }
-        }
-        sendKittyUpdate(ptyId, emulator, true);
-      }
+      await resyncKitty(ptyId, client);
     } catch {
       // ignore snapshot errors
     }
   }
 
-  async function sendSnapshots(ptyIds: string[]): Promise<void> {
-    await Promise.all(ptyIds.map((ptyId) => sendSnapshot(ptyId)));
+  /** Replay a pty's recorded kitty transmits to a client and resend its images. */
+  async function resyncKitty(ptyId: string, client: ShimClient): Promise<void> {
+    const emulator = state.ptyEmulators.get(ptyId) ??
+      await withPty((pty) => pty.getEmulator(PtyId.make(ptyId))) as ITerminalEmulator;
+    if (!emulator) return;
+    state.ptyEmulators.set(ptyId, emulator);
+    const cache = state.kittyTransmitCache.get(ptyId);
+    if (cache && cache.size > 0) {
+      for (const sequences of cache.values()) {
+        for (const seq of sequences) {
+          sendKittyTransmit(ptyId, seq, client);
+        }
+      }
+    }
+    sendKittyUpdate(ptyId, emulator, true, client);
   }
 
-  async function attachClient(socket: net.Socket, clientId: string): Promise<void> {
-    const previousClient = state.activeClient;
-    const previousClientId = previousClient ? state.clientIds.get(previousClient) ?? null : null;
+  async function sendSnapshots(ptyIds: string[], client: ShimClient): Promise<void> {
+    await Promise.all(ptyIds.map((ptyId) => sendSnapshot(ptyId, client, true)));
+  }
+
+  /** Send what a congested client missed once its socket drains. */
+  function handleClientDrain(client: ShimClient): void {
+    for (const ptyId of flushHeldFrames(client)) {
+      resyncKitty(ptyId, client).catch(() => {});
+    }
+    // Held updates go out once the held events have
+    if (client.congested) return;
+    for (const ptyId of flushPendingUpdates(client, encodePtyUpdate)) {
+      sendSnapshot(ptyId, client, false).catch(() => {});
+    }
+  }
+
+  /**
+   * Attach a client. A primary client replaces the previous primary (which
+   * is told it was detached and its id revoked); a shared client joins the
+   * clients already attached. Pty subscriptions are shared by all clients
+   * and only set up for the first one.
+   */
+  async function attachClient(socket: net.Socket, clientId: string, shared: boolean = false): Promise<void> {
+    const previousClient = shared ? null : state.activeClient;
+    const previousClientId = previousClient ? state.clients.get(previousClient)?.clientId ?? null : null;
+    if (previousClient) {
+      state.clients.delete(previousClient);
+    }
     if (previousClient && !previousClient.destroyed) {
       sendFrame(previousClient, { type: 'detached' });
       previousClient.end();
@@ -265,9 +274,13 @@ export function createServerHandlers(state: ShimServerState, options?: ShimServe
       state.revokedClientIds.add(previousClientId);
     }
 
-    state.clientIds.set(socket, clientId);
-    state.activeClient = socket;
-    state.activeClientId = clientId;
+    const client = createShimClient(socket, clientId, shared);
+    state.clients.set(socket, client);
+    socket.on('drain', () => handleClientDrain(client));
+    if (!shared) {
+      state.activeClient = socket;
+      state.activeClientId = clientId;
+    }
     setKittyTransmitForwarder(sendKittyTransmit);
     setKittyUpdateForwarder(queueKittyUpdate);
     setNotificationForwarder((event) => {
@@ -281,14 +294,43 @@ export function createServerHandlers(state: ShimServerState, options?: ShimServe
     const ptyIds = await subscribeAllPtys();
     await handleLifecycle();
     await handleTitles();
-    await sendSnapshots(ptyIds);
+    await sendSnapshots(ptyIds, client);
+  }
+
+  function setClientPtyFilter(socket: net.Socket, ptyIds: string[] | null): void {
+    const client = state.clients.get(socket);
+    if (!client) return;
+    const previous = client.ptyFilter;
+    client.ptyFilter = ptyIds ? new Set(ptyIds) : null;
+    for (const ptyId of client.staleUpdates) {
+      if (!clientWantsPty(client, ptyId)) {
+        client.staleUpdates.delete(ptyId);
+      }
+    }
+    for (const ptyId of client.pendingUpdates.keys()) {
+      if (!clientWantsPty(client, ptyId)) {
+        client.pendingUpdates.delete(ptyId);
+      }
+    }
+    // Newly visible ptys start from a full snapshot
+    for (const ptyId of state.ptySubscriptions.keys()) {
+      if (clientWantsPty(client, ptyId) && previous !== null && !previous.has(ptyId)) {
+        sendSnapshot(ptyId, client, true).catch(() => {});
+      }
+    }
   }
 
   async function detachClient(socket: net.Socket): Promise<void> {
-    if (state.activeClient !== socket) return;
+    const client = state.clients.get(socket);
+    if (!client) return;
+    client.search?.abort();
+    state.clients.delete(socket);
+    if (state.activeClient === socket) {
+      state.activeClient = null;
+      state.activeClientId = null;
+    }
+    if (state.clients.size > 0) return;
 
-    state.activeClient = null;
-    state.activeClientId = null;
     setKittyTransmitForwarder(null);
     setKittyUpdateForwarder(null);
     setNotificationForwarder(null);
@@ -313,7 +355,10 @@ export function createServerHandlers(state: ShimServerState, options?: ShimServe
     applyHostColors,
     sendResponse,
     sendError,
+    sendProgress,
+    sendScrollbackLines,
     attachClient,
+    setClientPtyFilter,
     registerMapping,
     removeMappingForPty,
   });
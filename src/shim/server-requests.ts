@@ -2,11 +2,11 @@ import type net from 'net';
 
 import { PtyId, Cols, Rows } from '../effect/types';
 import type { TerminalScrollState, TerminalState } from '../core/types';
-import type { ITerminalEmulator } from '../terminal/emulator-interface';
+import type { ITerminalEmulator, SearchMatch } from '../terminal/emulator-interface';
 import { packTerminalState, packRow } from '../terminal/cell-serialization';
 import type { TerminalColors } from '../terminal/terminal-colors';
 import { captureEmulator, type CaptureFormat } from '../control/capture';
-import type { ShimHeader } from './protocol';
+import { SHIM_PROTOCOL_MISMATCH, SHIM_PROTOCOL_VERSION, type ShimHeader } from './protocol';
 import type { ShimServerState } from './server-state';
 import type { WithPty } from './server-handlers';
 
@@ -16,7 +16,10 @@ export function createRequestHandler(params: {
   applyHostColors: (colors: TerminalColors) => Promise<void> | void;
   sendResponse: (socket: net.Socket, requestId: number, result?: unknown, payloads?: ArrayBuffer[]) => void;
   sendError: (socket: net.Socket, requestId: number, error: string) => void;
-  attachClient: (socket: net.Socket, clientId: string) => Promise<void>;
+  sendProgress: (socket: net.Socket, requestId: number, result: unknown) => void;
+  sendScrollbackLines: (socket: net.Socket, requestId: number, lineOffsets: number[], rows: ArrayBuffer[]) => void;
+  attachClient: (socket: net.Socket, clientId: string, shared?: boolean) => Promise<void>;
+  setClientPtyFilter: (socket: net.Socket, ptyIds: string[] | null) => void;
   registerMapping: (sessionId: string, paneId: string, ptyId: string) => void;
   removeMappingForPty: (ptyId: string) => void;
 }) {
@@ -32,7 +35,7 @@ export function createRequestHandler(params: {
     const requestParams = (header.params as Record<string, unknown>) ?? {};
 
     try {
-      if (method !== 'hello' && params.state.activeClient !== socket) {
+      if (method !== 'hello' && !params.state.clients.has(socket)) {
         params.sendError(socket, requestId, 'Inactive client');
         socket.end();
         return;
@@ -42,6 +45,17 @@ export function createRequestHandler(params: {
         case 'hello':
           {
             const clientId = typeof requestParams.clientId === 'string' ? requestParams.clientId : null;
+            const version = requestParams.version;
+            // Clients from before versioning send none; they can't decode binary frames
+            if (version !== SHIM_PROTOCOL_VERSION) {
+              params.sendError(
+                socket,
+                requestId,
+                `${SHIM_PROTOCOL_MISMATCH}: client ${typeof version === 'number' ? version : 'unversioned'}, shim ${SHIM_PROTOCOL_VERSION}`
+              );
+              socket.end();
+              return;
+            }
             if (!clientId) {
               params.sendError(socket, requestId, 'Missing clientId');
               socket.end();
@@ -52,15 +66,24 @@ export function createRequestHandler(params: {
               socket.end();
               return;
             }
-            if (params.state.activeClient === socket && params.state.activeClientId === clientId) {
-              params.sendResponse(socket, requestId, { pid: process.pid, clientId });
+            if (params.state.clients.get(socket)?.clientId === clientId) {
+              params.sendResponse(socket, requestId, { pid: process.pid, clientId, version: SHIM_PROTOCOL_VERSION });
               return;
             }
-            await params.attachClient(socket, clientId);
-            params.sendResponse(socket, requestId, { pid: process.pid, clientId });
+            await params.attachClient(socket, clientId, requestParams.shared === true);
+            params.sendResponse(socket, requestId, { pid: process.pid, clientId, version: SHIM_PROTOCOL_VERSION });
           }
           return;
 
+        case 'setPtyFilter': {
+          const ptyIds = Array.isArray(requestParams.ptyIds)
+            ? (requestParams.ptyIds as unknown[]).map(String)
+            : null;
+          params.setClientPtyFilter(socket, ptyIds);
+          params.sendResponse(socket, requestId);
+          return;
+        }
+
         case 'setHostColors':
           if (requestParams.colors) {
             await params.applyHostColors(requestParams.colors as any);
@@ -162,27 +185,22 @@ export function createRequestHandler(params: {
           const count = requestParams.count as number;
           const emulator = await params.withPty((pty) => pty.getEmulator(PtyId.make(ptyId))) as ITerminalEmulator;
 
+          // Archived rows are read off the event loop first; the loop below
+          // then serves them from the archive cache.
+          await emulator.prefetchScrollbackLines?.(startOffset, count);
+
           const lineOffsets: number[] = [];
-          const payloads: ArrayBuffer[] = [];
+          const rows: ArrayBuffer[] = [];
 
           for (let i = 0; i < count; i++) {
             const offset = startOffset + i;
             const line = emulator.getScrollbackLine(offset);
             if (!line) continue;
             lineOffsets.push(offset);
-            payloads.push(packRow(line));
+            rows.push(packRow(line));
           }
 
-          const combinedLength = payloads.reduce((sum, buf) => sum + buf.byteLength, 0);
-          const combined = new ArrayBuffer(combinedLength);
-          const view = new Uint8Array(combined);
-          let writeOffset = 0;
-          for (const payload of payloads) {
-            view.set(new Uint8Array(payload), writeOffset);
-            writeOffset += payload.byteLength;
-          }
-
-          params.sendResponse(socket, requestId, { lineOffsets }, [combined]);
+          params.sendScrollbackLines(socket, requestId, lineOffsets, rows);
           return;
         }
 
@@ -216,9 +234,41 @@ export function createRequestHandler(params: {
           const ptyId = requestParams.ptyId as string;
           const query = requestParams.query as string;
           const limit = requestParams.limit as number | undefined;
-          const emulator = await params.withPty((pty) => pty.getEmulator(PtyId.make(ptyId))) as ITerminalEmulator;
-          const result = await emulator.search(query, { limit });
-          params.sendResponse(socket, requestId, result);
+          const regex = requestParams.regex === true;
+          const anchor = typeof requestParams.anchor === 'number' ? requestParams.anchor : undefined;
+          const startLine = typeof requestParams.startLine === 'number' ? requestParams.startLine : undefined;
+          const endLine = typeof requestParams.endLine === 'number' ? requestParams.endLine : undefined;
+          // Streamed searches report each batch as a progress frame before the response
+          const onMatches = requestParams.stream === true
+            ? (matches: SearchMatch[]) => params.sendProgress(socket, requestId, { matches })
+            : undefined;
+          const client = params.state.clients.get(socket)!;
+          // One search per client: a new query supersedes the previous one
+          client.search?.abort();
+          const controller = new AbortController();
+          client.search = controller;
+          try {
+            const emulator = await params.withPty((pty) => pty.getEmulator(PtyId.make(ptyId))) as ITerminalEmulator;
+            const result = await emulator.search(query, {
+              limit,
+              regex,
+              anchor,
+              startLine,
+              endLine,
+              signal: controller.signal,
+              onMatches,
+            });
+            params.sendResponse(socket, requestId, result);
+          } finally {
+            if (client.search === controller) client.search = null;
+          }
+          return;
+        }
+
+        case 'cancelSearch': {
+          const client = params.state.clients.get(socket);
+          client?.search?.abort();
+          params.sendResponse(socket, requestId);
           return;
         }
 
@@ -1,5 +1,8 @@
 import type net from 'net';
+import type { Buffer } from 'buffer';
 import type { ITerminalEmulator, KittyGraphicsImageInfo } from '../terminal/emulator-interface';
+import type { PendingPtyUpdate } from './server/coalesce';
+import { KittyShmSegments } from './kitty-shm';
 
 export type KittyScreenKey = 'main' | 'alt';
 export type KittyScreenImages = {
@@ -7,12 +10,45 @@ export type KittyScreenImages = {
   alt: Map<number, KittyGraphicsImageInfo>;
 };
 
+/** An event frame held for a congested client. */
+export type HeldFrame = {
+  frame: Buffer;
+  /** Set for kitty frames, which may be dropped and the pty's kitty state resent instead. */
+  kittyPtyId?: string;
+};
+
+/**
+ * An attached UI client. The primary client (state.activeClient) is
+ * replaced when another client says hello; shared clients attach alongside
+ * it and receive the same events.
+ */
+export type ShimClient = {
+  socket: net.Socket;
+  clientId: string;
+  shared: boolean;
+  /** Pty ids this client receives output (updates, kitty) for; null means all. */
+  ptyFilter: Set<string> | null;
+  /** Set when socket.write() returned false, cleared on 'drain'. */
+  congested: boolean;
+  /** Updates held back while congested, one coalesced update per pty. */
+  pendingUpdates: Map<string, PendingPtyUpdate>;
+  /** Ptys whose held-back updates could not be coalesced; resent as snapshots on drain. */
+  staleUpdates: Set<string>;
+  /** Event frames held back while congested, written in order on drain. */
+  heldFrames: HeldFrame[];
+  heldBytes: number;
+  /** Ptys whose held kitty frames were dropped over the byte cap; resent on drain. */
+  kittyResync: Set<string>;
+  /** The client's in-flight search; a newer search or cancelSearch aborts it. */
+  search: AbortController | null;
+};
+
 type PtySubscriptions = Map<string, { unifiedUnsub: () => void; exitUnsub: () => void }>;
 
 export type ShimServerState = {
   sessionPanes: Map<string, Map<string, string>>;
   ptyToPane: Map<string, { sessionId: string; paneId: string }>;
-  clientIds: Map<net.Socket, string>;
+  clients: Map<net.Socket, ShimClient>;
   revokedClientIds: Set<string>;
   ptySubscriptions: PtySubscriptions;
   ptyEmulators: Map<string, ITerminalEmulator>;
@@ -20,6 +56,8 @@ export type ShimServerState = {
   kittyTransmitCache: Map<string, Map<string, string[]>>;
   kittyTransmitPending: Map<string, Map<string, string[]>>;
   kittyTransmitInvalidated: Map<string, { all: boolean; keys: Set<string> }>;
+  /** Shared-memory segments holding image data for clients to read. */
+  kittyShm: KittyShmSegments;
   lifecycleUnsub: (() => void) | null;
   titleUnsub: (() => void) | null;
   activeClient: net.Socket | null;
@@ -31,7 +69,7 @@ export function createShimServerState(): ShimServerState {
   return {
     sessionPanes: new Map(),
     ptyToPane: new Map(),
-    clientIds: new Map(),
+    clients: new Map(),
     revokedClientIds: new Set(),
     ptySubscriptions: new Map(),
     ptyEmulators: new Map(),
@@ -39,6 +77,7 @@ export function createShimServerState(): ShimServerState {
     kittyTransmitCache: new Map(),
     kittyTransmitPending: new Map(),
     kittyTransmitInvalidated: new Map(),
+    kittyShm: new KittyShmSegments(),
     lifecycleUnsub: null,
     titleUnsub: null,
     activeClient: null,
@@ -50,7 +89,7 @@ export function createShimServerState(): ShimServerState {
 export function resetShimServerState(state: ShimServerState): void {
   state.sessionPanes.clear();
   state.ptyToPane.clear();
-  state.clientIds.clear();
+  state.clients.clear();
   state.revokedClientIds.clear();
   state.ptySubscriptions.clear();
   state.ptyEmulators.clear();
@@ -58,6 +97,7 @@ export function resetShimServerState(state: ShimServerState): void {
   state.kittyTransmitCache.clear();
   state.kittyTransmitPending.clear();
   state.kittyTransmitInvalidated.clear();
+  state.kittyShm.dispose();
   state.lifecycleUnsub = null;
   state.titleUnsub = null;
   state.activeClient = null;
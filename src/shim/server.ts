@@ -38,12 +38,10 @@ export async function startShimServer(options?: ShimServerOptions): Promise<net.
     });
 
     socket.on('close', () => {
-      shimState.clientIds.delete(socket);
       handlers.detachClient(socket).catch(() => {});
     });
 
     socket.on('error', () => {
-      shimState.clientIds.delete(socket);
       handlers.detachClient(socket).catch(() => {});
     });
   });
@@ -0,0 +1,169 @@
+import type net from 'net';
+import type { Buffer } from 'buffer';
+import type { DirtyTerminalUpdate, TerminalScrollState } from '../../core/types';
+import type { HeldFrame, ShimClient, ShimServerState } from '../server-state';
+import { mergePendingPtyUpdate } from './coalesce';
+
+/** Event bytes held for a congested client before its kitty frames are dropped. */
+export const MAX_HELD_FRAME_BYTES = 4 * 1024 * 1024;
+
+export type PtyUpdateEncoder = (
+  ptyId: string,
+  update: DirtyTerminalUpdate,
+  scrollState: TerminalScrollState
+) => Buffer;
+
+export function createShimClient(socket: net.Socket, clientId: string, shared: boolean): ShimClient {
+  return {
+    socket,
+    clientId,
+    shared,
+    ptyFilter: null,
+    congested: false,
+    pendingUpdates: new Map(),
+    staleUpdates: new Set(),
+    heldFrames: [],
+    heldBytes: 0,
+    kittyResync: new Set(),
+    search: null,
+  };
+}
+
+export function clientWantsPty(client: ShimClient, ptyId: string): boolean {
+  return client.ptyFilter === null || client.ptyFilter.has(ptyId);
+}
+
+/**
+ * Write an encoded frame to one client, marking it congested when the
+ * socket buffer is over its high-water mark.
+ */
+export function writeClientFrame(client: ShimClient, frame: Buffer): void {
+  if (client.socket.destroyed) return;
+  if (!client.socket.write(frame)) {
+    client.congested = true;
+  }
+}
+
+/**
+ * Write an event frame to one client, or hold it while the client is
+ * congested (or still has held frames, to keep events in order). Held
+ * frames past MAX_HELD_FRAME_BYTES drop the client's held kitty frames;
+ * those ptys' kitty state is resent on drain, and further kitty frames
+ * for them are skipped until then.
+ */
+export function sendClientFrame(client: ShimClient, frame: Buffer, kittyPtyId?: string): void {
+  if (!client.congested && client.heldFrames.length === 0) {
+    writeClientFrame(client, frame);
+    return;
+  }
+  if (kittyPtyId !== undefined && client.kittyResync.has(kittyPtyId)) return;
+  client.heldFrames.push({ frame, kittyPtyId });
+  client.heldBytes += frame.byteLength;
+  if (client.heldBytes <= MAX_HELD_FRAME_BYTES) return;
+
+  const kept: HeldFrame[] = [];
+  client.heldBytes = 0;
+  for (const held of client.heldFrames) {
+    if (held.kittyPtyId !== undefined) {
+      client.kittyResync.add(held.kittyPtyId);
+      continue;
+    }
+    kept.push(held);
+    client.heldBytes += held.frame.byteLength;
+  }
+  client.heldFrames = kept;
+}
+
+/**
+ * Send an event frame to every attached client (restricted to clients
+ * that want `ptyId` when given). The frame is shared, not re-encoded.
+ * `kitty` marks a kitty frame for `ptyId` that congested clients may drop.
+ */
+export function broadcastFrame(state: ShimServerState, frame: Buffer, ptyId?: string, kitty = false): void {
+  for (const client of state.clients.values()) {
+    if (ptyId !== undefined && !clientWantsPty(client, ptyId)) continue;
+    sendClientFrame(client, frame, kitty ? ptyId : undefined);
+  }
+}
+
+/**
+ * Write held event frames after 'drain', in order. Stops if the socket
+ * congests again; the rest stay held. Once every held frame is out,
+ * returns the ptys whose kitty state must be resent.
+ */
+export function flushHeldFrames(client: ShimClient): string[] {
+  client.congested = false;
+  let written = 0;
+  while (written < client.heldFrames.length && !client.congested) {
+    const { frame } = client.heldFrames[written++];
+    client.heldBytes -= frame.byteLength;
+    writeClientFrame(client, frame);
+  }
+  client.heldFrames.splice(0, written);
+  if (client.heldFrames.length > 0) return [];
+  const resync = Array.from(client.kittyResync);
+  client.kittyResync.clear();
+  return resync;
+}
+
+/**
+ * Hold an update back for a congested client, coalescing it with any
+ * update already held for the pty. Updates that cannot be merged turn
+ * into a snapshot request for when the socket drains.
+ */
+function holdPtyUpdate(
+  client: ShimClient,
+  ptyId: string,
+  update: DirtyTerminalUpdate,
+  scrollState: TerminalScrollState
+): void {
+  if (client.staleUpdates.has(ptyId)) return;
+  const merged = mergePendingPtyUpdate(client.pendingUpdates.get(ptyId), update, scrollState);
+  if (merged) {
+    client.pendingUpdates.set(ptyId, merged);
+  } else {
+    client.pendingUpdates.delete(ptyId);
+    client.staleUpdates.add(ptyId);
+  }
+}
+
+/**
+ * Fan a ptyUpdate out to interested clients. The frame is encoded at most
+ * once, and only if some interested client can take it now. Congested
+ * clients hold a coalesced update per pty instead of queueing frames.
+ */
+export function broadcastPtyUpdate(
+  state: ShimServerState,
+  ptyId: string,
+  update: DirtyTerminalUpdate,
+  scrollState: TerminalScrollState,
+  encode: PtyUpdateEncoder
+): void {
+  let frame: Buffer | null = null;
+  for (const client of state.clients.values()) {
+    if (!clientWantsPty(client, ptyId)) continue;
+    if (client.congested || client.pendingUpdates.has(ptyId)) {
+      holdPtyUpdate(client, ptyId, update, scrollState);
+      continue;
+    }
+    frame ??= encode(ptyId, update, scrollState);
+    writeClientFrame(client, frame);
+  }
+}
+
+/**
+ * Send held-back updates after 'drain', newest coalesced state only.
+ * Stops early if the socket congests again; the rest stay held.
+ * Returns the ptys that need a snapshot instead.
+ */
+export function flushPendingUpdates(client: ShimClient, encode: PtyUpdateEncoder): string[] {
+  client.congested = false;
+  for (const [ptyId, pending] of client.pendingUpdates) {
+    if (client.congested) break;
+    client.pendingUpdates.delete(ptyId);
+    writeClientFrame(client, encode(ptyId, pending.update, pending.scrollState));
+  }
+  const stale = Array.from(client.staleUpdates);
+  client.staleUpdates.clear();
+  return stale;
+}
@@ -0,0 +1,70 @@
+import type { DirtyTerminalUpdate, TerminalScrollState } from '../../core/types';
+
+/** A ptyUpdate held back for a congested client. */
+export type PendingPtyUpdate = {
+  update: DirtyTerminalUpdate;
+  scrollState: TerminalScrollState;
+};
+
+/**
+ * Merge the next update for a pty into the one held back for a congested
+ * client. Dirty rows are unioned with the newest row data winning; cursor,
+ * modes and scroll state come from the newest update. A full update
+ * replaces whatever was pending, and dirty rows on top of a pending full
+ * update are folded into its state.
+ *
+ * Returns null when the updates cannot be merged (dimensions changed
+ * without a full update); the caller then falls back to a snapshot.
+ */
+export function mergePendingPtyUpdate(
+  pending: PendingPtyUpdate | undefined,
+  update: DirtyTerminalUpdate,
+  scrollState: TerminalScrollState
+): PendingPtyUpdate | null {
+  if (!pending || update.isFull) {
+    return {
+      update: update.isFull ? update : { ...update, dirtyRows: new Map(update.dirtyRows) },
+      scrollState,
+    };
+  }
+
+  const previous = pending.update;
+  if (previous.cols !== update.cols || previous.rows !== update.rows) {
+    return null;
+  }
+
+  if (previous.isFull && previous.fullState) {
+    const cells = previous.fullState.cells.slice();
+    for (const [rowIndex, row] of update.dirtyRows) {
+      cells[rowIndex] = row;
+    }
+    return {
+      update: {
+        ...update,
+        dirtyRows: new Map(),
+        isFull: true,
+        fullState: {
+          ...previous.fullState,
+          cells,
+          rowVersions: undefined,
+          cursor: update.cursor,
+          alternateScreen: update.alternateScreen,
+          mouseTracking: update.mouseTracking,
+          cursorKeyMode: update.cursorKeyMode,
+          kittyKeyboardFlags: update.kittyKeyboardFlags,
+        },
+      },
+      scrollState,
+    };
+  }
+
+  // The pending update owns its dirty row map (copied on first hold)
+  const dirtyRows = previous.dirtyRows;
+  for (const [rowIndex, row] of update.dirtyRows) {
+    dirtyRows.set(rowIndex, row);
+  }
+  return {
+    update: { ...update, dirtyRows },
+    scrollState,
+  };
+}
@@ -1,9 +1,14 @@
 import type net from 'net';
-import { encodeFrame, type ShimHeader } from '../protocol';
+import type { Buffer } from 'buffer';
+import { encodeAckFrame, encodeFrame, encodeScrollbackLinesFrame, type ShimHeader } from '../protocol';
 
-export function sendFrame(socket: net.Socket, header: ShimHeader, payloads: ArrayBuffer[] = []): void {
+export function sendEncodedFrame(socket: net.Socket, frame: Buffer): void {
   if (socket.destroyed) return;
-  socket.write(encodeFrame(header, payloads));
+  socket.write(frame);
+}
+
+export function sendFrame(socket: net.Socket, header: ShimHeader, payloads: ArrayBuffer[] = []): void {
+  sendEncodedFrame(socket, encodeFrame(header, payloads));
 }
 
 export function sendResponse(
@@ -12,6 +17,10 @@ export function sendResponse(
   result?: unknown,
   payloads: ArrayBuffer[] = []
 ): void {
+  if (result === undefined && payloads.length === 0) {
+    sendEncodedFrame(socket, encodeAckFrame(requestId));
+    return;
+  }
   sendFrame(socket, {
     type: 'response',
     requestId,
@@ -21,6 +30,24 @@ export function sendResponse(
   }, payloads);
 }
 
+/** Partial result for a request that is still running. */
+export function sendProgress(socket: net.Socket, requestId: number, result: unknown): void {
+  sendFrame(socket, {
+    type: 'progress',
+    requestId,
+    result,
+  });
+}
+
+export function sendScrollbackLines(
+  socket: net.Socket,
+  requestId: number,
+  lineOffsets: number[],
+  rows: ArrayBuffer[]
+): void {
+  sendEncodedFrame(socket, encodeScrollbackLinesFrame(requestId, lineOffsets, rows));
+}
+
 export function sendError(socket: net.Socket, requestId: number, error: string): void {
   sendFrame(socket, {
     type: 'response',
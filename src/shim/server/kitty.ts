@@ -7,17 +7,18 @@ import {
   parseTransmitParams,
 } from '../../terminal/kitty-graphics/sequence-utils';
 import { tracePtyEvent } from '../../terminal/pty-trace';
+import { KITTY_SHM_THRESHOLD_BYTES, type KittyShmRef } from '../kitty-shm';
 import type { ShimHeader } from '../protocol';
-import type { KittyScreenImages, KittyScreenKey, ShimServerState } from '../server-state';
+import type { KittyScreenImages, KittyScreenKey, ShimClient, ShimServerState } from '../server-state';
 
 export type KittyHandlers = {
-  sendKittyTransmit: (ptyId: string, sequence: string) => void;
-  sendKittyUpdate: (ptyId: string, emulator: ITerminalEmulator, force?: boolean) => void;
+  sendKittyTransmit: (ptyId: string, sequence: string, target?: ShimClient) => void;
+  sendKittyUpdate: (ptyId: string, emulator: ITerminalEmulator, force?: boolean, target?: ShimClient) => void;
   queueKittyUpdate: (ptyId: string) => void;
   hasCachedTransmit: (ptyId: string, info: KittyGraphicsImageInfo) => boolean;
 };
 
-type SendEvent = (header: ShimHeader, payloads?: ArrayBuffer[]) => void;
+type SendEvent = (header: ShimHeader, payloads?: ArrayBuffer[], target?: ShimClient) => void;
 
 type KittyWireImage = ReturnType<typeof serializeKittyImage>;
 
@@ -170,23 +171,35 @@ export function createKittyHandlers(state: ShimServerState, sendEvent: SendEvent
     return screens[screen];
   };
 
-  const sendKittyTransmit = (ptyId: string, sequence: string): void => {
-    if (!state.activeClient) return;
-    recordKittyTransmit(ptyId, sequence);
+  /**
+   * Forward a transmit to all clients and record it for replay. With a
+   * target, replay an already recorded transmit to that client only.
+   */
+  const sendKittyTransmit = (ptyId: string, sequence: string, target?: ShimClient): void => {
+    if (state.clients.size === 0) return;
+    if (!target) {
+      recordKittyTransmit(ptyId, sequence);
+    }
     const payload = Buffer.from(sequence, 'utf8');
     sendEvent({
       type: 'ptyKittyTransmit',
       ptyId,
       payloadLengths: [payload.byteLength],
-    }, [toArrayBuffer(payload)]);
+    }, [toArrayBuffer(payload)], target);
   };
 
+  /**
+   * Send the pty's kitty state to all clients as a diff against what they
+   * were last sent. With a target, send the full state to that client only,
+   * leaving the shared diff, shm segments and dirty state untouched.
+   */
   const sendKittyUpdate = (
     ptyId: string,
     emulator: ITerminalEmulator,
-    force: boolean = false
+    force: boolean = false,
+    target?: ShimClient
   ): void => {
-    if (!state.activeClient) return;
+    if (state.clients.size === 0) return;
     if (!emulator.getKittyImageIds || !emulator.getKittyPlacements) return;
 
     const dirty = emulator.getKittyImagesDirty?.() ?? false;
@@ -194,11 +207,14 @@ export function createKittyHandlers(state: ShimServerState, sendEvent: SendEvent
 
     const alternateScreen = emulator.isAlternateScreen?.() ?? false;
     const screenKey: KittyScreenKey = alternateScreen ? 'alt' : 'main';
-    const previous = getKittyImagesForScreen(ptyId, screenKey);
+    const previous = target
+      ? new Map<number, KittyGraphicsImageInfo>()
+      : getKittyImagesForScreen(ptyId, screenKey);
     const nextImages = new Map<number, KittyGraphicsImageInfo>();
     const images: KittyWireImage[] = [];
     const imageDataIds: number[] = [];
     const payloads: ArrayBuffer[] = [];
+    const sharedImages: KittyShmRef[] = [];
 
     const invalidation = state.kittyTransmitInvalidated.get(ptyId) ?? null;
     let usedInvalidationKeys: Set<string> | null = invalidation?.keys ? new Set<string>() : null;
@@ -220,8 +236,19 @@ export function createKittyHandlers(state: ShimServerState, sendEvent: SendEvent
       if (shouldIncludeData) {
         const data = emulator.getKittyImageData?.(id);
         if (data) {
-          imageDataIds.push(id);
-          payloads.push(toArrayBuffer(data));
+          // Large images go through shared memory; only the path is framed.
+          // Targeted sends reuse published segments and inline the rest.
+          const shmPath = data.byteLength < KITTY_SHM_THRESHOLD_BYTES
+            ? null
+            : target
+              ? state.kittyShm.lookup(ptyId, screenKey, info)
+              : state.kittyShm.publish(ptyId, screenKey, info, data);
+          if (shmPath) {
+            sharedImages.push({ id, path: shmPath, byteLength: data.byteLength });
+          } else {
+            imageDataIds.push(id);
+            payloads.push(toArrayBuffer(data));
+          }
           if (shouldForceData) {
             sentInvalidated = true;
             if (guestKey && usedInvalidationKeys) {
@@ -238,12 +265,15 @@ export function createKittyHandlers(state: ShimServerState, sendEvent: SendEvent
     for (const [id] of previous) {
       if (!nextImages.has(id)) {
         removedImageIds.push(id);
+        state.kittyShm.release(ptyId, screenKey, id);
       }
     }
 
-    const screens: KittyScreenImages = state.kittyImages.get(ptyId) ?? { main: new Map(), alt: new Map() };
-    screens[screenKey] = nextImages;
-    state.kittyImages.set(ptyId, screens);
+    if (!target) {
+      const screens: KittyScreenImages = state.kittyImages.get(ptyId) ?? { main: new Map(), alt: new Map() };
+      screens[screenKey] = nextImages;
+      state.kittyImages.set(ptyId, screens);
+    }
 
     const placements = emulator.getKittyPlacements?.() ?? [];
     const header: ShimHeader = {
@@ -256,6 +286,7 @@ export function createKittyHandlers(state: ShimServerState, sendEvent: SendEvent
         ),
         removedImageIds,
         imageDataIds,
+        sharedImages,
         alternateScreen,
       },
       payloadLengths: payloads.map((payload) => payload.byteLength),
@@ -268,12 +299,16 @@ export function createKittyHandlers(state: ShimServerState, sendEvent: SendEvent
       removedImageCount: removedImageIds.length,
       dirty,
       force,
+      targeted: Boolean(target),
       alternateScreen,
       imageDataCount: imageDataIds.length,
       imageDataBytes: payloads.reduce((sum, payload) => sum + payload.byteLength, 0),
+      sharedImageCount: sharedImages.length,
+      sharedImageBytes: sharedImages.reduce((sum, image) => sum + image.byteLength, 0),
     });
 
-    sendEvent(header, payloads);
+    sendEvent(header, payloads, target);
+    if (target) return;
     emulator.clearKittyImagesDirty?.();
 
     if (invalidation) {
@@ -309,7 +344,7 @@ export function createKittyHandlers(state: ShimServerState, sendEvent: SendEvent
   };
 
   const queueKittyUpdate = (ptyId: string) => {
-    if (!state.activeClient) return;
+    if (state.clients.size === 0) return;
     pendingKittyUpdates.add(ptyId);
     if (!kittyUpdateScheduled) {
       kittyUpdateScheduled = true;
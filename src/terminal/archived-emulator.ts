@@ -9,22 +9,35 @@ import type {
   DirtyTerminalUpdate,
 } from "../core/types"
 import type {
+  EmulatorWriteHints,
   ITerminalEmulator,
+  LineNumbering,
+  SearchMatch,
+  SearchOptions,
+  SearchPattern,
   SearchResult,
   TerminalModes,
   KittyGraphicsImageInfo,
   KittyGraphicsPlacement,
 } from "./emulator-interface"
 import type { TerminalColors } from "./terminal-colors"
-import { searchTerminal } from "./ghostty-vt/terminal-search"
-import { createEmptyRow } from "./ghostty-emulator/cell-converter"
+import {
+  compileSearchRegex,
+  regexMatches,
+  searchLines,
+  searchWrappedLinesRegex,
+} from "./ghostty-vt/terminal-search"
+import { extractLineText } from "./ghostty-vt/utils"
+import { runNumberedSearch, runSearchJob, type SearchRange } from "./search-job"
 import type { ScrollbackArchive } from "./scrollback-archive"
 
 export class ArchivedTerminalEmulator implements ITerminalEmulator {
   constructor(
     private base: ITerminalEmulator,
     private archive: ScrollbackArchive
-  ) {}
+  ) {
+    this.archive.setWidth(base.cols)
+  }
 
   get cols(): number {
     return this.base.cols
@@ -38,12 +51,14 @@ export class ArchivedTerminalEmulator implements ITerminalEmulator {
     return this.base.isDisposed
   }
 
-  write(data: string | Uint8Array): void {
-    this.base.write(data)
+  write(data: string | Uint8Array, hints?: EmulatorWriteHints): void {
+    this.base.write(data, hints)
   }
 
   resize(cols: number, rows: number): void {
     this.base.resize(cols, rows)
+    // Archived lines reflow as they are read, like the live scrollback
+    this.archive.setWidth(cols)
   }
 
   setPixelSize(widthPx: number, heightPx: number): void {
@@ -63,6 +78,16 @@ export class ArchivedTerminalEmulator implements ITerminalEmulator {
     return this.archive.length + this.base.getScrollbackLength()
   }
 
+  /**
+   * Lines trimmed from the live scrollback move into the archive without
+   * changing index, so only chunks dropped from the archive count as drops.
+   */
+  getLineNumbering(): LineNumbering {
+    const base = this.base.getLineNumbering?.()
+    const archive = this.archive.numbering
+    return { epoch: (base?.epoch ?? 0) + archive.epoch, dropped: archive.dropped }
+  }
+
   getScrollbackLine(offset: number): TerminalCell[] | null {
     const archiveLength = this.archive.length
     if (offset < archiveLength) {
@@ -75,7 +100,7 @@ export class ArchivedTerminalEmulator implements ITerminalEmulator {
     const archiveLength = this.archive.length
     if (startOffset < archiveLength) {
       const archiveCount = Math.min(count, archiveLength - startOffset)
-      this.archive.prefetchLines(startOffset, archiveCount)
+      return this.archive.prefetchLines(startOffset, archiveCount)
     }
     return Promise.resolve()
   }
@@ -168,12 +193,92 @@ export class ArchivedTerminalEmulator implements ITerminalEmulator {
     return this.base.drainResponses?.() ?? []
   }
 
-  async search(query: string, options?: { limit?: number }): Promise<SearchResult> {
-    return searchTerminal(query, options, {
-      getScrollbackLength: () => this.getScrollbackLength(),
-      getScrollbackLine: (offset) => this.getScrollbackLine(offset),
-      getTerminalState: () => this.getTerminalState(),
-      createEmptyRow: (cols) => createEmptyRow(cols, this.getColors()),
-    })
+  async search(query: string, options?: SearchOptions): Promise<SearchResult> {
+    if (!query) return { matches: [], hasMore: false }
+    // Archived lines are matched with the live emulator's native engine,
+    // falling back to a JS RegExp without one
+    const pattern = options?.regex ? this.base.compileSearchPattern?.(query) ?? null : null
+    const fallback = options?.regex ? compileSearchRegex(query) : null
+    if (options?.regex && !pattern && !fallback) return { matches: [], hasMore: false }
+    const matchText = (text: string) =>
+      pattern?.searchText(text) ?? (fallback ? regexMatches(fallback, text) : [])
+
+    // Archived lines are searched here; the live emulator searches its own
+    // scrollback and screen (natively when it can), shifted past the archive.
+    // Each step re-reads the archive length since lines move into it as
+    // output arrives; their absolute indexes don't change when they do.
+    const length = this.getScrollbackLength() + this.base.rows
+    const searchRange: SearchRange = async (start, end, limit) => {
+      const archiveLength = this.archive.length
+      let matches: SearchMatch[] = []
+      if (start < archiveLength) {
+        const archived = await this.searchArchive(
+          query,
+          options?.regex ? matchText : null,
+          start,
+          Math.min(end, archiveLength),
+          limit
+        )
+        if (archived.hasMore || end <= archiveLength) return archived
+        matches = archived.matches
+      }
+
+      const live = await this.base.search(query, {
+        regex: options?.regex,
+        limit: limit - matches.length,
+        startLine: Math.max(start, archiveLength) - archiveLength,
+        endLine: end - archiveLength,
+      })
+      for (const match of live.matches) {
+        matches.push({ ...match, lineIndex: match.lineIndex + archiveLength })
+      }
+      return { matches, hasMore: live.hasMore }
+    }
+    try {
+      return await runNumberedSearch(() => this.getLineNumbering(), () => runSearchJob(options, length, searchRange))
+    } finally {
+      pattern?.free()
+    }
+  }
+
+  compileSearchPattern(pattern: string): SearchPattern | null {
+    return this.base.compileSearchPattern?.(pattern) ?? null
+  }
+
+  /**
+   * Each range is loaded off the event loop before it is scanned. Patterns
+   * run over logical lines joined from the archive's wrap flags.
+   */
+  private async searchArchive(
+    query: string,
+    matchText: ((text: string) => Array<[number, number]>) | null,
+    start: number,
+    end: number,
+    limit: number
+  ): Promise<SearchResult> {
+    if (!matchText) {
+      const getText = (offset: number) => {
+        const cells = this.archive.getLine(offset)
+        return cells ? extractLineText(cells) : null
+      }
+      // Only read chunks whose trigram filters allow a match
+      const matches: SearchMatch[] = []
+      for (const [from, to] of this.archive.candidateRanges(query, start, end)) {
+        await this.archive.loadLines(from, to - from)
+        const result = searchLines(query, limit - matches.length, from, to, getText)
+        for (const match of result.matches) matches.push(match)
+        if (result.hasMore) return { matches, hasMore: true }
+      }
+      return { matches, hasMore: false }
+    }
+    await this.archive.loadLines(start, end - start)
+    return searchWrappedLinesRegex(
+      matchText,
+      limit,
+      start,
+      end,
+      (offset) => this.archive.getLine(offset),
+      (offset) => this.archive.isWrapped(offset)
+    )
   }
 }
@@ -0,0 +1,143 @@
+/**
+ * Byte-level helpers for the PTY output pipeline.
+ *
+ * PTY output stays as UTF-8 bytes from the ring buffer to ghostty, so the
+ * filter stages scan Uint8Array views instead of decoded strings. Escape
+ * sequence introducers are 7-bit ASCII; C1 controls (U+0080..U+009F) arrive
+ * as the two-byte UTF-8 form 0xC2 0x80..0x9F.
+ */
+
+const encoder = new TextEncoder();
+const decoder = new TextDecoder();
+
+export const EMPTY_BYTES = new Uint8Array(0);
+
+export const BYTE_ESC = 0x1b;
+export const BYTE_BEL = 0x07;
+/** UTF-8 lead byte for U+0080..U+00BF (includes all C1 controls) */
+export const BYTE_C1_LEAD = 0xc2;
+
+/** Encode a string (typically an escape sequence constant) to UTF-8 bytes. */
+export function encodeUtf8(text: string): Uint8Array {
+  return encoder.encode(text);
+}
+
+/** Decode a complete UTF-8 byte chunk to a string. */
+export function decodeUtf8(bytes: Uint8Array): string {
+  return bytes.length === 0 ? "" : decoder.decode(bytes);
+}
+
+/** Normalize pipeline input to bytes. */
+export function toBytes(data: string | Uint8Array): Uint8Array {
+  return typeof data === "string" ? encoder.encode(data) : data;
+}
+
+/**
+ * Find `needle` in `haystack` starting at `from`.
+ * Uses the native single-byte indexOf to skip to candidate positions.
+ */
+export function indexOfBytes(haystack: Uint8Array, needle: Uint8Array, from = 0): number {
+  const needleLen = needle.length;
+  if (needleLen === 0) return from <= haystack.length ? from : -1;
+  const first = needle[0];
+  const last = haystack.length - needleLen;
+  let i = haystack.indexOf(first, from);
+  while (i !== -1 && i <= last) {
+    let j = 1;
+    while (j < needleLen && haystack[i + j] === needle[j]) j++;
+    if (j === needleLen) return i;
+    i = haystack.indexOf(first, i + 1);
+  }
+  return -1;
+}
+
+export function lastIndexOfBytes(haystack: Uint8Array, needle: Uint8Array): number {
+  const needleLen = needle.length;
+  if (needleLen === 0) return haystack.length;
+  const first = needle[0];
+  let i = haystack.lastIndexOf(first, haystack.length - needleLen);
+  while (i !== -1) {
+    let j = 1;
+    while (j < needleLen && haystack[i + j] === needle[j]) j++;
+    if (j === needleLen) return i;
+    if (i === 0) return -1;
+    i = haystack.lastIndexOf(first, i - 1);
+  }
+  return -1;
+}
+
+export function includesBytes(haystack: Uint8Array, needle: Uint8Array): boolean {
+  return indexOfBytes(haystack, needle) !== -1;
+}
+
+/** Concatenate chunks into one buffer (returns the chunk itself when there is only one). */
+export function concatBytes(chunks: readonly Uint8Array[], totalLength?: number): Uint8Array {
+  if (chunks.length === 0) return EMPTY_BYTES;
+  if (chunks.length === 1) return chunks[0];
+  let length = totalLength ?? 0;
+  if (totalLength === undefined) {
+    for (const chunk of chunks) length += chunk.length;
+  }
+  const out = new Uint8Array(length);
+  let offset = 0;
+  for (const chunk of chunks) {
+    out.set(chunk, offset);
+    offset += chunk.length;
+  }
+  return out;
+}
+
+/**
+ * Return (a copy of) the last `limit` bytes of `prev + data`.
+ * Used for the small probe tails that catch sequences split across chunks.
+ */
+export function retainTail(prev: Uint8Array, data: Uint8Array, limit: number): Uint8Array {
+  if (data.length >= limit) {
+    return data.slice(data.length - limit);
+  }
+  const keepPrev = Math.min(prev.length, limit - data.length);
+  const out = new Uint8Array(keepPrev + data.length);
+  out.set(prev.subarray(prev.length - keepPrev), 0);
+  out.set(data, keepPrev);
+  return out;
+}
+
+/**
+ * Bytes spanning the boundary between a retained tail and new data:
+ * `tail + data[0 .. headLength)`. Scanning this plus `data` covers every
+ * match in `tail + data` without copying the whole chunk.
+ */
+export function boundaryBytes(tail: Uint8Array, data: Uint8Array, headLength: number): Uint8Array {
+  if (tail.length === 0) return EMPTY_BYTES;
+  const head = data.subarray(0, Math.min(headLength, data.length));
+  const out = new Uint8Array(tail.length + head.length);
+  out.set(tail, 0);
+  out.set(head, tail.length);
+  return out;
+}
+
+/**
+ * Length of the longest prefix of `bytes` that ends on a UTF-8 character
+ * boundary. Trailing bytes of an incomplete multi-byte character are excluded
+ * so each emitted chunk decodes independently.
+ */
+export function utf8CompleteLength(bytes: Uint8Array, length = bytes.length): number {
+  // Walk back over at most 3 continuation bytes to find the last lead byte.
+  let i = length - 1;
+  const stop = Math.max(0, length - 4);
+  while (i >= stop && (bytes[i] & 0xc0) === 0x80) i--;
+  if (i < stop) return length;
+
+  const lead = bytes[i];
+  let needed: number;
+  if (lead < 0xc0 || lead >= 0xf8) return length; // ASCII or invalid lead
+  else if (lead >= 0xf0) needed = 4;
+  else if (lead >= 0xe0) needed = 3;
+  else needed = 2;
+
+  return length - i >= needed ? length : i;
+}
+
+export function isC1Control(bytes: Uint8Array, index: number, code: number): boolean {
+  return bytes[index] === BYTE_C1_LEAD && bytes[index + 1] === code;
+}
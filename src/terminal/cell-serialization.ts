@@ -20,31 +20,35 @@
  *                bit 4: inverse
  *                bit 5: blink
  *                bit 6: dim
+ *                (RowFlags, the same bits packed TerminalRows use)
  * - byte 12:     width (1 or 2)
  * - bytes 13-14: hyperlinkId (u16, little-endian, 0 = none)
  * - byte 15:     padding (reserved)
+ *
+ * Full states and dirty rows sent to shim clients use a compact,
+ * style-interned cell block instead (see packCompactCells below), and the
+ * scrollback archive stores variable-length row records (packArchiveRow).
  */
 
 import type {
   TerminalCell,
   TerminalCursor,
+  TerminalRow,
   TerminalState,
   TerminalScrollState,
   DirtyTerminalUpdate,
 } from '../core/types';
 import type { SerializedDirtyUpdate } from './emulator-interface';
+import { RowFlags, cellRowFlags, createBlankRow, createTerminalRow, rowFromCells } from './terminal-row';
 
 // Constants
 export const CELL_SIZE = 16; // bytes per cell
-
-// Flag bit positions
-const FLAG_BOLD = 1 << 0;
-const FLAG_ITALIC = 1 << 1;
-const FLAG_UNDERLINE = 1 << 2;
-const FLAG_STRIKETHROUGH = 1 << 3;
-const FLAG_INVERSE = 1 << 4;
-const FLAG_BLINK = 1 << 5;
-const FLAG_DIM = 1 << 6;
+export const COMPACT_CELL_SIZE = 8;
+const COMPACT_STYLE_SIZE = 10;
+const COMPACT_HEADER_SIZE = 8;
+const CELL_FORMAT_LEGACY = 0;
+const CELL_FORMAT_COMPACT = 1;
+const MAX_COMPACT_STYLES = 0x10000;
 
 // ============================================================================
 // Cell Packing/Unpacking
@@ -69,15 +73,7 @@ function packCellAt(view: DataView, offset: number, cell: TerminalCell): void {
   view.setUint8(offset + 9, cell.bg.b);
 
   // Flags
-  let flags = 0;
-  if (cell.bold) flags |= FLAG_BOLD;
-  if (cell.italic) flags |= FLAG_ITALIC;
-  if (cell.underline) flags |= FLAG_UNDERLINE;
-  if (cell.strikethrough) flags |= FLAG_STRIKETHROUGH;
-  if (cell.inverse) flags |= FLAG_INVERSE;
-  if (cell.blink) flags |= FLAG_BLINK;
-  if (cell.dim) flags |= FLAG_DIM;
-  view.setUint16(offset + 10, flags, true);
+  view.setUint16(offset + 10, cellRowFlags(cell), true);
 
   // Width
   view.setUint8(offset + 12, cell.width);
@@ -113,13 +109,13 @@ function unpackCellAt(view: DataView, offset: number): TerminalCell {
 
   // Flags
   const flags = view.getUint16(offset + 10, true);
-  const bold = (flags & FLAG_BOLD) !== 0;
-  const italic = (flags & FLAG_ITALIC) !== 0;
-  const underline = (flags & FLAG_UNDERLINE) !== 0;
-  const strikethrough = (flags & FLAG_STRIKETHROUGH) !== 0;
-  const inverse = (flags & FLAG_INVERSE) !== 0;
-  const blink = (flags & FLAG_BLINK) !== 0;
-  const dim = (flags & FLAG_DIM) !== 0;
+  const bold = (flags & RowFlags.BOLD) !== 0;
+  const italic = (flags & RowFlags.ITALIC) !== 0;
+  const underline = (flags & RowFlags.UNDERLINE) !== 0;
+  const strikethrough = (flags & RowFlags.STRIKETHROUGH) !== 0;
+  const inverse = (flags & RowFlags.INVERSE) !== 0;
+  const blink = (flags & RowFlags.BLINK) !== 0;
+  const dim = (flags & RowFlags.DIM) !== 0;
 
   // Width
   const width = view.getUint8(offset + 12) as 1 | 2;
@@ -190,10 +186,10 @@ export function packRow(cells: TerminalCell[]): ArrayBuffer {
 }
 
 /**
- * Unpack a row from an ArrayBuffer
+ * Unpack a row from an ArrayBuffer, starting at byteOffset
  */
-export function unpackRow(buffer: ArrayBuffer): TerminalCell[] {
-  const view = new DataView(buffer);
+export function unpackRow(buffer: ArrayBuffer, byteOffset: number = 0): TerminalCell[] {
+  const view = new DataView(buffer, byteOffset);
   const count = view.getUint32(0, true);
   const cells: TerminalCell[] = new Array(count);
 
@@ -204,6 +200,518 @@ export function unpackRow(buffer: ArrayBuffer): TerminalCell[] {
   return cells;
 }
 
+// ============================================================================
+// Compact (style-interned) Cell Blocks
+// ============================================================================
+
+/**
+ * Compact cell block format:
+ * - byte 0:      format (1 = compact, 0 = legacy 16-byte cells follow the header)
+ * - bytes 1-3:   reserved
+ * - bytes 4-7:   style count (u32)
+ * - styles:      COMPACT_STYLE_SIZE bytes each
+ *                bytes 0-2: fg rgb, bytes 3-5: bg rgb,
+ *                byte 6: flags (same bits as above), byte 7: reserved,
+ *                bytes 8-9: hyperlinkId (u16)
+ * - cells:       COMPACT_CELL_SIZE bytes each
+ *                bytes 0-3: codepoint (u32), bytes 4-5: style index (u16),
+ *                byte 6: width, byte 7: reserved
+ *
+ * Cells that share colors, flags and hyperlink reference one style entry,
+ * which is typically a 2x reduction over the 16-byte cell format. Blocks
+ * with more than 65536 styles fall back to the legacy cell layout.
+ */
+
+/**
+ * Assigns style indices to packed cells. Consecutive cells usually share a
+ * style, so the last key is checked before the index.
+ */
+export class StyleInterner {
+  readonly fg: number[] = [];
+  readonly bg: number[] = [];
+  readonly attrs: number[] = [];
+  private index = new Map<number, Map<number, number>>();
+  private lastColors = -1;
+  private lastAttrs = -1;
+  private lastStyle = 0;
+
+  intern(fg: number, bg: number, attrs: number): number {
+    const colorKey = fg * 0x1000000 + bg;
+    if (colorKey === this.lastColors && attrs === this.lastAttrs) {
+      return this.lastStyle;
+    }
+
+    let byAttrs = this.index.get(colorKey);
+    if (!byAttrs) {
+      byAttrs = new Map();
+      this.index.set(colorKey, byAttrs);
+    }
+    let style = byAttrs.get(attrs);
+    if (style === undefined) {
+      style = this.fg.length;
+      this.fg.push(fg);
+      this.bg.push(bg);
+      this.attrs.push(attrs);
+      byAttrs.set(attrs, style);
+    }
+
+    this.lastColors = colorKey;
+    this.lastAttrs = attrs;
+    this.lastStyle = style;
+    return style;
+  }
+}
+
+/**
+ * Pack rows into a compact cell block. Each row contributes exactly `cols`
+ * cells; missing rows or cells are packed as blank cells.
+ */
+export function packCompactCells(
+  rows: ReadonlyArray<TerminalRow | undefined>,
+  cols: number
+): ArrayBuffer {
+  const cellCount = rows.length * cols;
+  const interner = new StyleInterner();
+  const styleIds = new Uint32Array(cellCount);
+
+  let i = 0;
+  for (const row of rows) {
+    const width = row ? Math.min(row.codepoints.length, cols) : 0;
+    for (let x = 0; x < cols; x++) {
+      styleIds[i++] = x < width
+        ? interner.intern(row!.fg[x], row!.bg[x], row!.flags[x] * 0x10000 + row!.hyperlinks[x])
+        : interner.intern(0, 0, 0);
+    }
+  }
+
+  const styleCount = interner.fg.length;
+  if (styleCount > MAX_COMPACT_STYLES) {
+    return packLegacyCells(rows, cols);
+  }
+
+  const buffer = new ArrayBuffer(
+    COMPACT_HEADER_SIZE + styleCount * COMPACT_STYLE_SIZE + cellCount * COMPACT_CELL_SIZE
+  );
+  const view = new DataView(buffer);
+  view.setUint8(0, CELL_FORMAT_COMPACT);
+  view.setUint32(4, styleCount, true);
+
+  let offset = COMPACT_HEADER_SIZE;
+  for (let style = 0; style < styleCount; style++) {
+    const fg = interner.fg[style];
+    const bg = interner.bg[style];
+    const attrs = interner.attrs[style];
+    view.setUint8(offset, (fg >> 16) & 0xff);
+    view.setUint8(offset + 1, (fg >> 8) & 0xff);
+    view.setUint8(offset + 2, fg & 0xff);
+    view.setUint8(offset + 3, (bg >> 16) & 0xff);
+    view.setUint8(offset + 4, (bg >> 8) & 0xff);
+    view.setUint8(offset + 5, bg & 0xff);
+    view.setUint8(offset + 6, Math.floor(attrs / 0x10000));
+    view.setUint16(offset + 8, attrs & 0xffff, true);
+    offset += COMPACT_STYLE_SIZE;
+  }
+
+  i = 0;
+  for (const row of rows) {
+    const width = row ? Math.min(row.codepoints.length, cols) : 0;
+    for (let x = 0; x < cols; x++) {
+      view.setUint32(offset, x < width ? row!.codepoints[x] : 0x20, true);
+      view.setUint16(offset + 4, styleIds[i++], true);
+      view.setUint8(offset + 6, x < width ? row!.widths[x] : 1);
+      offset += COMPACT_CELL_SIZE;
+    }
+  }
+
+  return buffer;
+}
+
+function packLegacyCells(rows: ReadonlyArray<TerminalRow | undefined>, cols: number): ArrayBuffer {
+  const buffer = new ArrayBuffer(COMPACT_HEADER_SIZE + rows.length * cols * CELL_SIZE);
+  const view = new DataView(buffer);
+  view.setUint8(0, CELL_FORMAT_LEGACY);
+
+  let offset = COMPACT_HEADER_SIZE;
+  for (const row of rows) {
+    const width = row ? Math.min(row.codepoints.length, cols) : 0;
+    for (let x = 0; x < cols; x++) {
+      if (x < width) {
+        const fg = row!.fg[x];
+        const bg = row!.bg[x];
+        view.setUint32(offset, row!.codepoints[x], true);
+        view.setUint8(offset + 4, (fg >> 16) & 0xff);
+        view.setUint8(offset + 5, (fg >> 8) & 0xff);
+        view.setUint8(offset + 6, fg & 0xff);
+        view.setUint8(offset + 7, (bg >> 16) & 0xff);
+        view.setUint8(offset + 8, (bg >> 8) & 0xff);
+        view.setUint8(offset + 9, bg & 0xff);
+        view.setUint16(offset + 10, row!.flags[x], true);
+        view.setUint8(offset + 12, row!.widths[x]);
+        view.setUint16(offset + 13, row!.hyperlinks[x], true);
+      }
+      offset += CELL_SIZE;
+    }
+  }
+  return buffer;
+}
+
+/**
+ * Unpack a compact cell block into `rowCount` packed rows of `cols` cells.
+ */
+export function unpackCompactCells(
+  buffer: ArrayBuffer,
+  byteOffset: number,
+  rowCount: number,
+  cols: number
+): TerminalRow[] {
+  const view = new DataView(buffer, byteOffset);
+  const rows: TerminalRow[] = new Array(rowCount);
+
+  if (view.byteLength === 0 || view.getUint8(0) === CELL_FORMAT_LEGACY) {
+    let offset = COMPACT_HEADER_SIZE;
+    for (let y = 0; y < rowCount; y++) {
+      const row = createBlankRow(cols, 0, 0);
+      for (let x = 0; x < cols; x++) {
+        if (offset + CELL_SIZE <= view.byteLength) {
+          const codepoint = view.getUint32(offset, true);
+          row.codepoints[x] = codepoint > 0 ? codepoint : 0x20;
+          row.fg[x] = (view.getUint8(offset + 4) << 16) | (view.getUint8(offset + 5) << 8) | view.getUint8(offset + 6);
+          row.bg[x] = (view.getUint8(offset + 7) << 16) | (view.getUint8(offset + 8) << 8) | view.getUint8(offset + 9);
+          row.flags[x] = view.getUint16(offset + 10, true);
+          row.widths[x] = view.getUint8(offset + 12) === 2 ? 2 : 1;
+          row.hyperlinks[x] = view.getUint16(offset + 13, true);
+        }
+        offset += CELL_SIZE;
+      }
+      rows[y] = row;
+    }
+    return rows;
+  }
+
+  const styleCount = view.getUint32(4, true);
+  const styleBase = COMPACT_HEADER_SIZE;
+  const styleFg = new Uint32Array(styleCount);
+  const styleBg = new Uint32Array(styleCount);
+  const styleFlags = new Uint8Array(styleCount);
+  const styleHyperlinks = new Uint16Array(styleCount);
+  for (let style = 0; style < styleCount; style++) {
+    const styleOffset = styleBase + style * COMPACT_STYLE_SIZE;
+    styleFg[style] = (view.getUint8(styleOffset) << 16) |
+      (view.getUint8(styleOffset + 1) << 8) |
+      view.getUint8(styleOffset + 2);
+    styleBg[style] = (view.getUint8(styleOffset + 3) << 16) |
+      (view.getUint8(styleOffset + 4) << 8) |
+      view.getUint8(styleOffset + 5);
+    styleFlags[style] = view.getUint8(styleOffset + 6);
+    styleHyperlinks[style] = view.getUint16(styleOffset + 8, true);
+  }
+
+  let offset = styleBase + styleCount * COMPACT_STYLE_SIZE;
+  for (let y = 0; y < rowCount; y++) {
+    const row = createTerminalRow(cols);
+    for (let x = 0; x < cols; x++) {
+      const codepoint = view.getUint32(offset, true);
+      const style = view.getUint16(offset + 4, true);
+      row.codepoints[x] = codepoint > 0 ? codepoint : 0x20;
+      row.fg[x] = styleFg[style];
+      row.bg[x] = styleBg[style];
+      row.flags[x] = styleFlags[style];
+      row.hyperlinks[x] = styleHyperlinks[style];
+      row.widths[x] = view.getUint8(offset + 6) === 2 ? 2 : 1;
+      offset += COMPACT_CELL_SIZE;
+    }
+    rows[y] = row;
+  }
+
+  return rows;
+}
+
+// ============================================================================
+// Archive Row Records
+// ============================================================================
+
+/**
+ * Archive row record format (all integers little-endian):
+ * - bytes 0-3:  record length, excluding these 4 bytes (u32)
+ * - bytes 4-5:  column count (u16)
+ * - byte 6:     flags (bit 0: the row soft-wraps into the next record)
+ * - byte 7:     reserved
+ * - u16 new style count, then COMPACT_STYLE_SIZE bytes per style
+ * - u16 cell count; cells past it are trailing blanks (for a wrapped row,
+ *   every cell but a trailing wide-character spacer)
+ * - u16 fill style (style of the trailing blanks)
+ * - u16 run count, then (u16 length, u16 style) per style run
+ * - u16 wide cell count, then u16 column per wide cell
+ * - UTF-8 text, one codepoint per cell
+ *
+ * Styles are interned per chunk: a record only defines the styles its
+ * chunk has not seen yet, so a chunk's style table is rebuilt by scanning
+ * its records in order. A 200-column log line with one style costs a few
+ * bytes plus its text, rather than 3.2 KB of packRow cells.
+ */
+export const MAX_ARCHIVE_STYLES = MAX_COMPACT_STYLES;
+const ARCHIVE_RECORD_HEADER_SIZE = 8;
+const ARCHIVE_RECORD_WRAPPED = 1 << 0;
+
+/** Header fields of an archive record, as read by scanArchiveRecord. */
+export interface ArchiveRecordHeader {
+  /** Offset of the next record */
+  next: number;
+  cols: number;
+  /** Cells that carry content; the rest of the row is trailing blanks */
+  used: number;
+  /** The row soft-wraps into the next record */
+  wrapped: boolean;
+  /** Columns of the row's wide cells, ascending */
+  wide: readonly number[];
+}
+
+const NO_WIDE_CELLS: readonly number[] = [];
+
+const textEncoder = new TextEncoder();
+const textDecoder = new TextDecoder();
+
+function rowCodepoint(row: TerminalRow, x: number): number {
+  const codepoint = row.codepoints[x];
+  return codepoint > 0 ? codepoint : 0x20;
+}
+
+/**
+ * Encode a row as an archive record, interning its styles into the
+ * chunk's style table. The table must stay under MAX_ARCHIVE_STYLES.
+ * `wrapped` rows keep their trailing blanks, which are part of the
+ * logical line they continue into.
+ */
+export function packArchiveRow(
+  cells: TerminalCell[],
+  styles: StyleInterner,
+  wrapped = false
+): Uint8Array {
+  return packArchiveRecord(rowFromCells(cells), styles, wrapped);
+}
+
+/** packArchiveRow for a packed row, as exported in bulk by the emulator. */
+export function packArchiveRecord(
+  row: TerminalRow,
+  styles: StyleInterner,
+  wrapped = false
+): Uint8Array {
+  const cols = row.codepoints.length;
+  const { widths } = row;
+  const knownStyles = styles.fg.length;
+  const cellStyles = new Uint32Array(cols);
+  for (let x = 0; x < cols; x++) {
+    cellStyles[x] = styles.intern(row.fg[x], row.bg[x], row.flags[x] * 0x10000 + row.hyperlinks[x]);
+  }
+
+  // Trailing blanks in the last cell's style are implied by the fill style
+  const fill = cols > 0 ? cellStyles[cols - 1] : 0;
+  let used = cols;
+  if (wrapped) {
+    // A wide character that didn't fit leaves a spacer before the wrap
+    if (used > 1 && widths[used - 1] === 0 && widths[used - 2] !== 2) used--;
+  } else {
+    while (
+      used > 0 &&
+      cellStyles[used - 1] === fill &&
+      widths[used - 1] !== 2 &&
+      rowCodepoint(row, used - 1) === 0x20
+    ) {
+      used--;
+    }
+  }
+
+  let text = '';
+  const runs: number[] = [];
+  const wide: number[] = [];
+  for (let x = 0; x < used; x++) {
+    text += String.fromCodePoint(rowCodepoint(row, x));
+    if (widths[x] === 2) wide.push(x);
+    if (x > 0 && cellStyles[x] === cellStyles[x - 1]) {
+      runs[runs.length - 2] += 1;
+    } else {
+      runs.push(1, cellStyles[x]);
+    }
+  }
+  const textBytes = textEncoder.encode(text);
+
+  const newStyles = styles.fg.length - knownStyles;
+  const length = 2 + newStyles * COMPACT_STYLE_SIZE + 6 + runs.length * 2 + 2 + wide.length * 2 + textBytes.byteLength;
+  const record = new Uint8Array(ARCHIVE_RECORD_HEADER_SIZE + length);
+  const view = new DataView(record.buffer);
+  view.setUint32(0, 4 + length, true);
+  view.setUint16(4, cols, true);
+  view.setUint8(6, wrapped ? ARCHIVE_RECORD_WRAPPED : 0);
+
+  let offset = ARCHIVE_RECORD_HEADER_SIZE;
+  view.setUint16(offset, newStyles, true);
+  offset += 2;
+  for (let style = knownStyles; style < styles.fg.length; style++) {
+    const fg = styles.fg[style];
+    const bg = styles.bg[style];
+    const attrs = styles.attrs[style];
+    view.setUint8(offset, (fg >> 16) & 0xff);
+    view.setUint8(offset + 1, (fg >> 8) & 0xff);
+    view.setUint8(offset + 2, fg & 0xff);
+    view.setUint8(offset + 3, (bg >> 16) & 0xff);
+    view.setUint8(offset + 4, (bg >> 8) & 0xff);
+    view.setUint8(offset + 5, bg & 0xff);
+    view.setUint8(offset + 6, Math.floor(attrs / 0x10000));
+    view.setUint16(offset + 8, attrs & 0xffff, true);
+    offset += COMPACT_STYLE_SIZE;
+  }
+
+  view.setUint16(offset, used, true);
+  view.setUint16(offset + 2, fill, true);
+  view.setUint16(offset + 4, runs.length / 2, true);
+  offset += 6;
+  for (const value of runs) {
+    view.setUint16(offset, value, true);
+    offset += 2;
+  }
+  view.setUint16(offset, wide.length, true);
+  offset += 2;
+  for (const x of wide) {
+    view.setUint16(offset, x, true);
+    offset += 2;
+  }
+  record.set(textBytes, offset);
+  return record;
+}
+
+/**
+ * Read the header of the record at `offset`. Returns null if the record is
+ * truncated.
+ */
+export function readArchiveRecordHeader(view: DataView, offset: number): ArchiveRecordHeader | null {
+  if (offset + ARCHIVE_RECORD_HEADER_SIZE + 2 > view.byteLength) return null;
+  const next = offset + 4 + view.getUint32(offset, true);
+  if (next > view.byteLength) return null;
+
+  const newStyles = view.getUint16(offset + ARCHIVE_RECORD_HEADER_SIZE, true);
+  const usedOffset = offset + ARCHIVE_RECORD_HEADER_SIZE + 2 + newStyles * COMPACT_STYLE_SIZE;
+  if (usedOffset + 6 > next) return null;
+  const wideOffset = usedOffset + 6 + view.getUint16(usedOffset + 4, true) * 4;
+  if (wideOffset + 2 > next) return null;
+  const wideCount = view.getUint16(wideOffset, true);
+  if (wideOffset + 2 + wideCount * 2 > next) return null;
+  let wide = NO_WIDE_CELLS;
+  if (wideCount > 0) {
+    const columns: number[] = new Array(wideCount);
+    for (let i = 0; i < wideCount; i++) {
+      columns[i] = view.getUint16(wideOffset + 2 + i * 2, true);
+    }
+    wide = columns;
+  }
+  return {
+    next,
+    cols: view.getUint16(offset + 4, true),
+    used: view.getUint16(usedOffset, true),
+    wrapped: (view.getUint8(offset + 6) & ARCHIVE_RECORD_WRAPPED) !== 0,
+    wide,
+  };
+}
+
+/**
+ * Read the header of the record at `offset`, adding the styles it defines
+ * to `styles`. Returns null if the record is truncated.
+ */
+export function scanArchiveRecord(
+  view: DataView,
+  offset: number,
+  styles: StyleInterner
+): ArchiveRecordHeader | null {
+  const header = readArchiveRecordHeader(view, offset);
+  if (!header) return null;
+
+  const newStyles = view.getUint16(offset + ARCHIVE_RECORD_HEADER_SIZE, true);
+  let styleOffset = offset + ARCHIVE_RECORD_HEADER_SIZE + 2;
+  for (let i = 0; i < newStyles; i++) {
+    const fg = (view.getUint8(styleOffset) << 16) |
+      (view.getUint8(styleOffset + 1) << 8) |
+      view.getUint8(styleOffset + 2);
+    const bg = (view.getUint8(styleOffset + 3) << 16) |
+      (view.getUint8(styleOffset + 4) << 8) |
+      view.getUint8(styleOffset + 5);
+    const attrs = view.getUint8(styleOffset + 6) * 0x10000 + view.getUint16(styleOffset + 8, true);
+    styles.intern(fg, bg, attrs);
+    styleOffset += COMPACT_STYLE_SIZE;
+  }
+  return header;
+}
+
+function styledCell(styles: StyleInterner, style: number, char: string, width: 1 | 2): TerminalCell {
+  const fg = styles.fg[style] ?? 0;
+  const bg = styles.bg[style] ?? 0;
+  const attrs = styles.attrs[style] ?? 0;
+  const flags = Math.floor(attrs / 0x10000);
+  const hyperlinkId = attrs & 0xffff;
+  return {
+    char,
+    fg: { r: (fg >> 16) & 0xff, g: (fg >> 8) & 0xff, b: fg & 0xff },
+    bg: { r: (bg >> 16) & 0xff, g: (bg >> 8) & 0xff, b: bg & 0xff },
+    bold: (flags & RowFlags.BOLD) !== 0,
+    italic: (flags & RowFlags.ITALIC) !== 0,
+    underline: (flags & RowFlags.UNDERLINE) !== 0,
+    strikethrough: (flags & RowFlags.STRIKETHROUGH) !== 0,
+    inverse: (flags & RowFlags.INVERSE) !== 0,
+    blink: (flags & RowFlags.BLINK) !== 0,
+    dim: (flags & RowFlags.DIM) !== 0,
+    width,
+    hyperlinkId: hyperlinkId > 0 ? hyperlinkId : undefined,
+  };
+}
+
+/**
+ * Decode the record at `offset` into its row's cells. `styles` must
+ * already hold every style defined up to and including this record.
+ */
+export function unpackArchiveRow(
+  view: DataView,
+  offset: number,
+  styles: StyleInterner
+): TerminalCell[] {
+  const end = offset + 4 + view.getUint32(offset, true);
+  const cols = view.getUint16(offset + 4, true);
+  let pos = offset + ARCHIVE_RECORD_HEADER_SIZE + 2 +
+    view.getUint16(offset + ARCHIVE_RECORD_HEADER_SIZE, true) * COMPACT_STYLE_SIZE;
+  const used = view.getUint16(pos, true);
+  const fill = view.getUint16(pos + 2, true);
+  const runCount = view.getUint16(pos + 4, true);
+  const runsStart = pos + 6;
+  pos = runsStart + runCount * 4;
+  const wideCount = view.getUint16(pos, true);
+  const wideStart = pos + 2;
+  pos = wideStart + wideCount * 2;
+
+  const wide = new Set<number>();
+  for (let i = 0; i < wideCount; i++) {
+    wide.add(view.getUint16(wideStart + i * 2, true));
+  }
+  const text = textDecoder.decode(new Uint8Array(view.buffer, view.byteOffset + pos, end - pos));
+
+  const cells: TerminalCell[] = new Array(Math.max(cols, used));
+  let x = 0;
+  let run = 0;
+  let runLeft = 0;
+  let style = fill;
+  for (const char of text) {
+    if (x >= used) break;
+    while (runLeft === 0 && run < runCount) {
+      runLeft = view.getUint16(runsStart + run * 4, true);
+      style = view.getUint16(runsStart + run * 4 + 2, true);
+      run++;
+    }
+    runLeft--;
+    cells[x] = styledCell(styles, style, char, wide.has(x) ? 2 : 1);
+    x++;
+  }
+  for (; x < cells.length; x++) {
+    cells[x] = styledCell(styles, fill, ' ', 1);
+  }
+  return cells;
+}
+
 // ============================================================================
 // Full Terminal State Packing
 // ============================================================================
@@ -221,7 +729,7 @@ export function unpackRow(buffer: ArrayBuffer): TerminalCell[] {
  * - byte 20:     cursorKeyMode (u8, 0=normal, 1=application)
  * - byte 21:     kittyKeyboardFlags (u8)
  * - bytes 22-27: reserved
- * - bytes 28+:   cell data (rows * cols * CELL_SIZE)
+ * - bytes 28+:   compact cell block (rows * cols cells)
  */
 const STATE_HEADER_SIZE = 28;
 
@@ -229,8 +737,12 @@ const STATE_HEADER_SIZE = 28;
  * Pack full terminal state into a transferable ArrayBuffer
  */
 export function packTerminalState(state: TerminalState): ArrayBuffer {
-  const cellCount = state.rows * state.cols;
-  const buffer = new ArrayBuffer(STATE_HEADER_SIZE + cellCount * CELL_SIZE);
+  const rowCells: Array<TerminalRow | undefined> = new Array(state.rows);
+  for (let y = 0; y < state.rows; y++) {
+    rowCells[y] = state.cells[y];
+  }
+  const cellBlock = packCompactCells(rowCells, state.cols);
+  const buffer = new ArrayBuffer(STATE_HEADER_SIZE + cellBlock.byteLength);
   const view = new DataView(buffer);
 
   // Header
@@ -248,22 +760,7 @@ export function packTerminalState(state: TerminalState): ArrayBuffer {
   view.setUint8(20, state.cursorKeyMode === 'application' ? 1 : 0);
   view.setUint8(21, state.kittyKeyboardFlags ?? 0);
 
-  // Cell data (row by row)
-  let offset = STATE_HEADER_SIZE;
-  for (let y = 0; y < state.rows; y++) {
-    const row = state.cells[y];
-    if (row) {
-      for (let x = 0; x < state.cols; x++) {
-        const cell = row[x];
-        if (cell) {
-          packCellAt(view, offset, cell);
-        }
-        offset += CELL_SIZE;
-      }
-    } else {
-      offset += state.cols * CELL_SIZE;
-    }
-  }
+  new Uint8Array(buffer, STATE_HEADER_SIZE).set(new Uint8Array(cellBlock));
 
   return buffer;
 }
@@ -290,17 +787,7 @@ export function unpackTerminalState(buffer: ArrayBuffer): TerminalState {
   const kittyKeyboardFlags = view.getUint8(21);
 
   // Cell data
-  const cells: TerminalCell[][] = new Array(rows);
-  let offset = STATE_HEADER_SIZE;
-
-  for (let y = 0; y < rows; y++) {
-    const row: TerminalCell[] = new Array(cols);
-    for (let x = 0; x < cols; x++) {
-      row[x] = unpackCellAt(view, offset);
-      offset += CELL_SIZE;
-    }
-    cells[y] = row;
-  }
+  const cells = unpackCompactCells(buffer, STATE_HEADER_SIZE, rows, cols);
 
   return {
     cols,
@@ -328,26 +815,17 @@ export function unpackTerminalState(buffer: ArrayBuffer): TerminalState {
  */
 export function packDirtyUpdate(update: DirtyTerminalUpdate): SerializedDirtyUpdate {
   const dirtyRowIndices = new Uint16Array(update.dirtyRows.size);
-  let rowDataSize = 0;
+  const rows: TerminalRow[] = new Array(update.dirtyRows.size);
 
-  // Calculate total size needed for dirty row data
   let i = 0;
   for (const [rowIndex, row] of update.dirtyRows) {
-    dirtyRowIndices[i++] = rowIndex;
-    rowDataSize += row.length * CELL_SIZE;
+    dirtyRowIndices[i] = rowIndex;
+    rows[i] = row;
+    i++;
   }
 
-  // Pack dirty row data
-  const dirtyRowData = new ArrayBuffer(rowDataSize);
-  const view = new DataView(dirtyRowData);
-  let offset = 0;
-
-  for (const [, row] of update.dirtyRows) {
-    for (const cell of row) {
-      packCellAt(view, offset, cell);
-      offset += CELL_SIZE;
-    }
-  }
+  // Pack dirty row data (cols cells per row, style-interned)
+  const dirtyRowData = rows.length > 0 ? packCompactCells(rows, update.cols) : new ArrayBuffer(0);
 
   // Pack full state if present
   let fullStateData: ArrayBuffer | undefined;
@@ -383,25 +861,14 @@ export function unpackDirtyUpdate(
   packed: SerializedDirtyUpdate,
   scrollState: TerminalScrollState
 ): DirtyTerminalUpdate {
-  // Unpack dirty rows
-  const dirtyRows = new Map<number, TerminalCell[]>();
-  const view = new DataView(packed.dirtyRowData);
-  let offset = 0;
-
-  // Calculate cells per row from the data
-  // Each row should have cols cells
-  const cols = packed.cols;
-
-  for (let i = 0; i < packed.dirtyRowIndices.length; i++) {
-    const rowIndex = packed.dirtyRowIndices[i];
-    const row: TerminalCell[] = new Array(cols);
-
-    for (let x = 0; x < cols; x++) {
-      row[x] = unpackCellAt(view, offset);
-      offset += CELL_SIZE;
+  // Unpack dirty rows (each row has cols cells)
+  const dirtyRows = new Map<number, TerminalRow>();
+  const rowCount = packed.dirtyRowIndices.length;
+  if (rowCount > 0) {
+    const rows = unpackCompactCells(packed.dirtyRowData, 0, rowCount, packed.cols);
+    for (let i = 0; i < rowCount; i++) {
+      dirtyRows.set(packed.dirtyRowIndices[i], rows[i]);
     }
-
-    dirtyRows.set(rowIndex, row);
   }
 
   // Unpack full state if present
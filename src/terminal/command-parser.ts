@@ -8,8 +8,8 @@
  * Where <encoded> is percent-encoded to avoid control characters.
  */
 
-const ESC = '\x1b';
-const BEL = '\x07';
+import { createOscSequenceScanner } from './osc-scanner';
+
 const COMMAND_CODE = 777;
 const COMMAND_PREFIX = 'openmux;cmd=';
 const NOTIFY_CODE = 9;
@@ -136,64 +136,13 @@ function sanitizeCommand(command: string, shellName?: string): string {
 }
 
 /**
- * Creates a command parser that can be called with data chunks.
+ * Creates a command parser that can be called with data chunks (strings or
+ * raw UTF-8 bytes).
  */
 export function createCommandParser(options: CommandParserOptions) {
   const { onCommand, shellName, onNotification } = options;
 
-  // State for OSC sequence parsing
-  let inOscSequence = false;
-  let collectingText = false;
-  let oscCodeBuffer: string[] = [];
-  let oscTextBuffer: string[] = [];
-
-  function processData(data: string): void {
-    for (let i = 0; i < data.length; i++) {
-      const char = data[i];
-
-      if (inOscSequence) {
-        if (char === BEL) {
-          handleOscComplete();
-          continue;
-        }
-
-        if (char === ESC && i + 1 < data.length && data[i + 1] === '\\') {
-          i += 1;
-          handleOscComplete();
-          continue;
-        }
-
-        if (!collectingText) {
-          if (char === ';') {
-            collectingText = true;
-          } else if (char >= '0' && char <= '9') {
-            oscCodeBuffer.push(char);
-          } else {
-            resetOsc();
-          }
-        } else {
-          oscTextBuffer.push(char);
-        }
-        continue;
-      }
-
-      if (char === ESC && i + 1 < data.length && data[i + 1] === ']') {
-        inOscSequence = true;
-        collectingText = false;
-        oscCodeBuffer = [];
-        oscTextBuffer = [];
-        i += 1;
-      }
-    }
-  }
-
-  function handleOscComplete(): void {
-    const oscCode = oscCodeBuffer.join('');
-    const oscText = oscTextBuffer.join('');
-    const code = Number.parseInt(oscCode, 10);
-
-    let handledCommand = false;
-
+  return createOscSequenceScanner((code, oscText) => {
     if (code === COMMAND_CODE && oscText.startsWith(COMMAND_PREFIX)) {
       const encoded = oscText.slice(COMMAND_PREFIX.length);
       const decoded = decodeCommand(encoded);
@@ -201,27 +150,14 @@ export function createCommandParser(options: CommandParserOptions) {
       if (sanitized) {
         onCommand(sanitized);
       }
-      handledCommand = true;
+      return;
     }
 
-    if (!handledCommand && onNotification) {
+    if (onNotification) {
       const notification = parseDesktopNotification(code, oscText);
       if (notification) {
         onNotification(notification);
       }
     }
-
-    resetOsc();
-  }
-
-  function resetOsc(): void {
-    inOscSequence = false;
-    collectingText = false;
-    oscCodeBuffer = [];
-    oscTextBuffer = [];
-  }
-
-  return {
-    processData,
-  };
+  });
 }
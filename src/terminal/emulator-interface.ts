@@ -7,6 +7,7 @@
 
 import type {
   TerminalCell,
+  TerminalRow,
   TerminalState,
   TerminalScrollState,
   DirtyTerminalUpdate,
@@ -16,6 +17,14 @@ import type { TerminalColors } from './terminal-colors';
 /**
  * Terminal emulator interface - implemented by native and remote emulators.
  */
+/**
+ * What the caller already knows about bytes passed to write().
+ */
+export interface EmulatorWriteHints {
+  /** False when the bytes contain no part of an OSC sequence */
+  mayContainOsc?: boolean;
+}
+
 export interface ITerminalEmulator {
   /** Current terminal width in columns */
   readonly cols: number;
@@ -30,7 +39,7 @@ export interface ITerminalEmulator {
    * Write data to terminal (parses VT sequences).
    * Does NOT notify subscribers - caller is responsible for that.
    */
-  write(data: string | Uint8Array): void;
+  write(data: string | Uint8Array, hints?: EmulatorWriteHints): void;
 
   /**
    * Resize terminal dimensions.
@@ -63,6 +72,12 @@ export interface ITerminalEmulator {
    */
   getScrollbackLength(): number;
 
+  /**
+   * How line indexes are currently numbered, for callers that hold on to
+   * them (e.g. search matches) across output
+   */
+  getLineNumbering?(): LineNumbering;
+
   /**
    * Get a line from the scrollback buffer
    * @param offset Line offset from top of scrollback (0 = oldest line)
@@ -70,6 +85,19 @@ export interface ITerminalEmulator {
    */
   getScrollbackLine(offset: number): TerminalCell[] | null;
 
+  /**
+   * Whether a scrollback line soft-wraps into the next one
+   * @param offset Line offset from top of scrollback (0 = oldest line)
+   */
+  isScrollbackLineWrapped?(offset: number): boolean;
+
+  /**
+   * Get up to `count` of the oldest scrollback lines as packed rows with
+   * their wrap flags, in one call (for the disk archiver)
+   * @returns The rows, or null if not available
+   */
+  getOldestScrollbackRows?(count: number): { rows: TerminalRow[]; wrapped: boolean[] } | null;
+
   /**
    * Get dirty terminal update with structural sharing.
    * Returns only changed rows instead of full state (key optimization).
@@ -199,11 +227,19 @@ export interface ITerminalEmulator {
 
   /**
    * Search for text in terminal (scrollback + visible area)
-   * Returns matches sorted from oldest to newest
-   * @param query Search string
+   * Runs as a cooperative job; batches stream to options.onMatches and the
+   * result holds all matches found, sorted from oldest to newest
+   * @param query Search string, or a pattern when options.regex is set
    * @param options.limit Maximum number of matches to return (default: 500)
    */
-  search(query: string, options?: { limit?: number }): Promise<SearchResult>;
+  search(query: string, options?: SearchOptions): Promise<SearchResult>;
+
+  /**
+   * Compile a case-insensitive pattern with the emulator's native regex
+   * engine, for lines the caller joins itself (archived scrollback).
+   * Returns null when the engine is unavailable or rejects the pattern.
+   */
+  compileSearchPattern?(pattern: string): SearchPattern | null;
 }
 
 /**
@@ -271,7 +307,7 @@ export interface KittyGraphicsPlacement {
 export interface SerializedDirtyUpdate {
   /** Which rows changed (indices) */
   dirtyRowIndices: Uint16Array;
-  /** Packed cell data for dirty rows (Transferable) */
+  /** Compact cell block for dirty rows, cols cells each (Transferable) */
   dirtyRowData: ArrayBuffer;
   /** Cursor position */
   cursor: { x: number; y: number; visible: boolean };
@@ -307,6 +343,35 @@ export interface SearchMatch {
   endCol: number;
 }
 
+/**
+ * Search options
+ */
+export interface SearchOptions {
+  /** Maximum number of matches to return (default: 500) */
+  limit?: number;
+  /** Treat the query as a case-insensitive regular expression */
+  regex?: boolean;
+  /** Cancels the search; it resolves early with the matches found so far */
+  signal?: AbortSignal;
+  /** First line to search (default: 0) */
+  startLine?: number;
+  /** Line to stop before (default: the last line) */
+  endLine?: number;
+  /** Line to search outward from; the nearest `limit` matches are kept */
+  anchor?: number;
+  /** Receives each batch of matches as the search progresses, in search order */
+  onMatches?: (matches: SearchMatch[]) => void;
+}
+
+/**
+ * Compiled search pattern; free() it once the search is done
+ */
+export interface SearchPattern {
+  /** Non-empty matches in `text` as [start, end) UTF-16 indexes, or null on failure */
+  searchText(text: string): Array<[number, number]> | null;
+  free(): void;
+}
+
 /**
  * Search result with pagination info
  */
@@ -315,4 +380,18 @@ export interface SearchResult {
   matches: SearchMatch[];
   /** Whether more matches exist beyond the limit */
   hasMore: boolean;
+  /** Numbering the match line indexes refer to, when the emulator tracks it */
+  numbering?: LineNumbering;
+  /** Lines were renumbered while the search ran; indexes may be inconsistent */
+  renumbered?: boolean;
+}
+
+/**
+ * Line index numbering. Lines leaving the top of the scrollback add to
+ * `dropped` and move every later index down by as many; anything else that
+ * renumbers lines (reflow, reset, clearing scrollback) changes `epoch`.
+ */
+export interface LineNumbering {
+  epoch: number;
+  dropped: number;
 }
@@ -36,6 +36,13 @@ export class ScrollbackCache {
     this.cache.clear()
   }
 
+  /** Drop cached lines at or after offset */
+  deleteFrom(offset: number): void {
+    for (const key of this.cache.keys()) {
+      if (key >= offset) this.cache.delete(key)
+    }
+  }
+
   get size(): number {
     return this.cache.size
   }
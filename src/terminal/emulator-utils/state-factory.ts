@@ -1,10 +1,10 @@
 /**
  * State Factory - creates default terminal states
  */
-import type { TerminalCell, TerminalState, TerminalScrollState, DirtyTerminalUpdate } from '../../core/types'
+import type { TerminalRow, TerminalState, TerminalScrollState, DirtyTerminalUpdate } from '../../core/types'
 import type { TerminalModes } from '../emulator-interface'
 import type { TerminalColors } from '../terminal-colors'
-import { extractRgb } from '../terminal-colors'
+import { createBlankRow } from '../terminal-row'
 
 /**
  * Create default terminal modes
@@ -38,28 +38,9 @@ export function createEmptyTerminalState(
   colors: TerminalColors,
   modes: TerminalModes
 ): TerminalState {
-  const fg = extractRgb(colors.foreground)
-  const bg = extractRgb(colors.background)
-
-  const emptyCells: TerminalCell[][] = []
+  const emptyCells: TerminalRow[] = []
   for (let y = 0; y < rows; y++) {
-    const row: TerminalCell[] = []
-    for (let x = 0; x < cols; x++) {
-      row.push({
-        char: ' ',
-        fg,
-        bg,
-        bold: false,
-        italic: false,
-        underline: false,
-        strikethrough: false,
-        inverse: false,
-        blink: false,
-        dim: false,
-        width: 1,
-      })
-    }
-    emptyCells.push(row)
+    emptyCells.push(createBlankRow(cols, colors.foreground, colors.background))
   }
 
   return {
@@ -1,13 +1,23 @@
 /**
  * Cell conversion utilities for terminal rendering.
- * Converts GhosttyCell format to our internal TerminalCell format.
+ * Converts GhosttyCell format to packed TerminalRows (and, for cold paths,
+ * to our TerminalCell format).
  */
 
-import { CellFlags, type GhosttyCell } from '../ghostty-vt/types';
-import type { TerminalCell } from '../../core/types';
+import { CellFlags, CompactStyleAttrs, type GhosttyCell, type GhosttyCompactFrame } from '../ghostty-vt/types';
+import type { TerminalCell, TerminalRow } from '../../core/types';
 import type { TerminalColors } from '../terminal-colors';
 import { extractRgb } from '../terminal-colors';
-import { isZeroWidthChar, isSpaceLikeChar, isCjkIdeograph, codepointToChar } from './codepoint-utils';
+import {
+  RowFlags,
+  createBlankRow,
+  createTerminalRow,
+  fillBlankCells,
+  packRgb,
+  rowCellAt,
+  rowToCells,
+} from '../terminal-row';
+import { isZeroWidthChar, isSpaceLikeChar, isCjkIdeograph, normalizeCodepoint } from './codepoint-utils';
 
 const KITTY_PLACEHOLDER = 0x10eeee;
 
@@ -94,201 +104,184 @@ export function createFillCell(lastCell: GhosttyCell | null, colors: TerminalCol
 }
 
 /**
- * Convert a single GhosttyCell to TerminalCell.
+ * Map ghostty CellFlags to RowFlags (INVISIBLE is folded into the codepoint).
+ */
+function toRowFlags(flags: number): number {
+  let result = flags & (
+    CellFlags.BOLD | CellFlags.ITALIC | CellFlags.UNDERLINE | CellFlags.STRIKETHROUGH | CellFlags.INVERSE
+  );
+  if ((flags & CellFlags.BLINK) !== 0) result |= RowFlags.BLINK;
+  if ((flags & CellFlags.FAINT) !== 0) result |= RowFlags.DIM;
+  return result;
+}
+
+/**
+ * Store one ghostty cell into column x of a packed row.
  * Handles special cases like zero-width chars, space-like chars, CJK validation, etc.
- *
- * @param cell - The GhosttyCell to convert
- * @returns Converted TerminalCell
+ * Colors are packed 0xRRGGBB.
  */
-export function convertCell(cell: GhosttyCell): TerminalCell {
-  // Safely extract colors with validation
-  const fg = safeRgb(cell.fg_r, cell.fg_g, cell.fg_b);
-  const bg = safeRgb(cell.bg_r, cell.bg_g, cell.bg_b);
+function storeCell(
+  row: TerminalRow,
+  x: number,
+  codepoint: number,
+  flags: number,
+  width: number,
+  hyperlinkId: number,
+  fg: number,
+  bg: number
+): void {
+  row.bg[x] = bg;
+  row.hyperlinks[x] = 0;
 
   // Kitty graphics placeholder cells encode image IDs in colors; keep them invisible.
-  if (cell.codepoint === KITTY_PLACEHOLDER) {
-    return {
-      char: ' ',
-      fg: bg,
-      bg,
-      bold: false,
-      italic: false,
-      underline: false,
-      strikethrough: false,
-      inverse: false,
-      blink: false,
-      dim: false,
-      width: 1,
-    };
-  }
-
   // Zero-width characters render as space but preserve background color
   // Only strip foreground to prevent invisible colored text
-  if (isZeroWidthChar(cell.codepoint)) {
-    return {
-      char: ' ',
-      fg: bg, // fg = bg (invisible)
-      bg: bg,
-      bold: false,
-      italic: false,
-      underline: false,
-      strikethrough: false,
-      inverse: false,
-      blink: false,
-      dim: false,
-      width: 1,
-    };
+  if (codepoint === KITTY_PLACEHOLDER || isZeroWidthChar(codepoint)) {
+    row.codepoints[x] = 0x20;
+    row.fg[x] = bg;
+    row.flags[x] = 0;
+    row.widths[x] = 1;
+    return;
   }
 
+  row.fg[x] = fg;
+
   // Space-like characters (braille blank, typographic spaces, etc.) should be
   // normalized to regular space to avoid rendering inconsistencies between
   // terminals. The colors are preserved so backgrounds render correctly.
-  if (isSpaceLikeChar(cell.codepoint)) {
-    return {
-      char: ' ',
-      fg,
-      bg,
-      bold: (cell.flags & CellFlags.BOLD) !== 0,
-      italic: (cell.flags & CellFlags.ITALIC) !== 0,
-      underline: (cell.flags & CellFlags.UNDERLINE) !== 0,
-      strikethrough: (cell.flags & CellFlags.STRIKETHROUGH) !== 0,
-      inverse: (cell.flags & CellFlags.INVERSE) !== 0,
-      blink: (cell.flags & CellFlags.BLINK) !== 0,
-      dim: (cell.flags & CellFlags.FAINT) !== 0,
-      width: 1, // Normalize to width 1 for consistent rendering
-    };
+  if (isSpaceLikeChar(codepoint)) {
+    row.codepoints[x] = 0x20;
+    row.flags[x] = toRowFlags(flags);
+    row.widths[x] = 1; // Normalize to width 1 for consistent rendering
+    return;
   }
 
   // Width=0 cells are spacer/continuation cells for wide characters
-  // They should render as empty space with the cell's background color
-  if (cell.width === 0) {
-    return {
-      char: ' ',
-      fg,
-      bg,
-      bold: false,
-      italic: false,
-      underline: false,
-      strikethrough: false,
-      inverse: false,
-      blink: false,
-      dim: false,
-      width: 1,
-    };
-  }
-
-  // Check for INVISIBLE flag (CellFlags.INVISIBLE = 32)
-  // Invisible cells should render as space but keep their colors
-  const isInvisible = (cell.flags & 32) !== 0;
-
+  // They should render as empty space with the cell's background color.
   // CJK ideographs should always have width=2. If we see a CJK codepoint with
   // width=1, it's likely corrupted cell data (e.g., from byte misalignment in
   // fast-rendering demos). Filter these out to prevent random Chinese chars.
-  if (isCjkIdeograph(cell.codepoint) && cell.width !== 2) {
-    return {
-      char: ' ',
-      fg,
-      bg,
-      bold: false,
-      italic: false,
-      underline: false,
-      strikethrough: false,
-      inverse: false,
-      blink: false,
-      dim: false,
-      width: 1,
-    };
+  if (width === 0 || (isCjkIdeograph(codepoint) && width !== 2)) {
+    row.codepoints[x] = 0x20;
+    row.flags[x] = 0;
+    row.widths[x] = 1;
+    return;
   }
 
-  // Convert codepoint to character
-  const char = codepointToChar(cell.codepoint, isInvisible);
+  // Invisible cells should render as space but keep their colors
+  const isInvisible = (flags & CellFlags.INVISIBLE) !== 0;
 
-  return {
-    char,
-    fg,
-    bg,
-    bold: (cell.flags & CellFlags.BOLD) !== 0,
-    italic: (cell.flags & CellFlags.ITALIC) !== 0,
-    underline: (cell.flags & CellFlags.UNDERLINE) !== 0,
-    strikethrough: (cell.flags & CellFlags.STRIKETHROUGH) !== 0,
-    inverse: (cell.flags & CellFlags.INVERSE) !== 0,
-    blink: (cell.flags & CellFlags.BLINK) !== 0,
-    dim: (cell.flags & CellFlags.FAINT) !== 0,
-    width: cell.width as 1 | 2,
-    hyperlinkId: cell.hyperlink_id,
-  };
+  row.codepoints[x] = normalizeCodepoint(codepoint, isInvisible);
+  row.flags[x] = toRowFlags(flags);
+  row.widths[x] = width === 2 ? 2 : 1;
+  row.hyperlinks[x] = hyperlinkId;
+}
+
+function storeGhosttyCell(row: TerminalRow, x: number, cell: GhosttyCell): void {
+  storeCell(
+    row,
+    x,
+    cell.codepoint,
+    cell.flags,
+    cell.width,
+    cell.hyperlink_id,
+    packRgb(cell.fg_r, cell.fg_g, cell.fg_b),
+    packRgb(cell.bg_r, cell.bg_g, cell.bg_b)
+  );
 }
 
+const scratchRow = createTerminalRow(1);
+
 /**
- * Convert a line of GhosttyCell to TerminalCell array with EOL fill.
+ * Convert a single GhosttyCell to TerminalCell.
+ *
+ * @param cell - The GhosttyCell to convert
+ * @returns Converted TerminalCell
+ */
+export function convertCell(cell: GhosttyCell): TerminalCell {
+  storeGhosttyCell(scratchRow, 0, cell);
+  return rowCellAt(scratchRow, 0);
+}
+
+/**
+ * Convert a line of GhosttyCell to a packed row with EOL fill.
  *
  * @param line - Array of GhosttyCell from the terminal
  * @param cols - Number of columns to fill to
  * @param colors - Terminal color scheme for fill cells
- * @returns Array of TerminalCell with EOL padding
+ * @returns Packed row of exactly `cols` cells
  */
-export function convertLine(line: GhosttyCell[], cols: number, colors: TerminalColors): TerminalCell[] {
-  const row: TerminalCell[] = [];
+export function convertLineToRow(line: GhosttyCell[], cols: number, colors: TerminalColors): TerminalRow {
+  const row = createTerminalRow(cols);
   const lineLength = Math.min(line.length, cols);
 
   for (let x = 0; x < lineLength; x++) {
-    row.push(convertCell(line[x]));
+    storeGhosttyCell(row, x, line[x]);
   }
 
   // Fill remaining cells with default background color (not last cell's color)
   // Using default prevents "smearing" where colored backgrounds extend to EOL
   if (lineLength < cols) {
-    const fg = extractRgb(colors.foreground);
-    const bg = extractRgb(colors.background);
-
-    for (let x = lineLength; x < cols; x++) {
-      // Create a new object for each cell to avoid shared references
-      row.push({
-        char: ' ',
-        fg,
-        bg,
-        bold: false,
-        italic: false,
-        underline: false,
-        strikethrough: false,
-        inverse: false,
-        blink: false,
-        dim: false,
-        width: 1,
-      });
-    }
+    fillBlankCells(row, lineLength, cols, colors.foreground, colors.background);
   }
 
   return row;
 }
 
+/**
+ * Convert a line of GhosttyCell to TerminalCell array with EOL fill.
+ * Used for scrollback lines, which are cached as cell objects.
+ *
+ * @param line - Array of GhosttyCell from the terminal
+ * @param cols - Number of columns to fill to
+ * @param colors - Terminal color scheme for fill cells
+ * @returns Array of TerminalCell with EOL padding
+ */
+export function convertLine(line: GhosttyCell[], cols: number, colors: TerminalColors): TerminalCell[] {
+  return rowToCells(convertLineToRow(line, cols, colors));
+}
+
+/**
+ * Convert the rows of a compact viewport export into packed rows.
+ * No per-cell objects are allocated.
+ *
+ * @param frame - Compact export from GhosttyVtTerminal.getViewportCompact()
+ * @param cols - Number of columns per row
+ * @returns One row per entry in frame.rows, in the same order
+ */
+export function convertCompactRows(frame: GhosttyCompactFrame, cols: number): TerminalRow[] {
+  const { cells, styles } = frame;
+  const view = new DataView(cells.buffer, cells.byteOffset, cells.byteLength);
+
+  const result: TerminalRow[] = new Array(frame.rows.length);
+  for (let i = 0; i < frame.rows.length; i++) {
+    const row = createTerminalRow(cols);
+    for (let x = 0; x < cols; x++) {
+      const offset = (i * cols + x) * 8;
+      const styleOffset = view.getUint16(offset + 4, true) * 8;
+      storeCell(
+        row,
+        x,
+        view.getUint32(offset, true),
+        styles[styleOffset + 6],
+        cells[offset + 6],
+        (styles[styleOffset + 7] & CompactStyleAttrs.HYPERLINK) !== 0 ? 1 : 0,
+        (styles[styleOffset] << 16) | (styles[styleOffset + 1] << 8) | styles[styleOffset + 2],
+        (styles[styleOffset + 3] << 16) | (styles[styleOffset + 4] << 8) | styles[styleOffset + 5]
+      );
+    }
+    result[i] = row;
+  }
+  return result;
+}
+
 /**
  * Create an empty row using the terminal's default colors.
  *
  * @param cols - Number of columns
  * @param colors - Terminal color scheme
- * @returns Array of empty cells
+ * @returns Packed row of blank cells
  */
-export function createEmptyRow(cols: number, colors: TerminalColors): TerminalCell[] {
-  const row: TerminalCell[] = [];
-  const fg = extractRgb(colors.foreground);
-  const bg = extractRgb(colors.background);
-
-  for (let x = 0; x < cols; x++) {
-    // Create a new object for each cell to avoid shared references
-    row.push({
-      char: ' ',
-      fg,
-      bg,
-      bold: false,
-      italic: false,
-      underline: false,
-      strikethrough: false,
-      inverse: false,
-      blink: false,
-      dim: false,
-      width: 1,
-    });
-  }
-  return row;
+export function createEmptyRow(cols: number, colors: TerminalColors): TerminalRow {
+  return createBlankRow(cols, colors.foreground, colors.background);
 }
@@ -157,52 +157,44 @@ export function isZeroWidthChar(codepoint: number): boolean {
 }
 
 /**
- * Convert a codepoint to a character string, with safety checks.
- * Returns space for invalid or unrenderable codepoints.
+ * Normalize a codepoint for display, with the same safety checks as
+ * codepointToChar. Returns 0x20 for invalid or unrenderable codepoints.
  *
- * @param codepoint - The Unicode codepoint to convert
+ * @param codepoint - The Unicode codepoint to normalize
  * @param isInvisible - Whether the cell has the INVISIBLE flag set
- * @returns The character string, or space if invalid
+ * @returns The codepoint to display, or 0x20 if invalid
  */
-export function codepointToChar(codepoint: number, isInvisible: boolean = false): string {
-  if (isInvisible) return ' ';
+export function normalizeCodepoint(codepoint: number, isInvisible: boolean = false): number {
+  if (isInvisible) return 0x20;
 
   const cp = codepoint;
-  if (typeof cp !== 'number' || cp < 0x20) return ' ';
+  if (typeof cp !== 'number' || cp < 0x20) return 0x20;
 
-  if (cp <= 0x7e) {
-    // Printable ASCII
-    return String.fromCharCode(cp);
-  } else if (cp >= 0xa0 && cp <= 0xd7ff) {
-    // Latin-1 Supplement through pre-surrogate BMP
-    return String.fromCharCode(cp);
-  } else if (cp >= 0xe000 && cp <= 0xfffd && cp !== 0xfffd) {
-    // Private Use Area (nerd fonts) through end of BMP, excluding U+FFFD
-    return String.fromCharCode(cp);
-  } else if (cp >= 0x10000 && cp <= 0xcffff) {
-    // Planes 1-12 (skip Plane 13 - unassigned, ghostty-vt returns garbage here)
-    try {
-      return String.fromCodePoint(cp);
-    } catch {
-      return ' ';
-    }
-  } else if (cp >= 0xe0000 && cp <= 0xeffff) {
-    // Plane 14: SSP (tags, variation selectors supplement)
-    try {
-      return String.fromCodePoint(cp);
-    } catch {
-      return ' ';
-    }
-  } else if (cp >= 0xf0000 && cp <= 0xfffff) {
-    // Plane 15: PUA-A (Supplementary Private Use Area A - file icons)
-    try {
-      return String.fromCodePoint(cp);
-    } catch {
-      return ' ';
-    }
+  if (
+    cp <= 0x7e || // Printable ASCII
+    (cp >= 0xa0 && cp <= 0xd7ff) || // Latin-1 Supplement through pre-surrogate BMP
+    (cp >= 0xe000 && cp < 0xfffd) || // Private Use Area (nerd fonts) through end of BMP, excluding U+FFFD
+    (cp >= 0x10000 && cp <= 0xcffff) || // Planes 1-12 (skip Plane 13 - unassigned, ghostty-vt returns garbage here)
+    (cp >= 0xe0000 && cp <= 0xeffff) || // Plane 14: SSP (tags, variation selectors supplement)
+    (cp >= 0xf0000 && cp <= 0xfffff) // Plane 15: PUA-A (Supplementary Private Use Area A - file icons)
+  ) {
+    return cp;
   }
 
   // Implicitly skip: DEL (0x7F), C1 controls (0x80-0x9F), surrogates (0xD800-0xDFFF),
   // replacement char (0xFFFD), non-characters, Plane 13 + Plane 16 (ghostty-vt bug)
-  return ' ';
+  return 0x20;
+}
+
+/**
+ * Convert a codepoint to a character string, with safety checks.
+ * Returns space for invalid or unrenderable codepoints.
+ *
+ * @param codepoint - The Unicode codepoint to convert
+ * @param isInvisible - Whether the cell has the INVISIBLE flag set
+ * @returns The character string, or space if invalid
+ */
+export function codepointToChar(codepoint: number, isInvisible: boolean = false): string {
+  const cp = normalizeCodepoint(codepoint, isInvisible);
+  return cp <= 0xffff ? String.fromCharCode(cp) : String.fromCodePoint(cp);
 }
@@ -10,6 +10,7 @@ export {
   isSpaceLikeChar,
   isZeroWidthChar,
   codepointToChar,
+  normalizeCodepoint,
 } from './codepoint-utils';
 
 // Cell conversion utilities
@@ -19,6 +20,8 @@ export {
   createFillCell,
   convertCell,
   convertLine,
+  convertLineToRow,
+  convertCompactRows,
   createEmptyRow,
 } from './cell-converter';
 export type { RGB } from './cell-converter';
@@ -1,4 +1,4 @@
-import type { TerminalCell } from "../../core/types";
+import type { TerminalCell, TerminalRow } from "../../core/types";
 import { areTerminalColorsEqual, type TerminalColors } from "../terminal-colors";
 
 export function buildOscColorSequence(colors: TerminalColors): string {
@@ -46,23 +46,41 @@ export function buildColorRemap(from: TerminalColors, to: TerminalColors): Map<n
   return map.size ? map : null;
 }
 
+/**
+ * Remap the colors of a scrollback row in place. Cells may share fg/bg
+ * objects, so each object is remapped once.
+ */
 export function applyColorRemapToRow(row: TerminalCell[], remap: Map<number, number>): void {
+  const seen = new Set<TerminalCell["fg"]>();
   for (const cell of row) {
-    const fgKey = (cell.fg.r << 16) | (cell.fg.g << 8) | cell.fg.b;
-    const fgNext = remap.get(fgKey);
-    if (fgNext !== undefined) {
-      setRgb(cell.fg, fgNext);
-    }
-    const bgKey = (cell.bg.r << 16) | (cell.bg.g << 8) | cell.bg.b;
-    const bgNext = remap.get(bgKey);
-    if (bgNext !== undefined) {
-      setRgb(cell.bg, bgNext);
-    }
+    remapRgb(cell.fg, remap, seen);
+    remapRgb(cell.bg, remap, seen);
   }
 }
 
-function setRgb(target: { r: number; g: number; b: number }, color: number): void {
-  target.r = (color >> 16) & 0xFF;
-  target.g = (color >> 8) & 0xFF;
-  target.b = color & 0xFF;
+/**
+ * Remap the packed colors of a live row in place.
+ */
+export function applyColorRemapToTerminalRow(row: TerminalRow, remap: Map<number, number>): void {
+  const { fg, bg } = row;
+  for (let x = 0; x < fg.length; x++) {
+    const fgNext = remap.get(fg[x]);
+    if (fgNext !== undefined) fg[x] = fgNext;
+    const bgNext = remap.get(bg[x]);
+    if (bgNext !== undefined) bg[x] = bgNext;
+  }
+}
+
+function remapRgb(
+  target: { r: number; g: number; b: number },
+  remap: Map<number, number>,
+  seen: Set<TerminalCell["fg"]>
+): void {
+  if (seen.has(target)) return;
+  seen.add(target);
+  const next = remap.get((target.r << 16) | (target.g << 8) | target.b);
+  if (next === undefined) return;
+  target.r = (next >> 16) & 0xFF;
+  target.g = (next >> 8) & 0xFF;
+  target.b = next & 0xFF;
 }
@@ -1,14 +1,15 @@
-import type { TerminalCell, TerminalState } from '../../core/types';
+import type { TerminalRow, TerminalState } from '../../core/types';
 import type { TerminalModes } from '../emulator-interface';
 import type { TerminalColors } from '../terminal-colors';
-import { convertLine } from '../ghostty-emulator/cell-converter';
-import type { GhosttyVtTerminal } from './terminal';
+import { convertCompactRows, convertLineToRow } from '../ghostty-emulator/cell-converter';
+import type { GhosttyCell, GhosttyCompactFrame, GhosttyDirtyRows } from './types';
 
 type Cursor = { x: number; y: number; visible: boolean };
 
 export function buildDirtyState({
-  terminal,
+  compact,
   viewport,
+  dirtyRowCells,
   cols,
   rows,
   colors,
@@ -18,8 +19,12 @@ export function buildDirtyState({
   modes,
   kittyKeyboardFlags,
 }: {
-  terminal: GhosttyVtTerminal;
-  viewport: ReturnType<GhosttyVtTerminal['getViewport']> | null;
+  /** Compact export (all rows when shouldBuildFull, else dirty rows); preferred when present */
+  compact: GhosttyCompactFrame | null;
+  /** Full viewport, used for full builds without a compact export */
+  viewport: GhosttyCell[] | null;
+  /** Dirty rows only, used for partial updates */
+  dirtyRowCells: GhosttyDirtyRows | null;
   cols: number;
   rows: number;
   colors: TerminalColors;
@@ -30,19 +35,21 @@ export function buildDirtyState({
   kittyKeyboardFlags: number;
 }): {
   cachedState: TerminalState | null;
-  dirtyRows: Map<number, TerminalCell[]>;
+  dirtyRows: Map<number, TerminalRow>;
   fullState?: TerminalState;
 } {
-  let dirtyRows = new Map<number, TerminalCell[]>();
+  let dirtyRows = new Map<number, TerminalRow>();
   let fullState: TerminalState | undefined;
 
   if (shouldBuildFull) {
-    const cells: TerminalCell[][] = [];
-    if (viewport) {
+    let cells: TerminalRow[] = [];
+    if (compact) {
+      cells = convertCompactRows(compact, cols);
+    } else if (viewport) {
       for (let y = 0; y < rows; y++) {
         const start = y * cols;
         const line = viewport.slice(start, start + cols);
-        cells.push(convertLine(line, cols, colors));
+        cells.push(convertLineToRow(line, cols, colors));
       }
     }
 
@@ -62,12 +69,19 @@ export function buildDirtyState({
       kittyKeyboardFlags,
     };
     cachedState = fullState;
-  } else if (viewport) {
-    for (let y = 0; y < rows; y++) {
-      if (!terminal.isRowDirty(y)) continue;
-      const start = y * cols;
-      const line = viewport.slice(start, start + cols);
-      dirtyRows.set(y, convertLine(line, cols, colors));
+  } else if (compact || dirtyRowCells) {
+    if (compact) {
+      const converted = convertCompactRows(compact, cols);
+      for (let i = 0; i < compact.rows.length; i++) {
+        dirtyRows.set(compact.rows[i], converted[i]);
+      }
+    } else if (dirtyRowCells) {
+      const { rows: rowIndices, cells } = dirtyRowCells;
+      for (let i = 0; i < rowIndices.length; i++) {
+        const start = i * cols;
+        const line = cells.slice(start, start + cols);
+        dirtyRows.set(rowIndices[i], convertLineToRow(line, cols, colors));
+      }
     }
 
     if (cachedState) {
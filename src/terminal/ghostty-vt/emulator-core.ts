@@ -4,19 +4,25 @@
 
 import type {
   TerminalCell,
+  TerminalRow,
   TerminalState,
   TerminalScrollState,
   DirtyTerminalUpdate,
 } from "../../core/types";
 import type {
+  EmulatorWriteHints,
+  LineNumbering,
+  SearchOptions,
   SearchResult,
   TerminalModes,
 } from "../emulator-interface";
 import { areTerminalColorsEqual, type TerminalColors } from "../terminal-colors";
 import { createTitleParser } from "../title-parser";
 import { stripProblematicOscSequences } from "./osc-stripping";
-import { GhosttyVtTerminal } from "./terminal";
-import { createEmptyRow } from "../ghostty-emulator/cell-converter";
+import { toBytes } from "../byte-utils";
+import { GhosttyVtTerminal, createSearchCursor, isSearchCursorDone, searchCursorLine } from "./terminal";
+import { GhosttyRegex } from "./regex";
+import { SearchFlags } from "./types";
 import {
   ScrollbackCache,
   createDefaultModes,
@@ -24,14 +30,24 @@ import {
   createEmptyTerminalState,
   createEmptyDirtyUpdate,
 } from "../emulator-utils";
-import { getModes } from "./utils";
-import { searchTerminal } from "./terminal-search";
+import { extractLineText, getModes } from "./utils";
+import {
+  cellsLineText,
+  compileSearchRegex,
+  rowLineText,
+  searchLines,
+  searchLinesRegex,
+} from "./terminal-search";
+import { runNumberedSearch, runSearchJob } from "../search-job";
+import { extractRowText } from "../terminal-row";
+import { convertCompactRows } from "../ghostty-emulator/cell-converter";
 import { fetchScrollbackLine } from "./scrollback";
 import { getCursorSnapshot } from "./cursor";
 import { prepareEmulatorUpdate } from "./emulator-updates";
 import { HOT_SCROLLBACK_LIMIT } from "../scrollback-config";
 import {
   applyColorRemapToRow,
+  applyColorRemapToTerminalRow,
   buildColorRemap,
   buildOscColorSequence,
   cloneColors,
@@ -63,7 +79,10 @@ export class GhosttyVTEmulatorCore {
 
   private scrollbackCache = new ScrollbackCache(1000);
   private scrollbackSnapshotDirty = true;
-  private decoder = new TextDecoder();
+
+  /** Line numbering: see getLineNumbering. */
+  private lineEpoch = 0;
+  private linesDropped = 0;
 
   constructor(cols: number, rows: number, colors: TerminalColors) {
     this._cols = cols;
@@ -109,17 +128,28 @@ export class GhosttyVTEmulatorCore {
     return this._disposed;
   }
 
-  write(data: string | Uint8Array): void {
+  write(data: string | Uint8Array, hints?: EmulatorWriteHints): void {
     if (this._disposed) return;
 
-    const text = typeof data === "string" ? data : this.decoder.decode(data);
-    if (text.length === 0) return;
+    // Raw UTF-8 flows straight through to ghostty; strings are encoded once.
+    const bytes = toBytes(data);
+    if (bytes.length === 0) return;
 
-    this.titleParser.processData(text);
-    const stripped = stripProblematicOscSequences(text);
+    // Titles and stripped codes are OSCs; both scans are skipped without one
+    const mayContainOsc = hints?.mayContainOsc ?? true;
+    if (mayContainOsc) {
+      this.titleParser.processData(bytes);
+    }
+    const stripped = mayContainOsc ? stripProblematicOscSequences(bytes) : bytes;
     if (stripped.length > 0) {
       this.scrollbackSnapshotDirty = true;
+      const scrollbackBefore = this.terminal.getScrollbackLength();
       this.terminal.write(stripped);
+      // Only trimScrollback shortens the scrollback from the top; anything
+      // else that shrinks it (clearing it, switching screens) renumbers lines.
+      if (this.terminal.getScrollbackLength() < scrollbackBefore) {
+        this.lineEpoch += 1;
+      }
       if (!this.updatesEnabled) {
         this.needsFullRefresh = true;
         return;
@@ -138,6 +168,8 @@ export class GhosttyVTEmulatorCore {
     if (this._disposed) return;
     if (cols === this._cols && rows === this._rows) return;
 
+    // Reflow moves lines between rows
+    if (cols !== this._cols) this.lineEpoch += 1;
     this._cols = cols;
     this._rows = rows;
     this.scrollbackSnapshotDirty = true;
@@ -160,6 +192,7 @@ export class GhosttyVTEmulatorCore {
   reset(): void {
     if (this._disposed) return;
     this.terminal.write("\x1bc");
+    this.lineEpoch += 1;
     this.currentTitle = "";
     this.scrollbackCache.clear();
     this.scrollbackSnapshotDirty = true;
@@ -198,6 +231,31 @@ export class GhosttyVTEmulatorCore {
     return this.fetchScrollbackLine(offset);
   }
 
+  getLineNumbering(): LineNumbering {
+    return { epoch: this.lineEpoch, dropped: this.linesDropped };
+  }
+
+  isScrollbackLineWrapped(offset: number): boolean {
+    if (this._disposed) return false;
+    return this.terminal.isScrollbackRowWrapped(offset);
+  }
+
+  getOldestScrollbackRows(count: number): { rows: TerminalRow[]; wrapped: boolean[] } | null {
+    if (this._disposed || count <= 0) return null;
+    if (this.scrollbackSnapshotDirty) {
+      this.terminal.update();
+      this.scrollbackSnapshotDirty = false;
+    }
+    const frame = this.terminal.getScrollbackCompact(count);
+    if (!frame) return null;
+
+    const rows = convertCompactRows(frame, this._cols);
+    if (this.colorRemap) {
+      for (const row of rows) applyColorRemapToTerminalRow(row, this.colorRemap);
+    }
+    return { rows, wrapped: Array.from(frame.wrapped, (flag) => flag !== 0) };
+  }
+
   getDirtyUpdate(scrollState: TerminalScrollState): DirtyTerminalUpdate {
     this.scrollState = scrollState;
 
@@ -226,7 +284,9 @@ export class GhosttyVTEmulatorCore {
   trimScrollback(lines: number): void {
     if (this._disposed) return;
     if (lines <= 0) return;
+    const scrollbackBefore = this.terminal.getScrollbackLength();
     this.terminal.trimScrollback(lines);
+    this.linesDropped += scrollbackBefore - this.terminal.getScrollbackLength();
     this.scrollbackCache.clear();
     this.scrollbackSnapshotDirty = true;
     this.scrollState = {
@@ -367,15 +427,96 @@ export class GhosttyVTEmulatorCore {
   // Search
   // ==========================================================================
 
-  async search(query: string, options?: { limit?: number }): Promise<SearchResult> {
-    return searchTerminal(query, options, {
-      getScrollbackLength: () => this.terminal.getScrollbackLength(),
-      getScrollbackLine: (offset) => this.fetchScrollbackLine(offset),
-      getTerminalState: () => this.getTerminalState(),
-      createEmptyRow: (cols) => createEmptyRow(cols, this.colors),
+  async search(query: string, options?: SearchOptions): Promise<SearchResult> {
+    if (!query || this._disposed) {
+      return { matches: [], hasMore: false };
+    }
+    const length = this.terminal.getScrollbackLength() + this._rows;
+    return runNumberedSearch(() => this.getLineNumbering(), () => {
+      if (options?.regex) {
+        return this.searchRegex(query, options, length);
+      }
+      return runSearchJob(options, length, (start, end, limit) => {
+        if (this._disposed) return { matches: [], hasMore: false };
+        return this.terminal.search(query, limit, start, end)
+          ?? searchLines(query, limit, start, end, this.searchLineReader(extractLineText, extractRowText));
+      });
     });
   }
 
+  compileSearchPattern(pattern: string): GhosttyRegex | null {
+    return GhosttyRegex.compile(pattern, SearchFlags.CASE_INSENSITIVE);
+  }
+
+  /**
+   * Regex search over logical lines. The pattern is compiled once per job
+   * and run natively over each step's rows. Falls back to a per-line JS
+   * RegExp when the native engine rejects the pattern or is unavailable.
+   */
+  private async searchRegex(pattern: string, options: SearchOptions, length: number): Promise<SearchResult> {
+    const regex = this.compileSearchPattern(pattern);
+    if (!regex) {
+      const fallback = compileSearchRegex(pattern);
+      if (!fallback) {
+        return { matches: [], hasMore: false };
+      }
+      return runSearchJob(options, length, (start, end, limit) =>
+        searchLinesRegex(fallback, limit, start, end, this.searchLineReader(cellsLineText, rowLineText))
+      );
+    }
+
+    try {
+      return await runSearchJob(options, length, (start, end, limit) =>
+        this.searchRegexRange(regex, start, end, limit)
+      );
+    } finally {
+      regex.free();
+    }
+  }
+
+  /**
+   * Native regex search over rows [start, end). The native search begins at
+   * the logical line holding `start` and finishes the one crossing `end`, so
+   * only row segments inside the range are kept.
+   */
+  private searchRegexRange(regex: GhosttyRegex, start: number, end: number, limit: number): SearchResult {
+    const matches: SearchResult["matches"] = [];
+    if (this._disposed) {
+      return { matches, hasMore: false };
+    }
+
+    const cursor = createSearchCursor(start);
+    const inRange = () => !isSearchCursorDone(cursor) && searchCursorLine(cursor) < end;
+    do {
+      const maxRows = end - searchCursorLine(cursor);
+      const step = this.terminal.searchRegexStep(regex, cursor, limit - matches.length, maxRows);
+      if (!step) break;
+      for (const match of step) {
+        if (match.lineIndex < end) matches.push(match);
+      }
+    } while (inRange() && matches.length < limit);
+
+    return { matches, hasMore: inRange() };
+  }
+
+  /** Read lines by absolute index for the JS search fallbacks. */
+  private searchLineReader<T>(
+    fromCells: (cells: TerminalCell[]) => T,
+    fromRow: (row: TerminalRow) => T
+  ): (index: number) => T | null {
+    const scrollbackLength = this.terminal.getScrollbackLength();
+    let state: TerminalState | null = null;
+    return (index) => {
+      if (index < scrollbackLength) {
+        const cells = this.fetchScrollbackLine(index);
+        return cells ? fromCells(cells) : null;
+      }
+      state ??= this.getTerminalState();
+      const row = state.cells[index - scrollbackLength];
+      return row ? fromRow(row) : null;
+    };
+  }
+
   // ==========================================================================
   // Internal helpers
   // ==========================================================================
@@ -426,6 +567,10 @@ export class GhosttyVTEmulatorCore {
       result.prevModes.alternateScreen !== result.modes.alternateScreen ||
       result.prevModes.inBandResize !== result.modes.inBandResize
     ) {
+      if (result.prevModes.alternateScreen !== result.modes.alternateScreen) {
+        // Line indexes now refer to the other screen
+        this.lineEpoch += 1;
+      }
       this.modes = result.modes;
       for (const callback of this.modeChangeCallbacks) {
         callback(result.modes, result.prevModes);
@@ -456,14 +601,14 @@ export class GhosttyVTEmulatorCore {
 
     if (pending.fullState) {
       for (const row of pending.fullState.cells) {
-        applyColorRemapToRow(row, remap);
+        applyColorRemapToTerminalRow(row, remap);
       }
       return;
     }
 
     if (pending.dirtyRows.size > 0) {
       for (const row of pending.dirtyRows.values()) {
-        applyColorRemapToRow(row, remap);
+        applyColorRemapToTerminalRow(row, remap);
       }
     }
   }
@@ -63,14 +63,22 @@ export function prepareEmulatorUpdate(params: PrepareEmulatorUpdateParams): Prep
     isAtScrollbackLimit,
   };
 
-  const shouldBuildFull = forceFull || dirtyState === DirtyState.FULL || !cachedState;
-  const viewport = shouldBuildFull || dirtyState !== DirtyState.NONE
-    ? terminal.getViewport()
+  let shouldBuildFull = forceFull || dirtyState === DirtyState.FULL || !cachedState;
+  const needsRows = shouldBuildFull || dirtyState !== DirtyState.NONE;
+  // Style-interned export; partial updates only convert the rows ghostty marked dirty
+  const compact = needsRows ? terminal.getViewportCompact(!shouldBuildFull) : null;
+  const dirtyRowCells = needsRows && !compact && !shouldBuildFull
+    ? terminal.getDirtyRows()
     : null;
+  if (needsRows && !compact && !dirtyRowCells) {
+    shouldBuildFull = true;
+  }
+  const viewport = shouldBuildFull && !compact ? terminal.getViewport() : null;
 
   const { cachedState: nextCachedState, dirtyRows, fullState } = buildDirtyState({
-    terminal,
+    compact,
     viewport,
+    dirtyRowCells,
     cols,
     rows,
     colors,
@@ -13,39 +13,60 @@ import { drainTerminalResponses } from "./responses";
 import { GhosttyVTEmulatorCore } from "./emulator-core";
 
 export class GhosttyVTEmulator extends GhosttyVTEmulatorCore implements ITerminalEmulator {
+  private kittyGeneration = 0;
+  private kittyAcknowledged = 0;
+  private kittyImages = new Map<number, KittyGraphicsImageInfo>();
+  private kittyPlacements: KittyGraphicsPlacement[] = [];
+
   getKittyKeyboardFlags(): number {
     if (this._disposed) return 0;
     return this.terminal.getKittyKeyboardFlags();
   }
 
+  /**
+   * Kitty state is synced from one native snapshot per generation. The
+   * dirty flag is derived from generations rather than the native flag, so
+   * a change landing between a read and clearKittyImagesDirty is not lost.
+   */
   getKittyImagesDirty(): boolean {
     if (this._disposed) return false;
-    return this.terminal.getKittyImagesDirty();
+    this.syncKitty();
+    return this.kittyGeneration !== this.kittyAcknowledged;
   }
 
   clearKittyImagesDirty(): void {
     if (this._disposed) return;
-    this.terminal.clearKittyImagesDirty();
+    this.kittyAcknowledged = this.kittyGeneration;
   }
 
   getKittyImageIds(): number[] {
     if (this._disposed) return [];
-    return this.terminal.getKittyImageIds();
+    this.syncKitty();
+    return Array.from(this.kittyImages.keys());
   }
 
   getKittyImageInfo(imageId: number): KittyGraphicsImageInfo | null {
     if (this._disposed) return null;
-    return mapKittyImageInfo(this.terminal, imageId);
+    return this.kittyImages.get(imageId) ?? null;
   }
 
   getKittyImageData(imageId: number): Uint8Array | null {
     if (this._disposed) return null;
-    return this.terminal.getKittyImageData(imageId);
+    return this.terminal.getKittyImageData(imageId, this.kittyImages.get(imageId)?.dataLength);
   }
 
   getKittyPlacements(): KittyGraphicsPlacement[] {
     if (this._disposed) return [];
-    return mapKittyPlacements(this.terminal);
+    this.syncKitty();
+    return this.kittyPlacements;
+  }
+
+  private syncKitty(): void {
+    const snapshot = this.terminal.getKittySnapshot(this.kittyGeneration);
+    if (!snapshot) return;
+    this.kittyGeneration = snapshot.generation;
+    this.kittyImages = new Map(snapshot.images.map((info) => [info.id, mapKittyImageInfo(info)]));
+    this.kittyPlacements = mapKittyPlacements(snapshot.placements);
   }
 
   drainResponses(): string[] {
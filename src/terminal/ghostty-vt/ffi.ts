@@ -83,6 +83,12 @@ export const ghostty = dlopen(libPath, {
     args: [FFIType.pointer, FFIType.pointer, FFIType.i32],
     returns: FFIType.void,
   },
+  ghostty_prefilter_new: { args: [], returns: FFIType.pointer },
+  ghostty_prefilter_free: { args: [FFIType.pointer], returns: FFIType.void },
+  ghostty_prefilter_scan: {
+    args: [FFIType.pointer, FFIType.pointer, FFIType.i32],
+    returns: FFIType.u32,
+  },
   ghostty_render_state_update: {
     args: [FFIType.pointer],
     returns: FFIType.i32,
@@ -127,6 +133,24 @@ export const ghostty = dlopen(libPath, {
     args: [FFIType.pointer, FFIType.pointer, FFIType.i32],
     returns: FFIType.i32,
   },
+  ghostty_render_state_get_dirty_rows: {
+    args: [FFIType.pointer, FFIType.pointer, FFIType.i32, FFIType.pointer, FFIType.i32],
+    returns: FFIType.i32,
+  },
+  ghostty_render_state_get_viewport_compact: {
+    args: [
+      FFIType.pointer,
+      FFIType.bool,
+      FFIType.pointer,
+      FFIType.i32,
+      FFIType.pointer,
+      FFIType.i32,
+      FFIType.pointer,
+      FFIType.i32,
+      FFIType.pointer,
+    ],
+    returns: FFIType.i32,
+  },
   ghostty_render_state_get_grapheme: {
     args: [FFIType.pointer, FFIType.i32, FFIType.i32, FFIType.pointer, FFIType.i32],
     returns: FFIType.i32,
@@ -163,6 +187,63 @@ export const ghostty = dlopen(libPath, {
     args: [FFIType.pointer, FFIType.i32],
     returns: FFIType.bool,
   },
+  ghostty_terminal_is_scrollback_row_wrapped: {
+    args: [FFIType.pointer, FFIType.i32],
+    returns: FFIType.bool,
+  },
+  ghostty_terminal_get_scrollback_compact: {
+    args: [
+      FFIType.pointer,
+      FFIType.u32,
+      FFIType.pointer,
+      FFIType.i32,
+      FFIType.pointer,
+      FFIType.i32,
+      FFIType.pointer,
+      FFIType.pointer,
+    ],
+    returns: FFIType.i32,
+  },
+  ghostty_terminal_search: {
+    args: [
+      FFIType.pointer,
+      FFIType.pointer,
+      FFIType.i32,
+      FFIType.u32,
+      FFIType.pointer,
+      FFIType.pointer,
+      FFIType.i32,
+      FFIType.u32,
+    ],
+    returns: FFIType.i32,
+  },
+  ghostty_regex_new: {
+    args: [FFIType.pointer, FFIType.i32, FFIType.u32],
+    returns: FFIType.pointer,
+  },
+  ghostty_regex_free: { args: [FFIType.pointer], returns: FFIType.void },
+  ghostty_regex_search_text: {
+    args: [
+      FFIType.pointer,
+      FFIType.pointer,
+      FFIType.i32,
+      FFIType.i32,
+      FFIType.pointer,
+      FFIType.i32,
+    ],
+    returns: FFIType.i32,
+  },
+  ghostty_terminal_search_regex: {
+    args: [
+      FFIType.pointer,
+      FFIType.pointer,
+      FFIType.pointer,
+      FFIType.pointer,
+      FFIType.i32,
+      FFIType.u32,
+    ],
+    returns: FFIType.i32,
+  },
   ghostty_terminal_has_response: {
     args: [FFIType.pointer],
     returns: FFIType.bool,
@@ -207,6 +288,18 @@ export const ghostty = dlopen(libPath, {
     args: [FFIType.pointer, FFIType.pointer, FFIType.i32],
     returns: FFIType.i32,
   },
+  ghostty_terminal_get_kitty_snapshot: {
+    args: [
+      FFIType.pointer,
+      FFIType.u64,
+      FFIType.pointer,
+      FFIType.i32,
+      FFIType.pointer,
+      FFIType.i32,
+      FFIType.pointer,
+    ],
+    returns: FFIType.i32,
+  },
   ghostty_key_event_new: {
     args: [FFIType.pointer, FFIType.pointer],
     returns: FFIType.i32,
@@ -3,9 +3,12 @@
  */
 
 export { GhosttyVtTerminal } from "./terminal";
-export { CellFlags, DirtyState } from "./types";
+export { GhosttyPrefilter } from "./prefilter";
+export { CellFlags, CompactStyleAttrs, DirtyState, PrefilterScanFlags } from "./types";
 export type {
   GhosttyCell,
+  GhosttyCompactFrame,
+  GhosttyDirtyRows,
   GhosttyTerminalConfig,
   GhosttyKittyImageInfo,
   GhosttyKittyPlacement,
@@ -5,15 +5,9 @@ import type {
   KittyGraphicsPlacement,
   KittyGraphicsPlacementTag,
 } from '../emulator-interface';
-import type { GhosttyVtTerminal } from './terminal';
-
-export function mapKittyImageInfo(
-  terminal: GhosttyVtTerminal,
-  imageId: number
-): KittyGraphicsImageInfo | null {
-  const info = terminal.getKittyImageInfo(imageId);
-  if (!info) return null;
+import type { GhosttyKittyImageInfo, GhosttyKittyPlacement } from './types';
 
+export function mapKittyImageInfo(info: GhosttyKittyImageInfo): KittyGraphicsImageInfo {
   return {
     id: info.id,
     number: info.number,
@@ -27,8 +21,7 @@ export function mapKittyImageInfo(
   };
 }
 
-export function mapKittyPlacements(terminal: GhosttyVtTerminal): KittyGraphicsPlacement[] {
-  const placements = terminal.getKittyPlacements();
+export function mapKittyPlacements(placements: GhosttyKittyPlacement[]): KittyGraphicsPlacement[] {
   return placements.map((placement) => ({
     imageId: placement.image_id,
     placementId: placement.placement_id,
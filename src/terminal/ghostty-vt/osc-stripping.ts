@@ -6,6 +6,22 @@
  * the title parser, and OSC queries are handled by passthrough.
  */
 
+import { concatBytes, decodeUtf8, encodeUtf8, BYTE_BEL, BYTE_ESC } from '../byte-utils';
+
+const OSC_BRACKET = 0x5d; // ']'
+const OSC_SEMICOLON = 0x3b; // ';'
+const OSC_QUERY = 0x3f; // '?'
+const ST_BACKSLASH = 0x5c; // '\\'
+
+const STRIP_CODES = new Set([
+  0, 1, 2,
+  7,
+  9,
+  10, 11, 12,
+  22, 23,
+  777,
+]);
+
 /**
  * Strip OSC sequences that can cause screen flash/flicker or unwanted state.
  *
@@ -18,69 +34,83 @@
  *
  * Note: Query sequences (with ?) are handled by query passthrough on main thread.
  * This only strips SET commands that go directly to the emulator.
+ *
+ * The byte form returns the input view unchanged when nothing is stripped.
  */
-export function stripProblematicOscSequences(text: string): string {
-  const ESC = '\x1b';
-  const BEL = '\x07';
-
-  const stripCodes = new Set([
-    0, 1, 2,
-    7,
-    9,
-    10, 11, 12,
-    22, 23,
-    777,
-  ]);
-
-  let result = '';
-  let i = 0;
-
-  while (i < text.length) {
-    if (text[i] === ESC && i + 1 < text.length && text[i + 1] === ']') {
-      let pos = i + 2;
-      let codeStr = '';
+export function stripProblematicOscSequences(data: Uint8Array): Uint8Array;
+export function stripProblematicOscSequences(text: string): string;
+export function stripProblematicOscSequences(data: string | Uint8Array): string | Uint8Array {
+  if (typeof data === 'string') {
+    return decodeUtf8(stripOscBytes(encodeUtf8(data)));
+  }
+  return stripOscBytes(data);
+}
 
-      while (pos < text.length && /\d/.test(text[pos])) {
-        codeStr += text[pos];
-        pos++;
-      }
+function stripOscBytes(data: Uint8Array): Uint8Array {
+  const len = data.length;
+  let spans: Uint8Array[] | null = null;
+  let spanStart = 0;
+  let keptLength = 0;
 
-      const code = parseInt(codeStr, 10);
+  let i = data.indexOf(BYTE_ESC);
+  while (i !== -1 && i < len) {
+    if (i + 1 >= len || data[i + 1] !== OSC_BRACKET) {
+      i = data.indexOf(BYTE_ESC, i + 1);
+      continue;
+    }
 
-      if (codeStr.length > 0 && stripCodes.has(code)) {
-        const isColorCode = code === 10 || code === 11 || code === 12;
+    let pos = i + 2;
+    let code = 0;
+    const codeStart = pos;
+    while (pos < len && data[pos] >= 0x30 && data[pos] <= 0x39) {
+      code = code * 10 + (data[pos] - 0x30);
+      pos++;
+    }
 
-        if (isColorCode) {
-          if (pos < text.length && text[pos] === ';') {
-            if (pos + 1 < text.length && text[pos + 1] === '?') {
-              result += text[i];
-              i++;
-              continue;
-            }
-          }
-        }
+    if (pos === codeStart || !STRIP_CODES.has(code)) {
+      i = data.indexOf(BYTE_ESC, i + 1);
+      continue;
+    }
 
-        while (pos < text.length) {
-          if (text[pos] === BEL) {
-            i = pos + 1;
-            break;
-          }
-          if (text[pos] === ESC && pos + 1 < text.length && text[pos + 1] === '\\') {
-            i = pos + 2;
-            break;
-          }
-          pos++;
-        }
+    const isColorCode = code === 10 || code === 11 || code === 12;
+    if (isColorCode && pos + 1 < len && data[pos] === OSC_SEMICOLON && data[pos + 1] === OSC_QUERY) {
+      // Color query - left for the passthrough/emulator
+      i = data.indexOf(BYTE_ESC, i + 1);
+      continue;
+    }
 
-        if (i > pos - 1) {
-          continue;
-        }
+    let end = -1;
+    while (pos < len) {
+      if (data[pos] === BYTE_BEL) {
+        end = pos + 1;
+        break;
+      }
+      if (data[pos] === BYTE_ESC && pos + 1 < len && data[pos + 1] === ST_BACKSLASH) {
+        end = pos + 2;
+        break;
       }
+      pos++;
     }
 
-    result += text[i];
-    i++;
+    if (end === -1) {
+      // Unterminated - keep as-is
+      i = data.indexOf(BYTE_ESC, i + 1);
+      continue;
+    }
+
+    spans ??= [];
+    if (i > spanStart) {
+      spans.push(data.subarray(spanStart, i));
+      keptLength += i - spanStart;
+    }
+    spanStart = end;
+    i = data.indexOf(BYTE_ESC, end);
   }
 
-  return result;
+  if (!spans) return data;
+  if (spanStart < len) {
+    spans.push(data.subarray(spanStart));
+    keptLength += len - spanStart;
+  }
+  return concatBytes(spans, keptLength);
 }
@@ -0,0 +1,42 @@
+/**
+ * Native single-pass pre-filter for PTY output.
+ *
+ * One scan per chunk reports which escape sequences it contains (titles,
+ * cwd, notifications, sync mode, ED 3, kitty APCs, focus tracking, queries),
+ * so the data handler can skip the JS stages that have nothing to do.
+ * Parser state carries across chunks inside the native scanner.
+ */
+
+import { ghostty } from "./ffi";
+import type { Pointer } from "bun:ffi";
+import { toBuffer } from "./terminal";
+
+export class GhosttyPrefilter {
+  private handle: Pointer | null;
+
+  private constructor(handle: Pointer) {
+    this.handle = handle;
+  }
+
+  /** Create a pre-filter, or null when the native scanner is unavailable. */
+  static create(): GhosttyPrefilter | null {
+    const handle = ghostty.symbols.ghostty_prefilter_new?.();
+    return handle ? new GhosttyPrefilter(handle) : null;
+  }
+
+  /**
+   * Scan a chunk and return its PrefilterScanFlags.
+   * After free() (the session is closing) chunks report no flags.
+   */
+  scan(data: Uint8Array): number {
+    if (!this.handle || data.length === 0) return 0;
+    const buffer = toBuffer(data);
+    return ghostty.symbols.ghostty_prefilter_scan(this.handle, buffer, buffer.byteLength);
+  }
+
+  free(): void {
+    if (!this.handle) return;
+    ghostty.symbols.ghostty_prefilter_free(this.handle);
+    this.handle = null;
+  }
+}
@@ -0,0 +1,95 @@
+/**
+ * Native compiled search pattern.
+ *
+ * Patterns are compiled once per query (Oniguruma syntax) and evaluated by
+ * GhosttyVtTerminal.searchRegexStep() over soft-wrapped logical lines, or
+ * by searchText() over lines the caller joined itself.
+ */
+
+import { ghostty } from "./ffi";
+import type { Pointer } from "bun:ffi";
+import type { SearchFlags } from "./types";
+
+/** Matches read back per native call. */
+const TEXT_RANGES_PER_CALL = 64;
+
+export class GhosttyRegex {
+  private _handle: Pointer | null;
+
+  private constructor(handle: Pointer) {
+    this._handle = handle;
+  }
+
+  /** Compile a pattern, or null when it is invalid or regex search is unavailable. */
+  static compile(pattern: string, flags: SearchFlags | 0 = 0): GhosttyRegex | null {
+    if (!ghostty.symbols.ghostty_regex_new) return null;
+    const source = Buffer.from(pattern, "utf8");
+    if (source.byteLength === 0) return null;
+    const handle = ghostty.symbols.ghostty_regex_new(source, source.byteLength, flags);
+    return handle ? new GhosttyRegex(handle) : null;
+  }
+
+  get handle(): Pointer | null {
+    return this._handle;
+  }
+
+  /**
+   * Non-empty matches in `text`, as [start, end) UTF-16 indexes. Returns
+   * null when the native search is unavailable or fails.
+   */
+  searchText(text: string): Array<[number, number]> | null {
+    if (!this._handle || !ghostty.symbols.ghostty_regex_search_text) return null;
+    const bytes = Buffer.from(text, "utf8");
+    const ranges = new Uint32Array(TEXT_RANGES_PER_CALL * 2);
+    const matches: Array<[number, number]> = [];
+    let from = 0;
+    while (from < bytes.byteLength) {
+      const written = ghostty.symbols.ghostty_regex_search_text(
+        this._handle,
+        bytes,
+        bytes.byteLength,
+        from,
+        ranges,
+        TEXT_RANGES_PER_CALL
+      );
+      if (written < 0) return null;
+      for (let i = 0; i < written; i++) {
+        matches.push([ranges[i * 2], ranges[i * 2 + 1]]);
+      }
+      if (written < TEXT_RANGES_PER_CALL) break;
+      from = ranges[written * 2 - 1];
+    }
+    if (matches.length === 0 || bytes.byteLength === text.length) return matches;
+
+    // Map byte offsets to UTF-16 indexes
+    const units = new Uint32Array(bytes.byteLength + 1);
+    let byte = 0;
+    for (let index = 0; index < text.length; index++) {
+      const code = text.charCodeAt(index);
+      units[byte] = index;
+      if (code < 0x80) {
+        byte += 1;
+      } else if (code < 0x800) {
+        byte += 2;
+      } else if (code >= 0xd800 && code <= 0xdbff && isLowSurrogate(text.charCodeAt(index + 1))) {
+        // One 4-byte sequence for the pair
+        byte += 4;
+        index++;
+      } else {
+        byte += 3;
+      }
+    }
+    units[byte] = text.length;
+    return matches.map(([start, end]) => [units[start], units[end]]);
+  }
+
+  free(): void {
+    if (!this._handle) return;
+    ghostty.symbols.ghostty_regex_free(this._handle);
+    this._handle = null;
+  }
+}
+
+function isLowSurrogate(code: number): boolean {
+  return code >= 0xdc00 && code <= 0xdfff;
+}
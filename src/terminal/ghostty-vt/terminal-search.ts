@@ -2,49 +2,39 @@
  * Search helpers for Ghostty VT terminal emulation.
  */
 
-import type { TerminalCell, TerminalState } from '../../core/types';
+import type { TerminalCell, TerminalRow } from '../../core/types';
 import type { SearchMatch, SearchResult } from '../emulator-interface';
-import { extractLineText } from './utils';
+import { codepointString } from '../terminal-row';
 
-export function searchTerminal(
+/**
+ * Case-insensitive substring search over lines [start, end). `getText`
+ * returns a line's text with one character per cell.
+ */
+export function searchLines(
   query: string,
-  options: { limit?: number } | undefined,
-  source: {
-    getScrollbackLength: () => number;
-    getScrollbackLine: (offset: number) => TerminalCell[] | null;
-    getTerminalState: () => TerminalState;
-    createEmptyRow: (cols: number) => TerminalCell[];
-  }
+  limit: number,
+  start: number,
+  end: number,
+  getText: (index: number) => string | null
 ): SearchResult {
-  const limit = options?.limit ?? 500;
   const matches: SearchMatch[] = [];
-  let hasMore = false;
-
   if (!query) {
-    return { matches, hasMore };
+    return { matches, hasMore: false };
   }
 
   const lowerQuery = query.toLowerCase();
-  const scrollbackLength = source.getScrollbackLength();
-
-  for (let offset = 0; offset < scrollbackLength; offset++) {
-    if (matches.length >= limit) {
-      hasMore = true;
-      break;
-    }
-
-    const cells = source.getScrollbackLine(offset);
-    if (!cells) continue;
+  for (let index = start; index < end; index++) {
+    const text = getText(index);
+    if (text === null) continue;
 
-    const text = extractLineText(cells).toLowerCase();
+    const lowerText = text.toLowerCase();
     let pos = 0;
-    while ((pos = text.indexOf(lowerQuery, pos)) !== -1) {
+    while ((pos = lowerText.indexOf(lowerQuery, pos)) !== -1) {
       if (matches.length >= limit) {
-        hasMore = true;
-        break;
+        return { matches, hasMore: true };
       }
       matches.push({
-        lineIndex: offset,
+        lineIndex: index,
         startCol: pos,
         endCol: pos + query.length,
       });
@@ -52,22 +42,174 @@ export function searchTerminal(
     }
   }
 
-  if (!hasMore) {
-    const state = source.getTerminalState();
-    for (let y = 0; y < state.rows; y++) {
-      const line = state.cells[y] ?? source.createEmptyRow(state.cols);
-      const text = extractLineText(line).toLowerCase();
-      let pos = 0;
-      while ((pos = text.indexOf(lowerQuery, pos)) !== -1) {
-        matches.push({
-          lineIndex: scrollbackLength + y,
-          startCol: pos,
-          endCol: pos + query.length,
-        });
-        pos += 1;
+  return { matches, hasMore: false };
+}
+
+/** Line text plus the cell column of each UTF-16 code unit; the extra last entry is the end column. */
+export interface SearchLineText {
+  text: string;
+  columns: number[];
+}
+
+function buildLineText(count: number, charAt: (x: number) => string, widthAt: (x: number) => number): SearchLineText {
+  let text = '';
+  const columns: number[] = [];
+  let endCol = 0;
+  let endIndex = 0;
+  for (let x = 0; x < count; x++) {
+    const char = charAt(x);
+    const width = widthAt(x) === 2 ? 2 : 1;
+    for (let k = 0; k < char.length; k++) columns.push(x);
+    text += char;
+    // Trailing blanks are dropped so `$` anchors at the last written cell
+    if (char !== ' ') {
+      endCol = x + width;
+      endIndex = text.length;
+    }
+    if (width === 2) x++;
+  }
+  columns.length = endIndex;
+  columns.push(endCol);
+  return { text: text.slice(0, endIndex), columns };
+}
+
+export function cellsLineText(cells: TerminalCell[]): SearchLineText {
+  return buildLineText(cells.length, (x) => cells[x].char, (x) => cells[x].width);
+}
+
+export function rowLineText(row: TerminalRow): SearchLineText {
+  return buildLineText(row.codepoints.length, (x) => codepointString(row.codepoints[x]), (x) => row.widths[x]);
+}
+
+/**
+ * Compile a case-insensitive search pattern, or null when it is invalid.
+ */
+export function compileSearchRegex(pattern: string): RegExp | null {
+  if (!pattern) return null;
+  try {
+    return new RegExp(pattern, 'giu');
+  } catch {
+    return null;
+  }
+}
+
+/**
+ * Regex search over physical lines [start, end). Used when native regex
+ * search is unavailable; lines are matched one at a time (no soft-wrap
+ * joining).
+ */
+export function searchLinesRegex(
+  regex: RegExp,
+  limit: number,
+  start: number,
+  end: number,
+  getLine: (index: number) => SearchLineText | null
+): SearchResult {
+  const matches: SearchMatch[] = [];
+
+  for (let index = start; index < end; index++) {
+    const line = getLine(index);
+    if (!line) continue;
+
+    for (const [from, to] of regexMatches(regex, line.text)) {
+      if (matches.length >= limit) {
+        return { matches, hasMore: true };
+      }
+      matches.push({
+        lineIndex: index,
+        startCol: line.columns[from],
+        endCol: line.columns[to],
+      });
+    }
+  }
+
+  return { matches, hasMore: false };
+}
+
+/** Non-empty matches of a compiled search regex as [start, end) indexes. */
+export function regexMatches(regex: RegExp, text: string): Array<[number, number]> {
+  const ranges: Array<[number, number]> = [];
+  regex.lastIndex = 0;
+  let match: RegExpExecArray | null;
+  while ((match = regex.exec(text)) !== null) {
+    if (match[0].length === 0) {
+      // Step over the empty match (a full code point under the u flag)
+      regex.lastIndex += (text.codePointAt(match.index) ?? 0) > 0xffff ? 2 : 1;
+      continue;
+    }
+    ranges.push([match.index, match.index + match[0].length]);
+  }
+  return ranges;
+}
+
+/**
+ * Regex search over rows [start, end) with soft-wrapped rows joined into
+ * logical lines, like the native terminal search; used for the disk
+ * archive. Matching begins at the logical line holding `start` and
+ * finishes the one crossing `end`, keeping only row segments inside the
+ * range, so a match crossing a wrap point is reported once per row.
+ * `matchText` returns a line's matches as [start, end) indexes.
+ */
+export function searchWrappedLinesRegex(
+  matchText: (text: string) => Array<[number, number]>,
+  limit: number,
+  start: number,
+  end: number,
+  getLine: (index: number) => TerminalCell[] | null,
+  isWrapped: (index: number) => boolean
+): SearchResult {
+  const matches: SearchMatch[] = [];
+  let index = start;
+  while (index > 0 && isWrapped(index - 1)) index--;
+
+  while (index < end) {
+    // Row, start column and end column of each UTF-16 code unit
+    let text = '';
+    const rows: number[] = [];
+    const starts: number[] = [];
+    const ends: number[] = [];
+    let wraps = true;
+    for (; wraps; index++) {
+      const cells = getLine(index);
+      if (!cells) {
+        index++;
+        break;
+      }
+      wraps = isWrapped(index);
+      // Trailing blanks are dropped unless the row wraps, so `$` anchors at
+      // the last written cell
+      let used = cells.length;
+      if (!wraps) {
+        while (used > 0 && (cells[used - 1].char === ' ' || cells[used - 1].char === '')) used--;
+      }
+      for (let x = 0; x < used; x++) {
+        const char = cells[x].char || ' ';
+        const width = cells[x].width === 2 ? 2 : 1;
+        for (let k = 0; k < char.length; k++) {
+          rows.push(index);
+          starts.push(x);
+          ends.push(Math.min(x + width, cells.length));
+        }
+        text += char;
+        if (width === 2) x++;
+      }
+    }
+
+    for (const [from, to] of matchText(text)) {
+      let segment = from;
+      for (let i = from; i < to; i++) {
+        if (i + 1 < to && rows[i + 1] === rows[segment]) continue;
+        const lineIndex = rows[segment];
+        if (lineIndex >= start && lineIndex < end) {
+          if (matches.length >= limit) {
+            return { matches, hasMore: true };
+          }
+          matches.push({ lineIndex, startCol: starts[segment], endCol: ends[i] });
+        }
+        segment = i + 1;
       }
     }
   }
 
-  return { matches, hasMore };
+  return { matches, hasMore: false };
 }
@@ -7,29 +7,87 @@ import type { Pointer } from "bun:ffi";
 import type {
   DirtyState,
   GhosttyCell,
+  GhosttyCompactFrame,
+  GhosttyDirtyRows,
+  GhosttyScrollbackFrame,
   GhosttyTerminalConfig,
   GhosttyKittyImageInfo,
   GhosttyKittyPlacement,
+  GhosttyKittySnapshot,
 } from "./types";
+import { SearchFlags } from "./types";
+import type { SearchMatch, SearchResult } from "../emulator-interface";
+import type { GhosttyRegex } from "./regex";
 
 const CELL_SIZE = 16;
+const COMPACT_CELL_SIZE = 8;
+const COMPACT_STYLE_SIZE = 8;
 const CONFIG_SIZE = 4 * 4 + 16 * 4;
 const KITTY_IMAGE_INFO_SIZE = 32;
 const KITTY_PLACEMENT_SIZE = 56;
-
-function toBuffer(data: Uint8Array): Buffer {
+const KITTY_SNAPSHOT_SIZE = 16;
+const KITTY_SNAPSHOT_INITIAL = 8;
+const SEARCH_MATCH_SIZE = 8;
+const SEARCH_CURSOR_SIZE = 8;
+const SEARCH_CURSOR_DONE = 6;
+const SEARCH_BATCH = 256;
+
+export function toBuffer(data: Uint8Array): Buffer {
   return Buffer.isBuffer(data)
     ? data
     : Buffer.from(data.buffer, data.byteOffset, data.byteLength);
 }
 
+/** Allocate a native search cursor positioned at `line` (0 = oldest line). */
+export function createSearchCursor(line = 0): Buffer {
+  const cursor = Buffer.alloc(SEARCH_CURSOR_SIZE);
+  cursor.writeUInt32LE(line, 0);
+  return cursor;
+}
+
+/** Line a native search cursor resumes from. */
+export function searchCursorLine(cursor: Buffer): number {
+  return cursor.readUInt32LE(0);
+}
+
+/** Whether a native search cursor has passed the last row. */
+export function isSearchCursorDone(cursor: Buffer): boolean {
+  return cursor[SEARCH_CURSOR_DONE] !== 0;
+}
+
+/**
+ * Whether a character is caseless or its case pair is a single Latin-1
+ * character, so the native folding finds what toLowerCase would ('ÿ' and
+ * 'µ' uppercase outside Latin-1, 'ß' to "SS").
+ */
+function foldsWithinLatin1(char: string): boolean {
+  const lower = char.toLowerCase();
+  const upper = char.toUpperCase();
+  if (lower === upper) return true;
+  return lower.length === 1 && upper.length === 1 &&
+    lower.charCodeAt(0) < 0x100 && upper.charCodeAt(0) < 0x100;
+}
+
 export class GhosttyVtTerminal {
   private handle: Pointer;
   private _cols: number;
   private _rows: number;
   private viewportBuffer: Buffer | null = null;
+  private dirtyRowsBuffer: Buffer | null = null;
+  private dirtyRows: GhosttyDirtyRows = { rows: [], cells: [] };
+  private compactCells: Buffer | null = null;
+  private compactStyles: Buffer | null = null;
+  private compactStyleCount = Buffer.alloc(4);
+  private compactFrame: GhosttyCompactFrame | null = null;
+  private spillCells: Buffer | null = null;
+  private spillStyles: Buffer | null = null;
+  private spillWrapped: Buffer | null = null;
+  private kittyHeader: Buffer | null = null;
+  private kittyImagesBuffer: Buffer | null = null;
+  private kittyPlacementsBuffer: Buffer | null = null;
   private cellPool: GhosttyCell[] = [];
   private lineBuffer: Buffer | null = null;
+  private searchBuffer: Buffer | null = null;
   private encoder = new TextEncoder();
 
   constructor(cols: number, rows: number, config?: GhosttyTerminalConfig) {
@@ -97,6 +155,11 @@ export class GhosttyVtTerminal {
     this._rows = rows;
     ghostty.symbols.ghostty_terminal_resize(this.handle, cols, rows);
     this.viewportBuffer = null;
+    this.dirtyRowsBuffer = null;
+    this.compactCells = null;
+    this.compactStyles = null;
+    this.spillCells = null;
+    this.spillStyles = null;
     this.lineBuffer = null;
     this.initCellPool();
   }
@@ -161,6 +224,95 @@ export class GhosttyVtTerminal {
     return this.cellPool;
   }
 
+  /**
+   * Fetch only the rows marked dirty by the last update(). The returned
+   * object and its cells are reused across calls (cells come from the
+   * viewport pool, so do not hold them across getViewport()).
+   * Returns null on error.
+   */
+  getDirtyRows(): GhosttyDirtyRows | null {
+    const rows = this._rows;
+    const totalCells = this._cols * rows;
+
+    if (!this.viewportBuffer || this.viewportBuffer.byteLength < totalCells * CELL_SIZE) {
+      this.viewportBuffer = Buffer.alloc(totalCells * CELL_SIZE);
+    }
+    if (!this.dirtyRowsBuffer || this.dirtyRowsBuffer.byteLength < rows * 4) {
+      this.dirtyRowsBuffer = Buffer.alloc(rows * 4);
+    }
+
+    const count = ghostty.symbols.ghostty_render_state_get_dirty_rows(
+      this.handle,
+      this.dirtyRowsBuffer,
+      rows,
+      this.viewportBuffer,
+      totalCells
+    );
+
+    if (count < 0) return null;
+
+    const indices = this.dirtyRows.rows;
+    indices.length = count;
+    for (let i = 0; i < count; i++) {
+      indices[i] = this.dirtyRowsBuffer.readUInt32LE(i * 4);
+    }
+    this.parseCellsIntoPool(this.viewportBuffer, count * this._cols);
+    this.dirtyRows.cells = this.cellPool;
+    return this.dirtyRows;
+  }
+
+  /**
+   * Fetch viewport rows as style-interned compact cells, either every row or
+   * only the rows marked dirty by the last update(). The returned frame and
+   * its views are reused across calls. Returns null on error (for example a
+   * viewport with more than 65536 distinct styles).
+   */
+  getViewportCompact(dirtyOnly: boolean): GhosttyCompactFrame | null {
+    const rows = this._rows;
+    const totalCells = this._cols * rows;
+    // Every cell can have its own style, plus the default fill style
+    const maxStyles = totalCells + 1;
+
+    if (!this.compactCells || this.compactCells.byteLength < totalCells * COMPACT_CELL_SIZE) {
+      this.compactCells = Buffer.alloc(totalCells * COMPACT_CELL_SIZE);
+    }
+    if (!this.compactStyles || this.compactStyles.byteLength < maxStyles * COMPACT_STYLE_SIZE) {
+      this.compactStyles = Buffer.alloc(maxStyles * COMPACT_STYLE_SIZE);
+    }
+    if (!this.dirtyRowsBuffer || this.dirtyRowsBuffer.byteLength < rows * 4) {
+      this.dirtyRowsBuffer = Buffer.alloc(rows * 4);
+    }
+
+    const count = ghostty.symbols.ghostty_render_state_get_viewport_compact(
+      this.handle,
+      dirtyOnly,
+      this.dirtyRowsBuffer,
+      rows,
+      this.compactCells,
+      totalCells,
+      this.compactStyles,
+      maxStyles,
+      this.compactStyleCount
+    );
+
+    if (count < 0) return null;
+
+    const frame = this.compactFrame ??= {
+      rows: [],
+      cells: this.compactCells,
+      styles: this.compactStyles,
+      styleCount: 0,
+    };
+    frame.rows.length = count;
+    for (let i = 0; i < count; i++) {
+      frame.rows[i] = this.dirtyRowsBuffer.readUInt32LE(i * 4);
+    }
+    frame.cells = this.compactCells.subarray(0, count * this._cols * COMPACT_CELL_SIZE);
+    frame.styleCount = this.compactStyleCount.readUInt32LE(0);
+    frame.styles = this.compactStyles.subarray(0, frame.styleCount * COMPACT_STYLE_SIZE);
+    return frame;
+  }
+
   // ==========================================================================
   // Modes and state
   // ==========================================================================
@@ -207,6 +359,116 @@ export class GhosttyVtTerminal {
     return ghostty.symbols.ghostty_terminal_is_row_wrapped(this.handle, row);
   }
 
+  /** Whether scrollback line `offset` (0 = oldest) soft-wraps into the next. */
+  isScrollbackRowWrapped(offset: number): boolean {
+    return ghostty.symbols.ghostty_terminal_is_scrollback_row_wrapped(this.handle, offset);
+  }
+
+  /**
+   * Fetch up to `maxRows` of the oldest scrollback lines as compact cells
+   * with their wrap flags, in one call. The frame's views are reused by the
+   * next export. Returns null on error.
+   */
+  getScrollbackCompact(maxRows: number): GhosttyScrollbackFrame | null {
+    const totalCells = this._cols * maxRows;
+    const maxStyles = totalCells + 1;
+    if (!this.spillCells || this.spillCells.byteLength < totalCells * COMPACT_CELL_SIZE) {
+      this.spillCells = Buffer.alloc(totalCells * COMPACT_CELL_SIZE);
+    }
+    if (!this.spillStyles || this.spillStyles.byteLength < maxStyles * COMPACT_STYLE_SIZE) {
+      this.spillStyles = Buffer.alloc(maxStyles * COMPACT_STYLE_SIZE);
+    }
+    if (!this.spillWrapped || this.spillWrapped.byteLength < maxRows) {
+      this.spillWrapped = Buffer.alloc(maxRows);
+    }
+
+    const count = ghostty.symbols.ghostty_terminal_get_scrollback_compact(
+      this.handle,
+      maxRows,
+      this.spillCells,
+      totalCells,
+      this.spillStyles,
+      maxStyles,
+      this.compactStyleCount,
+      this.spillWrapped
+    );
+    if (count < 0) return null;
+
+    const styleCount = this.compactStyleCount.readUInt32LE(0);
+    return {
+      rows: Array.from({ length: count }, (_, i) => i),
+      cells: this.spillCells.subarray(0, count * this._cols * COMPACT_CELL_SIZE),
+      styles: this.spillStyles.subarray(0, styleCount * COMPACT_STYLE_SIZE),
+      styleCount,
+      wrapped: this.spillWrapped.subarray(0, count),
+    };
+  }
+
+  /**
+   * Case-insensitive search over lines [start, end) of scrollback and the
+   * active area, read straight from the native page list. Returns null when
+   * the query needs case folding beyond ASCII/Latin-1, which the native
+   * search doesn't do.
+   */
+  search(query: string, limit: number, start = 0, end = Infinity): SearchResult | null {
+    const codepoints: number[] = [];
+    for (const char of query) {
+      if (!foldsWithinLatin1(char)) return null;
+      codepoints.push(char.codePointAt(0)!);
+    }
+
+    const matches: SearchMatch[] = [];
+    if (codepoints.length === 0) return { matches, hasMore: false };
+
+    const queryBuffer = new Uint32Array(codepoints);
+    const cursor = createSearchCursor(start);
+    const inRange = () => !isSearchCursorDone(cursor) && searchCursorLine(cursor) < end;
+
+    // At least one call is made so a zero limit still reports whether any
+    // match exists.
+    do {
+      const size = this.searchBatchSize(limit - matches.length);
+      const maxRows = Number.isFinite(end) ? end - searchCursorLine(cursor) : 0;
+      const written = ghostty.symbols.ghostty_terminal_search(
+        this.handle,
+        queryBuffer,
+        codepoints.length,
+        SearchFlags.CASE_INSENSITIVE,
+        cursor,
+        this.searchBuffer,
+        size,
+        maxRows
+      );
+      if (written < 0) return null;
+      this.readSearchMatches(written, matches);
+    } while (inRange() && matches.length < limit);
+
+    return { matches, hasMore: inRange() };
+  }
+
+  /**
+   * One step of a regex search over soft-wrapped logical lines: scans at
+   * most `maxRows` rows from `cursor` and returns up to `limit` matches,
+   * advancing the cursor. Returns null on error.
+   */
+  searchRegexStep(regex: GhosttyRegex, cursor: Buffer, limit: number, maxRows: number): SearchMatch[] | null {
+    const handle = regex.handle;
+    if (!handle) return null;
+    const size = this.searchBatchSize(limit);
+    const written = ghostty.symbols.ghostty_terminal_search_regex(
+      this.handle,
+      handle,
+      cursor,
+      this.searchBuffer,
+      size,
+      maxRows
+    );
+    if (written < 0) return null;
+    const matches: SearchMatch[] = [];
+    this.readSearchMatches(written, matches);
+    return matches;
+  }
+
   hasResponse(): boolean {
     return ghostty.symbols.ghostty_terminal_has_response(this.handle);
   }
@@ -256,26 +518,15 @@ export class GhosttyVtTerminal {
     const buffer = Buffer.alloc(KITTY_IMAGE_INFO_SIZE);
     const ok = ghostty.symbols.ghostty_terminal_get_kitty_image_info(this.handle, imageId, buffer);
     if (!ok) return null;
-
-    const view = new DataView(buffer.buffer, buffer.byteOffset, buffer.byteLength);
-    return {
-      id: view.getUint32(0, true),
-      number: view.getUint32(4, true),
-      width: view.getUint32(8, true),
-      height: view.getUint32(12, true),
-      data_len: view.getUint32(16, true),
-      format: view.getUint8(20),
-      compression: view.getUint8(21),
-      implicit_id: view.getUint8(22),
-      transmit_time: view.getBigUint64(24, true),
-    };
+    return readKittyImageInfo(new DataView(buffer.buffer, buffer.byteOffset, buffer.byteLength), 0);
   }
 
-  getKittyImageData(imageId: number): Uint8Array | null {
-    const info = this.getKittyImageInfo(imageId);
-    if (!info || info.data_len === 0) return null;
+  /** Copy image data; pass the length from a snapshot to skip the info lookup. */
+  getKittyImageData(imageId: number, dataLength?: number): Uint8Array | null {
+    const length = dataLength ?? this.getKittyImageInfo(imageId)?.data_len ?? 0;
+    if (length === 0) return null;
 
-    const buffer = Buffer.alloc(info.data_len);
+    const buffer = Buffer.alloc(length);
     const written = ghostty.symbols.ghostty_terminal_copy_kitty_image_data(
       this.handle,
       imageId,
@@ -298,31 +549,97 @@ export class GhosttyVtTerminal {
     const view = new DataView(buffer.buffer, buffer.byteOffset, buffer.byteLength);
     const total = Math.min(written, count);
     for (let i = 0; i < total; i++) {
-      const offset = i * KITTY_PLACEMENT_SIZE;
-      placements.push({
-        image_id: view.getUint32(offset, true),
-        placement_id: view.getUint32(offset + 4, true),
-        placement_tag: view.getUint8(offset + 8),
-        screen_x: view.getUint32(offset + 12, true),
-        screen_y: view.getUint32(offset + 16, true),
-        x_offset: view.getUint32(offset + 20, true),
-        y_offset: view.getUint32(offset + 24, true),
-        source_x: view.getUint32(offset + 28, true),
-        source_y: view.getUint32(offset + 32, true),
-        source_width: view.getUint32(offset + 36, true),
-        source_height: view.getUint32(offset + 40, true),
-        columns: view.getUint32(offset + 44, true),
-        rows: view.getUint32(offset + 48, true),
-        z: view.getInt32(offset + 52, true),
-      });
+      placements.push(readKittyPlacement(view, i * KITTY_PLACEMENT_SIZE));
     }
     return placements;
   }
 
+  /**
+   * Image infos and placements of the active screen in one native call, or
+   * null when nothing changed since `sinceGeneration` (0 = never synced).
+   */
+  getKittySnapshot(sinceGeneration: number): GhosttyKittySnapshot | null {
+    this.kittyHeader ??= Buffer.alloc(KITTY_SNAPSHOT_SIZE);
+    this.kittyImagesBuffer ??= Buffer.alloc(KITTY_SNAPSHOT_INITIAL * KITTY_IMAGE_INFO_SIZE);
+    this.kittyPlacementsBuffer ??= Buffer.alloc(KITTY_SNAPSHOT_INITIAL * KITTY_PLACEMENT_SIZE);
+    const header = this.kittyHeader;
+
+    for (let attempt = 0; attempt < 2; attempt++) {
+      const imageCapacity = this.kittyImagesBuffer.byteLength / KITTY_IMAGE_INFO_SIZE;
+      const placementCapacity = this.kittyPlacementsBuffer.byteLength / KITTY_PLACEMENT_SIZE;
+      const result = ghostty.symbols.ghostty_terminal_get_kitty_snapshot(
+        this.handle,
+        BigInt(sinceGeneration),
+        this.kittyImagesBuffer,
+        imageCapacity,
+        this.kittyPlacementsBuffer,
+        placementCapacity,
+        header
+      );
+      if (result === 0) return null;
+
+      const imageCount = header.readUInt32LE(8);
+      const placementCount = header.readUInt32LE(12);
+      if (result < 0) {
+        if (imageCount <= imageCapacity && placementCount <= placementCapacity) return null;
+        // The generation has already moved, so the retry can't report "unchanged"
+        if (imageCount > imageCapacity) {
+          this.kittyImagesBuffer = Buffer.alloc(imageCount * 2 * KITTY_IMAGE_INFO_SIZE);
+        }
+        if (placementCount > placementCapacity) {
+          this.kittyPlacementsBuffer = Buffer.alloc(placementCount * 2 * KITTY_PLACEMENT_SIZE);
+        }
+        continue;
+      }
+
+      const images: GhosttyKittyImageInfo[] = [];
+      const imageView = new DataView(
+        this.kittyImagesBuffer.buffer,
+        this.kittyImagesBuffer.byteOffset,
+        this.kittyImagesBuffer.byteLength
+      );
+      for (let i = 0; i < imageCount; i++) {
+        images.push(readKittyImageInfo(imageView, i * KITTY_IMAGE_INFO_SIZE));
+      }
+      const placements: GhosttyKittyPlacement[] = [];
+      const placementView = new DataView(
+        this.kittyPlacementsBuffer.buffer,
+        this.kittyPlacementsBuffer.byteOffset,
+        this.kittyPlacementsBuffer.byteLength
+      );
+      for (let i = 0; i < placementCount; i++) {
+        placements.push(readKittyPlacement(placementView, i * KITTY_PLACEMENT_SIZE));
+      }
+      return { generation: Number(header.readBigUInt64LE(0)), images, placements };
+    }
+    return null;
+  }
+
   // ==========================================================================
   // Internal helpers
   // ==========================================================================
 
+  /** Ensure the match buffer exists; returns how many matches to request. */
+  private searchBatchSize(remaining: number): number {
+    if (!this.searchBuffer) {
+      this.searchBuffer = Buffer.alloc(SEARCH_BATCH * SEARCH_MATCH_SIZE);
+    }
+    return Math.max(0, Math.min(SEARCH_BATCH, remaining));
+  }
+
+  private readSearchMatches(count: number, matches: SearchMatch[]): void {
+    const buffer = this.searchBuffer!;
+    const view = new DataView(buffer.buffer, buffer.byteOffset, buffer.byteLength);
+    for (let i = 0; i < count; i++) {
+      const offset = i * SEARCH_MATCH_SIZE;
+      matches.push({
+        lineIndex: view.getUint32(offset, true),
+        startCol: view.getUint16(offset + 4, true),
+        endCol: view.getUint16(offset + 6, true),
+      });
+    }
+  }
+
   private initCellPool(): void {
     const totalCells = this._cols * this._rows;
     this.cellPool = [];
@@ -384,3 +701,36 @@ export class GhosttyVtTerminal {
     return cells;
   }
 }
+
+function readKittyImageInfo(view: DataView, offset: number): GhosttyKittyImageInfo {
+  return {
+    id: view.getUint32(offset, true),
+    number: view.getUint32(offset + 4, true),
+    width: view.getUint32(offset + 8, true),
+    height: view.getUint32(offset + 12, true),
+    data_len: view.getUint32(offset + 16, true),
+    format: view.getUint8(offset + 20),
+    compression: view.getUint8(offset + 21),
+    implicit_id: view.getUint8(offset + 22),
+    transmit_time: view.getBigUint64(offset + 24, true),
+  };
+}
+
+function readKittyPlacement(view: DataView, offset: number): GhosttyKittyPlacement {
+  return {
+    image_id: view.getUint32(offset, true),
+    placement_id: view.getUint32(offset + 4, true),
+    placement_tag: view.getUint8(offset + 8),
+    screen_x: view.getUint32(offset + 12, true),
+    screen_y: view.getUint32(offset + 16, true),
+    x_offset: view.getUint32(offset + 20, true),
+    y_offset: view.getUint32(offset + 24, true),
+    source_x: view.getUint32(offset + 28, true),
+    source_y: view.getUint32(offset + 32, true),
+    source_width: view.getUint32(offset + 36, true),
+    source_height: view.getUint32(offset + 40, true),
+    columns: view.getUint32(offset + 44, true),
+    rows: view.getUint32(offset + 48, true),
+    z: view.getInt32(offset + 52, true),
+  };
+}
@@ -33,6 +33,33 @@ export interface GhosttyCell {
   grapheme_len: number;
 }
 
+/**
+ * Viewport rows in the compact format: 8-byte cells (codepoint u32, style u16,
+ * width u8, grapheme_len u8) indexing 8-byte styles (fg rgb, bg rgb, CellFlags,
+ * attrs). Views are reused by the next export.
+ */
+export interface GhosttyCompactFrame {
+  rows: number[];
+  cells: Uint8Array;
+  styles: Uint8Array;
+  styleCount: number;
+}
+
+/** Oldest scrollback rows in the compact format; wrapped[i] is 1 when row i soft-wraps. */
+export interface GhosttyScrollbackFrame extends GhosttyCompactFrame {
+  wrapped: Uint8Array;
+}
+
+export const enum CompactStyleAttrs {
+  HYPERLINK = 1 << 0,
+}
+
+/** Dirty rows from one render state update; cells hold cols entries per row. */
+export interface GhosttyDirtyRows {
+  rows: number[];
+  cells: GhosttyCell[];
+}
+
 export interface GhosttyTerminalConfig {
   scrollbackLimit?: number;
   fgColor?: number;
@@ -87,3 +114,31 @@ export interface GhosttyKittyPlacement {
   rows: number;
   z: number;
 }
+
+/** Kitty state of the active screen at one generation */
+export interface GhosttyKittySnapshot {
+  generation: number;
+  images: GhosttyKittyImageInfo[];
+  placements: GhosttyKittyPlacement[];
+}
+
+/** Summary flags returned by the output pre-filter scan */
+export const enum PrefilterScanFlags {
+  OSC = 1 << 0,
+  TITLE = 1 << 1,
+  CWD = 1 << 2,
+  NOTIFICATION = 1 << 3,
+  SYNC = 1 << 4,
+  ERASE_SCROLLBACK = 1 << 5,
+  KITTY = 1 << 6,
+  KITTY_QUERY = 1 << 7,
+  FOCUS_TRACKING = 1 << 8,
+  FOCUS_ENABLED = 1 << 9,
+  QUERY = 1 << 10,
+  PENDING = 1 << 11,
+}
+
+/** Flags for the native text search and regex compilation */
+export const enum SearchFlags {
+  CASE_INSENSITIVE = 1 << 0,
+}
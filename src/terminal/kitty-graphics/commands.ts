@@ -6,38 +6,72 @@ import { prepareImageData } from './image';
 const ESC = '\x1b';
 const KITTY_ESCAPE = `${ESC}_G`;
 const KITTY_END = `${ESC}\\`;
-const BASE64_CHUNK_SIZE = 4096;
+// Raw bytes per transmit chunk; encodes to the protocol's 4096-character limit
+const CHUNK_BYTES = 3072;
+// Characters per host write when a frame is written out in pieces
+const FRAME_WRITE_CHARS = 64 * 1024;
 
-export function buildTransmitImage(hostId: number, info: KittyGraphicsImageInfo, data: Uint8Array): string {
+export type PreparedTransmit = {
+  params: Array<[string, string | number]>;
+  payload: Buffer;
+};
+
+/** Transmit control params and payload for an image (null if unsupported). */
+export function prepareTransmit(
+  hostId: number,
+  info: KittyGraphicsImageInfo,
+  data: Uint8Array
+): PreparedTransmit | null {
   const prepared = prepareImageData(info, data);
   if (!prepared) {
-    return '';
+    return null;
   }
   const { format, payload } = prepared;
-  const params: Array<[string, string | number]> = [
-    ['a', 't'],
-    ['q', 2],
-    ['f', format],
-    ['t', 'd'],
-    ['s', info.width],
-    ['v', info.height],
-    ['i', hostId],
-  ];
+  return {
+    params: [
+      ['a', 't'],
+      ['q', 2],
+      ['f', format],
+      ['t', 'd'],
+      ['s', info.width],
+      ['v', info.height],
+      ['i', hostId],
+    ],
+    payload: Buffer.from(payload.buffer, payload.byteOffset, payload.byteLength),
+  };
+}
 
-  const buffer = Buffer.from(payload.buffer, payload.byteOffset, payload.byteLength);
-  const encoded = buffer.toString('base64');
+/**
+ * Transmit an image as escape codes, one command per chunk. The payload is
+ * base64-encoded one chunk at a time, so the whole image never exists as a
+ * single base64 string.
+ */
+export function buildTransmitChunks(transmit: PreparedTransmit): string[] {
+  const { params, payload } = transmit;
   const chunks: string[] = [];
-
-  for (let offset = 0; offset < encoded.length; offset += BASE64_CHUNK_SIZE) {
-    const chunk = encoded.slice(offset, offset + BASE64_CHUNK_SIZE);
-    const more = offset + BASE64_CHUNK_SIZE < encoded.length;
+  for (let offset = 0; offset < payload.byteLength; offset += CHUNK_BYTES) {
+    const end = Math.min(offset + CHUNK_BYTES, payload.byteLength);
+    const more = end < payload.byteLength;
     const chunkParams: Array<[string, string | number]> = more
       ? [...params, ['m', 1] as [string, number]]
       : params;
-    chunks.push(buildKittyCommand(chunkParams, chunk));
+    chunks.push(buildKittyCommand(chunkParams, payload.toString('base64', offset, end)));
   }
+  return chunks;
+}
+
+/** Transmit an image whose payload was written to a temporary file (t=t). */
+export function buildTransmitFile(transmit: PreparedTransmit, filePath: string): string {
+  const params = transmit.params.map(([key, value]): [string, string | number] =>
+    key === 't' ? [key, 't'] : [key, value]
+  );
+  return buildKittyCommand(params, Buffer.from(filePath).toString('base64'));
+}
 
-  return chunks.join('');
+/** Chunked transmit commands for an image; empty when it can't be sent. */
+export function buildTransmitImage(hostId: number, info: KittyGraphicsImageInfo, data: Uint8Array): string[] {
+  const transmit = prepareTransmit(hostId, info, data);
+  return transmit ? buildTransmitChunks(transmit) : [];
 }
 
 export function buildDisplay(render: PlacementRender): string {
@@ -82,6 +116,25 @@ export function buildDeleteImage(hostImageId: number): string {
   ]);
 }
 
+/**
+ * Write one frame of host commands inside a DEC 2026 synchronized update so
+ * the host applies its deletes, moves and adds atomically instead of
+ * painting intermediate states. Commands are coalesced into writes of about
+ * FRAME_WRITE_CHARS, so a frame carrying a large transmit is never joined
+ * into one string.
+ */
+export function writeSynchronizedUpdate(writeOut: (chunk: string) => void, commands: string[]): void {
+  let batch = `${ESC}[?2026h`;
+  for (const command of commands) {
+    if (batch.length > 0 && batch.length + command.length > FRAME_WRITE_CHARS) {
+      writeOut(batch);
+      batch = '';
+    }
+    batch += command;
+  }
+  writeOut(`${batch}${ESC}[?2026l`);
+}
+
 function buildKittyCommand(params: Array<[string, string | number]>, data = ''): string {
   const control = params.map(([key, value]) => `${key}=${value}`).join(',');
   return `${KITTY_ESCAPE}${control};${data}${KITTY_END}`;
@@ -1,3 +1,5 @@
+import { getHostCapabilities } from '../capabilities';
+
 const DEFAULT_OFFLOAD_THRESHOLD = 512 * 1024;
 const DEFAULT_OFFLOAD_CLEANUP_MS = 5000;
 
@@ -5,6 +7,14 @@ export function isSshSession(): boolean {
   return Boolean(process.env.SSH_CONNECTION || process.env.SSH_CLIENT || process.env.SSH_TTY);
 }
 
+/**
+ * Whether the host terminal can read kitty payloads from files we write:
+ * it has to speak kitty graphics and share our filesystem.
+ */
+export function hostSupportsKittyFileTransmit(): boolean {
+  return (getHostCapabilities()?.kittyGraphics ?? false) && !isSshSession();
+}
+
 export function resolveKittyOffloadThreshold(): number {
   const raw = process.env.OPENMUX_KITTY_OFFLOAD_THRESHOLD;
   if (raw !== undefined && raw !== '') {
@@ -0,0 +1,76 @@
+import { Buffer } from 'buffer';
+import fs from 'fs';
+import { createTempFilePath } from './sequence-utils';
+
+/**
+ * Streaming base64 decoder for offloaded kitty payloads.
+ *
+ * Chunks are decoded with Buffer#write into one preallocated scratch
+ * buffer, a window at a time, and written straight to the offload file,
+ * so a large payload never exists as a concatenated string or as a
+ * decoded copy on the JS heap. Characters that don't complete a base64
+ * quantum (at most three) carry over to the next chunk.
+ */
+
+const DECODE_WINDOW_CHARS = 64 * 1024;
+const scratch = Buffer.allocUnsafe((DECODE_WINDOW_CHARS / 4) * 3);
+
+export type OffloadState = {
+  fd: number;
+  filePath: string;
+  carry: string;
+  bytesWritten: number;
+};
+
+export function startOffload(counter: number): OffloadState {
+  const filePath = createTempFilePath(counter);
+  const fd = fs.openSync(filePath, 'w');
+  return { fd, filePath, carry: '', bytesWritten: 0 };
+}
+
+export function appendOffload(offload: OffloadState, data: string): void {
+  if (!data) return;
+  let start = 0;
+  if (offload.carry.length > 0) {
+    start = 4 - offload.carry.length;
+    if (data.length < start) {
+      offload.carry += data;
+      return;
+    }
+    writeDecoded(offload, offload.carry + data.slice(0, start));
+  }
+  const end = start + Math.floor((data.length - start) / 4) * 4;
+  for (let pos = start; pos < end; pos += DECODE_WINDOW_CHARS) {
+    writeDecoded(offload, data.slice(pos, Math.min(end, pos + DECODE_WINDOW_CHARS)));
+  }
+  offload.carry = data.slice(end);
+}
+
+export function finishOffload(offload: OffloadState): string {
+  if (offload.carry.length > 0) {
+    writeDecoded(offload, offload.carry);
+    offload.carry = '';
+  }
+  fs.closeSync(offload.fd);
+  return offload.filePath;
+}
+
+export function abortOffload(offload: OffloadState): void {
+  try {
+    fs.closeSync(offload.fd);
+  } catch {
+    // ignore
+  }
+  try {
+    fs.unlinkSync(offload.filePath);
+  } catch {
+    // ignore
+  }
+}
+
+function writeDecoded(offload: OffloadState, base64: string): void {
+  const length = scratch.write(base64, 0, scratch.length, 'base64');
+  if (length === 0) return;
+  fs.writeSync(offload.fd, scratch, 0, length);
+  offload.bytesWritten += length;
+}
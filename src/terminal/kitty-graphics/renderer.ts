@@ -1,5 +1,5 @@
 import { getHostCapabilities } from '../capabilities';
-import { buildDeleteImage } from './commands';
+import { writeSynchronizedUpdate } from './commands';
 import { getKittyTransmitBroker } from './transmit-broker';
 import { tracePtyEvent } from '../pty-trace';
 import {
@@ -8,6 +8,8 @@ import {
   getScreenKeys,
   getWriter,
 } from './renderer-helpers';
+import { FileTransmitQueue } from './renderer/file-transmits';
+import { HostImageCache } from './renderer/host-images';
 import { updatePtyState } from './renderer/pty-state';
 import {
   clearPanePlacements,
@@ -38,6 +40,10 @@ export class KittyGraphicsRenderer {
   private panes = new Map<string, PaneState>();
   private screenStates = new Map<string, PtyKittyState>();
   private imageRegistry = new Map<string, Map<number, ImageCache>>();
+  private hostImages = new HostImageCache();
+  private renderTarget: RendererLike | null = null;
+  // Large transmits written to files arrive in a later frame, which they request
+  private fileTransmits = new FileTransmitQueue(() => this.renderTarget?.requestRender?.());
   private placementsByPane = new Map<string, Map<string, PlacementRender>>();
   private screenTransitionTarget = new Map<string, boolean>();
   private pendingPtyDeletes = new Set<string>();
@@ -124,11 +130,9 @@ export class KittyGraphicsRenderer {
       .sort((a, b) => (a.y - b.y) || (a.x - b.x));
     const nextKey = nextRects.map((rect) => `${rect.x},${rect.y},${rect.width},${rect.height}`).join('|');
     if (nextKey === this.clipRectsKey) return;
+    // No clear: the next flush diffs each pane's clipped placements in place
     this.clipRects = nextRects;
     this.clipRectsKey = nextKey;
-    for (const pane of this.panes.values()) {
-      pane.needsClear = true;
-    }
   }
 
   setVisibleLayers(layers: Iterable<KittyPaneLayer>): void {
@@ -143,10 +147,8 @@ export class KittyGraphicsRenderer {
       }
       if (same) return;
     }
+    // Panes changing visibility are cleared by flush; the rest keep their placements
     this.visibleLayers = next;
-    for (const pane of this.panes.values()) {
-      pane.needsClear = true;
-    }
   }
 
   dispose(): void {
@@ -159,6 +161,9 @@ export class KittyGraphicsRenderer {
     this.panes.clear();
     this.screenStates.clear();
     this.imageRegistry.clear();
+    this.hostImages.clear();
+    this.fileTransmits.dispose();
+    this.renderTarget = null;
     this.placementsByPane.clear();
     this.clipRects = [];
     this.clipRectsKey = '';
@@ -170,18 +175,23 @@ export class KittyGraphicsRenderer {
 
     const writeOut = getWriter(renderer);
     if (!writeOut) return;
+    this.renderTarget = renderer;
 
+    // Pending transmits and this frame's placement diff go out as one
+    // synchronized write, transmits first so placements can reference them.
+    const output: string[] = [];
     const broker = getKittyTransmitBroker();
-    const flushedBroker = broker?.flushPending(writeOut) ?? false;
+    broker?.flushPending((chunk) => output.push(chunk));
+    this.fileTransmits.drain(output, (hostId) => this.hostImages.holds(hostId));
 
     const metrics = getCellMetrics(renderer);
     if (!metrics) {
-      if (flushedBroker) return;
+      if (output.length > 0) {
+        writeSynchronizedUpdate(writeOut, output);
+      }
       return;
     }
 
-    const output: string[] = [];
-
     for (const pane of this.panes.values()) {
       if (pane.removed || !pane.ptyId || !pane.emulator) {
         continue;
@@ -235,6 +245,8 @@ export class KittyGraphicsRenderer {
         allowPlacementReuse,
         screenStates: this.screenStates,
         imageRegistry: this.imageRegistry,
+        hostImages: this.hostImages,
+        fileTransmits: this.fileTransmits,
         placementsByPane: this.placementsByPane,
         nextHostImageId: this.nextHostImageId,
       });
@@ -278,6 +290,7 @@ export class KittyGraphicsRenderer {
         clipRects: this.clipRects,
         placementsByPane: this.placementsByPane,
         nextHostPlacementId: this.nextHostPlacementId,
+        isImagePending: (hostId) => this.fileTransmits.isPending(hostId),
       });
     }
 
@@ -286,7 +299,7 @@ export class KittyGraphicsRenderer {
         const images = this.imageRegistry.get(ptyId);
         if (images) {
           for (const [id, image] of images) {
-            output.push(buildDeleteImage(image.hostId));
+            this.hostImages.release(image, output);
             deletePlacementsForImage({ imageId: id, placementsByPane: this.placementsByPane, output });
             broker?.dropMapping(ptyId, image.info);
           }
@@ -301,11 +314,8 @@ export class KittyGraphicsRenderer {
       this.pendingPtyDeletes.clear();
     }
 
-    if (output.length === 0) {
-      if (flushedBroker) return;
-      return;
-    }
-    writeOut(output.join(''));
+    if (output.length === 0) return;
+    writeSynchronizedUpdate(writeOut, output);
   }
 
 }
@@ -0,0 +1,126 @@
+import fs from 'fs';
+import fsp from 'fs/promises';
+import {
+  buildTransmitChunks,
+  buildTransmitFile,
+  type PreparedTransmit,
+} from '../commands';
+import {
+  hostSupportsKittyFileTransmit,
+  resolveKittyOffloadCleanupDelay,
+  resolveKittyOffloadThreshold,
+} from '../offload-utils';
+import { createTempFilePath } from '../sequence-utils';
+import { tracePtyEvent } from '../../pty-trace';
+
+/**
+ * Renderer transmits that go to the host through temporary files (t=t).
+ *
+ * Files are written off the render path. An image's transmit is held back
+ * until its file is complete, then goes out with the next frame, which
+ * `onReady` asks for; placements of images still being written are not
+ * shown until then. The host deletes t=t files once read, and a cleanup
+ * timer removes any it left behind (e.g. after rejecting the command). A
+ * failed write falls back to chunked escape codes.
+ */
+export class FileTransmitQueue {
+  private readonly thresholdBytes: number;
+  private readonly cleanupDelayMs: number;
+  /** Host ids whose files are still being written. */
+  private writing = new Set<number>();
+  private ready: Array<{ hostId: number; commands: string[] }> = [];
+  private cleanupTimers = new Set<ReturnType<typeof setTimeout>>();
+  private fileCounter = 0;
+  private generation = 0;
+
+  constructor(
+    private onReady: () => void,
+    options?: { thresholdBytes?: number; cleanupDelayMs?: number }
+  ) {
+    this.thresholdBytes = options?.thresholdBytes
+      ?? (hostSupportsKittyFileTransmit() ? resolveKittyOffloadThreshold() : 0);
+    this.cleanupDelayMs = options?.cleanupDelayMs ?? resolveKittyOffloadCleanupDelay();
+  }
+
+  /** Whether an image's transmit is still waiting for its file. */
+  isPending(hostId: number): boolean {
+    return this.writing.has(hostId);
+  }
+
+  /**
+   * Start a file transmit for a large payload. Returns false when the
+   * payload is small enough (or the host unable) to be sent inline.
+   */
+  offer(hostId: number, transmit: PreparedTransmit): boolean {
+    if (this.thresholdBytes <= 0 || transmit.payload.byteLength < this.thresholdBytes) {
+      return false;
+    }
+    const filePath = createTempFilePath(this.fileCounter++);
+    const generation = this.generation;
+    this.writing.add(hostId);
+    void fsp.writeFile(filePath, transmit.payload).then(
+      () => this.finish(generation, hostId, [buildTransmitFile(transmit, filePath)], filePath),
+      (error) => {
+        tracePtyEvent('kitty-render-file-transmit-error', { hostId, error: String(error) });
+        this.finish(generation, hostId, buildTransmitChunks(transmit), filePath);
+      }
+    );
+    return true;
+  }
+
+  /**
+   * Move transmits whose files are complete into this frame's output,
+   * skipping images deleted from the host while they were written.
+   */
+  drain(output: string[], isLive: (hostId: number) => boolean): void {
+    if (this.ready.length === 0) return;
+    for (const { hostId, commands } of this.ready) {
+      if (!isLive(hostId)) continue;
+      for (const command of commands) output.push(command);
+    }
+    this.ready = [];
+  }
+
+  dispose(): void {
+    this.generation += 1;
+    this.writing.clear();
+    this.ready = [];
+    // Files still pending are removed as soon as their writes settle
+    for (const timer of this.cleanupTimers) {
+      clearTimeout(timer);
+    }
+    this.cleanupTimers.clear();
+  }
+
+  private finish(generation: number, hostId: number, commands: string[], filePath: string): void {
+    if (generation !== this.generation) {
+      removeFile(filePath);
+      return;
+    }
+    this.writing.delete(hostId);
+    this.ready.push({ hostId, commands });
+    this.scheduleCleanup(filePath);
+    this.onReady();
+  }
+
+  private scheduleCleanup(filePath: string): void {
+    // The command hasn't been written yet, so without a delay the file is
+    // left for the host to delete
+    if (this.cleanupDelayMs <= 0) {
+      return;
+    }
+    const timer = setTimeout(() => {
+      this.cleanupTimers.delete(timer);
+      removeFile(filePath);
+    }, this.cleanupDelayMs);
+    this.cleanupTimers.add(timer);
+  }
+}
+
+function removeFile(filePath: string): void {
+  try {
+    fs.unlinkSync(filePath);
+  } catch {
+    // ignore
+  }
+}
@@ -0,0 +1,103 @@
+import { createHash } from 'crypto';
+import type { KittyGraphicsImageInfo } from '../../emulator-interface';
+import { buildDeleteImage } from '../commands';
+import type { ImageCache } from '../types';
+
+/** Bytes of image data kept on the host for images no pane references. */
+export const HOST_IMAGE_CACHE_BYTES = 64 * 1024 * 1024;
+
+type HostImage = {
+  hostId: number;
+  bytes: number;
+  refs: number;
+};
+
+/**
+ * Content-addressed registry of images transmitted to the host terminal.
+ *
+ * Guest image ids are per PTY, so the same picture shown by several PTYs
+ * (or re-sent after a screen switch) used to be transmitted once per PTY.
+ * Entries are keyed by the image's shape and a hash of its data, and each
+ * (PTY, guest image) pair displaying one holds a reference. Unreferenced
+ * images stay on the host until the byte budget evicts them, least
+ * recently released first, so showing them again costs no transmit.
+ */
+export class HostImageCache {
+  private entries = new Map<string, HostImage>();
+  /** Unreferenced entries in release order (oldest first). */
+  private idle = new Map<string, HostImage>();
+  private totalBytes = 0;
+
+  constructor(private maxBytes = HOST_IMAGE_CACHE_BYTES) {}
+
+  get bytes(): number {
+    return this.totalBytes;
+  }
+
+  get size(): number {
+    return this.entries.size;
+  }
+
+  keyFor(info: KittyGraphicsImageInfo, data: Uint8Array): string {
+    const digest = createHash('sha1').update(data).digest('base64');
+    return `${info.format}:${info.compression}:${info.width}x${info.height}:${digest}`;
+  }
+
+  /** Whether `hostId` is still on the host (referenced or idle). */
+  holds(hostId: number): boolean {
+    for (const entry of this.entries.values()) {
+      if (entry.hostId === hostId) return true;
+    }
+    return false;
+  }
+
+  /** Reference the host copy of `key`; null when it has to be transmitted. */
+  acquire(key: string): number | null {
+    const entry = this.entries.get(key);
+    if (!entry) return null;
+    entry.refs++;
+    this.idle.delete(key);
+    return entry.hostId;
+  }
+
+  /** Record a freshly transmitted image, holding one reference to it. */
+  insert(key: string, hostId: number, bytes: number, output: string[]): void {
+    this.entries.set(key, { hostId, bytes, refs: 1 });
+    this.totalBytes += bytes;
+    this.evict(output);
+  }
+
+  /**
+   * Drop a registry image's hold on the host. Images the transmit broker
+   * placed on the host directly are not cached and are deleted outright.
+   */
+  release(image: ImageCache, output: string[]): void {
+    if (!image.key) {
+      output.push(buildDeleteImage(image.hostId));
+      return;
+    }
+    const entry = this.entries.get(image.key);
+    if (!entry || entry.refs === 0) return;
+    entry.refs--;
+    if (entry.refs === 0) {
+      this.idle.set(image.key, entry);
+      this.evict(output);
+    }
+  }
+
+  clear(): void {
+    this.entries.clear();
+    this.idle.clear();
+    this.totalBytes = 0;
+  }
+
+  private evict(output: string[]): void {
+    for (const [key, entry] of this.idle) {
+      if (this.totalBytes <= this.maxBytes) break;
+      output.push(buildDeleteImage(entry.hostId));
+      this.idle.delete(key);
+      this.entries.delete(key);
+      this.totalBytes -= entry.bytes;
+    }
+  }
+}
@@ -53,6 +53,8 @@ export function renderPanePlacements(params: {
   clipRects: ClipRect[];
   placementsByPane: Map<string, Map<string, PlacementRender>>;
   nextHostPlacementId: number;
+  /** Images not on the host yet; their placements wait for them. */
+  isImagePending?: (hostImageId: number) => boolean;
 }): number {
   const {
     paneKey,
@@ -62,6 +64,7 @@ export function renderPanePlacements(params: {
     output,
     clipRects,
     placementsByPane,
+    isImagePending,
   } = params;
   let nextHostPlacementId = params.nextHostPlacementId;
 
@@ -76,32 +79,51 @@ export function renderPanePlacements(params: {
     });
   }
 
+  const renders: PlacementRender[] = [];
   for (const placement of state.placements) {
     const image = state.images.get(placement.imageId);
-    if (!image) continue;
+    if (!image || isImagePending?.(image.hostId)) continue;
 
     const baseRender = computePlacementRender(pane, placement, image.info, metrics);
     if (!baseRender) continue;
 
-    const renders = applyClipRects(baseRender, metrics, clipRects);
-    if (renders.length === 0) continue;
-
-    for (const render of renders) {
-      const existing = prevPlacements.get(render.key);
-      const hostPlacementId = existing?.hostPlacementId ?? nextHostPlacementId++;
-      const renderState: PlacementRender = { ...render, hostImageId: image.hostId, hostPlacementId };
-
-      nextPlacements.set(render.key, renderState);
-      if (!existing || !isSameRender(existing, renderState)) {
-        output.push(buildDisplay(renderState));
-      }
+    for (const render of applyClipRects(baseRender, metrics, clipRects)) {
+      renders.push({ ...render, hostImageId: image.hostId });
     }
   }
+  renders.sort(compareRenderKeys);
 
-  for (const [key, placement] of prevPlacements) {
-    if (nextPlacements.has(key)) continue;
-    output.push(buildDeletePlacement(placement.hostImageId, placement.hostPlacementId));
+  // Both lists are ordered by key, so one merge pass pairs each render with
+  // the placement it replaces. Surviving keys keep their host placement id,
+  // which makes a changed render a move on the host rather than a
+  // delete/add pair; unchanged renders emit nothing.
+  const previous = [...prevPlacements.values()];
+  const deletes: string[] = [];
+  const displays: string[] = [];
+  let prevIndex = 0;
+  for (const render of renders) {
+    if (nextPlacements.has(render.key)) continue;
+    while (prevIndex < previous.length && previous[prevIndex].key < render.key) {
+      const stale = previous[prevIndex++];
+      deletes.push(buildDeletePlacement(stale.hostImageId, stale.hostPlacementId));
+    }
+    const existing = previous[prevIndex]?.key === render.key ? previous[prevIndex++] : undefined;
+    if (existing && existing.hostImageId !== render.hostImageId) {
+      // Host placement ids are scoped per image: re-placing under the new
+      // image leaves the old image's placement on screen unless deleted.
+      deletes.push(buildDeletePlacement(existing.hostImageId, existing.hostPlacementId));
+    }
+    render.hostPlacementId = existing?.hostPlacementId ?? nextHostPlacementId++;
+    nextPlacements.set(render.key, render);
+    if (!existing || !isSameRender(existing, render)) {
+      displays.push(buildDisplay(render));
+    }
+  }
+  for (; prevIndex < previous.length; prevIndex++) {
+    const stale = previous[prevIndex];
+    deletes.push(buildDeletePlacement(stale.hostImageId, stale.hostPlacementId));
   }
+  output.push(...deletes, ...displays);
 
   if (nextPlacements.size > 0) {
     placementsByPane.set(paneKey, nextPlacements);
@@ -115,8 +137,14 @@ export function renderPanePlacements(params: {
       screen: pane.isAlternateScreen ? 'alt' : 'main',
       prevPlacements: prevPlacements.size,
       nextPlacements: nextPlacements.size,
+      deleted: deletes.length,
+      displayed: displays.length,
     });
   }
 
   return nextHostPlacementId;
 }
+
+function compareRenderKeys(a: PlacementRender, b: PlacementRender): number {
+  return a.key < b.key ? -1 : a.key > b.key ? 1 : 0;
+}
@@ -1,5 +1,5 @@
 import type { ITerminalEmulator } from '../../emulator-interface';
-import { buildDeleteImage, buildTransmitImage } from '../commands';
+import { buildTransmitChunks, prepareTransmit } from '../commands';
 import { getKittyTransmitBroker } from '../transmit-broker';
 import { tracePtyEvent } from '../../pty-trace';
 import {
@@ -8,6 +8,8 @@ import {
   isSameImage,
 } from '../renderer-helpers';
 import type { ImageCache, PtyKittyState, PlacementRender } from '../types';
+import type { FileTransmitQueue } from './file-transmits';
+import type { HostImageCache } from './host-images';
 import { deletePlacementsForImage } from './placements';
 
 function getScreenState(
@@ -42,6 +44,8 @@ export function updatePtyState(params: {
   allowPlacementReuse: boolean;
   screenStates: Map<string, PtyKittyState>;
   imageRegistry: Map<string, Map<number, ImageCache>>;
+  hostImages: HostImageCache;
+  fileTransmits: FileTransmitQueue;
   placementsByPane: Map<string, Map<string, PlacementRender>>;
   nextHostImageId: number;
 }): number {
@@ -53,6 +57,8 @@ export function updatePtyState(params: {
     allowPlacementReuse,
     screenStates,
     imageRegistry,
+    hostImages,
+    fileTransmits,
     placementsByPane,
   } = params;
   let nextHostImageId = params.nextHostImageId;
@@ -87,25 +93,49 @@ export function updatePtyState(params: {
     const previousScreen = previousImages.get(id);
     const previous = registry.get(id);
     const brokerHostId = broker?.resolveHostId(ptyId, info) ?? null;
-    const hostId = brokerHostId ?? previous?.hostId ?? nextHostImageId++;
     const changed = !previous || !isSameImage(previous.info, info);
     if (!previousScreen || !isSameImage(previousScreen.info, info)) {
       imagesChanged = true;
     }
 
+    let hostId = brokerHostId ?? previous?.hostId ?? null;
+    let key = brokerHostId ? undefined : previous?.key;
+    let acquired = false;
     if (changed && !brokerHostId) {
       const data = emulator.getKittyImageData?.(id);
       if (data) {
-        const transmit = buildTransmitImage(hostId, info, data);
-        if (transmit) {
-          output.push(transmit);
+        // Identical content already on the host (from another PTY or an
+        // earlier screen) is referenced instead of transmitted again.
+        const contentKey = hostImages.keyFor(info, data);
+        const sharedId = hostImages.acquire(contentKey);
+        if (sharedId !== null) {
+          hostId = sharedId;
+          key = contentKey;
+          acquired = true;
+        } else {
+          const transmitId = nextHostImageId++;
+          const transmit = prepareTransmit(transmitId, info, data);
+          if (transmit) {
+            if (!fileTransmits.offer(transmitId, transmit)) {
+              for (const command of buildTransmitChunks(transmit)) output.push(command);
+            }
+            hostImages.insert(contentKey, transmitId, data.byteLength, output);
+            hostId = transmitId;
+            key = contentKey;
+            acquired = true;
+          }
         }
       }
     }
+    if (previous?.key && (acquired || brokerHostId)) {
+      hostImages.release(previous, output);
+    }
+    hostId ??= nextHostImageId++;
 
     const cache = previous ?? { hostId, info };
     cache.hostId = hostId;
     cache.info = info;
+    cache.key = key;
     registry.set(id, cache);
     nextImages.set(id, cache);
   }
@@ -147,7 +177,7 @@ export function updatePtyState(params: {
   }
   for (const [id, image] of registry) {
     if (activeIds.has(id)) continue;
-    output.push(buildDeleteImage(image.hostId));
+    hostImages.release(image, output);
     deletePlacementsForImage({ imageId: id, placementsByPane, output });
     broker?.dropMapping(ptyId, image.info);
     registry.delete(id);
@@ -1,4 +1,3 @@
-import { Buffer } from 'buffer';
 import fs from 'fs';
 import { getHostCapabilities } from '../capabilities';
 import type { KittyGraphicsImageInfo } from '../emulator-interface';
@@ -12,7 +11,6 @@ import {
 } from './transmit-broker/sequences';
 import {
   buildGuestKey,
-  createTempFilePath,
   estimateDecodedSize,
   mergeTransmitParams,
   normalizeParamId,
@@ -22,6 +20,13 @@ import {
   type TransmitParams,
 } from './sequence-utils';
 import { resolveKittyOffloadCleanupDelay, resolveKittyOffloadThreshold } from './offload-utils';
+import {
+  abortOffload,
+  appendOffload,
+  finishOffload,
+  startOffload,
+  type OffloadState,
+} from './offload-writer';
 
 type PendingChunk = {
   guestKey: string;
@@ -37,13 +42,6 @@ type PtyBrokerState = {
   nextSyntheticGuestId: number;
 };
 
-type OffloadState = {
-  fd: number;
-  filePath: string;
-  carry: string;
-  bytesWritten: number;
-};
-
 let activeBroker: KittyTransmitBroker | null = null;
 
 export function getKittyTransmitBroker(): KittyTransmitBroker | null {
@@ -135,7 +133,7 @@ export class KittyTransmitBroker {
   clearPty(ptyId: string): void {
     const state = this.stateByPty.get(ptyId);
     if (state?.pendingChunk?.offload) {
-      this.abortOffload(state.pendingChunk.offload);
+      abortOffload(state.pendingChunk.offload);
     }
     this.stateByPty.delete(ptyId);
   }
@@ -183,7 +181,7 @@ export class KittyTransmitBroker {
       const deleteTarget = parsed.params.get('d') ?? '';
       if (deleteTarget === 'a') {
         if (state.pendingChunk?.offload) {
-          this.abortOffload(state.pendingChunk.offload);
+          abortOffload(state.pendingChunk.offload);
         }
         state.pendingChunk = null;
         // Host renders are driven by the emulator state; forwarding d=a would
@@ -255,13 +253,13 @@ export class KittyTransmitBroker {
     const activeOffload = state.pendingChunk?.offload ?? null;
     const shouldOffload = activeOffload ?? this.shouldOffload(mergedParams, parsed.data, transmit.more);
     if (shouldOffload) {
-      const offload = activeOffload ?? this.startOffload();
+      const offload = activeOffload ?? startOffload(this.tempFileCounter++);
       if (!activeOffload && transmit.more) {
         state.pendingChunk = { guestKey, hostId, params: mergedParams, offload };
       }
-      this.appendOffload(offload, parsed.data);
+      appendOffload(offload, parsed.data);
       if (!transmit.more) {
-        const filePath = this.finishOffload(offload);
+        const filePath = finishOffload(offload);
         const hostSequence = buildHostFileTransmitSequence(hostId, mergedParams, filePath);
         if (hostSequence.length > 0) {
           this.enqueue(hostSequence);
@@ -377,51 +375,6 @@ export class KittyTransmitBroker {
     return estimated >= this.offloadThresholdBytes;
   }
 
-  private startOffload(): OffloadState {
-    const filePath = createTempFilePath(this.tempFileCounter++);
-    const fd = fs.openSync(filePath, 'w');
-    return { fd, filePath, carry: '', bytesWritten: 0 };
-  }
-
-  private appendOffload(offload: OffloadState, data: string): void {
-    if (!data) return;
-    const combined = `${offload.carry}${data}`;
-    const usableLen = Math.floor(combined.length / 4) * 4;
-    const toDecode = usableLen > 0 ? combined.slice(0, usableLen) : '';
-    offload.carry = combined.slice(usableLen);
-    if (toDecode.length === 0) return;
-    const decoded = Buffer.from(toDecode, 'base64');
-    if (decoded.length === 0) return;
-    fs.writeSync(offload.fd, decoded);
-    offload.bytesWritten += decoded.length;
-  }
-
-  private finishOffload(offload: OffloadState): string {
-    if (offload.carry.length > 0) {
-      const decoded = Buffer.from(offload.carry, 'base64');
-      if (decoded.length > 0) {
-        fs.writeSync(offload.fd, decoded);
-        offload.bytesWritten += decoded.length;
-      }
-      offload.carry = '';
-    }
-    fs.closeSync(offload.fd);
-    return offload.filePath;
-  }
-
-  private abortOffload(offload: OffloadState): void {
-    try {
-      fs.closeSync(offload.fd);
-    } catch {
-      // ignore
-    }
-    try {
-      fs.unlinkSync(offload.filePath);
-    } catch {
-      // ignore
-    }
-  }
-
   private scheduleCleanup(filePath: string): void {
     if (this.offloadCleanupDelayMs <= 0) {
       try {
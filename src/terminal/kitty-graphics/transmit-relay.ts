@@ -5,7 +5,6 @@ import {
   ESC,
   KITTY_PREFIX_ESC,
   buildGuestKey,
-  createTempFilePath,
   estimateDecodedSize,
   mergeTransmitParams,
   normalizeParamId,
@@ -19,6 +18,13 @@ import {
   type TransmitParams,
 } from './sequence-utils';
 import { resolveKittyOffloadCleanupDelay, resolveKittyOffloadThreshold } from './offload-utils';
+import {
+  abortOffload,
+  appendOffload,
+  finishOffload,
+  startOffload,
+  type OffloadState,
+} from './offload-writer';
 
 type PendingChunk = {
   guestKey: string;
@@ -29,13 +35,6 @@ type PendingChunk = {
   controlParams: Map<string, string> | null;
 };
 
-type OffloadState = {
-  fd: number;
-  filePath: string;
-  carry: string;
-  bytesWritten: number;
-};
-
 export type KittyTransmitRelayResult = {
   emuSequence: string;
   forwardSequence: string | null;
@@ -66,7 +65,7 @@ export class KittyTransmitRelay {
 
   dispose(): void {
     if (this.pendingChunk?.offload) {
-      this.abortOffload(this.pendingChunk.offload);
+      abortOffload(this.pendingChunk.offload);
     }
     this.pendingChunk = null;
     this.stubbedGuestKeys.clear();
@@ -138,7 +137,7 @@ export class KittyTransmitRelay {
 
     if (this.pendingChunk && this.pendingChunk.guestKey !== guestKey) {
       if (this.pendingChunk.offload) {
-        this.abortOffload(this.pendingChunk.offload);
+        abortOffload(this.pendingChunk.offload);
       }
       this.pendingChunk = null;
     }
@@ -164,8 +163,8 @@ export class KittyTransmitRelay {
     let offloadDims: { width: number; height: number } | null = null;
     let forwardSequence: string | null = null;
     if (shouldOffload) {
-      const offload = activeOffload ?? this.startOffload();
-      this.appendOffload(offload, parsed.data);
+      const offload = activeOffload ?? startOffload(this.tempFileCounter++);
+      appendOffload(offload, parsed.data);
       if (transmit.more) {
         this.pendingChunk = {
           guestKey,
@@ -176,7 +175,7 @@ export class KittyTransmitRelay {
           controlParams: new Map(parsed.params),
         };
       } else {
-        const filePath = this.finishOffload(offload);
+        const filePath = finishOffload(offload);
         const payload = Buffer.from(filePath).toString('base64');
         forwardSequence = buildForwardFileSequence(parsed, payload);
         if (shouldStubEmulator) {
@@ -361,51 +360,6 @@ export class KittyTransmitRelay {
     return estimated >= this.offloadThresholdBytes;
   }
 
-  private startOffload(): OffloadState {
-    const filePath = createTempFilePath(this.tempFileCounter++);
-    const fd = fs.openSync(filePath, 'w');
-    return { fd, filePath, carry: '', bytesWritten: 0 };
-  }
-
-  private appendOffload(offload: OffloadState, data: string): void {
-    if (!data) return;
-    const combined = `${offload.carry}${data}`;
-    const usableLen = Math.floor(combined.length / 4) * 4;
-    const toDecode = usableLen > 0 ? combined.slice(0, usableLen) : '';
-    offload.carry = combined.slice(usableLen);
-    if (toDecode.length === 0) return;
-    const decoded = Buffer.from(toDecode, 'base64');
-    if (decoded.length === 0) return;
-    fs.writeSync(offload.fd, decoded);
-    offload.bytesWritten += decoded.length;
-  }
-
-  private finishOffload(offload: OffloadState): string {
-    if (offload.carry.length > 0) {
-      const decoded = Buffer.from(offload.carry, 'base64');
-      if (decoded.length > 0) {
-        fs.writeSync(offload.fd, decoded);
-        offload.bytesWritten += decoded.length;
-      }
-      offload.carry = '';
-    }
-    fs.closeSync(offload.fd);
-    return offload.filePath;
-  }
-
-  private abortOffload(offload: OffloadState): void {
-    try {
-      fs.closeSync(offload.fd);
-    } catch {
-      // ignore
-    }
-    try {
-      fs.unlinkSync(offload.filePath);
-    } catch {
-      // ignore
-    }
-  }
-
   private scheduleCleanup(filePath: string): void {
     if (this.offloadCleanupDelayMs <= 0) {
       try {
@@ -11,6 +11,7 @@ export type RendererLike = {
   width?: number;
   height?: number;
   writeOut?: (chunk: string) => void;
+  requestRender?: () => void;
   stdout?: NodeJS.WriteStream;
   realStdoutWrite?: (chunk: any, encoding?: any, callback?: any) => boolean;
 };
@@ -56,6 +57,8 @@ export type PtyKittyState = {
 export type ImageCache = {
   hostId: number;
   info: KittyGraphicsImageInfo;
+  /** HostImageCache key; unset for images the transmit broker owns. */
+  key?: string;
 };
 
 export type PlacementRender = {
@@ -0,0 +1,100 @@
+/**
+ * Streaming OSC scanner shared by the title and command parsers.
+ *
+ * Scans raw UTF-8 bytes for `ESC ] <code> ; <text> (BEL | ESC \)` and reports
+ * each completed sequence. State carries across chunks, and the payload is
+ * only decoded to a string once a sequence completes.
+ */
+
+import { decodeUtf8, toBytes, BYTE_BEL, BYTE_ESC } from './byte-utils';
+
+const OSC_BRACKET = 0x5d; // ']'
+const OSC_SEMICOLON = 0x3b; // ';'
+const ST_BACKSLASH = 0x5c; // '\\'
+
+export interface OscSequenceScanner {
+  processData(data: string | Uint8Array): void;
+}
+
+export function createOscSequenceScanner(
+  onComplete: (code: number, text: string) => void
+): OscSequenceScanner {
+  let inOscSequence = false;
+  let collectingText = false; // Whether we've passed the semicolon
+  let code = 0;
+  let hasCode = false;
+  let textBytes: number[] = [];
+
+  function resetOsc(): void {
+    inOscSequence = false;
+    collectingText = false;
+    code = 0;
+    hasCode = false;
+    textBytes = [];
+  }
+
+  function handleOscComplete(): void {
+    const completedCode = hasCode ? code : Number.NaN;
+    const text = textBytes.length > 0 ? decodeUtf8(Uint8Array.from(textBytes)) : '';
+    resetOsc();
+    onComplete(completedCode, text);
+  }
+
+  function processData(input: string | Uint8Array): void {
+    const data = toBytes(input);
+    const len = data.length;
+    let i = 0;
+
+    while (i < len) {
+      if (!inOscSequence) {
+        // Skip straight to the next ESC; plain text needs no per-byte work
+        const esc = data.indexOf(BYTE_ESC, i);
+        if (esc === -1) return;
+        i = esc;
+        if (i + 1 < len && data[i + 1] === OSC_BRACKET) {
+          inOscSequence = true;
+          collectingText = false;
+          code = 0;
+          hasCode = false;
+          textBytes = [];
+          i += 2;
+        } else {
+          i += 1;
+        }
+        continue;
+      }
+
+      const byte = data[i];
+
+      // Check for terminator
+      if (byte === BYTE_BEL) {
+        handleOscComplete();
+        i += 1;
+        continue;
+      }
+
+      if (byte === BYTE_ESC && i + 1 < len && data[i + 1] === ST_BACKSLASH) {
+        handleOscComplete();
+        i += 2;
+        continue;
+      }
+
+      if (!collectingText) {
+        if (byte === OSC_SEMICOLON) {
+          collectingText = true;
+        } else if (byte >= 0x30 && byte <= 0x39) {
+          code = code * 10 + (byte - 0x30);
+          hasCode = true;
+        } else {
+          // Invalid OSC, abort
+          resetOsc();
+        }
+      } else {
+        textBytes.push(byte);
+      }
+      i += 1;
+    }
+  }
+
+  return { processData };
+}
@@ -6,6 +6,7 @@ type TraceMeta = Record<string, unknown>;
 const tracePath = process.env.OPENMUX_PTY_TRACE ?? "";
 const maxChars = Number.parseInt(process.env.OPENMUX_PTY_TRACE_MAX_CHARS ?? "0", 10);
 const enabled = tracePath.length > 0;
+const traceDecoder = new TextDecoder();
 
 if (enabled) {
   try {
@@ -52,9 +53,10 @@ function writeLine(entry: Record<string, unknown>): void {
   }
 }
 
-export function tracePtyChunk(type: string, data: string, meta: TraceMeta = {}): void {
+export function tracePtyChunk(type: string, chunk: string | Uint8Array, meta: TraceMeta = {}): void {
   if (!enabled) return;
-  if (data.length === 0) return;
+  if (chunk.length === 0) return;
+  const data = typeof chunk === "string" ? chunk : traceDecoder.decode(chunk);
   let escaped = escapeForLog(data);
   if (maxChars > 0 && escaped.length > maxChars) {
     const over = escaped.length - maxChars;
@@ -1,38 +1,177 @@
 /**
  * Disk-backed scrollback archive for terminal history.
+ *
+ * Lines are located with a binary search over cumulative chunk offsets and
+ * read with positioned reads on chunk fds kept open in a small LRU, so a
+ * page of history costs one read per chunk rather than an open/read/close
+ * per line.
+ *
+ * Chunks store variable-length row records (see packArchiveRow): trailing
+ * blanks are trimmed, styles are run-length encoded against a per-chunk
+ * style table, and a row offset table built on first use keeps random
+ * access. Chunks from older archives hold fixed-size packRow rows and stay
+ * readable.
+ *
+ * Records keep the soft-wrap flag of the row they came from, so the archive
+ * holds logical lines rather than rows of the width they were written at.
+ * Rows are produced at the archive width (setWidth) when read: each chunk
+ * keeps a histogram of its logical line lengths, so a resize only recounts
+ * rows per chunk, and lines are re-split only when scrolled into view.
+ * A wide cell that would straddle a row boundary moves to the next row, so
+ * chunks holding wide cells count their rows from their records instead.
+ * Raw chunks carry no wrap flags and keep the width they were written at.
+ *
+ * Viewport reads (prefetchLines/loadLines) run on the libuv thread pool and
+ * fill the line cache, reading ahead in the direction of travel; getLine
+ * only reads synchronously on a cache miss.
+ *
+ * Each chunk has a trigram filter sidecar (chunk-N.tri) built as lines are
+ * appended, so literal searches skip chunks that can't contain the query.
+ *
+ * Chunk metadata changes are appended to meta.journal (see
+ * scrollback-journal) after the chunk data they describe, and folded into
+ * meta.json only when the journal grows past checkpointBytes. On load the
+ * journal is replayed over the checkpoint; chunk bytes and files past what
+ * it records are dropped, so a killed process always reopens to the last
+ * journaled append.
  */
 
 import fs from "node:fs"
 import fsp from "node:fs/promises"
 import path from "node:path"
-import type { TerminalCell } from "../core/types"
-import { packRow, unpackRow, CELL_SIZE } from "./cell-serialization"
+import type { TerminalCell, TerminalRow } from "../core/types"
+import type { LineNumbering } from "./emulator-interface"
+import {
+  MAX_ARCHIVE_STYLES,
+  StyleInterner,
+  packArchiveRecord,
+  readArchiveRecordHeader,
+  scanArchiveRecord,
+  unpackArchiveRow,
+  unpackRow,
+} from "./cell-serialization"
 import { ScrollbackCache } from "./emulator-utils/scrollback-cache"
+import {
+  addLineTrigrams,
+  createTrigramFilter,
+  filterMayContain,
+  isTrigramFilterSize,
+  queryTrigramBits,
+} from "./scrollback-trigrams"
+import {
+  JOURNAL_HEADER_BYTES,
+  encodeJournalEntries,
+  encodeJournalHeader,
+  readJournal,
+  type JournalEntry,
+} from "./scrollback-journal"
 import {
   SCROLLBACK_ARCHIVE_CHUNK_MAX_LINES,
   SCROLLBACK_ARCHIVE_MAX_BYTES_PER_PTY,
 } from "./scrollback-config"
+import { extractRowText, rowFromCells } from "./terminal-row"
+
+/** Chunk files kept open for reads; older fds are closed LRU-first. */
+const MAX_OPEN_CHUNK_FDS = 16
+
+/** Rows read ahead of a viewport prefetch, in the direction of travel. */
+const READ_AHEAD_LINES = 256
+
+const NO_WIDE_CELLS: readonly number[] = []
+
+/** Journal size past which metadata is checkpointed into meta.json. */
+const JOURNAL_CHECKPOINT_BYTES = 64 * 1024
+
+const CHUNK_FILE_PATTERN = /^chunk-(\d+)\.(bin|tri)$/
+
+const META_VERSION = 3
+
+/** "raw": fixed-size packRow rows (version 1 archives); "compact": row records. */
+type ChunkEncoding = "raw" | "compact"
+
+/** Style table and record index of a compact chunk. */
+type ChunkRecords = {
+  styles: StyleInterner
+  /** offsets[i] is the byte offset of record i. */
+  offsets: number[]
+  /** Content cells of each record (see ArchiveRecordHeader.used). */
+  used: number[]
+  /** Whether each record soft-wraps into the next. */
+  wrapped: boolean[]
+  /** Columns of each record's wide cells. */
+  wide: (readonly number[])[]
+  /** Byte offset just past the last indexed record. */
+  end: number
+}
+
+/** Where a compact chunk's logical lines start at one width. */
+type ChunkLayout = {
+  width: number
+  /** Records indexed when the layout was built. */
+  records: number
+  /** First record of each logical line. */
+  lineRecords: number[]
+  /** First chunk-relative row of each logical line. */
+  lineRows: number[]
+  rows: number
+}
+
+/** One positioned read of a chunk, and how to turn its bytes into rows. */
+type ChunkRead = {
+  position: number
+  length: number
+  decode: (data: Uint8Array, bytesRead: number) => TerminalCell[][]
+}
 
 type ArchiveChunk = {
   id: number
   filename: string
   path: string
+  encoding: ChunkEncoding
+  /** Compact chunks: built on first use; null when the file can't be read. */
+  records?: ChunkRecords | null
+  /** Trigram filter sidecar: u32 line count, then the filter bitset. */
+  indexPath: string
+  /** Loaded lazily; null when the sidecar is missing or stale. */
+  filter?: Uint32Array | null
   cols: number
+  /** Raw chunks: bytes per packRow row (0 for compact chunks). */
   rowBytes: number
+  /** Records (rows as written) in the chunk. */
   lineCount: number
+  /** Compact chunks: logical line length -> count, excluding the open line. */
+  lineLengths: Map<number, number>
+  /** Cells in a trailing logical line that still wraps (0 = none). */
+  openLength: number
+  /** Line-relative columns of the open line's wide cells. */
+  openWide?: readonly number[]
+  /** Whether any line has wide cells; undefined until the records are read. */
+  wideCells?: boolean
+  /** Last characters of the open line, to index trigrams across the wrap. */
+  openTail?: string
+  /** Rows at the archive width. */
+  rows: number
+  layout?: ChunkLayout
   bytes: number
   createdAt: number
 }
 
 type ArchiveMeta = {
   version: number
+  /** Checkpoint number; meta.journal only applies if its header matches. */
+  checkpoint?: number
   nextChunkId: number
   chunks: Array<{
     id: number
     filename: string
+    encoding?: ChunkEncoding
     cols: number
     rowBytes: number
     lineCount: number
+    /** Flattened [length, count] pairs of lineLengths. */
+    lineLengths?: number[]
+    openLength?: number
+    wideCells?: boolean
     bytes: number
     createdAt: number
   }>
@@ -41,11 +180,28 @@ type ArchiveMeta = {
 export class ScrollbackArchive {
   private readonly rootDir: string
   private readonly metaPath: string
+  private readonly journalPath: string
+  private readonly checkpointBytes: number
+  private checkpointId = 0
+  /** Entry bytes in the journal since the last checkpoint. */
+  private journalBytes = 0
   private readonly maxBytes: number
   private readonly chunkMaxLines: number
   private readonly cache: ScrollbackCache
   private readonly manager?: ScrollbackArchiveManager
   private chunks: ArchiveChunk[] = []
+  /** chunkStarts[i] is the archive offset of chunks[i]'s first row. */
+  private chunkStarts: number[] = []
+  /** Width rows are produced at; 0 keeps each logical line on one row. */
+  private width = 0
+  /** Bumped whenever rows move or are re-split; async reads started earlier are dropped. */
+  private epoch = 0
+  /** Rows dropped from the top so far; later offsets moved down by as many. */
+  private droppedRows = 0
+  /** Bumped when offsets move other than by a drop (reflow, reset). */
+  private renumberings = 0
+  private lastPrefetch: number | null = null
+  private readonly fds = new ChunkFdCache(MAX_OPEN_CHUNK_FDS)
   private totalLines = 0
   private totalBytes = 0
   private nextChunkId = 1
@@ -57,10 +213,15 @@ export class ScrollbackArchive {
     maxBytes?: number
     chunkMaxLines?: number
     cacheSize?: number
+    checkpointBytes?: number
     manager?: ScrollbackArchiveManager
+    /** Share of the manager's budget relative to other archives (default 1). */
+    quotaWeight?: number
   }) {
     this.rootDir = options.rootDir
     this.metaPath = path.join(this.rootDir, "meta.json")
+    this.journalPath = path.join(this.rootDir, "meta.journal")
+    this.checkpointBytes = options.checkpointBytes ?? JOURNAL_CHECKPOINT_BYTES
     this.maxBytes = options.maxBytes ?? SCROLLBACK_ARCHIVE_MAX_BYTES_PER_PTY
     this.chunkMaxLines = options.chunkMaxLines ?? SCROLLBACK_ARCHIVE_CHUNK_MAX_LINES
     this.cache = new ScrollbackCache(options.cacheSize ?? 4000)
@@ -68,7 +229,7 @@ export class ScrollbackArchive {
 
     this.ensureDir()
     this.loadMeta()
-    this.manager?.register(this)
+    this.manager?.register(this, options.quotaWeight)
     this.enforceLimit()
     this.manager?.enforceGlobalLimit()
   }
@@ -77,6 +238,11 @@ export class ScrollbackArchive {
     return this.totalLines
   }
 
+  /** How offsets are numbered; see LineNumbering. */
+  get numbering(): LineNumbering {
+    return { epoch: this.renumberings, dropped: this.droppedRows }
+  }
+
   get bytes(): number {
     return this.totalBytes
   }
@@ -89,23 +255,44 @@ export class ScrollbackArchive {
     this.cache.clear()
   }
 
+  /**
+   * Produce rows `cols` wide from now on. Only row counts are recomputed
+   * here; lines are re-split as they are read.
+   */
+  setWidth(cols: number): void {
+    const width = Math.max(0, Math.floor(cols))
+    if (width === this.width) return
+    this.width = width
+    this.epoch += 1
+    this.renumberings += 1
+    this.cache.clear()
+    this.totalLines = 0
+    for (let i = 0; i < this.chunks.length; i++) {
+      const chunk = this.chunks[i]
+      chunk.rows = this.countRows(chunk)
+      this.chunkStarts[i] = this.totalLines
+      this.totalLines += chunk.rows
+    }
+  }
+
   reset(): void {
     const chunksToDelete = this.chunks
     this.generation += 1
+    this.epoch += 1
+    this.renumberings += 1
+    this.fds.closeAll()
     this.chunks = []
+    this.chunkStarts = []
     this.totalLines = 0
     this.totalBytes = 0
     this.nextChunkId = 1
     this.cache.clear()
+    this.manager?.update(this)
     void this.enqueue(async () => {
       for (const chunk of chunksToDelete) {
-        try {
-          await fsp.unlink(chunk.path)
-        } catch {
-          // Ignore cleanup errors.
-        }
+        await removeChunkFiles(chunk)
       }
-      await this.flushMeta()
+      await this.checkpoint()
     })
   }
 
@@ -114,20 +301,38 @@ export class ScrollbackArchive {
     this.manager?.unregister(this)
   }
 
-  appendLines(lines: TerminalCell[][]): Promise<void> {
-    if (lines.length === 0) return Promise.resolve()
+  /**
+   * Append rows, oldest first. `wrapped[i]` marks rows that soft-wrap into
+   * the next one; a trailing wrapped row is continued by the next append.
+   */
+  appendLines(lines: TerminalCell[][], wrapped?: boolean[]): Promise<void> {
+    return this.appendRows(lines.map((line) => rowFromCells(line)), wrapped)
+  }
+
+  /** appendLines for packed rows, which are encoded without cell objects. */
+  appendRows(rows: TerminalRow[], wrapped?: boolean[]): Promise<void> {
+    if (rows.length === 0) return Promise.resolve()
     const generation = this.generation
-    return this.enqueue(() => this.appendLinesInternal(lines, generation))
+    return this.enqueue(() => this.appendLinesInternal(rows, wrapped, generation))
   }
 
-  private async appendLinesInternal(lines: TerminalCell[][], generation: number): Promise<void> {
+  private async appendLinesInternal(
+    lines: TerminalRow[],
+    wrapped: boolean[] | undefined,
+    generation: number
+  ): Promise<void> {
     if (lines.length === 0) return
     if (generation !== this.generation) return
 
     this.ensureDir()
 
     let currentChunk = this.chunks[this.chunks.length - 1] ?? null
-    let buffered: Buffer[] = []
+    const created: ArchiveChunk[] = []
+    /** Chunks appended to, with the logical line lengths each closed. */
+    const touched = new Map<ArchiveChunk, Map<number, number>>()
+    /** Chunks that got their first wide cells. */
+    const widened: ArchiveChunk[] = []
+    let buffered: Uint8Array[] = []
     let bufferedBytes = 0
 
     const flushBuffer = async (): Promise<boolean> => {
@@ -135,40 +340,98 @@ export class ScrollbackArchive {
       const payload = buffered.length === 1 ? buffered[0] : Buffer.concat(buffered, bufferedBytes)
       await fsp.appendFile(currentChunk.path, payload)
       if (generation !== this.generation) return false
+      await this.writeFilter(currentChunk)
       buffered = []
       bufferedBytes = 0
       return true
     }
 
-    for (const line of lines) {
-      if (line.length === 0) continue
-      const cols = line.length
-      const rowBytes = 4 + cols * CELL_SIZE
+    for (let i = 0; i < lines.length; i++) {
+      const line = lines[i]
+      const cols = line.codepoints.length
+      if (cols === 0) continue
+      const wraps = wrapped?.[i] ?? false
 
-      if (
-        !currentChunk ||
-        currentChunk.cols !== cols ||
-        currentChunk.lineCount >= this.chunkMaxLines
-      ) {
+      if (!currentChunk || !this.canAppend(currentChunk, cols)) {
         const flushed = await flushBuffer()
         if (flushed === false) return
-        currentChunk = this.createChunk(cols, rowBytes)
+        currentChunk = this.createChunk(cols)
         this.chunks.push(currentChunk)
+        this.chunkStarts.push(this.totalLines)
+        created.push(currentChunk)
+      }
+
+      // A chunk reopened without a valid sidecar stays unfiltered
+      const filter = this.loadFilter(currentChunk)
+      const text = filter || wraps ? extractRowText(line) : ""
+      if (filter) {
+        addLineTrigrams(filter, (currentChunk.openTail ?? "") + text)
       }
+      currentChunk.openTail = wraps ? text.slice(-2) : undefined
 
-      const packed = Buffer.from(packRow(line))
-      buffered.push(packed)
-      bufferedBytes += packed.byteLength
+      const records = currentChunk.records!
+      const record = packArchiveRecord(line, records.styles, wraps)
+      const header = readArchiveRecordHeader(new DataView(record.buffer), 0)!
+      records.offsets.push(records.end)
+      records.used.push(header.used)
+      records.wrapped.push(wraps)
+      records.wide.push(header.wide)
+      records.end += record.byteLength
+      buffered.push(record)
+      bufferedBytes += record.byteLength
       currentChunk.lineCount += 1
-      currentChunk.bytes += rowBytes
-      this.totalLines += 1
-      this.totalBytes += rowBytes
+      currentChunk.bytes += record.byteLength
+      this.totalBytes += record.byteLength
+
+      let closed = touched.get(currentChunk)
+      if (!closed) {
+        closed = new Map()
+        touched.set(currentChunk, closed)
+      }
+      if (!wraps) {
+        const length = currentChunk.openLength + header.used
+        closed.set(length, (closed.get(length) ?? 0) + 1)
+      }
+
+      if (currentChunk.openLength > 0) {
+        // The open line is re-split with these cells: its cached rows, and
+        // reads planned against the old split, are stale
+        this.cache.deleteFrom(this.totalLines - this.lineRows(currentChunk.openLength, currentChunk.openWide))
+        this.epoch += 1
+      }
+      if (header.wide.length > 0 && !currentChunk.wideCells) {
+        currentChunk.wideCells = true
+        widened.push(currentChunk)
+      }
+      const rowsBefore = currentChunk.rows
+      this.addLineCells(currentChunk, header.used, wraps, header.wide)
+      this.totalLines += currentChunk.rows - rowsBefore
     }
 
     const flushed = await flushBuffer()
     if (flushed === false || generation !== this.generation) return
-    await this.flushMeta()
+    const entries: JournalEntry[] = created.map((chunk) => ({
+      type: "create" as const,
+      id: chunk.id,
+      cols: chunk.cols,
+      createdAt: chunk.createdAt,
+    }))
+    for (const [chunk, closed] of touched) {
+      entries.push({
+        type: "append",
+        id: chunk.id,
+        lineCount: chunk.lineCount,
+        bytes: chunk.bytes,
+        openLength: chunk.openLength,
+        lineLengths: Array.from(closed).flat(),
+      })
+    }
+    for (const chunk of widened) {
+      entries.push({ type: "wide", id: chunk.id })
+    }
+    await this.writeJournal(entries)
     if (generation !== this.generation) return
+    this.manager?.update(this)
     this.enforceLimit()
     this.manager?.enforceGlobalLimit()
   }
@@ -186,34 +449,114 @@ export class ScrollbackArchive {
     return row
   }
 
-  prefetchLines(startOffset: number, count: number): void {
-    if (count <= 0) return
-    const start = Math.max(0, startOffset)
-    const endOffset = Math.min(this.totalLines, start + count)
-    for (let offset = start; offset < endOffset; offset++) {
-      if (this.cache.get(offset)) continue
+  /** Whether the row at `offset` soft-wraps into the next one. */
+  isWrapped(offset: number): boolean {
+    const found = this.findChunk(offset)
+    if (!found || found.chunk.encoding !== "compact") return false
+    const records = this.loadRecords(found.chunk)
+    if (!records) return false
+
+    const layout = this.layoutOf(found.chunk, records)
+    const line = lastAtOrBefore(layout.lineRows, found.index)
+    const next = line + 1 < layout.lineRows.length ? layout.lineRows[line + 1] : layout.rows
+    if (found.index + 1 < next) return true
+    // The last row of a line wraps only when its record does (an open line)
+    const lastRecord = (line + 1 < layout.lineRecords.length ? layout.lineRecords[line + 1] : records.offsets.length) - 1
+    return records.wrapped[lastRecord] ?? false
+  }
+
+  /**
+   * Load the rows a viewport is about to show, then read ahead in the
+   * direction it moved since the previous prefetch. Resolves once the
+   * requested rows are cached; the read-ahead continues in the background.
+   */
+  async prefetchLines(startOffset: number, count: number): Promise<void> {
+    const previous = this.lastPrefetch
+    this.lastPrefetch = startOffset
+    await this.loadLines(startOffset, count)
+    if (previous === null || previous === startOffset) return
+
+    const aheadStart = startOffset > previous ? startOffset + count : startOffset - READ_AHEAD_LINES
+    void this.loadLines(aheadStart, READ_AHEAD_LINES)
+  }
+
+  /**
+   * Load a range of lines into the cache, one read on the libuv thread pool
+   * per run of uncached lines within a chunk.
+   */
+  async loadLines(startOffset: number, count: number): Promise<void> {
+    let offset = Math.max(0, startOffset)
+    const endOffset = Math.min(this.totalLines, startOffset + count)
+    while (offset < endOffset) {
+      if (this.cache.get(offset)) {
+        offset++
+        continue
+      }
       const found = this.findChunk(offset)
       if (!found) break
-      this.readChunkRange(found.chunk, found.chunkStart, found.index, 1)
+
+      const runLimit = Math.min(endOffset, found.chunkStart + found.chunk.rows)
+      let runEnd = offset + 1
+      while (runEnd < runLimit && !this.cache.get(runEnd)) {
+        runEnd++
+      }
+      const rows = await this.readChunkRangeAsync(found.chunk, found.chunkStart, found.index, runEnd - offset)
+      if (rows.length === 0) break
+      offset += rows.length
+    }
+  }
+
+  /**
+   * Split [start, end) into runs of lines whose chunks may contain `query`
+   * as a case-insensitive substring. Chunks ruled out by their trigram
+   * filter are skipped; chunks without one are always included.
+   */
+  candidateRanges(query: string, start: number, end: number): Array<[number, number]> {
+    const from = Math.max(0, start)
+    const to = Math.min(this.totalLines, end)
+    if (from >= to) return []
+
+    const bits = queryTrigramBits(query)
+    if (!bits) return [[from, to]]
+
+    const ranges: Array<[number, number]> = []
+    for (let i = this.chunkIndexAt(from); i < this.chunks.length && this.chunkStarts[i] < to; i++) {
+      const chunk = this.chunks[i]
+      const filter = this.loadFilter(chunk)
+      if (filter && !filterMayContain(filter, bits)) continue
+
+      const rangeStart = Math.max(from, this.chunkStarts[i])
+      const rangeEnd = Math.min(to, this.chunkStarts[i] + chunk.rows)
+      const last = ranges[ranges.length - 1]
+      if (last && last[1] === rangeStart) {
+        last[1] = rangeEnd
+      } else {
+        ranges.push([rangeStart, rangeEnd])
+      }
     }
+    return ranges
   }
 
   dropOldestChunk(): { linesRemoved: number; bytesRemoved: number } | null {
     const chunk = this.chunks.shift()
     if (!chunk) return null
 
-    this.totalLines -= chunk.lineCount
+    this.fds.close(chunk.id)
+    this.chunkStarts.shift()
+    for (let i = 0; i < this.chunkStarts.length; i++) {
+      this.chunkStarts[i] -= chunk.rows
+    }
+    this.totalLines -= chunk.rows
     this.totalBytes -= chunk.bytes
+    this.epoch += 1
+    this.droppedRows += chunk.rows
     this.cache.clear()
+    this.manager?.update(this)
     void this.enqueue(async () => {
-      try {
-        await fsp.unlink(chunk.path)
-      } catch {
-        // Ignore cleanup errors.
-      }
-      await this.flushMeta()
+      await removeChunkFiles(chunk)
+      await this.writeJournal([{ type: "drop", id: chunk.id }])
     })
-    return { linesRemoved: chunk.lineCount, bytesRemoved: chunk.bytes }
+    return { linesRemoved: chunk.rows, bytesRemoved: chunk.bytes }
   }
 
   private enqueue(task: () => Promise<void>): Promise<void> {
@@ -228,31 +571,128 @@ export class ScrollbackArchive {
     fs.mkdirSync(this.rootDir, { recursive: true })
   }
 
-  private createChunk(cols: number, rowBytes: number): ArchiveChunk {
+  /**
+   * Whether a row of width `cols` can go on the end of `chunk`. Older raw
+   * chunks are never extended, and a compact chunk is only extended when
+   * its records were all indexed and its style table has room. Full chunks
+   * still take the rest of an open logical line, up to twice their size,
+   * so lines rarely span chunks; an open line reloaded from disk is
+   * closed instead, since its trigram tail is gone.
+   */
+  private canAppend(chunk: ArchiveChunk, cols: number): boolean {
+    if (chunk.encoding !== "compact") return false
+    if (chunk.openLength > 0 ? chunk.openTail === undefined : chunk.lineCount >= this.chunkMaxLines) return false
+    if (chunk.lineCount >= this.chunkMaxLines * 2) return false
+    const records = this.loadRecords(chunk)
+    if (!records || records.offsets.length !== chunk.lineCount || records.end !== chunk.bytes) {
+      return false
+    }
+    return records.styles.fg.length + cols <= MAX_ARCHIVE_STYLES
+  }
+
+  /**
+   * Rows a logical line of `length` cells takes at the archive width, given
+   * the (ascending) columns of its wide cells; see rowStarts.
+   */
+  private lineRows(length: number, wide: readonly number[] = NO_WIDE_CELLS): number {
+    if (this.width === 0) return 1
+    if (wide.length === 0) return Math.max(1, Math.ceil(length / this.width))
+    return this.rowStarts(length, wide).length
+  }
+
+  /**
+   * First cell of each row of a logical line. A wide cell that would land
+   * in the last column moves to the next row, which keeps it whole.
+   */
+  private rowStarts(length: number, wide: readonly number[]): number[] {
+    const width = this.width
+    // A wide cell's trimmed spacer still takes a column
+    const end = wide.length > 0 ? Math.max(length, wide[wide.length - 1] + 2) : length
+    const starts = [0]
+    let start = 0
+    let next = 0
+    while (end - start > width) {
+      const cut = start + width
+      while (next < wide.length && wide[next] < cut - 1) next++
+      start = width >= 2 && wide[next] === cut - 1 ? cut - 1 : cut
+      starts.push(start)
+    }
+    return starts
+  }
+
+  private countRows(chunk: ArchiveChunk): number {
+    if (chunk.encoding === "raw") return chunk.lineCount
+    if (chunk.wideCells !== false) {
+      // Wide cells may move to the next row depending on the width
+      const records = this.loadRecords(chunk)
+      if (records) return this.layoutOf(chunk, records).rows
+    }
+    let rows = chunk.openLength > 0 ? this.lineRows(chunk.openLength) : 0
+    for (const [length, count] of chunk.lineLengths) {
+      rows += count * this.lineRows(length)
+    }
+    return rows
+  }
+
+  /**
+   * Account for a record of `used` cells, with wide cells at columns
+   * `wide`, in the chunk's line lengths.
+   */
+  private addLineCells(chunk: ArchiveChunk, used: number, wraps: boolean, wide: readonly number[]): void {
+    const length = chunk.openLength + used
+    const openWide = chunk.openWide ?? NO_WIDE_CELLS
+    const lineWide = wide.length > 0
+      ? [...openWide, ...wide.map((column) => chunk.openLength + column)]
+      : openWide
+    if (chunk.openLength > 0) chunk.rows -= this.lineRows(chunk.openLength, openWide)
+    if (wraps) {
+      chunk.openLength = length
+      chunk.openWide = lineWide
+    } else {
+      chunk.lineLengths.set(length, (chunk.lineLengths.get(length) ?? 0) + 1)
+      chunk.openLength = 0
+      chunk.openWide = undefined
+    }
+    chunk.rows += this.lineRows(length, lineWide)
+  }
+
+  private createChunk(cols: number): ArchiveChunk {
     const id = this.nextChunkId++
     const filename = `chunk-${id}.bin`
+    const chunkPath = path.join(this.rootDir, filename)
     return {
       id,
       filename,
-      path: path.join(this.rootDir, filename),
+      path: chunkPath,
+      encoding: "compact",
+      records: { styles: new StyleInterner(), offsets: [], used: [], wrapped: [], wide: [], end: 0 },
+      indexPath: indexPathFor(chunkPath),
+      filter: createTrigramFilter(),
       cols,
-      rowBytes,
+      rowBytes: 0,
       lineCount: 0,
+      lineLengths: new Map(),
+      openLength: 0,
+      wideCells: false,
+      rows: 0,
       bytes: 0,
       createdAt: Date.now(),
     }
   }
 
+  /** Index of the last chunk whose first row is at or before offset. */
+  private chunkIndexAt(offset: number): number {
+    return lastAtOrBefore(this.chunkStarts, offset)
+  }
+
   private findChunk(offset: number): { chunk: ArchiveChunk; chunkStart: number; index: number } | null {
-    let start = 0
-    for (const chunk of this.chunks) {
-      const end = start + chunk.lineCount
-      if (offset < end) {
-        return { chunk, chunkStart: start, index: offset - start }
-      }
-      start = end
-    }
-    return null
+    if (offset < 0 || offset >= this.totalLines) return null
+
+    const lo = this.chunkIndexAt(offset)
+    const chunk = this.chunks[lo]
+    const chunkStart = this.chunkStarts[lo]
+    if (!chunk || offset >= chunkStart + chunk.rows) return null
+    return { chunk, chunkStart, index: offset - chunkStart }
   }
 
   private readRow(
@@ -270,46 +710,317 @@ export class ScrollbackArchive {
     index: number,
     count: number
   ): TerminalCell[][] {
-    const maxCount = Math.min(count, chunk.lineCount - index)
-    if (maxCount <= 0) return []
+    if (chunk.encoding === "compact" && !this.loadRecords(chunk)) return []
+    const read = this.planRead(chunk, chunkStart, index, count)
+    if (!read) return []
 
-    const rowBytes = chunk.rowBytes
-    const totalBytes = rowBytes * maxCount
-    const buffer = Buffer.alloc(totalBytes)
-    const offsetBytes = rowBytes * index
+    const fd = this.fds.get(chunk)
+    if (fd === null) return []
 
+    const data = new Uint8Array(read.length)
     let bytesRead = 0
-    let fd: number | null = null
     try {
-      fd = fs.openSync(chunk.path, "r")
-      bytesRead = fs.readSync(fd, buffer, 0, totalBytes, offsetBytes)
+      bytesRead = fs.readSync(fd, data, 0, read.length, read.position)
+    } catch {
+      this.fds.close(chunk.id)
+      return []
+    }
+    return read.decode(data, bytesRead)
+  }
+
+  private async readChunkRangeAsync(
+    chunk: ArchiveChunk,
+    chunkStart: number,
+    index: number,
+    count: number
+  ): Promise<TerminalCell[][]> {
+    const epoch = this.epoch
+    if (chunk.encoding === "compact" && !(await this.loadRecordsAsync(chunk))) return []
+    if (epoch !== this.epoch) return []
+    const read = this.planRead(chunk, chunkStart, index, count)
+    if (!read) return []
+
+    const fd = await this.fds.acquire(chunk)
+    if (fd === null) return []
+
+    const data = new Uint8Array(read.length)
+    let bytesRead = 0
+    try {
+      bytesRead = await readAt(fd, data, read.position)
     } catch {
+      this.fds.close(chunk.id)
       return []
     } finally {
-      if (fd !== null) {
-        try {
-          fs.closeSync(fd)
-        } catch {
-          // Ignore close errors.
+      this.fds.release(fd)
+    }
+    // Rows moved (resize, eviction, reset) while the read was in flight
+    if (epoch !== this.epoch) return []
+    return read.decode(data, bytesRead)
+  }
+
+  /**
+   * Plan the read behind rows [index, index + count) of a chunk. Compact
+   * chunks need their records loaded first.
+   */
+  private planRead(
+    chunk: ArchiveChunk,
+    chunkStart: number,
+    index: number,
+    count: number
+  ): ChunkRead | null {
+    const maxCount = Math.min(count, chunk.rows - index)
+    if (maxCount <= 0) return null
+    if (chunk.encoding === "compact") {
+      return this.planLinesRead(chunk, chunkStart, index, maxCount)
+    }
+
+    const rowBytes = chunk.rowBytes
+    return {
+      position: rowBytes * index,
+      length: rowBytes * maxCount,
+      decode: (data, bytesRead) => {
+        const rows: TerminalCell[][] = []
+        const totalRows = Math.floor(bytesRead / rowBytes)
+        for (let i = 0; i < totalRows; i++) {
+          const row = unpackRow(data.buffer as ArrayBuffer, i * rowBytes)
+          rows.push(row)
+          this.cache.set(chunkStart + index + i, row)
         }
-      }
+        return rows
+      },
     }
+  }
+
+  /**
+   * Plan one read of the records behind rows [index, index + count) of a
+   * compact chunk. Every row of the logical lines touched is cached, since
+   * scrolling usually reaches the neighbouring rows next.
+   */
+  private planLinesRead(
+    chunk: ArchiveChunk,
+    chunkStart: number,
+    index: number,
+    count: number
+  ): ChunkRead | null {
+    const records = chunk.records
+    if (!records) return null
+    const layout = this.layoutOf(chunk, records)
+    const endRow = Math.min(index + count, layout.rows)
+    if (index >= endRow) return null
 
-    if (bytesRead < rowBytes) return []
+    const firstLine = lastAtOrBefore(layout.lineRows, index)
+    const lastLine = lastAtOrBefore(layout.lineRows, endRow - 1)
+    const lineEnd = (line: number) =>
+      line + 1 < layout.lineRecords.length ? layout.lineRecords[line + 1] : records.offsets.length
+    const recordEnd = (record: number) =>
+      record + 1 < records.offsets.length ? records.offsets[record + 1] : records.end
+    const startByte = records.offsets[layout.lineRecords[firstLine]]
+
+    return {
+      position: startByte,
+      length: recordEnd(lineEnd(lastLine) - 1) - startByte,
+      decode: (data, bytesRead) => {
+        // Rows still buffered by an in-flight append read short and are skipped
+        const view = new DataView(data.buffer, data.byteOffset, bytesRead)
+        const rows: TerminalCell[][] = []
+        for (let line = firstLine; line <= lastLine; line++) {
+          const last = lineEnd(line) - 1
+          if (recordEnd(last) - startByte > bytesRead) break
+
+          let cells: TerminalCell[] = []
+          let length = 0
+          for (let record = layout.lineRecords[line]; record <= last; record++) {
+            const row = unpackArchiveRow(view, records.offsets[record] - startByte, records.styles)
+            cells = cells.concat(record < last ? row.slice(0, records.used[record]) : row)
+            length += records.used[record]
+          }
+
+          const lineStart = layout.lineRows[line]
+          const split = this.splitLine(cells, length)
+          for (let k = 0; k < split.length; k++) {
+            const rowIndex = lineStart + k
+            this.cache.set(chunkStart + rowIndex, split[k])
+            if (rowIndex >= index && rowIndex < endRow) rows.push(split[k])
+          }
+        }
+        return rows
+      },
+    }
+  }
+
+  /**
+   * Split a logical line of `length` content cells into rows of the
+   * archive width. Cells past `length` are its trailing blanks, kept when
+   * they fit and padded with the last cell's style otherwise. A row whose
+   * last column would hold a wide cell ends with a blank instead.
+   */
+  private splitLine(cells: TerminalCell[], length: number): TerminalCell[][] {
+    const width = this.width
+    if (width === 0) return [cells]
+    const wide: number[] = []
+    for (let x = 0; x < length; x++) {
+      if (cells[x].width === 2) wide.push(x)
+    }
+    const starts = this.rowStarts(length, wide)
+    if (starts.length === 1 && cells.length === width) return [cells]
 
     const rows: TerminalCell[][] = []
-    const totalRows = Math.floor(bytesRead / rowBytes)
-    for (let i = 0; i < totalRows; i++) {
-      const slice = buffer.subarray(i * rowBytes, (i + 1) * rowBytes)
-      const row = unpackRow(toArrayBuffer(slice))
+    const last = cells[cells.length - 1]
+    for (let k = 0; k < starts.length; k++) {
+      const end = k + 1 < starts.length ? starts[k + 1] : starts[k] + width
+      const row = cells.slice(starts[k], end)
+      while (row.length < width) {
+        row.push({ ...last, char: " ", width: 1 })
+      }
       rows.push(row)
-      const absoluteOffset = chunkStart + index + i
-      this.cache.set(absoluteOffset, row)
     }
-
     return rows
   }
 
+  private layoutOf(chunk: ArchiveChunk, records: ChunkRecords): ChunkLayout {
+    const cached = chunk.layout
+    if (cached && cached.width === this.width && cached.records === records.offsets.length) {
+      return cached
+    }
+
+    const lineRecords: number[] = []
+    const lineRows: number[] = []
+    let rows = 0
+    let record = 0
+    while (record < records.offsets.length) {
+      lineRecords.push(record)
+      lineRows.push(rows)
+      let length = 0
+      let wide = NO_WIDE_CELLS
+      do {
+        if (records.wide[record].length > 0) {
+          wide = [...wide, ...records.wide[record].map((column) => length + column)]
+        }
+        length += records.used[record]
+        record++
+      } while (records.wrapped[record - 1] && record < records.offsets.length)
+      rows += this.lineRows(length, wide)
+    }
+    chunk.layout = { width: this.width, records: record, lineRecords, lineRows, rows }
+    return chunk.layout
+  }
+
+  /**
+   * Index a compact chunk's records and rebuild its style table with one
+   * read of the file. Bytes past the last row in the metadata (left by an
+   * append that never reached meta.json) are truncated so new rows follow
+   * the indexed ones.
+   */
+  private loadRecords(chunk: ArchiveChunk): ChunkRecords | null {
+    if (chunk.records !== undefined) return chunk.records
+    chunk.records = null
+
+    const fd = this.fds.get(chunk)
+    if (fd === null) return null
+    let data: Uint8Array
+    try {
+      data = new Uint8Array(fs.fstatSync(fd).size)
+      const bytesRead = fs.readSync(fd, data, 0, data.byteLength, 0)
+      data = data.subarray(0, bytesRead)
+    } catch {
+      this.fds.close(chunk.id)
+      return null
+    }
+    return this.indexRecords(chunk, data)
+  }
+
+  private async loadRecordsAsync(chunk: ArchiveChunk): Promise<ChunkRecords | null> {
+    if (chunk.records !== undefined) return chunk.records
+
+    const fd = await this.fds.acquire(chunk)
+    if (fd === null) return null
+    let data: Uint8Array | null = null
+    try {
+      data = new Uint8Array(await sizeOf(fd))
+      const bytesRead = await readAt(fd, data, 0)
+      data = data.subarray(0, bytesRead)
+    } catch {
+      this.fds.close(chunk.id)
+    } finally {
+      this.fds.release(fd)
+    }
+
+    // A synchronous read or an append may have indexed the chunk meanwhile
+    if (chunk.records !== undefined) return chunk.records
+    if (!data) {
+      chunk.records = null
+      return null
+    }
+    return this.indexRecords(chunk, data)
+  }
+
+  private indexRecords(chunk: ArchiveChunk, data: Uint8Array): ChunkRecords {
+    const view = new DataView(data.buffer, data.byteOffset, data.byteLength)
+    const styles = new StyleInterner()
+    const offsets: number[] = []
+    const used: number[] = []
+    const wrapped: boolean[] = []
+    const wide: (readonly number[])[] = []
+    let wideCells = false
+    let end = 0
+    while (offsets.length < chunk.lineCount) {
+      const header = scanArchiveRecord(view, end, styles)
+      if (!header) break
+      offsets.push(end)
+      used.push(header.used)
+      wrapped.push(header.wrapped)
+      wide.push(header.wide)
+      wideCells ||= header.wide.length > 0
+      end = header.next
+    }
+
+    if (offsets.length === chunk.lineCount && data.byteLength > end) {
+      try {
+        fs.truncateSync(chunk.path, end)
+      } catch {
+        // Appends check records.end against chunk.bytes instead.
+      }
+    }
+
+    chunk.records = { styles, offsets, used, wrapped, wide, end }
+    chunk.wideCells = wideCells
+    return chunk.records
+  }
+
+  /**
+   * The chunk's trigram filter, read from its sidecar on first use. The
+   * sidecar is ignored unless it was written for the chunk's current line
+   * count, so an interrupted append never hides lines from search.
+   */
+  private loadFilter(chunk: ArchiveChunk): Uint32Array | null {
+    if (chunk.filter !== undefined) return chunk.filter
+    chunk.filter = null
+    try {
+      const data = fs.readFileSync(chunk.indexPath)
+      if (isTrigramFilterSize(data.byteLength - 4) && data.readUInt32LE(0) === chunk.lineCount) {
+        const filter = createTrigramFilter()
+        new Uint8Array(filter.buffer).set(data.subarray(4))
+        chunk.filter = filter
+      }
+    } catch {
+      // Missing sidecar: the chunk is searched without a filter.
+    }
+    return chunk.filter
+  }
+
+  private async writeFilter(chunk: ArchiveChunk): Promise<void> {
+    const filter = chunk.filter
+    if (!filter) return
+    const data = Buffer.allocUnsafe(4 + filter.byteLength)
+    data.writeUInt32LE(chunk.lineCount, 0)
+    data.set(new Uint8Array(filter.buffer, filter.byteOffset, filter.byteLength), 4)
+    try {
+      await fsp.writeFile(chunk.indexPath, data)
+    } catch {
+      // A stale sidecar is discarded on load.
+    }
+  }
+
   private enforceLimit(): void {
     while (this.totalBytes > this.maxBytes) {
       const removed = this.dropOldestChunk()
@@ -317,111 +1028,526 @@ export class ScrollbackArchive {
     }
   }
 
+  /** Load the meta.json checkpoint and replay meta.journal over it. */
   private loadMeta(): void {
-    if (!fs.existsSync(this.metaPath)) return
+    const chunks = new Map<number, ArchiveChunk>()
     let parsed: ArchiveMeta | null = null
     try {
       parsed = JSON.parse(fs.readFileSync(this.metaPath, "utf8")) as ArchiveMeta
     } catch {
-      return
+      // No checkpoint yet: the journal holds everything.
+    }
+    // Version 2 compact records had no width or wrap flag and are dropped
+    if (parsed && (parsed.version === 1 || parsed.version === META_VERSION)) {
+      this.checkpointId = parsed.checkpoint ?? 0
+      this.nextChunkId = parsed.nextChunkId || 1
+      for (const entry of parsed.chunks ?? []) {
+        const chunk = this.chunkFromEntry(entry.id, entry.filename, entry.encoding ?? "raw", entry.cols, entry.createdAt)
+        chunk.rowBytes = entry.rowBytes
+        chunk.lineCount = entry.lineCount
+        chunk.openLength = entry.openLength ?? 0
+        chunk.wideCells = entry.wideCells
+        chunk.bytes = entry.bytes
+        const pairs = entry.lineLengths ?? []
+        for (let i = 0; i + 1 < pairs.length; i += 2) {
+          chunk.lineLengths.set(pairs[i], pairs[i + 1])
+        }
+        chunks.set(chunk.id, chunk)
+      }
     }
-    if (!parsed || parsed.version !== 1) return
+
+    this.replayJournal(chunks)
 
     this.chunks = []
+    this.chunkStarts = []
     this.totalLines = 0
     this.totalBytes = 0
-    this.nextChunkId = parsed.nextChunkId || 1
-
-    for (const entry of parsed.chunks ?? []) {
-      const chunkPath = path.join(this.rootDir, entry.filename)
-      if (!fs.existsSync(chunkPath)) continue
-      const chunk: ArchiveChunk = {
-        id: entry.id,
-        filename: entry.filename,
-        path: chunkPath,
-        cols: entry.cols,
-        rowBytes: entry.rowBytes,
-        lineCount: entry.lineCount,
-        bytes: entry.bytes,
-        createdAt: entry.createdAt,
-      }
+    for (const chunk of chunks.values()) {
+      this.nextChunkId = Math.max(this.nextChunkId, chunk.id + 1)
+      if (!fs.existsSync(chunk.path)) continue
+      chunk.rows = this.countRows(chunk)
       this.chunks.push(chunk)
-      this.totalLines += chunk.lineCount
+      this.chunkStarts.push(this.totalLines)
+      this.totalLines += chunk.rows
       this.totalBytes += chunk.bytes
     }
+    this.removeOrphanedFiles()
+  }
 
-    if (this.chunks.length > 0) {
-      const maxId = Math.max(...this.chunks.map((chunk) => chunk.id))
-      this.nextChunkId = Math.max(this.nextChunkId, maxId + 1)
+  private chunkFromEntry(
+    id: number,
+    filename: string,
+    encoding: ChunkEncoding,
+    cols: number,
+    createdAt: number
+  ): ArchiveChunk {
+    const chunkPath = path.join(this.rootDir, filename)
+    return {
+      id,
+      filename,
+      path: chunkPath,
+      encoding,
+      indexPath: indexPathFor(chunkPath),
+      cols,
+      rowBytes: 0,
+      lineCount: 0,
+      lineLengths: new Map(),
+      openLength: 0,
+      rows: 0,
+      bytes: 0,
+      createdAt,
     }
   }
 
-  private async flushMeta(): Promise<void> {
+  /**
+   * Apply journal entries written since the loaded checkpoint, dropping a
+   * torn tail. A journal from another checkpoint is replaced.
+   */
+  private replayJournal(chunks: Map<number, ArchiveChunk>): void {
+    let data: Uint8Array | null = null
+    try {
+      data = fs.readFileSync(this.journalPath)
+    } catch {
+      // Missing journal: nothing to replay.
+    }
+    const journal = data ? readJournal(data) : null
+    if (!journal || journal.checkpoint !== this.checkpointId) {
+      this.journalBytes = 0
+      try {
+        fs.writeFileSync(this.journalPath, encodeJournalHeader(this.checkpointId))
+      } catch {
+        // Retried by the next checkpoint.
+        this.journalBytes = this.checkpointBytes
+      }
+      return
+    }
+
+    for (const entry of journal.entries) {
+      if (entry.type === "create") {
+        const chunk = this.chunkFromEntry(entry.id, `chunk-${entry.id}.bin`, "compact", entry.cols, entry.createdAt)
+        chunk.wideCells = false
+        chunks.set(entry.id, chunk)
+        this.nextChunkId = Math.max(this.nextChunkId, entry.id + 1)
+      } else if (entry.type === "append") {
+        const chunk = chunks.get(entry.id)
+        if (!chunk) continue
+        chunk.lineCount = entry.lineCount
+        chunk.bytes = entry.bytes
+        chunk.openLength = entry.openLength
+        for (let i = 0; i + 1 < entry.lineLengths.length; i += 2) {
+          const length = entry.lineLengths[i]
+          chunk.lineLengths.set(length, (chunk.lineLengths.get(length) ?? 0) + entry.lineLengths[i + 1])
+        }
+      } else if (entry.type === "wide") {
+        const chunk = chunks.get(entry.id)
+        if (chunk) chunk.wideCells = true
+      } else {
+        chunks.delete(entry.id)
+      }
+    }
+
+    this.journalBytes = journal.validBytes - JOURNAL_HEADER_BYTES
+    if (data && journal.validBytes < data.byteLength) {
+      try {
+        fs.truncateSync(this.journalPath, journal.validBytes)
+      } catch {
+        // Entries appended after the torn one would be skipped; checkpoint instead.
+        this.journalBytes = this.checkpointBytes
+      }
+    }
+  }
+
+  /**
+   * Remove chunk files no checkpoint or journal entry refers to: chunks
+   * created or dropped by a process killed before journaling it. A new
+   * chunk reusing such an id would otherwise append to stale bytes.
+   */
+  private removeOrphanedFiles(): void {
+    const live = new Set(this.chunks.map((chunk) => chunk.id))
+    let names: string[] = []
+    try {
+      names = fs.readdirSync(this.rootDir)
+    } catch {
+      return
+    }
+    for (const name of names) {
+      const match = CHUNK_FILE_PATTERN.exec(name)
+      if (!match || live.has(Number(match[1]))) continue
+      try {
+        fs.unlinkSync(path.join(this.rootDir, name))
+      } catch {
+        // Ignore cleanup errors.
+      }
+    }
+  }
+
+  /**
+   * Record metadata changes. Past checkpointBytes of journal, the whole
+   * state is checkpointed instead, which already includes `entries`.
+   */
+  private async writeJournal(entries: JournalEntry[]): Promise<void> {
+    if (entries.length === 0) return
+    if (this.journalBytes >= this.checkpointBytes) {
+      await this.checkpoint()
+      return
+    }
+    const data = encodeJournalEntries(entries)
+    try {
+      await fsp.appendFile(this.journalPath, data)
+      this.journalBytes += data.byteLength
+    } catch {
+      // Ignore metadata write failures.
+    }
+  }
+
+  /**
+   * Write meta.json atomically, then start a journal for it. A crash in
+   * between leaves the old journal, whose checkpoint number no longer
+   * matches and is ignored.
+   */
+  private async checkpoint(): Promise<void> {
+    const checkpoint = this.checkpointId + 1
     const meta: ArchiveMeta = {
-      version: 1,
+      version: META_VERSION,
+      checkpoint,
       nextChunkId: this.nextChunkId,
       chunks: this.chunks.map((chunk) => ({
         id: chunk.id,
         filename: chunk.filename,
+        encoding: chunk.encoding,
         cols: chunk.cols,
         rowBytes: chunk.rowBytes,
         lineCount: chunk.lineCount,
+        lineLengths: Array.from(chunk.lineLengths).flat(),
+        openLength: chunk.openLength,
+        wideCells: chunk.wideCells,
         bytes: chunk.bytes,
         createdAt: chunk.createdAt,
       })),
     }
     try {
-      await fsp.writeFile(this.metaPath, JSON.stringify(meta), "utf8")
+      const tmpPath = `${this.metaPath}.tmp`
+      await fsp.writeFile(tmpPath, JSON.stringify(meta), "utf8")
+      await fsp.rename(tmpPath, this.metaPath)
+      this.checkpointId = checkpoint
+      await fsp.writeFile(this.journalPath, encodeJournalHeader(checkpoint))
+      this.journalBytes = 0
     } catch {
-      // Ignore metadata write failures.
+      // Ignore metadata write failures; the next journal write retries.
     }
   }
 }
 
+type ArchiveAccount = {
+  weight: number
+  /** archive.bytes as of the last update. */
+  bytes: number
+  oldestId: number | null
+  /** Bumped when the oldest chunk changes; older heap entries are stale. */
+  version: number
+}
+
+/** An archive keyed by the creation time of its oldest chunk. */
+type OldestChunkEntry = {
+  archive: ScrollbackArchive
+  createdAt: number
+  version: number
+}
+
+/**
+ * Global archive budget shared by every pane. Archives report size and
+ * oldest-chunk changes through update(), so the total is kept running and
+ * the globally oldest chunk comes off a min-heap instead of a scan.
+ *
+ * Each archive is guaranteed `maxBytes * weight / totalWeight`: eviction
+ * only takes chunks from archives over their share, so one pane flooding
+ * output evicts its own history before anyone else's.
+ */
 export class ScrollbackArchiveManager {
-  private archives = new Set<ScrollbackArchive>()
+  private archives = new Map<ScrollbackArchive, ArchiveAccount>()
+  private heap: OldestChunkEntry[] = []
   private readonly maxBytes: number
+  private totalBytes = 0
+  private totalWeight = 0
 
   constructor(maxBytes: number) {
     this.maxBytes = maxBytes
   }
 
-  register(archive: ScrollbackArchive): void {
-    this.archives.add(archive)
+  get bytes(): number {
+    return this.totalBytes
+  }
+
+  register(archive: ScrollbackArchive, weight = 1): void {
+    if (this.archives.has(archive)) return
+    const account: ArchiveAccount = { weight: Math.max(0, weight), bytes: 0, oldestId: null, version: 0 }
+    this.archives.set(archive, account)
+    this.totalWeight += account.weight
+    this.update(archive)
   }
 
   unregister(archive: ScrollbackArchive): void {
+    const account = this.archives.get(archive)
+    if (!account) return
     this.archives.delete(archive)
+    this.totalBytes -= account.bytes
+    this.totalWeight -= account.weight
+    // Its heap entries are dropped as stale when they surface
+  }
+
+  /** Change an archive's share of the budget, e.g. to favour a focused pane. */
+  setWeight(archive: ScrollbackArchive, weight: number): void {
+    const account = this.archives.get(archive)
+    if (!account) return
+    const next = Math.max(0, weight)
+    this.totalWeight += next - account.weight
+    account.weight = next
+  }
+
+  /** Record a change in an archive's size or oldest chunk. */
+  update(archive: ScrollbackArchive): void {
+    const account = this.archives.get(archive)
+    if (!account) return
+    this.totalBytes += archive.bytes - account.bytes
+    account.bytes = archive.bytes
+
+    const oldest = archive.getOldestChunk()
+    const oldestId = oldest ? oldest.id : null
+    if (oldestId === account.oldestId) return
+    account.oldestId = oldestId
+    account.version += 1
+    if (oldest) {
+      this.push({ archive, createdAt: oldest.createdAt, version: account.version })
+    }
+    if (this.heap.length > this.archives.size * 2 + 32) this.rebuildHeap()
   }
 
   enforceGlobalLimit(): void {
-    let totalBytes = 0
-    for (const archive of this.archives) {
-      totalBytes += archive.bytes
+    if (this.totalBytes <= this.maxBytes) return
+
+    const withinQuota: OldestChunkEntry[] = []
+    while (this.totalBytes > this.maxBytes) {
+      const entry = this.pop()
+      if (!entry) break
+      const account = this.archives.get(entry.archive)
+      if (!account || account.version !== entry.version) continue
+      if (account.bytes <= this.quota(account)) {
+        withinQuota.push(entry)
+        continue
+      }
+      // Pushes the archive's next-oldest chunk through update()
+      if (!entry.archive.dropOldestChunk()) break
     }
+    for (const entry of withinQuota) this.push(entry)
+  }
 
-    while (totalBytes > this.maxBytes) {
-      let targetArchive: ScrollbackArchive | null = null
-      let targetChunk: ArchiveChunk | null = null
+  private quota(account: ArchiveAccount): number {
+    return this.totalWeight > 0 ? (this.maxBytes * account.weight) / this.totalWeight : 0
+  }
 
-      for (const archive of this.archives) {
-        const chunk = archive.getOldestChunk()
-        if (!chunk) continue
-        if (!targetChunk || chunk.createdAt < targetChunk.createdAt) {
-          targetChunk = chunk
-          targetArchive = archive
-        }
+  private rebuildHeap(): void {
+    const entries: OldestChunkEntry[] = []
+    for (const [archive, account] of this.archives) {
+      const oldest = archive.getOldestChunk()
+      if (oldest) entries.push({ archive, createdAt: oldest.createdAt, version: account.version })
+    }
+    this.heap = []
+    for (const entry of entries) this.push(entry)
+  }
+
+  private push(entry: OldestChunkEntry): void {
+    const heap = this.heap
+    heap.push(entry)
+    let i = heap.length - 1
+    while (i > 0) {
+      const parent = (i - 1) >>> 1
+      if (heap[parent].createdAt <= entry.createdAt) break
+      heap[i] = heap[parent]
+      i = parent
+    }
+    heap[i] = entry
+  }
+
+  private pop(): OldestChunkEntry | null {
+    const heap = this.heap
+    const top = heap[0]
+    if (!top) return null
+    const last = heap.pop()!
+    if (heap.length === 0) return top
+
+    let i = 0
+    for (;;) {
+      const left = i * 2 + 1
+      if (left >= heap.length) break
+      const right = left + 1
+      const child = right < heap.length && heap[right].createdAt < heap[left].createdAt ? right : left
+      if (heap[child].createdAt >= last.createdAt) break
+      heap[i] = heap[child]
+      i = child
+    }
+    heap[i] = last
+    return top
+  }
+}
+
+/** Index of the last entry of ascending `starts` at or before `value`. */
+function lastAtOrBefore(starts: number[], value: number): number {
+  let lo = 0
+  let hi = starts.length - 1
+  while (lo < hi) {
+    const mid = (lo + hi + 1) >>> 1
+    if (starts[mid] <= value) {
+      lo = mid
+    } else {
+      hi = mid - 1
+    }
+  }
+  return lo
+}
+
+function indexPathFor(chunkPath: string): string {
+  return chunkPath.replace(/\.bin$/, "") + ".tri"
+}
+
+async function removeChunkFiles(chunk: ArchiveChunk): Promise<void> {
+  for (const file of [chunk.path, chunk.indexPath]) {
+    try {
+      await fsp.unlink(file)
+    } catch {
+      // Ignore cleanup errors.
+    }
+  }
+}
+
+function readAt(fd: number, buffer: Uint8Array, position: number): Promise<number> {
+  return new Promise((resolve, reject) => {
+    fs.read(fd, buffer, 0, buffer.byteLength, position, (error, bytesRead) => {
+      if (error) reject(error)
+      else resolve(bytesRead)
+    })
+  })
+}
+
+function sizeOf(fd: number): Promise<number> {
+  return new Promise((resolve, reject) => {
+    fs.fstat(fd, (error, stats) => {
+      if (error) reject(error)
+      else resolve(stats.size)
+    })
+  })
+}
+
+function openForRead(filePath: string): Promise<number> {
+  return new Promise((resolve, reject) => {
+    fs.open(filePath, "r", (error, fd) => {
+      if (error) reject(error)
+      else resolve(fd)
+    })
+  })
+}
+
+/**
+ * Read-only chunk file descriptors, most recently used last. Async reads
+ * pin their fd so an eviction in the meantime defers the close instead of
+ * letting the fd number be reused under the read.
+ */
+class ChunkFdCache {
+  private fds = new Map<number, number>()
+  /** Pin count per fd with an async read in flight. */
+  private pins = new Map<number, number>()
+  /** Pinned fds already evicted, closed on their last release. */
+  private closing = new Set<number>()
+  private readonly maxOpen: number
+
+  constructor(maxOpen: number) {
+    this.maxOpen = maxOpen
+  }
+
+  get(chunk: ArchiveChunk): number | null {
+    const existing = this.touch(chunk.id)
+    if (existing !== undefined) return existing
+
+    let fd: number
+    try {
+      fd = fs.openSync(chunk.path, "r")
+    } catch {
+      return null
+    }
+    this.insert(chunk.id, fd)
+    return fd
+  }
+
+  /** Open (or reuse) the chunk's fd without blocking, pinned until release. */
+  async acquire(chunk: ArchiveChunk): Promise<number | null> {
+    let fd = this.touch(chunk.id)
+    if (fd === undefined) {
+      let opened: number
+      try {
+        opened = await openForRead(chunk.path)
+      } catch {
+        return null
+      }
+      fd = this.touch(chunk.id)
+      if (fd === undefined) {
+        fd = opened
+        this.insert(chunk.id, fd)
+      } else {
+        closeFd(opened)
       }
+    }
+    this.pins.set(fd, (this.pins.get(fd) ?? 0) + 1)
+    return fd
+  }
 
-      if (!targetArchive || !targetChunk) break
+  release(fd: number): void {
+    const pins = (this.pins.get(fd) ?? 1) - 1
+    if (pins > 0) {
+      this.pins.set(fd, pins)
+      return
+    }
+    this.pins.delete(fd)
+    if (this.closing.delete(fd)) closeFd(fd)
+  }
 
-      const removed = targetArchive.dropOldestChunk()
-      if (!removed) break
-      totalBytes -= removed.bytesRemoved
+  close(chunkId: number): void {
+    const fd = this.fds.get(chunkId)
+    if (fd === undefined) return
+    this.fds.delete(chunkId)
+    if (this.pins.has(fd)) {
+      this.closing.add(fd)
+    } else {
+      closeFd(fd)
+    }
+  }
+
+  closeAll(): void {
+    for (const chunkId of Array.from(this.fds.keys())) {
+      this.close(chunkId)
+    }
+  }
+
+  private touch(chunkId: number): number | undefined {
+    const existing = this.fds.get(chunkId)
+    if (existing !== undefined) {
+      this.fds.delete(chunkId)
+      this.fds.set(chunkId, existing)
+    }
+    return existing
+  }
+
+  private insert(chunkId: number, fd: number): void {
+    this.fds.set(chunkId, fd)
+    if (this.fds.size > this.maxOpen) {
+      const oldest = this.fds.keys().next().value
+      if (oldest !== undefined) this.close(oldest)
     }
   }
 }
 
-function toArrayBuffer(buffer: Buffer): ArrayBuffer {
-  return buffer.buffer.slice(buffer.byteOffset, buffer.byteOffset + buffer.byteLength) as ArrayBuffer
+function closeFd(fd: number): void {
+  try {
+    fs.closeSync(fd)
+  } catch {
+    // Ignore close errors.
+  }
 }
@@ -0,0 +1,175 @@
+/**
+ * Append-only metadata journal for the scrollback archive.
+ *
+ * meta.json is a checkpoint; every change after it is appended to
+ * meta.journal as a small binary entry, and the journal is replayed on
+ * load. The journal starts with the number of the checkpoint it follows,
+ * so a journal left over from before a newer checkpoint is ignored.
+ *
+ * Each entry is framed as u32 payload length, u8 type, payload, u32
+ * checksum (FNV-1a over type and payload). Replay stops at the first
+ * torn or corrupt entry, which is where a killed writer stopped.
+ */
+
+const JOURNAL_MAGIC = 0x4a4d4f53 // "SOMJ" little-endian
+export const JOURNAL_HEADER_BYTES = 8
+
+const ENTRY_CREATE = 1
+const ENTRY_APPEND = 2
+const ENTRY_DROP = 3
+const ENTRY_WIDE = 4
+
+export type JournalEntry =
+  | { type: "create"; id: number; cols: number; createdAt: number }
+  | {
+      type: "append"
+      id: number
+      /** Totals after the append, not deltas. */
+      lineCount: number
+      bytes: number
+      openLength: number
+      /** Flattened [length, count] pairs of logical lines closed by the append. */
+      lineLengths: number[]
+    }
+  | { type: "drop"; id: number }
+  /** The chunk now holds wide cells (its rows are counted from its records). */
+  | { type: "wide"; id: number }
+
+export function encodeJournalHeader(checkpoint: number): Uint8Array {
+  const data = new Uint8Array(JOURNAL_HEADER_BYTES)
+  const view = new DataView(data.buffer)
+  view.setUint32(0, JOURNAL_MAGIC, true)
+  view.setUint32(4, checkpoint, true)
+  return data
+}
+
+export function encodeJournalEntries(entries: JournalEntry[]): Uint8Array {
+  let total = 0
+  for (const entry of entries) total += 9 + payloadBytes(entry)
+
+  const data = new Uint8Array(total)
+  const view = new DataView(data.buffer)
+  let offset = 0
+  for (const entry of entries) {
+    const length = payloadBytes(entry)
+    view.setUint32(offset, length, true)
+    const start = offset + 4
+    let p = start + 1
+    switch (entry.type) {
+      case "create":
+        view.setUint8(start, ENTRY_CREATE)
+        view.setUint32(p, entry.id, true)
+        view.setUint16(p + 4, entry.cols, true)
+        view.setFloat64(p + 6, entry.createdAt, true)
+        break
+      case "append":
+        view.setUint8(start, ENTRY_APPEND)
+        view.setUint32(p, entry.id, true)
+        view.setUint32(p + 4, entry.lineCount, true)
+        view.setUint32(p + 8, entry.bytes, true)
+        view.setUint32(p + 12, entry.openLength, true)
+        p += 16
+        for (const value of entry.lineLengths) {
+          view.setUint32(p, value, true)
+          p += 4
+        }
+        break
+      case "drop":
+        view.setUint8(start, ENTRY_DROP)
+        view.setUint32(p, entry.id, true)
+        break
+      case "wide":
+        view.setUint8(start, ENTRY_WIDE)
+        view.setUint32(p, entry.id, true)
+        break
+    }
+    view.setUint32(start + 1 + length, checksum(data, start, 1 + length), true)
+    offset = start + 1 + length + 4
+  }
+  return data
+}
+
+/**
+ * Parse a journal. `validBytes` is where the intact entries end; anything
+ * after it is a torn write to truncate. Returns null for a missing or
+ * foreign header.
+ */
+export function readJournal(
+  data: Uint8Array
+): { checkpoint: number; entries: JournalEntry[]; validBytes: number } | null {
+  if (data.byteLength < JOURNAL_HEADER_BYTES) return null
+  const view = new DataView(data.buffer, data.byteOffset, data.byteLength)
+  if (view.getUint32(0, true) !== JOURNAL_MAGIC) return null
+
+  const entries: JournalEntry[] = []
+  let offset = JOURNAL_HEADER_BYTES
+  while (offset + 9 <= data.byteLength) {
+    const length = view.getUint32(offset, true)
+    const start = offset + 4
+    const end = start + 1 + length
+    if (end + 4 > data.byteLength) break
+    if (view.getUint32(end, true) !== checksum(data, start, 1 + length)) break
+
+    const entry = decodeEntry(view, view.getUint8(start), start + 1, length)
+    if (!entry) break
+    entries.push(entry)
+    offset = end + 4
+  }
+  return { checkpoint: view.getUint32(4, true), entries, validBytes: offset }
+}
+
+function decodeEntry(view: DataView, type: number, p: number, length: number): JournalEntry | null {
+  switch (type) {
+    case ENTRY_CREATE:
+      if (length !== 14) return null
+      return {
+        type: "create",
+        id: view.getUint32(p, true),
+        cols: view.getUint16(p + 4, true),
+        createdAt: view.getFloat64(p + 6, true),
+      }
+    case ENTRY_APPEND: {
+      if (length < 16 || (length - 16) % 8 !== 0) return null
+      const lineLengths: number[] = []
+      for (let q = p + 16; q < p + length; q += 4) {
+        lineLengths.push(view.getUint32(q, true))
+      }
+      return {
+        type: "append",
+        id: view.getUint32(p, true),
+        lineCount: view.getUint32(p + 4, true),
+        bytes: view.getUint32(p + 8, true),
+        openLength: view.getUint32(p + 12, true),
+        lineLengths,
+      }
+    }
+    case ENTRY_DROP:
+      if (length !== 4) return null
+      return { type: "drop", id: view.getUint32(p, true) }
+    case ENTRY_WIDE:
+      if (length !== 4) return null
+      return { type: "wide", id: view.getUint32(p, true) }
+    default:
+      return null
+  }
+}
+
+function payloadBytes(entry: JournalEntry): number {
+  switch (entry.type) {
+    case "create":
+      return 14
+    case "append":
+      return 16 + entry.lineLengths.length * 4
+    case "drop":
+    case "wide":
+      return 4
+  }
+}
+
+function checksum(data: Uint8Array, start: number, length: number): number {
+  let hash = 0x811c9dc5
+  for (let i = start; i < start + length; i++) {
+    hash = Math.imul(hash ^ data[i], 0x01000193)
+  }
+  return hash >>> 0
+}
@@ -0,0 +1,63 @@
+/**
+ * Trigram filters for scrollback archive chunks.
+ *
+ * Each chunk keeps a fixed-size bitset with one bit per hashed trigram of
+ * its lowercased line text. A literal query can only match inside a chunk
+ * whose bitset has every bit of the query's trigrams set, so searches skip
+ * the other chunks without reading them. Lines are indexed one at a time,
+ * the same way the archive is searched, and the text is the one search
+ * reads (one character per cell, wide-character spacers skipped).
+ */
+
+/** Bits per chunk filter (8 KiB); a full 2000-line chunk sets well under half. */
+export const TRIGRAM_FILTER_BITS = 1 << 16
+const FILTER_WORDS = TRIGRAM_FILTER_BITS / 32
+const HASH_MASK = TRIGRAM_FILTER_BITS - 1
+
+export function createTrigramFilter(): Uint32Array {
+  return new Uint32Array(FILTER_WORDS)
+}
+
+/** Whether `data` has the byte length of a filter. */
+export function isTrigramFilterSize(byteLength: number): boolean {
+  return byteLength === FILTER_WORDS * 4
+}
+
+/** FNV-1a over three UTF-16 code units, folded to a bit index. */
+function trigramBit(text: string, i: number): number {
+  let hash = 0x811c9dc5
+  hash = Math.imul(hash ^ text.charCodeAt(i), 0x01000193)
+  hash = Math.imul(hash ^ text.charCodeAt(i + 1), 0x01000193)
+  hash = Math.imul(hash ^ text.charCodeAt(i + 2), 0x01000193)
+  return (hash ^ (hash >>> 16)) & HASH_MASK
+}
+
+/** Add the trigrams of a line's text (see extractRowText). */
+export function addLineTrigrams(filter: Uint32Array, line: string): void {
+  const text = line.toLowerCase()
+  for (let i = 0; i + 3 <= text.length; i++) {
+    const bit = trigramBit(text, i)
+    filter[bit >>> 5] |= 1 << (bit & 31)
+  }
+}
+
+/**
+ * Filter bits a chunk needs for a case-insensitive substring query, or
+ * null when the query is too short to have a trigram.
+ */
+export function queryTrigramBits(query: string): number[] | null {
+  const text = query.toLowerCase()
+  if (text.length < 3) return null
+  const bits = new Set<number>()
+  for (let i = 0; i + 3 <= text.length; i++) {
+    bits.add(trigramBit(text, i))
+  }
+  return Array.from(bits)
+}
+
+export function filterMayContain(filter: Uint32Array, bits: number[]): boolean {
+  for (const bit of bits) {
+    if ((filter[bit >>> 5] & (1 << (bit & 31))) === 0) return false
+  }
+  return true
+}
@@ -0,0 +1,128 @@
+/**
+ * Cooperative search jobs.
+ *
+ * A search is split into steps of a few thousand lines. Steps run one at a
+ * time with an event-loop yield in between, so PTY output and other requests
+ * keep flowing during a long scan and a newer query can cancel the job via
+ * its AbortSignal. With an anchor line the steps are visited outward from it,
+ * so the matches nearest the viewport are found (and streamed) first.
+ */
+
+import type { LineNumbering, SearchMatch, SearchOptions, SearchResult } from './emulator-interface';
+import { deferNextTick } from '../core/scheduling';
+
+export const DEFAULT_SEARCH_LIMIT = 500;
+
+/** Lines scanned per step before yielding to the event loop. */
+export const SEARCH_LINES_PER_STEP = 4000;
+
+/** Searches lines [start, end) for at most `limit` matches. */
+export type SearchRange = (start: number, end: number, limit: number) => SearchResult | Promise<SearchResult>;
+
+/** Order matches oldest to newest. */
+export function compareSearchMatches(a: SearchMatch, b: SearchMatch): number {
+  return a.lineIndex - b.lineIndex || a.startCol - b.startCol;
+}
+
+/**
+ * Split [start, end) into steps of `step` lines. Without an anchor the
+ * steps run oldest to newest; with one, the first step is centred on the
+ * anchor and the rest alternate above and below it.
+ */
+export function searchSteps(
+  start: number,
+  end: number,
+  step: number,
+  anchor?: number
+): Array<[number, number]> {
+  const steps: Array<[number, number]> = [];
+  if (end <= start) return steps;
+
+  if (anchor === undefined) {
+    for (let from = start; from < end; from += step) {
+      steps.push([from, Math.min(end, from + step)]);
+    }
+    return steps;
+  }
+
+  const center = Math.max(start, Math.min(end - 1, Math.floor(anchor)));
+  let lo = Math.max(start, center - Math.floor(step / 2));
+  let hi = Math.min(end, lo + step);
+  steps.push([lo, hi]);
+  while (lo > start || hi < end) {
+    if (lo > start) {
+      const next = Math.max(start, lo - step);
+      steps.push([next, lo]);
+      lo = next;
+    }
+    if (hi < end) {
+      const next = Math.min(end, hi + step);
+      steps.push([hi, next]);
+      hi = next;
+    }
+  }
+  return steps;
+}
+
+/**
+ * Run a search over `length` lines (narrowed by options.startLine/endLine)
+ * one step at a time. Each step's matches go to options.onMatches as soon
+ * as the step finishes; the result holds every match found, oldest first.
+ * With options.anchor the `limit` matches kept are the nearest ones.
+ * A cancelled job resolves with the matches found so far and hasMore set.
+ */
+export async function runSearchJob(
+  options: SearchOptions | undefined,
+  length: number,
+  searchRange: SearchRange
+): Promise<SearchResult> {
+  const limit = options?.limit ?? DEFAULT_SEARCH_LIMIT;
+  const start = Math.max(0, options?.startLine ?? 0);
+  const end = Math.min(length, options?.endLine ?? length);
+  const signal = options?.signal;
+  const matches: SearchMatch[] = [];
+  let hasMore = false;
+
+  const steps = searchSteps(start, end, SEARCH_LINES_PER_STEP, options?.anchor);
+  for (let i = 0; i < steps.length; i++) {
+    if (i > 0) {
+      await new Promise<void>((resolve) => deferNextTick(resolve));
+    }
+    if (signal?.aborted) {
+      hasMore = true;
+      break;
+    }
+
+    const [stepStart, stepEnd] = steps[i];
+    const result = await searchRange(stepStart, stepEnd, limit - matches.length);
+    if (result.matches.length > 0) {
+      for (const match of result.matches) matches.push(match);
+      options?.onMatches?.(result.matches);
+    }
+    if (result.hasMore) {
+      hasMore = true;
+      break;
+    }
+  }
+
+  matches.sort(compareSearchMatches);
+  return { matches, hasMore };
+}
+
+/**
+ * Run a search and record the line numbering its matches refer to. When
+ * the numbering changes mid-job, matches found before and after it can't
+ * be told apart, so the result is flagged as renumbered.
+ */
+export async function runNumberedSearch(
+  getNumbering: () => LineNumbering,
+  search: () => Promise<SearchResult>
+): Promise<SearchResult> {
+  const before = getNumbering();
+  const result = await search();
+  const after = getNumbering();
+  if (before.epoch === after.epoch && before.dropped === after.dropped) {
+    return { ...result, numbering: before };
+  }
+  return { ...result, numbering: after, renumbered: true };
+}
@@ -6,19 +6,24 @@
  *
  * This prevents flickering when child processes (like OpenTUI apps) use
  * sync mode to batch their frame updates.
+ *
+ * Operates on raw UTF-8 bytes; ready segments are views into the input
+ * whenever no buffering is required.
  */
 
-const SYNC_SET = '\x1b[?2026h'
-const SYNC_RESET = '\x1b[?2026l'
+import { concatBytes, encodeUtf8, indexOfBytes, EMPTY_BYTES, BYTE_ESC } from './byte-utils'
+
+const SYNC_SET = encodeUtf8('\x1b[?2026h')
+const SYNC_RESET = encodeUtf8('\x1b[?2026l')
 
 export interface SyncModeParser {
   /**
    * Process incoming data, returns segments ready for rendering.
    * Content inside sync mode boundaries is buffered until sync end is received.
    */
-  process(data: string): {
+  process(data: Uint8Array): {
     /** Segments that are complete and ready to render */
-    readySegments: string[]
+    readySegments: Uint8Array[]
     /** Whether we're currently buffering inside sync mode */
     isBuffering: boolean
   }
@@ -27,7 +32,7 @@ export interface SyncModeParser {
    * Force flush any buffered content (e.g., on timeout).
    * Returns buffered content and resets sync mode state.
    */
-  flush(): string
+  flush(): Uint8Array
 
   /**
    * Check if currently in sync mode (buffering).
@@ -35,34 +40,52 @@ export interface SyncModeParser {
   isInSyncMode(): boolean
 }
 
+function isPartialPrefix(sequence: Uint8Array, suffix: Uint8Array): boolean {
+  if (suffix.length >= sequence.length) return false
+  for (let i = 0; i < suffix.length; i++) {
+    if (sequence[i] !== suffix[i]) return false
+  }
+  return true
+}
+
 export function createSyncModeParser(): SyncModeParser {
-  let buffer = ''
+  let buffer: Uint8Array[] = []
+  let bufferLength = 0
   let inSyncMode = false
   // Buffer for partial escape sequences at chunk boundaries
-  let partialEscape = ''
+  let partialEscape: Uint8Array = EMPTY_BYTES
+
+  const takeBuffer = (): Uint8Array => {
+    const result = concatBytes(buffer, bufferLength)
+    buffer = []
+    bufferLength = 0
+    return result
+  }
+
+  const appendBuffer = (chunk: Uint8Array) => {
+    if (chunk.length === 0) return
+    buffer.push(chunk)
+    bufferLength += chunk.length
+  }
 
   return {
-    process(data: string) {
-      const readySegments: string[] = []
+    process(data: Uint8Array) {
+      const readySegments: Uint8Array[] = []
 
       // Prepend any partial escape from previous chunk
-      let input = partialEscape + data
-      partialEscape = ''
+      let input = partialEscape.length > 0 ? concatBytes([partialEscape, data]) : data
+      partialEscape = EMPTY_BYTES
 
       // Check for partial escape sequence at end (starts with ESC but incomplete)
-      // The sync sequences are 8 characters long: \x1b[?2026h and \x1b[?2026l
+      // The sync sequences are 8 bytes long: \x1b[?2026h and \x1b[?2026l
       // We only buffer if it's truly partial (not already a complete sequence)
-      const lastEsc = input.lastIndexOf('\x1b')
-      if (lastEsc !== -1 && lastEsc > input.length - 8) {
-        // Potential partial sequence at end
-        const suffix = input.slice(lastEsc)
-        // Check if this is a PARTIAL sequence (could become a sync sequence but isn't complete)
-        // Don't buffer if it's already a complete sync sequence
-        const isPartialSyncSet = SYNC_SET.startsWith(suffix) && suffix !== SYNC_SET
-        const isPartialSyncReset = SYNC_RESET.startsWith(suffix) && suffix !== SYNC_RESET
-        if (isPartialSyncSet || isPartialSyncReset) {
-          partialEscape = suffix
-          input = input.slice(0, lastEsc)
+      const lastEsc = input.lastIndexOf(BYTE_ESC)
+      if (lastEsc !== -1 && lastEsc > input.length - SYNC_SET.length) {
+        const suffix = input.subarray(lastEsc)
+        if (isPartialPrefix(SYNC_SET, suffix) || isPartialPrefix(SYNC_RESET, suffix)) {
+          // Copy: the caller may reuse the input buffer
+          partialEscape = suffix.slice()
+          input = input.subarray(0, lastEsc)
         }
       }
 
@@ -70,35 +93,32 @@ export function createSyncModeParser(): SyncModeParser {
       while (pos < input.length) {
         if (!inSyncMode) {
           // Not in sync mode - look for sync start
-          const syncStart = input.indexOf(SYNC_SET, pos)
+          const syncStart = indexOfBytes(input, SYNC_SET, pos)
           if (syncStart === -1) {
             // No sync start found - emit everything from current position
-            if (pos < input.length) {
-              readySegments.push(input.slice(pos))
-            }
+            readySegments.push(input.subarray(pos))
             pos = input.length
           } else {
             // Found sync start - emit content before it, then enter sync mode
             if (syncStart > pos) {
-              readySegments.push(input.slice(pos, syncStart))
+              readySegments.push(input.subarray(pos, syncStart))
             }
             inSyncMode = true
             pos = syncStart + SYNC_SET.length
           }
         } else {
           // In sync mode - look for sync end
-          const syncEnd = input.indexOf(SYNC_RESET, pos)
+          const syncEnd = indexOfBytes(input, SYNC_RESET, pos)
           if (syncEnd === -1) {
             // No sync end yet - buffer everything from current position
-            buffer += input.slice(pos)
+            appendBuffer(input.subarray(pos))
             pos = input.length
           } else {
             // Found sync end - add to buffer and flush as single segment
-            buffer += input.slice(pos, syncEnd)
-            if (buffer.length > 0) {
-              readySegments.push(buffer)
+            appendBuffer(input.subarray(pos, syncEnd))
+            if (bufferLength > 0) {
+              readySegments.push(takeBuffer())
             }
-            buffer = ''
             inSyncMode = false
             pos = syncEnd + SYNC_RESET.length
           }
@@ -109,9 +129,8 @@ export function createSyncModeParser(): SyncModeParser {
     },
 
     flush() {
-      const result = partialEscape + buffer
-      partialEscape = ''
-      buffer = ''
+      const result = concatBytes([partialEscape, takeBuffer()])
+      partialEscape = EMPTY_BYTES
       inSyncMode = false
       return result
     },
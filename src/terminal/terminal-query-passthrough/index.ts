@@ -11,7 +11,7 @@ export { TerminalQueryPassthrough } from './passthrough';
 export type { TerminalQuery, QueryParseResult, QueryType } from './types';
 
 // Parser (for testing or direct use)
-export { parseTerminalQueries, mightContainQueries } from './parser';
+export { parseTerminalQueries, mightContainQueries, mightContainQueriesBytes } from './parser';
 
 // Response generators (for testing or direct use)
 export * from './responses';
@@ -8,6 +8,24 @@
 import type { TerminalQuery, QueryParseResult } from './types';
 import { ESC, CSI, DCS } from './constants';
 import { getDefaultRegistry } from './query-registry';
+import { encodeUtf8, includesBytes, BYTE_ESC } from '../byte-utils';
+
+const bytes = (text: string) => encodeUtf8(text);
+const CSI_ESC_BYTES = bytes(`${ESC}[`);
+const CSI_C1_BYTES = bytes(CSI);
+const OSC_ESC_BYTES = bytes(`${ESC}]`);
+const DCS_BYTES = bytes(DCS);
+const CSI_QUERY_PATTERNS = [
+  '5n', '6n',
+  `${ESC}[c`, `${ESC}[0c`, `${ESC}[>c`, `${ESC}[>0c`, `${ESC}[=c`, `${ESC}[=0c`,
+  `${ESC}[>q`, `${ESC}[>0q`,
+  '$p',
+  `${ESC}[?u`,
+  `${ESC}[?6n`,
+  '14t', '16t', '18t',
+].map(bytes);
+const OSC_QUERY_PATTERNS = [';?', ']4;', ']52;', ']66;'].map(bytes);
+const BYTE_T = 0x74; // 't'
 
 /**
  * Quick check if data might contain terminal queries.
@@ -72,6 +90,36 @@ export function mightContainQueries(data: string): boolean {
   return false;
 }
 
+/**
+ * Byte-level equivalent of mightContainQueries() for raw UTF-8 PTY output.
+ * Returns the same answer as the string form on the decoded text, so callers
+ * can skip decoding entirely when it is false.
+ */
+export function mightContainQueriesBytes(data: Uint8Array): boolean {
+  if (data.indexOf(BYTE_ESC) === -1 && !includesBytes(data, CSI_C1_BYTES)) {
+    return false;
+  }
+
+  if (includesBytes(data, CSI_ESC_BYTES) || includesBytes(data, CSI_C1_BYTES)) {
+    for (const pattern of CSI_QUERY_PATTERNS) {
+      if (includesBytes(data, pattern)) return true;
+    }
+    // Generic CSI...t sequences (digit followed by 't'), mirrors /\dt/
+    let t = data.indexOf(BYTE_T, 1);
+    while (t !== -1) {
+      const prev = data[t - 1];
+      if (prev >= 0x30 && prev <= 0x39) return true;
+      t = data.indexOf(BYTE_T, t + 1);
+    }
+  }
+  if (includesBytes(data, OSC_ESC_BYTES)) {
+    for (const pattern of OSC_QUERY_PATTERNS) {
+      if (includesBytes(data, pattern)) return true;
+    }
+  }
+  return includesBytes(data, DCS_BYTES);
+}
+
 /**
  * Parse PTY output for terminal queries.
  * Uses the registry-based Strategy pattern for extensible parsing.
@@ -33,16 +33,19 @@
  */
 
 import type { TerminalQuery } from './types';
-import { parseTerminalQueries } from './parser';
+import { mightContainQueriesBytes, parseTerminalQueries } from './parser';
 import { tracePtyEvent } from '../pty-trace';
-import { findIncompleteSequenceStart, stripKittyResponses } from './utils';
+import { endsInIncompleteSequence, findIncompleteSequenceStart, stripKittyResponses } from './utils';
 import { handleTerminalQuery } from './query-handlers';
+import { decodeUtf8, encodeUtf8, includesBytes } from '../byte-utils';
 
 const ESC = '\x1b';
 const APC_C1 = '\x9f';
 const ST_C1 = '\x9c';
 const KITTY_APC_PREFIX = `${ESC}_G`;
 const KITTY_APC_C1_PREFIX = `${APC_C1}G`;
+const KITTY_APC_PREFIX_BYTES = encodeUtf8(KITTY_APC_PREFIX);
+const KITTY_APC_C1_PREFIX_BYTES = encodeUtf8(KITTY_APC_C1_PREFIX);
 
 export class TerminalQueryPassthrough {
   private ptyWriter: ((data: string) => void) | null = null;
@@ -230,6 +233,52 @@ export class TerminalQueryPassthrough {
     }
   }
 
+  /**
+   * Byte-native form of process() for raw UTF-8 PTY output.
+   *
+   * Most output contains no queries, kitty APCs or partial sequences; that
+   * data is returned as the same view without decoding. Otherwise the chunk
+   * takes the string path. Chunks must end on a UTF-8 character boundary.
+   *
+   * `knownPlain` lets a caller that already scanned the chunk (the native
+   * pre-filter) skip the byte probes; pending partial state is still honored.
+   */
+  processBytes(data: Uint8Array, knownPlain = false): Uint8Array {
+    if (knownPlain && !this.hasPendingState()) {
+      return data;
+    }
+    if (this.canPassThroughBytes(data)) {
+      return data;
+    }
+    return encodeUtf8(this.process(decodeUtf8(data)));
+  }
+
+  /**
+   * Byte-native form of processWithResponses().
+   */
+  processBytesWithResponses(data: Uint8Array): { data: Uint8Array; responses: string[] } {
+    if (this.canPassThroughBytes(data)) {
+      return { data, responses: [] };
+    }
+    const { text, responses } = this.processWithResponses(decodeUtf8(data));
+    return { data: encodeUtf8(text), responses };
+  }
+
+  /**
+   * Whether process() would return `data` unchanged without side effects.
+   */
+  private canPassThroughBytes(data: Uint8Array): boolean {
+    if (this.hasPendingState()) return false;
+    if (includesBytes(data, KITTY_APC_PREFIX_BYTES) || includesBytes(data, KITTY_APC_C1_PREFIX_BYTES)) {
+      return false;
+    }
+    return !mightContainQueriesBytes(data) && !endsInIncompleteSequence(data);
+  }
+
+  private hasPendingState(): boolean {
+    return this.pendingInput.length > 0 || this.kittyPartialBuffer.length > 0;
+  }
+
   /**
    * Handle a query by generating and sending the appropriate response
    */
@@ -8,6 +8,16 @@ const APC_C1 = '\x9f';
 
 type ParseState = 'text' | 'esc' | 'csi' | 'osc' | 'dcs' | 'apc' | 'osc-esc' | 'dcs-esc' | 'apc-esc';
 
+// Byte forms: C1 controls arrive as the UTF-8 pair 0xC2 0x80..0x9F
+const B_ESC = 0x1b;
+const B_BEL = 0x07;
+const B_C1_LEAD = 0xc2;
+const B_CSI = 0x9b;
+const B_DCS = 0x90;
+const B_OSC = 0x9d;
+const B_ST = 0x9c;
+const B_APC = 0x9f;
+
 export function findIncompleteSequenceStart(data: string): number | null {
   let state: ParseState = 'text';
   let seqStart = -1;
@@ -121,6 +131,95 @@ export function findIncompleteSequenceStart(data: string): number | null {
   return seqStart >= 0 ? seqStart : null;
 }
 
+/**
+ * Byte-level equivalent of `findIncompleteSequenceStart(text) !== null`:
+ * whether raw UTF-8 output ends inside an unterminated escape sequence.
+ */
+export function endsInIncompleteSequence(data: Uint8Array): boolean {
+  let state: ParseState = 'text';
+  const len = data.length;
+
+  for (let i = 0; i < len; i++) {
+    const b = data[i];
+    const c1 = b === B_C1_LEAD && i + 1 < len ? data[i + 1] : -1;
+    switch (state) {
+      case 'text': {
+        // Plain text: jump to the next possible introducer
+        if (b !== B_ESC && b !== B_C1_LEAD) {
+          const esc = data.indexOf(B_ESC, i + 1);
+          const lead = data.indexOf(B_C1_LEAD, i + 1);
+          const next = esc === -1 ? lead : lead === -1 ? esc : Math.min(esc, lead);
+          if (next === -1) return false;
+          i = next - 1;
+          break;
+        }
+        if (b === B_ESC) {
+          state = 'esc';
+        } else if (c1 === B_CSI) {
+          state = 'csi';
+          i++;
+        } else if (c1 === B_OSC) {
+          state = 'osc';
+          i++;
+        } else if (c1 === B_DCS) {
+          state = 'dcs';
+          i++;
+        } else if (c1 === B_APC) {
+          state = 'apc';
+          i++;
+        }
+        break;
+      }
+      case 'esc':
+        if (b === 0x5b) {
+          state = 'csi';
+        } else if (b === 0x5d) {
+          state = 'osc';
+        } else if (b === 0x50) {
+          state = 'dcs';
+        } else if (b === 0x5f) {
+          state = 'apc';
+        } else if (b !== B_ESC) {
+          state = 'text';
+        }
+        break;
+      case 'csi':
+        if (b >= 0x40 && b <= 0x7e) {
+          state = 'text';
+        }
+        break;
+      case 'osc':
+        if (b === B_BEL || c1 === B_ST) {
+          state = 'text';
+          if (c1 === B_ST) i++;
+        } else if (b === B_ESC) {
+          state = 'osc-esc';
+        }
+        break;
+      case 'dcs':
+      case 'apc':
+        if (c1 === B_ST) {
+          state = 'text';
+          i++;
+        } else if (b === B_ESC) {
+          state = state === 'dcs' ? 'dcs-esc' : 'apc-esc';
+        }
+        break;
+      case 'osc-esc':
+      case 'dcs-esc':
+      case 'apc-esc':
+        if (b === 0x5c) {
+          state = 'text';
+        } else if (b !== B_ESC) {
+          state = state === 'osc-esc' ? 'osc' : state === 'dcs-esc' ? 'dcs' : 'apc';
+        }
+        break;
+    }
+  }
+
+  return state !== 'text';
+}
+
 export function stripKittyResponses(data: string): string {
   let result = '';
   let i = 0;
@@ -0,0 +1,187 @@
+/**
+ * Packed terminal rows.
+ *
+ * Live terminal rows are stored as parallel typed arrays over one buffer
+ * (see TerminalRow) rather than one TerminalCell object per column, so a
+ * full-screen update allocates a handful of objects per row instead of
+ * thousands. Hot paths read the arrays directly; cold paths that want cell
+ * objects (selection, copy mode) materialize them with rowToCells().
+ */
+
+import type { TerminalCell, TerminalRow } from '../core/types';
+
+/** Per-cell style bits. Same layout as the cell serialization format. */
+export const enum RowFlags {
+  BOLD = 1 << 0,
+  ITALIC = 1 << 1,
+  UNDERLINE = 1 << 2,
+  STRIKETHROUGH = 1 << 3,
+  INVERSE = 1 << 4,
+  BLINK = 1 << 5,
+  DIM = 1 << 6,
+}
+
+const SPACE = 0x20;
+
+/** Bytes per column: codepoint, fg, bg (u32 each), hyperlink (u16), flags, width (u8). */
+const BYTES_PER_COLUMN = 16;
+
+const ASCII_CHARS: string[] = Array.from({ length: 0x80 }, (_, i) => String.fromCharCode(i));
+
+/**
+ * Allocate a row of `cols` zeroed cells backed by a single ArrayBuffer.
+ */
+export function createTerminalRow(cols: number): TerminalRow {
+  const buffer = new ArrayBuffer(cols * BYTES_PER_COLUMN);
+  return {
+    codepoints: new Uint32Array(buffer, 0, cols),
+    fg: new Uint32Array(buffer, cols * 4, cols),
+    bg: new Uint32Array(buffer, cols * 8, cols),
+    hyperlinks: new Uint16Array(buffer, cols * 12, cols),
+    flags: new Uint8Array(buffer, cols * 14, cols),
+    widths: new Uint8Array(buffer, cols * 15, cols),
+  };
+}
+
+/**
+ * Fill cells [start, end) with unstyled spaces in the given packed colors.
+ */
+export function fillBlankCells(row: TerminalRow, start: number, end: number, fg: number, bg: number): void {
+  row.codepoints.fill(SPACE, start, end);
+  row.fg.fill(fg, start, end);
+  row.bg.fill(bg, start, end);
+  row.hyperlinks.fill(0, start, end);
+  row.flags.fill(0, start, end);
+  row.widths.fill(1, start, end);
+}
+
+/**
+ * Create a row of blank cells in the given packed colors.
+ */
+export function createBlankRow(cols: number, fg: number, bg: number): TerminalRow {
+  const row = createTerminalRow(cols);
+  fillBlankCells(row, 0, cols, fg, bg);
+  return row;
+}
+
+export function packRgb(r: number, g: number, b: number): number {
+  return ((r & 0xff) << 16) | ((g & 0xff) << 8) | (b & 0xff);
+}
+
+export function unpackRgb(color: number): { r: number; g: number; b: number } {
+  return { r: (color >> 16) & 0xff, g: (color >> 8) & 0xff, b: color & 0xff };
+}
+
+/**
+ * Display string for a normalized codepoint. ASCII strings are shared.
+ */
+export function codepointString(codepoint: number): string {
+  if (codepoint < 0x80) {
+    return codepoint === 0 ? ' ' : ASCII_CHARS[codepoint];
+  }
+  return String.fromCodePoint(codepoint);
+}
+
+/**
+ * RowFlags bits for a TerminalCell.
+ */
+export function cellRowFlags(cell: TerminalCell): number {
+  let flags = 0;
+  if (cell.bold) flags |= RowFlags.BOLD;
+  if (cell.italic) flags |= RowFlags.ITALIC;
+  if (cell.underline) flags |= RowFlags.UNDERLINE;
+  if (cell.strikethrough) flags |= RowFlags.STRIKETHROUGH;
+  if (cell.inverse) flags |= RowFlags.INVERSE;
+  if (cell.blink) flags |= RowFlags.BLINK;
+  if (cell.dim) flags |= RowFlags.DIM;
+  return flags;
+}
+
+function materializeCell(
+  row: TerminalRow,
+  x: number,
+  fg: TerminalCell['fg'],
+  bg: TerminalCell['bg']
+): TerminalCell {
+  const flags = row.flags[x];
+  const hyperlinkId = row.hyperlinks[x];
+  return {
+    char: codepointString(row.codepoints[x]),
+    fg,
+    bg,
+    bold: (flags & RowFlags.BOLD) !== 0,
+    italic: (flags & RowFlags.ITALIC) !== 0,
+    underline: (flags & RowFlags.UNDERLINE) !== 0,
+    strikethrough: (flags & RowFlags.STRIKETHROUGH) !== 0,
+    inverse: (flags & RowFlags.INVERSE) !== 0,
+    blink: (flags & RowFlags.BLINK) !== 0,
+    dim: (flags & RowFlags.DIM) !== 0,
+    width: row.widths[x] === 2 ? 2 : 1,
+    hyperlinkId: hyperlinkId > 0 ? hyperlinkId : undefined,
+  };
+}
+
+/**
+ * Materialize one cell of a packed row.
+ */
+export function rowCellAt(row: TerminalRow, x: number): TerminalCell {
+  return materializeCell(row, x, unpackRgb(row.fg[x]), unpackRgb(row.bg[x]));
+}
+
+/**
+ * Materialize a packed row as TerminalCell objects. Cells with the same
+ * color share their fg/bg objects; they are never mutated.
+ */
+export function rowToCells(row: TerminalRow): TerminalCell[] {
+  const cols = row.codepoints.length;
+  const colors = new Map<number, TerminalCell['fg']>();
+  const resolve = (color: number) => {
+    let rgb = colors.get(color);
+    if (!rgb) {
+      rgb = unpackRgb(color);
+      colors.set(color, rgb);
+    }
+    return rgb;
+  };
+
+  const cells: TerminalCell[] = new Array(cols);
+  for (let x = 0; x < cols; x++) {
+    cells[x] = materializeCell(row, x, resolve(row.fg[x]), resolve(row.bg[x]));
+  }
+  return cells;
+}
+
+/**
+ * Pack TerminalCell objects into a row of `cols` cells.
+ * Missing cells are left as blank cells with black colors.
+ */
+export function rowFromCells(cells: ReadonlyArray<TerminalCell | undefined>, cols: number = cells.length): TerminalRow {
+  const row = createBlankRow(cols, 0, 0);
+  const count = Math.min(cells.length, cols);
+  for (let x = 0; x < count; x++) {
+    const cell = cells[x];
+    if (!cell) continue;
+    row.codepoints[x] = cell.char.codePointAt(0) ?? SPACE;
+    row.fg[x] = packRgb(cell.fg.r, cell.fg.g, cell.fg.b);
+    row.bg[x] = packRgb(cell.bg.r, cell.bg.g, cell.bg.b);
+    row.hyperlinks[x] = cell.hyperlinkId ?? 0;
+    row.flags[x] = cellRowFlags(cell);
+    row.widths[x] = cell.width;
+  }
+  return row;
+}
+
+/**
+ * Extract the text of a packed row, skipping wide character placeholders.
+ */
+export function extractRowText(row: TerminalRow): string {
+  const { codepoints, widths } = row;
+  let text = '';
+  for (let i = 0; i < codepoints.length; i++) {
+    text += codepointString(codepoints[i]);
+    if (widths[i] === 2) {
+      i++;
+    }
+  }
+  return text;
+}
@@ -9,6 +9,9 @@ import {
   extractLineText,
   isCellInMatch,
   calculateScrollOffset,
+  getViewportCenterLine,
+  mergeMatches,
+  findNearestMatchIndex,
   buildMatchLookup,
 } from '../../src/contexts/search/helpers';
 
@@ -201,6 +204,54 @@ describe('calculateScrollOffset', () => {
   });
 });
 
+describe('getViewportCenterLine', () => {
+  it('returns the middle screen row at the bottom', () => {
+    expect(getViewportCenterLine(100, 0, 24)).toBe(112);
+  });
+
+  it('follows the viewport into scrollback', () => {
+    expect(getViewportCenterLine(100, 100, 24)).toBe(12);
+  });
+});
+
+describe('mergeMatches', () => {
+  it('merges an unsorted batch into sorted matches', () => {
+    const existing: SearchMatch[] = [
+      { lineIndex: 2, startCol: 0, endCol: 1 },
+      { lineIndex: 8, startCol: 0, endCol: 1 },
+    ];
+    const merged = mergeMatches(existing, [
+      { lineIndex: 9, startCol: 0, endCol: 1 },
+      { lineIndex: 2, startCol: 4, endCol: 5 },
+      { lineIndex: 0, startCol: 0, endCol: 1 },
+    ]);
+
+    expect(merged.map((m) => [m.lineIndex, m.startCol])).toEqual([[0, 0], [2, 0], [2, 4], [8, 0], [9, 0]]);
+    // Existing match objects are kept, so the current match can be found again
+    expect(merged[1]).toBe(existing[0]);
+  });
+});
+
+describe('findNearestMatchIndex', () => {
+  const matches: SearchMatch[] = [
+    { lineIndex: 10, startCol: 0, endCol: 1 },
+    { lineIndex: 20, startCol: 0, endCol: 1 },
+    { lineIndex: 40, startCol: 0, endCol: 1 },
+  ];
+
+  it('returns -1 without matches', () => {
+    expect(findNearestMatchIndex([], 5)).toBe(-1);
+  });
+
+  it('picks the closest match and the later one on ties', () => {
+    expect(findNearestMatchIndex(matches, 0)).toBe(0);
+    expect(findNearestMatchIndex(matches, 14)).toBe(0);
+    expect(findNearestMatchIndex(matches, 15)).toBe(1);
+    expect(findNearestMatchIndex(matches, 31)).toBe(2);
+    expect(findNearestMatchIndex(matches, 100)).toBe(2);
+  });
+});
+
 describe('buildMatchLookup', () => {
   it('returns empty map for no matches', () => {
     const lookup = buildMatchLookup([]);
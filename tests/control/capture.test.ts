@@ -2,6 +2,7 @@ import { describe, expect, test } from "bun:test";
 import type { TerminalCell, TerminalState } from '../../src/core/types';
 import type { ITerminalEmulator } from '../../src/terminal/emulator-interface';
 import { captureEmulator } from '../../src/control/capture';
+import { rowFromCells } from '../../src/terminal/terminal-row';
 
 function makeCell(char: string, overrides: Partial<TerminalCell> = {}): TerminalCell {
   return {
@@ -31,7 +32,7 @@ function createEmulator(params: {
   const state: TerminalState = {
     cols: params.live[0]?.length ?? 0,
     rows: params.live.length,
-    cells: params.live,
+    cells: params.live.map((line) => rowFromCells(line)),
     cursor: { x: 0, y: 0, visible: true },
     alternateScreen: false,
     mouseTracking: false,
@@ -6,6 +6,7 @@ import type { TerminalState, Workspace } from '../../src/core/types';
 import type { LayoutState } from '../../src/core/operations/layout-actions';
 import { DEFAULT_CONFIG } from '../../src/core/config';
 import type { ITerminalEmulator } from '../../src/terminal/emulator-interface';
+import { rowFromCells } from '../../src/terminal/terminal-row';
 
 const mockControlProtocol = async () => {
   const protocol = await import('../../src/control/protocol');
@@ -20,7 +21,7 @@ function makeState(line: string): TerminalState {
   return {
     cols: line.length,
     rows: 1,
-    cells: [line.split('').map((char) => ({
+    cells: [rowFromCells(line.split('').map((char) => ({
       char,
       fg: { r: 255, g: 255, b: 255 },
       bg: { r: 0, g: 0, b: 0 },
@@ -32,7 +33,7 @@ function makeState(line: string): TerminalState {
       blink: false,
       dim: false,
       width: 1,
-    }))],
+    })))],
     cursor: { x: 0, y: 0, visible: true },
     alternateScreen: false,
     mouseTracking: false,
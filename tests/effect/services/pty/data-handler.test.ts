@@ -6,6 +6,10 @@ import { createDataHandler } from "../../../../src/effect/services/pty/data-hand
 import { createSyncModeParser } from "../../../../src/terminal/sync-mode-parser"
 import type { InternalPtySession } from "../../../../src/effect/services/pty/types"
 import type { TerminalQueryPassthrough } from "../../../../src/terminal/terminal-query-passthrough"
+import { PrefilterScanFlags } from "../../../../src/terminal/ghostty-vt/types"
+
+const decoder = new TextDecoder()
+const decodeWrite = (data: unknown) => decoder.decode(data as Uint8Array)
 
 function createSession() {
   const emulator = {
@@ -27,9 +31,9 @@ function createSession() {
   }
 
   const queryPassthrough = {
-    process: (data: string) => data,
-    processWithResponses: (data: string) => ({ text: data, responses: [] as string[] }),
-  } as TerminalQueryPassthrough
+    processBytes: (data: Uint8Array) => data,
+    processBytesWithResponses: (data: Uint8Array) => ({ data, responses: [] as string[] }),
+  } as unknown as TerminalQueryPassthrough
 
   const session: InternalPtySession = {
     id: "pty-test" as InternalPtySession["id"],
@@ -45,6 +49,7 @@ function createSession() {
       reset: vi.fn(),
     } as unknown as InternalPtySession["scrollbackArchiver"],
     queryPassthrough,
+    prefilter: null,
     cols: 80,
     rows: 24,
     cellWidth: 8,
@@ -97,7 +102,7 @@ describe("createDataHandler", () => {
 
     await vi.runAllTimersAsync()
 
-    const writes = emulator.write.mock.calls.map(([data]) => data as string)
+    const writes = emulator.write.mock.calls.map(([data]) => decodeWrite(data))
     expect(writes.length).toBe(3)
     expect(writes.join("")).toBe(segments.join(""))
   })
@@ -118,7 +123,7 @@ describe("createDataHandler", () => {
     await vi.runAllTimersAsync()
 
     expect(emulator.write).toHaveBeenCalledTimes(1)
-    expect(emulator.write).toHaveBeenCalledWith("Hello")
+    expect(decodeWrite(emulator.write.mock.calls[0][0])).toBe("Hello")
   })
 
   it("writes terminal responses back to the PTY", async () => {
@@ -154,11 +159,11 @@ describe("createDataHandler", () => {
   it("defers query responses until after emulator responses for kitty queries", () => {
     const { session, emulator, pty } = createSession()
     const passthrough = session.queryPassthrough as TerminalQueryPassthrough & {
-      processWithResponses: (data: string) => { text: string; responses: string[] }
+      processBytesWithResponses: (data: Uint8Array) => { data: Uint8Array; responses: string[] }
     }
 
-    passthrough.processWithResponses = vi.fn(() => ({
-      text: "payload",
+    passthrough.processBytesWithResponses = vi.fn(() => ({
+      data: new TextEncoder().encode("payload"),
       responses: ["\x1b[c"],
     }))
     emulator.drainResponses = vi.fn(() => ["\x1b_Gi=1;OK\x1b\\"])
@@ -191,4 +196,146 @@ describe("createDataHandler", () => {
     expect(session.focusTrackingEnabled).toBe(true)
     expect(pty.write).toHaveBeenCalledWith("\x1b[O")
   })
+
+  it("resets archived scrollback on ED 3 split across chunks", async () => {
+    const { session } = createSession()
+    const handler = createDataHandler({
+      session,
+      syncParser: createSyncModeParser(),
+      syncTimeoutMs: 50,
+    })
+
+    handler.handleData("output\x1b[")
+    handler.handleData("3Jmore")
+    await vi.runAllTimersAsync()
+
+    expect(session.scrollbackArchive.reset).toHaveBeenCalled()
+  })
+
+  it("resets archived scrollback on ED 3 inside a sync block", async () => {
+    const { session, emulator } = createSession()
+    const handler = createDataHandler({
+      session,
+      syncParser: createSyncModeParser(),
+      syncTimeoutMs: 50,
+    })
+
+    handler.handleData("\x1b[?2026h\x1b[3Jframe")
+    expect(session.scrollbackArchive.reset).not.toHaveBeenCalled()
+
+    handler.handleData("\x1b[?2026l")
+    await vi.runAllTimersAsync()
+
+    expect(session.scrollbackArchive.reset).toHaveBeenCalledTimes(1)
+    expect(emulator.write).toHaveBeenCalledTimes(1)
+  })
+
+  it("uses native pre-filter flags to skip JS stages", async () => {
+    const { session, emulator, pty } = createSession()
+    const processBytes = vi.fn((data: Uint8Array) => data)
+    session.queryPassthrough.processBytes = processBytes
+    const commandParser = { processData: vi.fn() }
+    const prefilter = {
+      scan: vi.fn(() => PrefilterScanFlags.FOCUS_TRACKING | PrefilterScanFlags.FOCUS_ENABLED),
+    }
+
+    const handler = createDataHandler({
+      session,
+      syncParser: createSyncModeParser(),
+      commandParser,
+      prefilter,
+      syncTimeoutMs: 50,
+    })
+
+    handler.handleData("\x1b[?1004hplain")
+    await vi.runAllTimersAsync()
+
+    expect(prefilter.scan).toHaveBeenCalledTimes(1)
+    expect(processBytes.mock.calls[0][1]).toBe(true)
+    expect(commandParser.processData).not.toHaveBeenCalled()
+    expect(session.focusTrackingEnabled).toBe(true)
+    expect(pty.write).toHaveBeenCalledWith("\x1b[O")
+    expect(emulator.write).toHaveBeenCalledTimes(1)
+  })
+
+  it("skips the sync parser and OSC scans for chunks the pre-filter clears", async () => {
+    const { session, emulator } = createSession()
+    const parser = createSyncModeParser()
+    const syncParser = { ...parser, process: vi.fn(parser.process) }
+
+    const handler = createDataHandler({
+      session,
+      syncParser,
+      prefilter: { scan: () => 0 },
+      syncTimeoutMs: 50,
+    })
+
+    handler.handleData("plain \x1b[31mred\x1b[0m")
+    await vi.runAllTimersAsync()
+
+    expect(syncParser.process).not.toHaveBeenCalled()
+    expect(emulator.write).toHaveBeenCalledTimes(1)
+    expect(decodeWrite(emulator.write.mock.calls[0][0])).toBe("plain \x1b[31mred\x1b[0m")
+    expect(emulator.write.mock.calls[0][1]).toEqual({ mayContainOsc: false })
+  })
+
+  it("keeps OSC hints for output buffered across sync chunks", async () => {
+    const { session, emulator } = createSession()
+    const flags = [
+      PrefilterScanFlags.SYNC | PrefilterScanFlags.OSC | PrefilterScanFlags.PENDING,
+      PrefilterScanFlags.OSC,
+      PrefilterScanFlags.SYNC,
+    ]
+    const handler = createDataHandler({
+      session,
+      syncParser: createSyncModeParser(),
+      prefilter: { scan: () => flags.shift() ?? 0 },
+      syncTimeoutMs: 50,
+    })
+
+    handler.handleData("\x1b[?2026h\x1b]0;ti")
+    handler.handleData("tle\x07frame")
+    handler.handleData("\x1b[?2026l")
+    await vi.runAllTimersAsync()
+
+    expect(emulator.write).toHaveBeenCalledTimes(1)
+    expect(decodeWrite(emulator.write.mock.calls[0][0])).toBe("\x1b]0;title\x07frame")
+    expect(emulator.write.mock.calls[0][1]).toEqual({ mayContainOsc: true })
+  })
+
+  it("releases a split escape held by the sync parser", async () => {
+    const { session, emulator } = createSession()
+    const flags = [PrefilterScanFlags.PENDING, 0]
+    const handler = createDataHandler({
+      session,
+      syncParser: createSyncModeParser(),
+      prefilter: { scan: () => flags.shift() ?? 0 },
+      syncTimeoutMs: 50,
+    })
+
+    handler.handleData("a\x1b[?20")
+    handler.handleData("25hb")
+    await vi.runAllTimersAsync()
+
+    expect(emulator.write).toHaveBeenCalledTimes(1)
+    expect(decodeWrite(emulator.write.mock.calls[0][0])).toBe("a\x1b[?2025hb")
+  })
+
+  it("passes raw byte chunks through to the emulator", async () => {
+    const { session, emulator } = createSession()
+    const handler = createDataHandler({
+      session,
+      syncParser: createSyncModeParser(),
+      syncTimeoutMs: 50,
+    })
+
+    const chunk = new TextEncoder().encode("caf\u00e9 \x1b[31mred\x1b[0m")
+    handler.handleData(chunk)
+    await vi.runAllTimersAsync()
+
+    expect(emulator.write).toHaveBeenCalledTimes(1)
+    const written = emulator.write.mock.calls[0][0] as Uint8Array
+    expect(written.buffer).toBe(chunk.buffer)
+    expect(decodeWrite(written)).toBe("caf\u00e9 \x1b[31mred\x1b[0m")
+  })
 })
@@ -61,6 +61,7 @@ describe("createSession", () => {
         return { dispose: () => {} }
       },
       onData: vi.fn(),
+      onBinaryData: vi.fn(),
       write: vi.fn(),
       resize: vi.fn(),
       kill: vi.fn(),
@@ -122,6 +123,7 @@ describe("createSession", () => {
     const fakePty = {
       onExit: vi.fn(() => ({ dispose: () => {} })),
       onData: vi.fn(),
+      onBinaryData: vi.fn(),
       write: vi.fn(),
       resize: vi.fn(),
       resizeWithPixels,
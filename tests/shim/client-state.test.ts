@@ -9,6 +9,7 @@ import {
   handlePtyKittyUpdate,
   handlePtyTitle,
   handleUnifiedUpdate,
+  onUnifiedSubscriptionsChange,
   registerEmulatorFactory,
   setPtyState,
   subscribeScroll,
@@ -18,6 +19,7 @@ import {
   subscribeToTitle,
   subscribeUnified,
 } from '../../src/shim/client/state';
+import { extractRowText, rowFromCells } from '../../src/terminal/terminal-row';
 import {
   KittyGraphicsCompression,
   KittyGraphicsFormat,
@@ -43,7 +45,7 @@ function makeState(char: string): TerminalState {
   return {
     cols: 2,
     rows: 1,
-    cells: [[cell, cell]],
+    cells: [rowFromCells([cell, cell])],
     cursor: { x: 0, y: 0, visible: true },
     alternateScreen: false,
     mouseTracking: false,
@@ -88,7 +90,7 @@ describe('shim client state', () => {
     expect(unifiedCount).toBe(1);
     expect(stateCount).toBe(1);
     expect(scrollCount).toBe(1);
-    expect(getPtyState(ptyId)?.terminalState?.cells[0]?.[0]?.char).toBe('x');
+    expect(extractRowText(getPtyState(ptyId)!.terminalState!.cells[0])).toBe('xx');
 
     unsubUnified();
     unsubState();
@@ -106,7 +108,7 @@ describe('shim client state', () => {
       title: 'init',
     });
 
-    const dirtyRow = [{ ...baseCell, char: 'z' }, { ...baseCell, char: 'y' }];
+    const dirtyRow = rowFromCells([{ ...baseCell, char: 'z' }, { ...baseCell, char: 'y' }]);
     const update: UnifiedTerminalUpdate = {
       terminalUpdate: {
         dirtyRows: new Map([[0, dirtyRow]]),
@@ -125,12 +127,42 @@ describe('shim client state', () => {
 
     handleUnifiedUpdate(ptyId, update);
     const state = getPtyState(ptyId);
-    expect(state?.terminalState?.cells[0]?.[0]?.char).toBe('z');
+    expect(extractRowText(state!.terminalState!.cells[0])).toBe('zy');
     expect(state?.title).toBe('init');
 
     deletePtyState(ptyId);
   });
 
+  test('reports the watched ptys once per tick and drops unwatched screens', async () => {
+    const changes: string[][] = [];
+    const stop = onUnifiedSubscriptionsChange((ptyIds) => changes.push(ptyIds));
+    setPtyState('pty-watch-a', {
+      terminalState: makeState('a'),
+      cachedRows: [],
+      scrollState: { viewportOffset: 0, scrollbackLength: 0, isAtBottom: true },
+      title: 'a',
+    });
+
+    const unsubA = subscribeUnified('pty-watch-a', () => {});
+    const unsubB = subscribeUnified('pty-watch-b', () => {});
+    // A remount within the tick doesn't change the set
+    unsubB();
+    const resubB = subscribeUnified('pty-watch-b', () => {});
+    await Promise.resolve();
+    expect(changes.map((ids) => ids.filter((id) => id.startsWith('pty-watch')).sort())).toEqual([
+      ['pty-watch-a', 'pty-watch-b'],
+    ]);
+
+    unsubA();
+    await Promise.resolve();
+    expect(changes.at(-1)!.filter((id) => id.startsWith('pty-watch'))).toEqual(['pty-watch-b']);
+    expect(getPtyState('pty-watch-a')?.terminalState).toBeNull();
+    expect(getPtyState('pty-watch-a')?.title).toBe('a');
+
+    resubB();
+    stop();
+  });
+
   test('updates title and notifies title subscribers', () => {
     const ptyId = 'pty-title';
     let titleCount = 0;
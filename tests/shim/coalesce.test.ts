@@ -0,0 +1,198 @@
+import { describe, expect, test } from "bun:test";
+import { Buffer } from 'buffer';
+
+import type { DirtyTerminalUpdate, TerminalScrollState, TerminalState } from '../../src/core/types';
+import {
+  MAX_HELD_FRAME_BYTES,
+  broadcastFrame,
+  broadcastPtyUpdate,
+  createShimClient,
+  flushHeldFrames,
+  flushPendingUpdates,
+} from '../../src/shim/server/clients';
+import { mergePendingPtyUpdate } from '../../src/shim/server/coalesce';
+import { createShimServerState } from '../../src/shim/server-state';
+import { createBlankRow, extractRowText } from '../../src/terminal/terminal-row';
+
+const scrollState: TerminalScrollState = { viewportOffset: 0, scrollbackLength: 0, isAtBottom: true };
+
+function textRow(text: string) {
+  const row = createBlankRow(4, 0, 0);
+  for (let i = 0; i < text.length; i++) {
+    row.codepoints[i] = text.charCodeAt(i);
+  }
+  return row;
+}
+
+function makeUpdate(rows: Record<number, string>, overrides: Partial<DirtyTerminalUpdate> = {}): DirtyTerminalUpdate {
+  return {
+    dirtyRows: new Map(Object.entries(rows).map(([index, text]) => [Number(index), textRow(text)])),
+    cursor: { x: 0, y: 0, visible: true },
+    scrollState,
+    cols: 4,
+    rows: 3,
+    isFull: false,
+    alternateScreen: false,
+    mouseTracking: false,
+    cursorKeyMode: 'normal',
+    inBandResize: false,
+    ...overrides,
+  };
+}
+
+function makeFullState(lines: string[]): TerminalState {
+  return {
+    cols: 4,
+    rows: lines.length,
+    cells: lines.map(textRow),
+    cursor: { x: 0, y: 0, visible: true },
+    alternateScreen: false,
+    mouseTracking: false,
+  };
+}
+
+function fakeSocket(writeResults: boolean[]) {
+  const writes: Buffer[] = [];
+  const socket = {
+    destroyed: false,
+    write: (frame: Buffer) => {
+      writes.push(frame);
+      return writeResults.shift() ?? true;
+    },
+  };
+  return { socket: socket as any, writes };
+}
+
+describe('ptyUpdate coalescing', () => {
+  test('unions dirty rows with the newest row data winning', () => {
+    const first = mergePendingPtyUpdate(undefined, makeUpdate({ 0: 'aaaa', 1: 'bbbb' }), scrollState);
+    const second = mergePendingPtyUpdate(
+      first!,
+      makeUpdate({ 1: 'BBBB', 2: 'cccc' }, { cursor: { x: 2, y: 2, visible: false } }),
+      { ...scrollState, scrollbackLength: 5 }
+    );
+
+    expect(second).not.toBeNull();
+    const merged = second!.update;
+    expect(Array.from(merged.dirtyRows.keys()).sort()).toEqual([0, 1, 2]);
+    expect(extractRowText(merged.dirtyRows.get(1)!)).toBe('BBBB');
+    expect(merged.cursor).toEqual({ x: 2, y: 2, visible: false });
+    expect(second!.scrollState.scrollbackLength).toBe(5);
+  });
+
+  test('folds dirty rows into a pending full update', () => {
+    const fullState = makeFullState(['aaaa', 'bbbb', 'cccc']);
+    const full = mergePendingPtyUpdate(undefined, makeUpdate({}, { isFull: true, fullState }), scrollState);
+    const merged = mergePendingPtyUpdate(full!, makeUpdate({ 1: 'xxxx' }), scrollState)!.update;
+
+    expect(merged.isFull).toBe(true);
+    expect(merged.fullState!.cells.map(extractRowText)).toEqual(['aaaa', 'xxxx', 'cccc']);
+    // The original full state is not mutated
+    expect(extractRowText(fullState.cells[1])).toBe('bbbb');
+  });
+
+  test('falls back when dimensions change without a full update', () => {
+    const first = mergePendingPtyUpdate(undefined, makeUpdate({ 0: 'aaaa' }), scrollState);
+    expect(mergePendingPtyUpdate(first!, makeUpdate({ 0: 'a' }, { cols: 2 }), scrollState)).toBeNull();
+  });
+
+  test('encodes once for ready clients and holds coalesced updates for congested ones', () => {
+    const state = createShimServerState();
+    const fast = fakeSocket([]);
+    const slow = fakeSocket([false]);
+    state.clients.set(fast.socket, createShimClient(fast.socket, 'fast', false));
+    const slowClient = createShimClient(slow.socket, 'slow', true);
+    state.clients.set(slow.socket, slowClient);
+
+    let encodes = 0;
+    const encode = (_ptyId: string, update: DirtyTerminalUpdate) => {
+      encodes += 1;
+      return Buffer.from(Array.from(update.dirtyRows.keys()).join(','));
+    };
+
+    broadcastPtyUpdate(state, 'pty-1', makeUpdate({ 0: 'aaaa' }), scrollState, encode);
+    expect(encodes).toBe(1);
+    expect(slowClient.congested).toBe(true);
+
+    broadcastPtyUpdate(state, 'pty-1', makeUpdate({ 1: 'bbbb' }), scrollState, encode);
+    broadcastPtyUpdate(state, 'pty-1', makeUpdate({ 1: 'BBBB', 2: 'cccc' }), scrollState, encode);
+    expect(fast.writes.map(String)).toEqual(['0', '1', '1,2']);
+    expect(slow.writes.map(String)).toEqual(['0']);
+
+    expect(flushPendingUpdates(slowClient, encode)).toEqual([]);
+    expect(slow.writes.map(String)).toEqual(['0', '1,2']);
+    expect(slowClient.pendingUpdates.size).toBe(0);
+  });
+
+  test('turns unmergeable held updates into snapshot requests', () => {
+    const state = createShimServerState();
+    const slow = fakeSocket([false]);
+    const client = createShimClient(slow.socket, 'slow', false);
+    state.clients.set(slow.socket, client);
+    const encode = () => Buffer.from('frame');
+
+    broadcastPtyUpdate(state, 'pty-1', makeUpdate({ 0: 'aaaa' }), scrollState, encode);
+    broadcastPtyUpdate(state, 'pty-1', makeUpdate({ 0: 'aaaa' }), scrollState, encode);
+    broadcastPtyUpdate(state, 'pty-1', makeUpdate({ 0: 'aa' }, { cols: 2 }), scrollState, encode);
+
+    expect(flushPendingUpdates(client, encode)).toEqual(['pty-1']);
+    expect(slow.writes).toHaveLength(1);
+  });
+
+  test('holds events for congested clients and drops kitty frames over the cap', () => {
+    const state = createShimServerState();
+    const fast = fakeSocket([]);
+    const slow = fakeSocket([false]);
+    state.clients.set(fast.socket, createShimClient(fast.socket, 'fast', false));
+    const client = createShimClient(slow.socket, 'slow', true);
+    state.clients.set(slow.socket, client);
+
+    broadcastFrame(state, Buffer.from('title'), 'pty-1');
+    broadcastFrame(state, Buffer.from('exit'), 'pty-2');
+    broadcastFrame(state, Buffer.from('kitty'), 'pty-1', true);
+    expect(fast.writes.map(String)).toEqual(['title', 'exit', 'kitty']);
+    expect(slow.writes.map(String)).toEqual(['title']);
+
+    // Kitty frames go once the held bytes pass the cap; later ones for the pty are skipped
+    broadcastFrame(state, Buffer.alloc(MAX_HELD_FRAME_BYTES), 'pty-1', true);
+    broadcastFrame(state, Buffer.from('kitty-2'), 'pty-1', true);
+    expect(client.heldFrames.map(({ frame }) => String(frame))).toEqual(['exit']);
+
+    expect(flushHeldFrames(client)).toEqual(['pty-1']);
+    expect(slow.writes.map(String)).toEqual(['title', 'exit']);
+    expect(client.heldBytes).toBe(0);
+    expect(client.kittyResync.size).toBe(0);
+  });
+
+  test('sends kitty frames only to clients that want the pty', () => {
+    const state = createShimServerState();
+    const all = fakeSocket([]);
+    const filtered = fakeSocket([]);
+    state.clients.set(all.socket, createShimClient(all.socket, 'all', false));
+    const client = createShimClient(filtered.socket, 'filtered', true);
+    client.ptyFilter = new Set(['pty-2']);
+    state.clients.set(filtered.socket, client);
+
+    broadcastFrame(state, Buffer.from('kitty-1'), 'pty-1', true);
+    broadcastFrame(state, Buffer.from('kitty-2'), 'pty-2', true);
+    expect(all.writes.map(String)).toEqual(['kitty-1', 'kitty-2']);
+    expect(filtered.writes.map(String)).toEqual(['kitty-2']);
+  });
+
+  test('keeps held events that do not fit when the socket congests again', () => {
+    const state = createShimServerState();
+    const slow = fakeSocket([false, false]);
+    const client = createShimClient(slow.socket, 'slow', false);
+    state.clients.set(slow.socket, client);
+
+    broadcastFrame(state, Buffer.from('a'));
+    broadcastFrame(state, Buffer.from('b'));
+    broadcastFrame(state, Buffer.from('c'));
+    expect(flushHeldFrames(client)).toEqual([]);
+    expect(client.congested).toBe(true);
+    expect(client.heldFrames.map(({ frame }) => String(frame))).toEqual(['c']);
+
+    flushHeldFrames(client);
+    expect(slow.writes.map(String)).toEqual(['a', 'b', 'c']);
+  });
+});
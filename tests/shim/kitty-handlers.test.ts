@@ -1,8 +1,11 @@
+import fs from 'fs';
 import { describe, expect, it } from "bun:test";
 import type { ITerminalEmulator, KittyGraphicsImageInfo } from '../../src/terminal/emulator-interface';
 import { KittyGraphicsCompression, KittyGraphicsFormat } from '../../src/terminal/emulator-interface';
 import { createKittyHandlers } from '../../src/shim/server/kitty';
+import { createShimClient } from '../../src/shim/server/clients';
 import { createShimServerState } from '../../src/shim/server-state';
+import { KITTY_SHM_THRESHOLD_BYTES, readKittyShm } from '../../src/shim/kitty-shm';
 
 const makeImageInfo = (id: number, transmitTime: bigint): KittyGraphicsImageInfo => ({
   id,
@@ -20,7 +23,7 @@ describe('createKittyHandlers', () => {
   it('forces image data after delete-all invalidation', () => {
     const state = createShimServerState();
     const events: Array<{ header: any; payloads: ArrayBuffer[] }> = [];
-    state.activeClient = {} as any;
+    state.clients.set({} as any, createShimClient({} as any, 'client-1', false));
 
     const handlers = createKittyHandlers(state, (header, payloads = []) => {
       events.push({ header, payloads });
@@ -49,4 +52,92 @@ describe('createKittyHandlers', () => {
     expect(update?.header.kitty.imageDataIds).toEqual([1]);
     expect(update?.payloads.length).toBe(1);
   });
+
+  it('sends targeted updates to one client without touching shared state', () => {
+    const state = createShimServerState();
+    const events: Array<{ header: any; payloads: ArrayBuffer[]; target?: unknown }> = [];
+    const target = createShimClient({} as any, 'client-2', true);
+    state.clients.set({} as any, createShimClient({} as any, 'client-1', false));
+    state.clients.set({} as any, target);
+
+    const handlers = createKittyHandlers(state, (header, payloads = [], to) => {
+      events.push({ header, payloads, target: to });
+    });
+
+    let cleared = 0;
+    const emulator: ITerminalEmulator = {
+      getKittyImagesDirty: () => true,
+      clearKittyImagesDirty: () => { cleared += 1; },
+      getKittyImageIds: () => [1],
+      getKittyImageInfo: () => makeImageInfo(1, 1n),
+      getKittyImageData: () => new Uint8Array([1, 2, 3]),
+      getKittyPlacements: () => [],
+      isAlternateScreen: () => false,
+    } as ITerminalEmulator;
+
+    handlers.sendKittyUpdate('pty-1', emulator, true, target);
+    expect(events).toHaveLength(1);
+    expect(events[0].target).toBe(target);
+    expect(events[0].header.kitty.imageDataIds).toEqual([1]);
+    expect(cleared).toBe(0);
+    expect(state.kittyImages.has('pty-1')).toBe(false);
+
+    // The next broadcast still diffs against what all clients were sent
+    events.length = 0;
+    handlers.sendKittyUpdate('pty-1', emulator);
+    expect(events[0].target).toBeUndefined();
+    expect(events[0].header.kitty.imageDataIds).toEqual([1]);
+    expect(cleared).toBe(1);
+  });
+
+  it('passes large image data through shared memory', () => {
+    const state = createShimServerState();
+    const events: Array<{ header: any; payloads: ArrayBuffer[] }> = [];
+    state.clients.set({} as any, createShimClient({} as any, 'client-1', false));
+
+    const handlers = createKittyHandlers(state, (header, payloads = []) => {
+      events.push({ header, payloads });
+    });
+
+    const data = new Uint8Array(KITTY_SHM_THRESHOLD_BYTES).map((_, i) => i & 0xff);
+    let ids = [1, 2];
+    const emulator: ITerminalEmulator = {
+      getKittyImagesDirty: () => true,
+      clearKittyImagesDirty: () => {},
+      getKittyImageIds: () => ids,
+      getKittyImageInfo: (id: number) => makeImageInfo(id, 1n),
+      getKittyImageData: (id: number) => (id === 1 ? data : new Uint8Array([1, 2, 3])),
+      getKittyPlacements: () => [],
+      isAlternateScreen: () => false,
+    } as ITerminalEmulator;
+
+    try {
+      handlers.sendKittyUpdate('pty-1', emulator, true);
+      const update = events.find((event) => event.header.type === 'ptyKitty')!;
+      expect(update.header.kitty.imageDataIds).toEqual([2]);
+      expect(update.payloads.map((payload) => payload.byteLength)).toEqual([3]);
+
+      const [ref] = update.header.kitty.sharedImages;
+      expect(ref).toMatchObject({ id: 1, byteLength: data.byteLength });
+      expect(readKittyShm(ref)).toEqual(data);
+
+      // Unchanged images reuse their segment; removed ones unlink it
+      events.length = 0;
+      handlers.sendKittyUpdate('pty-1', emulator, true);
+      expect(events[0].header.kitty.sharedImages[0].path).toBe(ref.path);
+
+      // Targeted resends reuse the published segment as well
+      events.length = 0;
+      const [client] = state.clients.values();
+      handlers.sendKittyUpdate('pty-1', emulator, true, client);
+      expect(events[0].header.kitty.sharedImages[0].path).toBe(ref.path);
+
+      ids = [2];
+      handlers.sendKittyUpdate('pty-1', emulator, false);
+      expect(fs.existsSync(ref.path)).toBe(false);
+      expect(readKittyShm(ref)).toBeNull();
+    } finally {
+      state.kittyShm.dispose();
+    }
+  });
 });
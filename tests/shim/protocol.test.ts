@@ -1,5 +1,14 @@
 import { describe, expect, test } from "bun:test";
-import { encodeFrame, FrameReader, type ShimHeader } from '../../src/shim/protocol';
+import {
+  encodeAckFrame,
+  encodeFrame,
+  encodePtyUpdateFrame,
+  encodeRequestFrame,
+  encodeScrollbackLinesFrame,
+  FrameReader,
+  type ShimHeader,
+} from '../../src/shim/protocol';
+import type { SerializedDirtyUpdate } from '../../src/terminal/emulator-interface';
 
 function readFrames(chunks: Buffer[]): Array<{ header: ShimHeader; payloads: Buffer[] }> {
   const reader = new FrameReader();
@@ -58,4 +67,124 @@ describe('shim protocol', () => {
     expect(frames[0].payloads).toHaveLength(1);
     expect(frames[0].payloads[0].toString('utf8')).toBe('onetwo');
   });
+
+  test('decodes binary ptyUpdate frames into the JSON header shape', () => {
+    const packed: SerializedDirtyUpdate = {
+      dirtyRowIndices: new Uint16Array([2, 5]),
+      dirtyRowData: new Uint8Array([1, 2, 3, 4]).buffer,
+      cursor: { x: 7, y: 3, visible: true },
+      cols: 80,
+      rows: 24,
+      scrollbackLength: 1200,
+      isFull: false,
+      alternateScreen: true,
+      mouseTracking: false,
+      cursorKeyMode: 1,
+      kittyKeyboardFlags: 5,
+      inBandResize: true,
+    };
+    const frame = encodePtyUpdateFrame('pty-1', packed, { viewportOffset: 42, isAtBottom: false });
+    const [decoded] = readFrames([frame]);
+
+    expect(decoded.header).toEqual({
+      type: 'ptyUpdate',
+      ptyId: 'pty-1',
+      packed: {
+        cursor: { x: 7, y: 3, visible: true },
+        cols: 80,
+        rows: 24,
+        scrollbackLength: 1200,
+        isFull: false,
+        alternateScreen: true,
+        mouseTracking: false,
+        cursorKeyMode: 1,
+        kittyKeyboardFlags: 5,
+        inBandResize: true,
+      },
+      scrollState: { viewportOffset: 42, isAtBottom: false },
+    });
+    expect(Array.from(new Uint16Array(new Uint8Array(decoded.payloads[0]).buffer))).toEqual([2, 5]);
+    expect(Array.from(decoded.payloads[1])).toEqual([1, 2, 3, 4]);
+    expect(decoded.payloads[2].length).toBe(0);
+  });
+
+  test('encodes hot requests as binary and the rest as JSON', () => {
+    const write = encodeRequestFrame(1, 'write', { ptyId: 'p', data: 'l\u00e9s\r' });
+    const resize = encodeRequestFrame(2, 'resize', { ptyId: 'p', cols: 100, rows: 30, pixelWidth: 800 });
+    const scrollback = encodeRequestFrame(3, 'getScrollbackLines', { ptyId: 'p', startOffset: 10, count: 4 });
+    const other = encodeRequestFrame(4, 'getCwd', { ptyId: 'p' });
+
+    expect(write.readUInt32BE(4) & 0x80000000).not.toBe(0);
+    expect(other.readUInt32BE(4) & 0x80000000).toBe(0);
+
+    const frames = readFrames([Buffer.concat([write, resize, scrollback, other])]);
+    expect(frames.map((frame) => frame.header)).toEqual([
+      { type: 'request', requestId: 1, method: 'write', params: { ptyId: 'p', data: 'l\u00e9s\r' } },
+      {
+        type: 'request',
+        requestId: 2,
+        method: 'resize',
+        params: { ptyId: 'p', cols: 100, rows: 30, pixelWidth: 800, pixelHeight: undefined },
+      },
+      { type: 'request', requestId: 3, method: 'getScrollbackLines', params: { ptyId: 'p', startOffset: 10, count: 4 } },
+      { type: 'request', requestId: 4, method: 'getCwd', params: { ptyId: 'p' }, payloadLengths: [] },
+    ]);
+  });
+
+  test('decodes binary responses', () => {
+    const ack = encodeAckFrame(9);
+    const lines = encodeScrollbackLinesFrame(10, [3, 4], [Buffer.from('ab'), Buffer.from('cd')]);
+    const frames = readFrames([Buffer.concat([ack, lines])]);
+
+    expect(frames[0].header).toEqual({ type: 'response', requestId: 9, ok: true });
+    expect(frames[1].header).toEqual({ type: 'response', requestId: 10, ok: true, result: { lineOffsets: [3, 4] } });
+    expect(frames[1].payloads[0].toString('utf8')).toBe('abcd');
+  });
+
+  test('reassembles frames split byte by byte without aliasing payloads', () => {
+    const frameA = encodeFrame({ type: 'event', payloadLengths: [3] }, [Buffer.from('abc')]);
+    const frameB = encodeRequestFrame(7, 'write', { ptyId: 'p', data: 'xyz' });
+    const stream = Buffer.concat([frameA, frameB, frameA]);
+    const chunks: Buffer[] = [];
+    for (let i = 0; i < stream.length; i++) {
+      chunks.push(stream.subarray(i, i + 1));
+    }
+    const frames = readFrames(chunks);
+
+    expect(frames).toHaveLength(3);
+    expect(frames[0].payloads[0].toString('utf8')).toBe('abc');
+    expect(frames[1].header.params).toEqual({ ptyId: 'p', data: 'xyz' });
+    expect(frames[2].payloads[0].toString('utf8')).toBe('abc');
+  });
+
+  test('shrinks the split-frame buffer after a large frame', () => {
+    const reader = new FrameReader();
+    const payloads: Buffer[] = [];
+    const feedSplit = (frame: Buffer) => {
+      const middle = frame.length >> 1;
+      for (const chunk of [frame.subarray(0, middle), frame.subarray(middle)]) {
+        reader.feed(chunk, (_header, framePayloads) => payloads.push(framePayloads[0]));
+      }
+    };
+    const pendingCapacity = () => (reader as unknown as { pending: Buffer }).pending.length;
+
+    const large = Buffer.alloc(2 * 1024 * 1024, 7);
+    feedSplit(encodeFrame({ type: 'event', payloadLengths: [large.length] }, [large]));
+    expect(payloads[0].equals(large)).toBe(true);
+    expect(pendingCapacity()).toBe(64 * 1024);
+
+    feedSplit(encodeFrame({ type: 'event', payloadLengths: [3] }, [Buffer.from('abc')]));
+    expect(payloads[1].toString('utf8')).toBe('abc');
+  });
+
+  test('turns truncated binary responses into failed responses', () => {
+    const lines = encodeScrollbackLinesFrame(11, [3, 4], [Buffer.from('ab'), Buffer.from('cd')]);
+    // Keep the request id but cut the line offset table short
+    const truncated = Buffer.from(lines.subarray(0, 4 + 14));
+    truncated.writeUInt32BE(14, 0);
+    const frames = readFrames([truncated]);
+
+    expect(frames).toHaveLength(1);
+    expect(frames[0].header).toMatchObject({ type: 'response', requestId: 11, ok: false });
+  });
 });
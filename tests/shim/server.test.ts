@@ -4,7 +4,7 @@ import { join } from 'path';
 import { describe, expect, test } from "bun:test";
 import fs from 'fs/promises';
 
-import { encodeFrame, FrameReader, type ShimHeader } from '../../src/shim/protocol';
+import { encodeFrame, FrameReader, SHIM_PROTOCOL_MISMATCH, SHIM_PROTOCOL_VERSION, type ShimHeader } from '../../src/shim/protocol';
 import { startShimServer } from '../../src/shim/server';
 
 type Frame = { header: ShimHeader; payloads: Buffer[] };
@@ -156,7 +156,7 @@ describe('shim server', () => {
       type: 'request',
       requestId: 1,
       method: 'hello',
-      params: { clientId: 'client-a' },
+      params: { version: SHIM_PROTOCOL_VERSION, clientId: 'client-a' },
     });
     const helloA = await readerA.nextFrame();
     expect(helloA.header.ok).toBe(true);
@@ -168,7 +168,7 @@ describe('shim server', () => {
       type: 'request',
       requestId: 2,
       method: 'hello',
-      params: { clientId: 'client-b' },
+      params: { version: SHIM_PROTOCOL_VERSION, clientId: 'client-b' },
     });
     const detached = await readerA.nextFrame();
     expect(detached.header.type).toBe('detached');
@@ -181,7 +181,7 @@ describe('shim server', () => {
       type: 'request',
       requestId: 3,
       method: 'hello',
-      params: { clientId: 'client-a' },
+      params: { version: SHIM_PROTOCOL_VERSION, clientId: 'client-a' },
     });
     const revoked = await readerARe.nextFrame();
     expect(revoked.header.ok).toBe(false);
@@ -194,6 +194,58 @@ describe('shim server', () => {
     await fs.rm(socketDir, { recursive: true, force: true });
   });
 
+  test('hello rejects clients without a matching protocol version', async () => {
+    const socketDir = await fs.mkdtemp(join(tmpdir(), 'openmux-shim-'));
+    const socketPath = join(socketDir, 'shim.sock');
+
+    const fakePty = {
+      listAll: () => [],
+      subscribeToLifecycle: () => () => {},
+      subscribeToAllTitleChanges: () => () => {},
+    };
+
+    const server = await startShimServer({
+      socketPath,
+      withPty: async (fn) => fn(fakePty),
+      setHostColors: () => {},
+    });
+
+    const helloParams = [
+      { clientId: 'client-legacy' },
+      { version: SHIM_PROTOCOL_VERSION + 1, clientId: 'client-future' },
+    ];
+    for (const [index, params] of helloParams.entries()) {
+      const client = await connectClient(socketPath);
+      const reader = createFrameQueue(client);
+      await sendRequest(client, {
+        type: 'request',
+        requestId: index + 1,
+        method: 'hello',
+        params,
+      });
+      const response = await reader.nextFrame();
+      expect(response.header.ok).toBe(false);
+      expect(response.header.error?.startsWith(SHIM_PROTOCOL_MISMATCH)).toBe(true);
+      client.destroy();
+    }
+
+    const client = await connectClient(socketPath);
+    const reader = createFrameQueue(client);
+    await sendRequest(client, {
+      type: 'request',
+      requestId: 3,
+      method: 'hello',
+      params: { version: SHIM_PROTOCOL_VERSION, clientId: 'client-current' },
+    });
+    const hello = await reader.nextFrame();
+    expect(hello.header.ok).toBe(true);
+    expect((hello.header.result as { version?: number }).version).toBe(SHIM_PROTOCOL_VERSION);
+
+    client.destroy();
+    server.close();
+    await fs.rm(socketDir, { recursive: true, force: true });
+  });
+
   test('A -> B -> A race detaches once and keeps one active client', async () => {
     const socketDir = await fs.mkdtemp(join(tmpdir(), 'openmux-shim-'));
     const socketPath = join(socketDir, 'shim.sock');
@@ -216,7 +268,7 @@ describe('shim server', () => {
       type: 'request',
       requestId: 1,
       method: 'hello',
-      params: { clientId: 'client-a' },
+      params: { version: SHIM_PROTOCOL_VERSION, clientId: 'client-a' },
     });
     const helloA = await readerA.nextFrame();
     expect(helloA.header.ok).toBe(true);
@@ -229,13 +281,13 @@ describe('shim server', () => {
         type: 'request',
         requestId: 2,
         method: 'hello',
-        params: { clientId: 'client-b' },
+        params: { version: SHIM_PROTOCOL_VERSION, clientId: 'client-b' },
       }),
       sendRequest(clientA, {
         type: 'request',
         requestId: 3,
         method: 'hello',
-        params: { clientId: 'client-a' },
+        params: { version: SHIM_PROTOCOL_VERSION, clientId: 'client-a' },
       }),
     ]);
 
@@ -265,6 +317,85 @@ describe('shim server', () => {
     await fs.rm(socketDir, { recursive: true, force: true });
   });
 
+  test('shared clients attach alongside the primary and receive the same events', async () => {
+    const socketDir = await fs.mkdtemp(join(tmpdir(), 'openmux-shim-'));
+    const socketPath = join(socketDir, 'shim.sock');
+
+    let emitTitle: ((event: { ptyId: string; title: string }) => void) | null = null;
+    let titleSubscriptions = 0;
+    const fakePty = {
+      listAll: () => [],
+      subscribeToLifecycle: () => () => {},
+      subscribeToAllTitleChanges: (callback: (event: { ptyId: string; title: string }) => void) => {
+        titleSubscriptions += 1;
+        emitTitle = callback;
+        return () => {};
+      },
+    };
+
+    const server = await startShimServer({
+      socketPath,
+      withPty: async (fn) => fn(fakePty),
+      setHostColors: () => {},
+    });
+
+    const primary = await connectClient(socketPath);
+    const primaryReader = createFrameQueue(primary);
+    await sendRequest(primary, {
+      type: 'request',
+      requestId: 1,
+      method: 'hello',
+      params: { version: SHIM_PROTOCOL_VERSION, clientId: 'client-primary' },
+    });
+    expect((await primaryReader.nextFrame()).header.ok).toBe(true);
+
+    const viewer = await connectClient(socketPath);
+    const viewerReader = createFrameQueue(viewer);
+    await sendRequest(viewer, {
+      type: 'request',
+      requestId: 1,
+      method: 'hello',
+      params: { version: SHIM_PROTOCOL_VERSION, clientId: 'client-viewer', shared: true },
+    });
+    expect((await viewerReader.nextFrame()).header.ok).toBe(true);
+    expect(titleSubscriptions).toBe(1);
+
+    // The primary stays attached
+    await sendRequest(primary, {
+      type: 'request',
+      requestId: 2,
+      method: 'getSessionMapping',
+      params: { sessionId: 'session-1' },
+    });
+    const mapping = await primaryReader.nextFrame();
+    expect(mapping.header.type).toBe('response');
+    expect(mapping.header.ok).toBe(true);
+
+    emitTitle?.({ ptyId: 'pty-1', title: 'build' });
+    const primaryTitle = await primaryReader.nextFrame();
+    const viewerTitle = await viewerReader.nextFrame();
+    expect(primaryTitle.header).toEqual({ type: 'ptyTitle', ptyId: 'pty-1', title: 'build' });
+    expect(viewerTitle.header).toEqual(primaryTitle.header);
+
+    await sendRequest(viewer, {
+      type: 'request',
+      requestId: 2,
+      method: 'setPtyFilter',
+      params: { ptyIds: ['pty-2'] },
+    });
+    expect((await viewerReader.nextFrame()).header.ok).toBe(true);
+
+    // The filter covers pty output; titles still reach every client
+    emitTitle?.({ ptyId: 'pty-1', title: 'test' });
+    expect((await primaryReader.nextFrame()).header.title).toBe('test');
+    expect((await viewerReader.nextFrame()).header.title).toBe('test');
+
+    primary.destroy();
+    viewer.destroy();
+    server.close();
+    await fs.rm(socketDir, { recursive: true, force: true });
+  });
+
   test('registers and returns session mappings', async () => {
     const socketDir = await fs.mkdtemp(join(tmpdir(), 'openmux-shim-'));
     const socketPath = join(socketDir, 'shim.sock');
@@ -289,7 +420,7 @@ describe('shim server', () => {
       type: 'request',
       requestId: 1,
       method: 'hello',
-      params: { clientId: 'client-map' },
+      params: { version: SHIM_PROTOCOL_VERSION, clientId: 'client-map' },
     });
     await reader.nextFrame();
 
@@ -342,7 +473,7 @@ describe('shim server', () => {
       type: 'request',
       requestId: 1,
       method: 'hello',
-      params: { clientId: 'client-stale' },
+      params: { version: SHIM_PROTOCOL_VERSION, clientId: 'client-stale' },
     });
     await reader.nextFrame();
 
@@ -4,12 +4,12 @@
 
 import { describe, it, expect } from "bun:test"
 import { shouldClearCacheOnUpdate } from "../../src/terminal/emulator-utils/scrollback-cache"
-import type { DirtyTerminalUpdate, TerminalCell } from "../../src/core/types"
+import type { DirtyTerminalUpdate, TerminalRow } from "../../src/core/types"
 import type { TerminalModes } from "../../src/terminal/emulator-interface"
 
 function createUpdate(alternateScreen: boolean): DirtyTerminalUpdate {
   return {
-    dirtyRows: new Map<number, TerminalCell[]>(),
+    dirtyRows: new Map<number, TerminalRow>(),
     cursor: { x: 0, y: 0, visible: false },
     scrollState: { viewportOffset: 0, scrollbackLength: 0, isAtBottom: true },
     cols: 80,
@@ -11,7 +11,15 @@ import {
   unpackDirtyUpdate,
   packTerminalState,
   unpackTerminalState,
+  packCompactCells,
+  unpackCompactCells,
+  packArchiveRow,
+  packArchiveRecord,
+  scanArchiveRecord,
+  unpackArchiveRow,
+  StyleInterner,
 } from '../../src/terminal/cell-serialization';
+import { extractRowText, rowCellAt, rowFromCells } from '../../src/terminal/terminal-row';
 import type { TerminalCell, TerminalState, DirtyTerminalUpdate, TerminalScrollState } from '../../src/core/types';
 
 describe('cell-serialization', () => {
@@ -150,8 +158,8 @@ describe('cell-serialization', () => {
       };
 
       // Create full rows with 3 cells each (cols = 3)
-      const row0 = [createTestCell('A'), createTestCell('B'), createTestCell('C')];
-      const row2 = [createTestCell('X'), createTestCell('Y'), createTestCell('Z')];
+      const row0 = rowFromCells([createTestCell('A'), createTestCell('B'), createTestCell('C')]);
+      const row2 = rowFromCells([createTestCell('X'), createTestCell('Y'), createTestCell('Z')]);
 
       const update: DirtyTerminalUpdate = {
         dirtyRows: new Map([
@@ -181,8 +189,8 @@ describe('cell-serialization', () => {
       expect(unpacked.mouseTracking).toBe(true);
       expect(unpacked.cursorKeyMode).toBe('normal');
       expect(unpacked.dirtyRows.size).toBe(2);
-      expect(unpacked.dirtyRows.get(0)?.[0].char).toBe('A');
-      expect(unpacked.dirtyRows.get(2)?.[0].char).toBe('X');
+      expect(extractRowText(unpacked.dirtyRows.get(0)!)).toBe('ABC');
+      expect(extractRowText(unpacked.dirtyRows.get(2)!)).toBe('XYZ');
     });
 
     it('should handle full update with fullState', () => {
@@ -196,8 +204,8 @@ describe('cell-serialization', () => {
         cols: 2,
         rows: 2,
         cells: [
-          [createTestCell('X'), createTestCell('Y')],
-          [createTestCell('Z'), createTestCell('W')],
+          rowFromCells([createTestCell('X'), createTestCell('Y')]),
+          rowFromCells([createTestCell('Z'), createTestCell('W')]),
         ],
         cursor: { x: 0, y: 0, visible: true, style: 'block' },
         alternateScreen: true,
@@ -225,22 +233,122 @@ describe('cell-serialization', () => {
 
       expect(unpacked.isFull).toBe(true);
       expect(unpacked.fullState).toBeDefined();
-      expect(unpacked.fullState?.cells[0][0].char).toBe('X');
-      expect(unpacked.fullState?.cells[1][1].char).toBe('W');
+      expect(rowCellAt(unpacked.fullState!.cells[0], 0).char).toBe('X');
+      expect(rowCellAt(unpacked.fullState!.cells[1], 1).char).toBe('W');
       expect(unpacked.cursorKeyMode).toBe('application');
       expect(unpacked.kittyKeyboardFlags).toBe(3);
     });
   });
 
+  describe('compact cell blocks', () => {
+    it('should intern shared styles and round-trip attributes', () => {
+      const red = { r: 255, g: 0, b: 0 };
+      const black = { r: 0, g: 0, b: 0 };
+      const styled = (char: string): TerminalCell => ({
+        ...createTestCell(char),
+        fg: red,
+        bg: black,
+        bold: true,
+        hyperlinkId: 7,
+      });
+      const rows = [
+        rowFromCells([styled('a'), styled('b'), createTestCell('c')]),
+        rowFromCells([styled('d'), createTestCell('e'), createTestCell('f')]),
+      ];
+
+      const packed = packCompactCells(rows, 3);
+      // 8-byte header + 2 styles (10 bytes) + 6 cells (8 bytes)
+      expect(packed.byteLength).toBe(8 + 2 * 10 + 6 * 8);
+
+      const unpacked = unpackCompactCells(packed, 0, 2, 3);
+      expect(extractRowText(unpacked[0])).toBe('abc');
+      expect(rowCellAt(unpacked[1], 0)).toMatchObject({ char: 'd', fg: red, bold: true, hyperlinkId: 7 });
+      expect(rowCellAt(unpacked[0], 2).bold).toBe(false);
+      expect(rowCellAt(unpacked[0], 2).hyperlinkId).toBeUndefined();
+      expect(unpacked[0].fg[0]).toBe(0xff0000);
+      expect(unpacked[1].bg[0]).toBe(0);
+    });
+
+    it('should pack missing rows as blank cells', () => {
+      const packed = packCompactCells([undefined, rowFromCells([createTestCell('x')])], 2);
+      const unpacked = unpackCompactCells(packed, 0, 2, 2);
+
+      expect(extractRowText(unpacked[0])).toBe('  ');
+      expect(extractRowText(unpacked[1])).toBe('x ');
+    });
+  });
+
+  describe('archive row records', () => {
+    it('round-trips styles, wide cells and trailing blanks', () => {
+      const red = { ...createTestCell('e'), fg: { r: 200, g: 0, b: 0 }, bold: true, hyperlinkId: 7 };
+      const wide = { ...createTestCell('日'), width: 2 as const };
+      const row: TerminalCell[] = [
+        createTestCell('o'),
+        createTestCell('k'),
+        red,
+        wide,
+        createTestCell(' '),
+        ...Array.from({ length: 195 }, () => createTestCell(' ')),
+      ];
+
+      const styles = new StyleInterner();
+      const first = packArchiveRow(row, styles);
+      const second = packArchiveRow(row, styles);
+      expect(first.byteLength).toBeLessThan(64);
+      // The second record reuses the chunk's styles
+      expect(second.byteLength).toBeLessThan(first.byteLength);
+
+      const buffer = new Uint8Array(first.byteLength + second.byteLength);
+      buffer.set(first);
+      buffer.set(second, first.byteLength);
+      const view = new DataView(buffer.buffer);
+
+      // Rebuild the style table the way a reopened chunk does
+      const scanned = new StyleInterner();
+      const header = scanArchiveRecord(view, 0, scanned)!;
+      expect(header).toEqual({ next: first.byteLength, cols: 200, used: 4, wrapped: false, wide: [3] });
+      const next = header.next;
+      expect(scanArchiveRecord(view, next, scanned)?.next).toBe(buffer.byteLength);
+      expect(scanArchiveRecord(new DataView(buffer.buffer, 0, 10), 0, new StyleInterner())).toBeNull();
+
+      const unpacked = unpackArchiveRow(view, next, scanned);
+      expect(unpacked).toHaveLength(200);
+      expect(unpacked.map((cell) => cell.char).join('').trimEnd()).toBe('ok' + 'e' + '日');
+      expect(unpacked[2]).toEqual(red);
+      expect(unpacked[3].width).toBe(2);
+      expect(unpacked[4]).toEqual(createTestCell(' '));
+      expect(unpacked[199].char).toBe(' ');
+    });
+
+    it('keeps the trailing blanks of wrapped rows', () => {
+      const row = [createTestCell('a'), createTestCell(' '), createTestCell(' ')];
+      const record = packArchiveRow(row, new StyleInterner(), true);
+      const header = scanArchiveRecord(new DataView(record.buffer), 0, new StyleInterner());
+      expect(header).toEqual({ next: record.byteLength, cols: 3, used: 3, wrapped: true, wide: [] });
+    });
+
+    it('encodes packed rows exactly like cell rows', () => {
+      const row = [
+        { ...createTestCell('x'), italic: true, bg: { r: 0, g: 0, b: 90 } },
+        { ...createTestCell('字'), width: 2 as const },
+        { ...createTestCell(''), width: 0 as const },
+        createTestCell(' '),
+      ];
+      const fromCells = packArchiveRow(row, new StyleInterner());
+      const fromRow = packArchiveRecord(rowFromCells(row), new StyleInterner());
+      expect(fromRow).toEqual(fromCells);
+    });
+  });
+
   describe('packTerminalState/unpackTerminalState', () => {
     it('should pack and unpack terminal state', () => {
       const state: TerminalState = {
         cols: 80,
         rows: 3,
         cells: [
-          [createTestCell('H'), createTestCell('e'), createTestCell('l')],
-          [createTestCell('l'), createTestCell('o'), createTestCell(' ')],
-          [createTestCell('W'), createTestCell('o'), createTestCell('r')],
+          rowFromCells([createTestCell('H'), createTestCell('e'), createTestCell('l')]),
+          rowFromCells([createTestCell('l'), createTestCell('o'), createTestCell(' ')]),
+          rowFromCells([createTestCell('W'), createTestCell('o'), createTestCell('r')]),
         ],
         cursor: { x: 2, y: 1, visible: true, style: 'block' },
         alternateScreen: false,
@@ -255,9 +363,9 @@ describe('cell-serialization', () => {
       expect(unpacked.cols).toBe(80);
       expect(unpacked.rows).toBe(3);
       expect(unpacked.cells.length).toBe(3);
-      expect(unpacked.cells[0][0].char).toBe('H');
-      expect(unpacked.cells[1][1].char).toBe('o');
-      expect(unpacked.cells[2][2].char).toBe('r');
+      expect(extractRowText(unpacked.cells[0]).slice(0, 3)).toBe('Hel');
+      expect(rowCellAt(unpacked.cells[1], 1).char).toBe('o');
+      expect(rowCellAt(unpacked.cells[2], 2).char).toBe('r');
       expect(unpacked.kittyKeyboardFlags).toBe(5);
     });
   });
@@ -61,6 +61,16 @@ const { MockTerminal, terminalState } = vi.hoisted(() => {
       return true
     }
 
+    getDirtyRows(): { rows: number[]; cells: any[] } {
+      this.assertAlive()
+      return { rows: [], cells: [] }
+    }
+
+    getViewportCompact(): null {
+      this.assertAlive()
+      return null
+    }
+
     resize(cols: number, rows: number): void {
       this.assertAlive()
       this.cols = cols
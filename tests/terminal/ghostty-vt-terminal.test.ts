@@ -218,6 +218,59 @@ describe("GhosttyVtTerminal", () => {
     term.free();
   });
 
+  it("parses dirty rows and their cells", () => {
+    const cellData = Buffer.alloc(CELL_SIZE * 2);
+    writeCell(cellData, 0, {
+      codepoint: 0x58,
+      fg: [1, 1, 1],
+      bg: [2, 2, 2],
+      flags: 0,
+      width: 1,
+      hyperlinkId: 0,
+    });
+    writeCell(cellData, 1, {
+      codepoint: 0x59,
+      fg: [3, 3, 3],
+      bg: [4, 4, 4],
+      flags: 1,
+      width: 1,
+      hyperlinkId: 0,
+    });
+
+    const dirtyRowsMock = vi.fn((
+      _handle: number,
+      outRows: Buffer,
+      rowsSize: number,
+      outCells: Buffer,
+      cellsSize: number
+    ) => {
+      expect(rowsSize).toBe(3);
+      expect(cellsSize).toBe(6);
+      outRows.writeUInt32LE(2, 0);
+      cellData.copy(outCells);
+      return 1;
+    });
+
+    mockGhostty.symbols = {
+      ghostty_terminal_new: vi.fn(() => 1),
+      ghostty_terminal_free: vi.fn(),
+      ghostty_render_state_get_dirty_rows: dirtyRowsMock,
+    };
+
+    const term = new GhosttyVtTerminal(2, 3);
+
+    const dirty = term.getDirtyRows();
+    expect(dirty?.rows).toEqual([2]);
+    expect(dirty?.cells[0].codepoint).toBe(0x58);
+    expect(dirty?.cells[1].codepoint).toBe(0x59);
+    expect(dirty?.cells[1].flags).toBe(1);
+
+    dirtyRowsMock.mockImplementation(() => -1);
+    expect(term.getDirtyRows()).toBeNull();
+
+    term.free();
+  });
+
   it("parses scrollback lines into new arrays", () => {
     const lineData = Buffer.alloc(CELL_SIZE * 2);
     writeCell(lineData, 0, {
@@ -337,6 +390,59 @@ describe("GhosttyVtTerminal", () => {
     term.free();
   });
 
+  it("searches natively in batches and resumes from the cursor", () => {
+    const hits = [
+      { line: 0, start: 1, end: 4 },
+      { line: 2, start: 0, end: 3 },
+      { line: 5, start: 6, end: 9 },
+    ];
+    let next = 0;
+
+    mockGhostty.symbols = {
+      ghostty_terminal_new: vi.fn(() => 1),
+      ghostty_terminal_free: vi.fn(),
+      ghostty_terminal_search: vi.fn(
+        (_handle: number, query: Uint32Array, queryLen: number, flags: number, cursor: Buffer, out: Buffer, size: number) => {
+          expect(Array.from(query.subarray(0, queryLen))).toEqual([0x61, 0x62, 0x63]);
+          expect(flags).toBe(1);
+          const view = new DataView(out.buffer, out.byteOffset, out.byteLength);
+          let written = 0;
+          while (next < hits.length && written < size) {
+            const hit = hits[next++];
+            view.setUint32(written * 8, hit.line, true);
+            view.setUint16(written * 8 + 4, hit.start, true);
+            view.setUint16(written * 8 + 6, hit.end, true);
+            written++;
+          }
+          cursor[6] = next >= hits.length ? 1 : 0;
+          return written;
+        }
+      ),
+    };
+
+    const term = new GhosttyVtTerminal(10, 2);
+    const limited = term.search("abc", 2);
+    expect(limited?.matches).toEqual([
+      { lineIndex: 0, startCol: 1, endCol: 4 },
+      { lineIndex: 2, startCol: 0, endCol: 3 },
+    ]);
+    expect(limited?.hasMore).toBe(true);
+
+    next = 0;
+    const all = term.search("abc", 500);
+    expect(all?.matches).toHaveLength(3);
+    expect(all?.hasMore).toBe(false);
+
+    // Case folding beyond Latin-1 is left to the JS search
+    expect(term.search("\u03a9", 10)).toBeNull();
+    // ...as is any whose case pair lies outside Latin-1
+    expect(term.search("\u00ff", 10)).toBeNull();
+    expect(term.search("\u00b5", 10)).toBeNull();
+    expect(term.search("\u00df", 10)).toBeNull();
+
+    term.free();
+  });
+
   it("reads kitty placements", () => {
     const placement = {
       image_id: 3,
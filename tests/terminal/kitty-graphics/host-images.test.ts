@@ -0,0 +1,45 @@
+import { describe, expect, it } from "bun:test";
+import { HostImageCache } from '../../../src/terminal/kitty-graphics/renderer/host-images';
+import { createImageInfo } from './helpers';
+
+describe('HostImageCache', () => {
+  it('shares one host image between identical guest images', () => {
+    const cache = new HostImageCache();
+    const output: string[] = [];
+    const key = cache.keyFor(createImageInfo(1, 1n), new Uint8Array([255, 0, 0]));
+    expect(cache.keyFor(createImageInfo(7, 9n), new Uint8Array([255, 0, 0]))).toBe(key);
+    expect(cache.keyFor(createImageInfo(1, 1n), new Uint8Array([0, 255, 0]))).not.toBe(key);
+
+    expect(cache.acquire(key)).toBeNull();
+    cache.insert(key, 5, 3, output);
+    expect(cache.acquire(key)).toBe(5);
+
+    cache.release({ hostId: 5, info: createImageInfo(1, 1n), key }, output);
+    cache.release({ hostId: 5, info: createImageInfo(7, 9n), key }, output);
+    // Unreferenced but within budget: kept for reuse
+    expect(output).toEqual([]);
+    expect(cache.acquire(key)).toBe(5);
+  });
+
+  it('evicts unreferenced images least recently released first', () => {
+    const cache = new HostImageCache(8);
+    const output: string[] = [];
+    const info = createImageInfo(1, 1n);
+    for (const [key, hostId] of [['a', 1], ['b', 2], ['c', 3]] as const) {
+      cache.insert(key, hostId, 4, output);
+    }
+    // Referenced images are never evicted, even over budget
+    expect(output).toEqual([]);
+
+    cache.release({ hostId: 2, info, key: 'b' }, output);
+    cache.release({ hostId: 1, info, key: 'a' }, output);
+    expect(output.join('')).toContain('d=I,i=2;');
+    expect(output.join('')).not.toContain('i=1;');
+    expect(cache.bytes).toBe(8);
+    expect(cache.acquire('b')).toBeNull();
+
+    output.length = 0;
+    cache.release({ hostId: 9, info }, output);
+    expect(output.join('')).toContain('d=I,i=9;');
+  });
+});
@@ -268,4 +268,161 @@ describe('KittyGraphicsRenderer (basic)', () => {
 
     expect(output.join('')).toContain('d=i');
   });
+
+  it('transmits identical images shown by several PTYs once', () => {
+    const renderer = new KittyGraphicsRenderer();
+    const output: string[] = [];
+    const renderTarget = defaultRenderTarget(output);
+
+    const createEmulator = (imageId: number) => {
+      let dirty = true;
+      return {
+        getKittyImagesDirty: () => dirty,
+        clearKittyImagesDirty: () => {
+          dirty = false;
+        },
+        getKittyImageIds: () => [imageId],
+        getKittyImageInfo: () => createImageInfo(imageId, BigInt(imageId)),
+        getKittyImageData: () => new Uint8Array([10, 20, 30]),
+        getKittyPlacements: () => [createPlacement(imageId)],
+        isAlternateScreen: () => false,
+      } as ITerminalEmulator;
+    };
+
+    ['a', 'b', 'c'].forEach((name, i) => {
+      renderer.updatePane(`pane-${name}`, {
+        ptyId: `pty-${name}`,
+        emulator: createEmulator(i + 1),
+        offsetX: i * 3,
+        offsetY: 0,
+        width: 3,
+        height: 10,
+        cols: 3,
+        rows: 10,
+        viewportOffset: 0,
+        scrollbackLength: 0,
+        isAlternateScreen: false,
+      });
+    });
+
+    renderer.flush(renderTarget);
+
+    const joined = output.join('');
+    expect(joined.match(/a=t/g)).toHaveLength(1);
+    expect(joined.match(/a=p/g)).toHaveLength(3);
+  });
+
+  it('moves placements in place when a pane scrolls', () => {
+    const renderer = new KittyGraphicsRenderer();
+    const output: string[] = [];
+    const renderTarget = defaultRenderTarget(output);
+
+    let dirty = true;
+    const imageInfo = createImageInfo(8, 8n);
+    const placements = [
+      { ...createPlacement(8, 1), screenY: 10 },
+      { ...createPlacement(8, 2), screenY: 14 },
+    ];
+    const emulator = {
+      getKittyImagesDirty: () => dirty,
+      clearKittyImagesDirty: () => {
+        dirty = false;
+      },
+      getKittyImageIds: () => [8],
+      getKittyImageInfo: () => imageInfo,
+      getKittyImageData: () => new Uint8Array([1, 2, 3]),
+      getKittyPlacements: () => placements,
+      isAlternateScreen: () => false,
+    } as ITerminalEmulator;
+
+    const showPane = (viewportOffset: number) => {
+      renderer.updatePane('pane-8', {
+        ptyId: 'pty-8',
+        emulator,
+        offsetX: 0,
+        offsetY: 0,
+        width: 10,
+        height: 10,
+        cols: 10,
+        rows: 10,
+        viewportOffset,
+        scrollbackLength: 10,
+        isAlternateScreen: false,
+      });
+      renderer.flush(renderTarget);
+      const joined = output.join('');
+      output.length = 0;
+      return joined;
+    };
+
+    const initial = showPane(0);
+    expect(initial.startsWith('\x1b[?2026h')).toBe(true);
+    expect(initial.endsWith('\x1b[?2026l')).toBe(true);
+    expect(initial.match(/a=p/g)).toHaveLength(2);
+
+    // Same frame again: nothing changed, nothing written
+    expect(showPane(0)).toBe('');
+
+    // Scrolling back moves both placements under their existing ids
+    const scrolled = showPane(1);
+    expect(scrolled).not.toContain('a=d');
+    expect(scrolled.match(/a=p/g)).toHaveLength(2);
+    expect(scrolled.match(/,p=\d+/g)).toEqual(initial.match(/,p=\d+/g));
+
+    // Scrolling further pushes the lower placement out of view
+    const partial = showPane(6);
+    expect(partial.match(/d=i/g)).toHaveLength(1);
+    expect(partial.match(/a=p/g)).toHaveLength(1);
+  });
+
+  it('deletes the old placement when an image is redrawn under the same id', () => {
+    const renderer = new KittyGraphicsRenderer();
+    const output: string[] = [];
+    const renderTarget = defaultRenderTarget(output);
+
+    let dirty = true;
+    let imageInfo = createImageInfo(9, 1n);
+    let imageData = new Uint8Array([9, 9, 9]);
+    const placement = createPlacement(9);
+    const emulator = {
+      getKittyImagesDirty: () => dirty,
+      clearKittyImagesDirty: () => {
+        dirty = false;
+      },
+      getKittyImageIds: () => [9],
+      getKittyImageInfo: () => imageInfo,
+      getKittyImageData: () => imageData,
+      getKittyPlacements: () => [placement],
+      isAlternateScreen: () => false,
+    } as ITerminalEmulator;
+
+    renderer.updatePane('pane-9', {
+      ptyId: 'pty-9',
+      emulator,
+      offsetX: 0,
+      offsetY: 0,
+      width: 10,
+      height: 10,
+      cols: 10,
+      rows: 10,
+      viewportOffset: 0,
+      scrollbackLength: 0,
+      isAlternateScreen: false,
+    });
+
+    renderer.flush(renderTarget);
+    const oldHostId = output.join('').match(/a=p,q=2,C=1,i=(\d+),p=(\d+)/);
+    expect(oldHostId).not.toBeNull();
+    output.length = 0;
+
+    dirty = true;
+    imageInfo = createImageInfo(9, 2n);
+    imageData = new Uint8Array([1, 2, 3]);
+    renderer.flush(renderTarget);
+
+    const joined = output.join('');
+    expect(joined).toContain(`d=i,i=${oldHostId![1]},p=${oldHostId![2]};`);
+    expect(joined).toContain('a=t');
+    expect(joined).not.toContain(`a=p,q=2,C=1,i=${oldHostId![1]},`);
+  });
 });
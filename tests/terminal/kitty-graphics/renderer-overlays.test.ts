@@ -156,4 +156,61 @@ describe('KittyGraphicsRenderer (overlays)', () => {
     expect(joined).toContain('a=d');
     expect(joined).toContain('\x1b_Ga=p');
   });
+
+  it('diffs placements when clip rects change instead of clearing them', () => {
+    const renderer = new KittyGraphicsRenderer();
+    const output: string[] = [];
+    const renderTarget = defaultRenderTarget(output);
+
+    let dirty = true;
+    const imageInfo = createImageInfo(6, 6n);
+    const placements = [
+      createPlacement(6, 1),
+      { ...createPlacement(6, 2), screenX: 5 },
+    ];
+    const emulator = {
+      getKittyImagesDirty: () => dirty,
+      clearKittyImagesDirty: () => {
+        dirty = false;
+      },
+      getKittyImageIds: () => [6],
+      getKittyImageInfo: () => imageInfo,
+      getKittyImageData: () => new Uint8Array([6, 6, 6]),
+      getKittyPlacements: () => placements,
+      isAlternateScreen: () => false,
+    } as ITerminalEmulator;
+
+    renderer.updatePane('pane-6', {
+      ptyId: 'pty-6',
+      emulator,
+      offsetX: 0,
+      offsetY: 0,
+      width: 10,
+      height: 10,
+      cols: 10,
+      rows: 10,
+      viewportOffset: 0,
+      scrollbackLength: 0,
+      isAlternateScreen: false,
+    });
+
+    renderer.flush(renderTarget);
+    expect(output.join('').match(/a=p/g)).toHaveLength(2);
+
+    // Covering only the first placement deletes it and leaves the other alone
+    output.length = 0;
+    renderer.setClipRects([{ x: 0, y: 0, width: 2, height: 2 }]);
+    renderer.flush(renderTarget);
+    const clipped = output.join('');
+    expect(clipped.match(/d=i/g)).toHaveLength(1);
+    expect(clipped).toContain(',p=1;');
+    expect(clipped).not.toContain('\x1b_Ga=p');
+
+    output.length = 0;
+    renderer.setClipRects([]);
+    renderer.flush(renderTarget);
+    const restored = output.join('');
+    expect(restored).not.toContain('a=d');
+    expect(restored.match(/\x1b_Ga=p/g)).toHaveLength(1);
+  });
 });
@@ -0,0 +1,120 @@
+import fs from 'fs';
+import { Buffer } from 'buffer';
+import { describe, expect, it } from "bun:test";
+import {
+  abortOffload,
+  appendOffload,
+  finishOffload,
+  startOffload,
+} from '../../src/terminal/kitty-graphics/offload-writer';
+import {
+  buildTransmitImage,
+  prepareTransmit,
+  writeSynchronizedUpdate,
+} from '../../src/terminal/kitty-graphics/commands';
+import { FileTransmitQueue } from '../../src/terminal/kitty-graphics/renderer/file-transmits';
+import {
+  KittyGraphicsCompression,
+  KittyGraphicsFormat,
+  type KittyGraphicsImageInfo,
+} from '../../src/terminal/emulator-interface';
+
+
+function bytes(length: number): Uint8Array {
+  return Uint8Array.from({ length }, (_, i) => (i * 31 + 7) & 0xff);
+}
+
+function imageInfo(width: number, height: number): KittyGraphicsImageInfo {
+  return {
+    id: 1,
+    number: 0,
+    width,
+    height,
+    dataLength: width * height * 3,
+    format: KittyGraphicsFormat.RGB,
+    compression: KittyGraphicsCompression.NONE,
+    implicitId: false,
+    transmitTime: 1n,
+  };
+}
+
+describe('kitty offload writer', () => {
+  it('decodes base64 split at arbitrary chunk boundaries', () => {
+    const data = bytes(200_003);
+    const encoded = Buffer.from(data).toString('base64');
+    const offload = startOffload(0);
+    try {
+      // Chunks shorter than a base64 quantum, and one spanning several decode windows
+      for (const [start, end] of [[0, 1], [1, 3], [3, 10], [10, 150_001], [150_001, encoded.length]]) {
+        appendOffload(offload, encoded.slice(start, end));
+      }
+      const filePath = finishOffload(offload);
+      expect(offload.bytesWritten).toBe(data.byteLength);
+      expect(new Uint8Array(fs.readFileSync(filePath))).toEqual(data);
+    } finally {
+      abortOffload(offload);
+    }
+  });
+
+  it('transmits renderer images chunk by chunk', () => {
+    const data = bytes(3 * 3000);
+    const chunked = buildTransmitImage(4, imageInfo(100, 30), data);
+    expect(chunked).toHaveLength(3);
+    const payloads = chunked.map((command) => command.slice(command.indexOf(';') + 1, -2));
+    expect(payloads.every((payload) => payload.length <= 4096)).toBe(true);
+    expect(chunked.filter((command) => command.includes('m=1'))).toHaveLength(2);
+    expect(new Uint8Array(Buffer.concat(payloads.map((p) => Buffer.from(p, 'base64'))))).toEqual(data);
+  });
+
+  it('transmits large renderer images through a temp file written off the render path', async () => {
+    const data = bytes(3 * 3000);
+    const transmit = prepareTransmit(4, imageInfo(100, 30), data)!;
+    let ready = 0;
+    const queue = new FileTransmitQueue(() => ready++, { thresholdBytes: 1024, cleanupDelayMs: 0 });
+
+    expect(queue.offer(5, { ...transmit, payload: transmit.payload.subarray(0, 512) })).toBe(false);
+    expect(queue.offer(4, transmit)).toBe(true);
+    expect(queue.isPending(4)).toBe(true);
+    const output: string[] = [];
+    queue.drain(output, () => true);
+    expect(output).toEqual([]);
+
+    while (ready === 0) await new Promise((resolve) => setTimeout(resolve, 1));
+    expect(queue.isPending(4)).toBe(false);
+    queue.drain(output, () => true);
+    expect(output).toHaveLength(1);
+    expect(output[0]).toContain('t=t');
+    const filePath = Buffer.from(output[0].slice(output[0].indexOf(';') + 1, -2), 'base64').toString('utf8');
+    expect(filePath).toContain('tty-graphics-protocol');
+    expect(new Uint8Array(fs.readFileSync(filePath))).toEqual(data);
+    fs.unlinkSync(filePath);
+    queue.dispose();
+  });
+
+  it('drops file transmits for images deleted while written and cleans files up', async () => {
+    let ready = 0;
+    const queue = new FileTransmitQueue(() => ready++, { thresholdBytes: 1024, cleanupDelayMs: 1 });
+    queue.offer(4, prepareTransmit(4, imageInfo(100, 30), bytes(3 * 3000))!);
+    queue.offer(6, prepareTransmit(6, imageInfo(100, 30), bytes(3 * 3000))!);
+    while (ready < 2) await new Promise((resolve) => setTimeout(resolve, 1));
+
+    const output: string[] = [];
+    queue.drain(output, (hostId) => hostId === 4);
+    expect(output).toHaveLength(1);
+    expect(output[0]).toContain('i=4');
+    const filePath = Buffer.from(output[0].slice(output[0].indexOf(';') + 1, -2), 'base64').toString('utf8');
+    await new Promise((resolve) => setTimeout(resolve, 20));
+    expect(fs.existsSync(filePath)).toBe(false);
+    queue.dispose();
+  });
+
+  it('writes a frame carrying a large transmit in pieces', () => {
+    const commands = buildTransmitImage(4, imageInfo(200, 200), bytes(200 * 200 * 3));
+    const writes: string[] = [];
+    writeSynchronizedUpdate((chunk) => writes.push(chunk), commands);
+
+    expect(writes.length).toBeGreaterThan(1);
+    expect(writes.every((chunk) => chunk.length <= 64 * 1024 + 8)).toBe(true);
+    expect(writes.join('')).toBe(`\x1b[?2026h${commands.join('')}\x1b[?2026l`);
+  });
+});
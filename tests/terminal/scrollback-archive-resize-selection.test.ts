@@ -10,9 +10,13 @@ import { ArchivedTerminalEmulator } from "../../src/terminal/archived-emulator"
 import { ScrollbackArchive } from "../../src/terminal/scrollback-archive"
 import { extractSelectedText } from "../../src/core/coordinates/selection-coords"
 import { getDefaultColors } from "../../src/terminal/terminal-colors"
+import { extractRowText, rowFromCells, rowToCells } from "../../src/terminal/terminal-row"
+import { runSearchJob } from "../../src/terminal/search-job"
+import { searchLines } from "../../src/terminal/ghostty-vt/terminal-search"
 import type {
   DirtyTerminalUpdate,
   TerminalCell,
+  TerminalRow,
   TerminalScrollState,
   TerminalState,
 } from "../../src/core/types"
@@ -20,7 +24,7 @@ import type { ITerminalEmulator } from "../../src/terminal/emulator-interface"
 
 type EmulatorHarness = {
   emulator: ArchivedTerminalEmulator
-  setLiveCells: (cells: TerminalCell[][]) => void
+  setLiveCells: (rows: TerminalRow[]) => void
   dispose: () => void
 }
 
@@ -60,7 +64,7 @@ async function createHarness(options: {
 
   await archive.appendLines(options.archivedLines.map(rowFromString))
 
-  let liveCells = options.liveLines.map(rowFromString)
+  let liveCells = options.liveLines.map((line) => rowFromCells(rowFromString(line)))
   let cols = options.cols
   let rows = options.rows
 
@@ -145,8 +149,10 @@ async function createHarness(options: {
     onModeChange() {
       return () => {}
     },
-    async search() {
-      return { matches: [], hasMore: false }
+    async search(query, options) {
+      return runSearchJob(options, rows, (start, end, limit) =>
+        searchLines(query, limit, start, end, (y) => (liveCells[y] ? extractRowText(liveCells[y]) : null))
+      )
     },
   }
 
@@ -165,7 +171,7 @@ async function createHarness(options: {
 }
 
 describe("scrollback archive resize + selection", () => {
-  it("keeps archived row width stable across resize", async () => {
+  it("reflows archived rows to the new width on resize", async () => {
     const harness = await createHarness({
       archivedLines: ["ABCD"],
       liveLines: ["LIVE"],
@@ -178,8 +184,13 @@ describe("scrollback archive resize + selection", () => {
       expect(line?.length).toBe(4)
 
       harness.emulator.resize(2, 1)
-      const resizedLine = harness.emulator.getScrollbackLine(0)
-      expect(resizedLine?.length).toBe(4)
+      expect(harness.emulator.getScrollbackLength()).toBe(2)
+      const rows = [0, 1].map((y) => harness.emulator.getScrollbackLine(y)?.map((cell) => cell.char).join(""))
+      expect(rows).toEqual(["AB", "CD"])
+
+      harness.emulator.resize(6, 1)
+      const widened = harness.emulator.getScrollbackLine(0)
+      expect(widened?.map((cell) => cell.char).join("")).toBe("ABCD  ")
     } finally {
       harness.dispose()
     }
@@ -194,13 +205,14 @@ describe("scrollback archive resize + selection", () => {
     })
 
     try {
-      const scrollbackLength = harness.emulator.getScrollbackLength()
+      let scrollbackLength = harness.emulator.getScrollbackLength()
       const getLine = (absoluteY: number) => {
         if (absoluteY < scrollbackLength) {
           return harness.emulator.getScrollbackLine(absoluteY)
         }
         const liveY = absoluteY - scrollbackLength
-        return harness.emulator.getTerminalState().cells[liveY] ?? null
+        const row = harness.emulator.getTerminalState().cells[liveY]
+        return row ? rowToCells(row) : null
       }
 
       const range = {
@@ -215,8 +227,37 @@ describe("scrollback archive resize + selection", () => {
       expect(before).toBe("ABCD\nEFGH\nIJKL")
 
       harness.emulator.resize(2, 1)
-      const after = extractSelectedText(range, scrollbackLength, getLine)
-      expect(after).toBe("ABCD\nEFGH\nIJKL")
+      scrollbackLength = harness.emulator.getScrollbackLength()
+      const after = extractSelectedText({ ...range, endY: 4 }, scrollbackLength, getLine)
+      expect(after).toBe("AB\nCD\nEF\nGH\nIJKL")
+    } finally {
+      harness.dispose()
+    }
+  })
+
+  it("searches archived and live rows with absolute line indexes", async () => {
+    const harness = await createHarness({
+      archivedLines: ["find", "nope", "FIND"],
+      liveLines: ["xfind"],
+      cols: 5,
+      rows: 1,
+    })
+
+    try {
+      const batches: number[][] = []
+      const result = await harness.emulator.search("find", {
+        anchor: 3,
+        onMatches: (batch) => batches.push(batch.map((m) => m.lineIndex)),
+      })
+      expect(result.matches.map((m) => [m.lineIndex, m.startCol])).toEqual([[0, 0], [2, 0], [3, 1]])
+      expect(batches.flat().sort()).toEqual([0, 2, 3])
+
+      const live = await harness.emulator.search("find", { startLine: 3 })
+      expect(live.matches.map((m) => m.lineIndex)).toEqual([3])
+
+      const limited = await harness.emulator.search("find", { limit: 1 })
+      expect(limited.matches.map((m) => m.lineIndex)).toEqual([0])
+      expect(limited.hasMore).toBe(true)
     } finally {
       harness.dispose()
     }
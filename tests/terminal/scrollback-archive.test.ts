@@ -0,0 +1,413 @@
+/**
+ * Tests for scrollback archive chunk lookup and range reads.
+ */
+
+import fs from "node:fs"
+import os from "node:os"
+import path from "node:path"
+import { describe, it, expect, afterEach } from "bun:test"
+import { ScrollbackArchive, ScrollbackArchiveManager } from "../../src/terminal/scrollback-archive"
+import { packRow } from "../../src/terminal/cell-serialization"
+import type { TerminalCell } from "../../src/core/types"
+
+function rowFromString(value: string): TerminalCell[] {
+  return Array.from(value, (char) => ({
+    char,
+    fg: { r: 255, g: 255, b: 255 },
+    bg: { r: 0, g: 0, b: 0 },
+    bold: false,
+    italic: false,
+    underline: false,
+    strikethrough: false,
+    inverse: false,
+    blink: false,
+    dim: false,
+    width: 1 as const,
+  }))
+}
+
+/** Like rowFromString, but CJK characters take two cells (a wide cell and its spacer). */
+function wideRowFromString(value: string): TerminalCell[] {
+  return rowFromString(value).flatMap((cell) =>
+    /[\u3000-\u9fff]/.test(cell.char)
+      ? [{ ...cell, width: 2 as const }, { ...cell, char: "", width: 0 as const }]
+      : [cell]
+  )
+}
+
+function lineText(cells: TerminalCell[] | null): string | null {
+  return cells ? cells.map((cell) => cell.char).join("") : null
+}
+
+const tmpDirs: string[] = []
+
+function createArchive(options: {
+  chunkMaxLines: number
+  cacheSize?: number
+  maxBytes?: number
+  checkpointBytes?: number
+  manager?: ScrollbackArchiveManager
+  quotaWeight?: number
+}) {
+  const rootDir = fs.mkdtempSync(path.join(os.tmpdir(), "openmux-archive-test-"))
+  tmpDirs.push(rootDir)
+  return new ScrollbackArchive({ rootDir, maxBytes: 1024 * 1024, ...options })
+}
+
+afterEach(() => {
+  for (const dir of tmpDirs.splice(0)) {
+    fs.rmSync(dir, { recursive: true, force: true })
+  }
+})
+
+describe("ScrollbackArchive", () => {
+  it("finds lines across chunks of different widths", async () => {
+    const archive = createArchive({ chunkMaxLines: 3, cacheSize: 1 })
+    await archive.appendLines(["aa", "bb", "cc", "dd"].map(rowFromString))
+    await archive.appendLines(["eee", "fff"].map(rowFromString))
+    await archive.appendLines(["ggg", "hhh", "iii"].map(rowFromString))
+
+    expect(archive.length).toBe(9)
+    const lines = Array.from({ length: 9 }, (_, i) => lineText(archive.getLine(i)))
+    expect(lines).toEqual(["aa", "bb", "cc", "dd", "eee", "fff", "ggg", "hhh", "iii"])
+    expect(archive.getLine(9)).toBeNull()
+    expect(archive.getLine(-1)).toBeNull()
+    archive.dispose()
+  })
+
+  it("prefetches a range across chunk boundaries", async () => {
+    const archive = createArchive({ chunkMaxLines: 4, cacheSize: 100 })
+    const values = Array.from({ length: 10 }, (_, i) => `l${i}`)
+    await archive.appendLines(values.map(rowFromString))
+
+    archive.getLine(5)
+    await archive.prefetchLines(2, 7)
+    const lines = Array.from({ length: 7 }, (_, i) => lineText(archive.getLine(2 + i)))
+    expect(lines).toEqual(values.slice(2, 9))
+    archive.dispose()
+  })
+
+  it("serves prefetched and read-ahead rows without synchronous reads", async () => {
+    const archive = createArchive({ chunkMaxLines: 8, cacheSize: 1000 })
+    const values = Array.from({ length: 40 }, (_, i) => `r${i}`)
+    await archive.appendLines(values.map(rowFromString))
+
+    await archive.prefetchLines(30, 5)
+    await archive.prefetchLines(25, 5)
+    await new Promise((resolve) => setTimeout(resolve, 50))
+
+    const readSync = fs.readSync
+    fs.readSync = (() => {
+      throw new Error("synchronous read")
+    }) as typeof fs.readSync
+    try {
+      // The scroll moved up, so rows above the viewport were read ahead
+      const lines = Array.from({ length: 35 }, (_, i) => lineText(archive.getLine(i)))
+      expect(lines).toEqual(values.slice(0, 35))
+    } finally {
+      fs.readSync = readSync
+    }
+    archive.dispose()
+  })
+
+  it("keeps offsets consistent after dropping the oldest chunk", async () => {
+    const archive = createArchive({ chunkMaxLines: 2, cacheSize: 1 })
+    await archive.appendLines(["a0", "a1", "b0", "b1", "c0"].map(rowFromString))
+
+    expect(lineText(archive.getLine(4))).toBe("c0")
+    expect(archive.dropOldestChunk()?.linesRemoved).toBe(2)
+    expect(archive.length).toBe(3)
+    expect([0, 1, 2].map((i) => lineText(archive.getLine(i)))).toEqual(["b0", "b1", "c0"])
+
+    await archive.appendLines([rowFromString("c1")])
+    expect(lineText(archive.getLine(3))).toBe("c1")
+    archive.dispose()
+  })
+
+  it("counts dropped rows and renumbers on reflow", async () => {
+    const archive = createArchive({ chunkMaxLines: 2 })
+    await archive.appendLines(["a0", "a1", "b0"].map(rowFromString))
+    expect(archive.numbering).toEqual({ epoch: 0, dropped: 0 })
+
+    archive.dropOldestChunk()
+    expect(archive.numbering).toEqual({ epoch: 0, dropped: 2 })
+
+    archive.setWidth(1)
+    expect(archive.numbering).toEqual({ epoch: 1, dropped: 2 })
+    archive.setWidth(1)
+    expect(archive.numbering.epoch).toBe(1)
+    archive.dispose()
+  })
+
+  it("reloads chunk offsets from metadata", async () => {
+    const archive = createArchive({ chunkMaxLines: 2 })
+    await archive.appendLines(["x0", "x1", "y0"].map(rowFromString))
+    const rootDir = tmpDirs[tmpDirs.length - 1]
+
+    const reopened = new ScrollbackArchive({ rootDir, maxBytes: 1024 * 1024, chunkMaxLines: 2 })
+    expect([0, 1, 2].map((i) => lineText(reopened.getLine(i)))).toEqual(["x0", "x1", "y0"])
+    reopened.clearCache()
+  })
+
+  it("replays appends and drops from the journal without rewriting meta.json", async () => {
+    const archive = createArchive({ chunkMaxLines: 2 })
+    await archive.appendLines(["a0", "a1"].map(rowFromString))
+    await archive.appendLines(["b0"].map(rowFromString))
+    await archive.appendLines(["b1", "c0"].map(rowFromString))
+    archive.dropOldestChunk()
+    await archive.appendLines(["c1"].map(rowFromString))
+    const rootDir = tmpDirs[tmpDirs.length - 1]
+
+    expect(fs.existsSync(path.join(rootDir, "meta.json"))).toBe(false)
+    const reopened = new ScrollbackArchive({ rootDir, maxBytes: 1024 * 1024, chunkMaxLines: 2 })
+    expect(reopened.length).toBe(4)
+    expect([0, 1, 2, 3].map((i) => lineText(reopened.getLine(i)))).toEqual(["b0", "b1", "c0", "c1"])
+    reopened.clearCache()
+  })
+
+  it("recovers to the last journaled append after a torn write", async () => {
+    const archive = createArchive({ chunkMaxLines: 10 })
+    await archive.appendLines(["a0", "a1"].map(rowFromString))
+    const rootDir = tmpDirs[tmpDirs.length - 1]
+    const journalPath = path.join(rootDir, "meta.journal")
+    const journaled = fs.statSync(journalPath).size
+
+    // A batch killed mid-way: chunk bytes, a new chunk file, half an entry
+    fs.appendFileSync(path.join(rootDir, "chunk-1.bin"), Buffer.from([9, 0, 0, 0, 1]))
+    fs.writeFileSync(path.join(rootDir, "chunk-2.bin"), Buffer.from([1, 2, 3]))
+    fs.appendFileSync(journalPath, Buffer.from([20, 0, 0, 0, 2, 1]))
+
+    const reopened = new ScrollbackArchive({ rootDir, maxBytes: 1024 * 1024, chunkMaxLines: 10 })
+    expect(reopened.length).toBe(2)
+    expect(fs.statSync(journalPath).size).toBe(journaled)
+    expect(fs.existsSync(path.join(rootDir, "chunk-2.bin"))).toBe(false)
+
+    await reopened.appendLines([rowFromString("a2")])
+    const again = new ScrollbackArchive({ rootDir, maxBytes: 1024 * 1024, chunkMaxLines: 10 })
+    expect([0, 1, 2].map((i) => lineText(again.getLine(i)))).toEqual(["a0", "a1", "a2"])
+    reopened.clearCache()
+    again.clearCache()
+  })
+
+  it("checkpoints a full journal and ignores a journal from before the checkpoint", async () => {
+    const archive = createArchive({ chunkMaxLines: 2, checkpointBytes: 1 })
+    await archive.appendLines(["a0", "a1"].map(rowFromString))
+    const rootDir = tmpDirs[tmpDirs.length - 1]
+    const journalPath = path.join(rootDir, "meta.journal")
+    const beforeCheckpoint = fs.readFileSync(journalPath)
+
+    await archive.appendLines(["b0"].map(rowFromString))
+    const meta = JSON.parse(fs.readFileSync(path.join(rootDir, "meta.json"), "utf8"))
+    expect(meta.checkpoint).toBe(1)
+    expect(fs.statSync(journalPath).size).toBe(8)
+
+    // Killed between writing meta.json and starting the new journal
+    fs.writeFileSync(journalPath, beforeCheckpoint)
+    const reopened = new ScrollbackArchive({ rootDir, maxBytes: 1024 * 1024, chunkMaxLines: 2 })
+    expect([0, 1, 2].map((i) => lineText(reopened.getLine(i)))).toEqual(["a0", "a1", "b0"])
+    expect(reopened.length).toBe(3)
+    reopened.clearCache()
+  })
+
+  it("stores blank-heavy rows compactly", async () => {
+    const archive = createArchive({ chunkMaxLines: 100 })
+    const rows = Array.from({ length: 50 }, (_, i) => `line ${i}`.padEnd(200, " "))
+    await archive.appendLines(rows.map(rowFromString))
+
+    expect(archive.bytes).toBeLessThan(rows.length * (4 + 200 * 16) / 20)
+    expect(lineText(archive.getLine(42))).toBe(rows[42])
+    archive.dispose()
+  })
+
+  it("drops unindexed bytes before appending to a reopened chunk", async () => {
+    const archive = createArchive({ chunkMaxLines: 10 })
+    await archive.appendLines(["a0", "a1"].map(rowFromString))
+    const rootDir = tmpDirs[tmpDirs.length - 1]
+    // An append that reached the chunk file but not the journal
+    fs.appendFileSync(path.join(rootDir, "chunk-1.bin"), Buffer.from([9, 0, 0, 0, 1]))
+
+    const reopened = new ScrollbackArchive({ rootDir, maxBytes: 1024 * 1024, chunkMaxLines: 10 })
+    await reopened.appendLines([rowFromString("a2")])
+    reopened.clearCache()
+    expect([0, 1, 2].map((i) => lineText(reopened.getLine(i)))).toEqual(["a0", "a1", "a2"])
+    reopened.clearCache()
+  })
+
+  it("reads raw chunks from version 1 archives", async () => {
+    const rootDir = fs.mkdtempSync(path.join(os.tmpdir(), "openmux-archive-test-"))
+    tmpDirs.push(rootDir)
+    const rows = ["r0", "r1"].map((value) => Buffer.from(packRow(rowFromString(value))))
+    fs.writeFileSync(path.join(rootDir, "chunk-1.bin"), Buffer.concat(rows))
+    fs.writeFileSync(
+      path.join(rootDir, "meta.json"),
+      JSON.stringify({
+        version: 1,
+        nextChunkId: 2,
+        chunks: [{ id: 1, filename: "chunk-1.bin", cols: 2, rowBytes: rows[0].byteLength, lineCount: 2, bytes: rows[0].byteLength * 2, createdAt: 1 }],
+      })
+    )
+
+    const archive = new ScrollbackArchive({ rootDir, maxBytes: 1024 * 1024, chunkMaxLines: 10 })
+    await archive.appendLines([rowFromString("c0")])
+    expect([0, 1, 2].map((i) => lineText(archive.getLine(i)))).toEqual(["r0", "r1", "c0"])
+    archive.clearCache()
+  })
+
+  it("joins soft-wrapped rows and reflows them to the archive width", async () => {
+    const archive = createArchive({ chunkMaxLines: 10 })
+    await archive.appendLines(["abcd", "ef  ", "gh  "].map(rowFromString), [true, false, false])
+    const rows = () => Array.from({ length: archive.length }, (_, i) => lineText(archive.getLine(i)))
+
+    archive.setWidth(4)
+    expect(rows()).toEqual(["abcd", "ef  ", "gh  "])
+    archive.setWidth(2)
+    expect(rows()).toEqual(["ab", "cd", "ef", "gh"])
+    expect([0, 1, 2, 3].map((i) => archive.isWrapped(i))).toEqual([true, true, false, false])
+    archive.setWidth(8)
+    expect(rows()).toEqual(["abcdef  ", "gh      "])
+    archive.dispose()
+  })
+
+  it("continues an open logical line in the next append", async () => {
+    const archive = createArchive({ chunkMaxLines: 1 })
+    archive.setWidth(3)
+    await archive.appendLines([rowFromString("abcd")], [true])
+    // The open line's last row wraps into rows not archived yet
+    expect([0, 1].map((i) => archive.isWrapped(i))).toEqual([true, true])
+    await archive.appendLines(["ef", "gh"].map(rowFromString), [false, false])
+
+    expect(archive.length).toBe(3)
+    expect([0, 1, 2].map((i) => lineText(archive.getLine(i)))).toEqual(["abc", "def", "gh "])
+    // Trigrams span the wrap
+    expect(archive.candidateRanges("cde", 0, 3)).toEqual([[0, 2]])
+
+    // Row counts come from metadata; lines are re-split only when read
+    const rootDir = tmpDirs[tmpDirs.length - 1]
+    const reopened = new ScrollbackArchive({ rootDir, maxBytes: 1024 * 1024, chunkMaxLines: 1 })
+    reopened.setWidth(2)
+    expect(reopened.length).toBe(4)
+    expect([0, 1, 2, 3].map((i) => lineText(reopened.getLine(i)))).toEqual(["ab", "cd", "ef", "gh"])
+    reopened.clearCache()
+  })
+
+  it("moves a wide cell that would straddle a row boundary to the next row", async () => {
+    const archive = createArchive({ chunkMaxLines: 10 })
+    await archive.appendLines([wideRowFromString("ab日cd")])
+    const rows = (target: ScrollbackArchive) =>
+      Array.from({ length: target.length }, (_, i) => lineText(target.getLine(i)))
+
+    archive.setWidth(3)
+    expect(rows(archive)).toEqual(["ab ", "日 c", "d  "])
+    expect(archive.getLine(1)?.[0].width).toBe(2)
+    archive.setWidth(4)
+    expect(rows(archive)).toEqual(["ab日 ", "cd  "])
+    archive.clearCache()
+
+    // Reopened chunks with wide cells count their rows from the records
+    const rootDir = tmpDirs[tmpDirs.length - 1]
+    const reopened = new ScrollbackArchive({ rootDir, maxBytes: 1024 * 1024, chunkMaxLines: 10 })
+    reopened.setWidth(3)
+    expect(reopened.length).toBe(3)
+    expect(rows(reopened)).toEqual(["ab ", "日 c", "d  "])
+    reopened.clearCache()
+  })
+
+  it("drops cached rows of an open line when it is continued", async () => {
+    const archive = createArchive({ chunkMaxLines: 10 })
+    archive.setWidth(3)
+    await archive.appendLines(["xyz", "abcd"].map(rowFromString), [false, true])
+    await archive.loadLines(0, archive.length)
+    expect(lineText(archive.getLine(2))).toBe("d  ")
+
+    await archive.appendLines([rowFromString("ef")], [false])
+    expect([0, 1, 2].map((i) => lineText(archive.getLine(i)))).toEqual(["xyz", "abc", "def"])
+    archive.dispose()
+  })
+
+  it("skips chunks whose trigram filter rules out the query", async () => {
+    const archive = createArchive({ chunkMaxLines: 2 })
+    await archive.appendLines(["alpha", "bravo", "ERROR", "delta", "hello", "error", "golfs", "hotel"].map(rowFromString))
+
+    expect(archive.candidateRanges("error", 0, 8)).toEqual([[2, 6]])
+    expect(archive.candidateRanges("error", 0, 3)).toEqual([[2, 3]])
+    // Too short for a trigram: nothing is skipped
+    expect(archive.candidateRanges("er", 1, 6)).toEqual([[1, 6]])
+    archive.dispose()
+  })
+
+  it("reloads trigram filters and ignores stale sidecars", async () => {
+    const archive = createArchive({ chunkMaxLines: 2 })
+    await archive.appendLines(["alpha", "bravo", "error", "delta"].map(rowFromString))
+    const rootDir = tmpDirs[tmpDirs.length - 1]
+
+    const reopened = new ScrollbackArchive({ rootDir, maxBytes: 1024 * 1024, chunkMaxLines: 2 })
+    expect(reopened.candidateRanges("error", 0, 4)).toEqual([[2, 4]])
+    reopened.clearCache()
+
+    // A sidecar from before the last append no longer covers every line
+    const sidecar = path.join(rootDir, "chunk-1.tri")
+    const data = fs.readFileSync(sidecar)
+    data.writeUInt32LE(1, 0)
+    fs.writeFileSync(sidecar, data)
+    fs.rmSync(path.join(rootDir, "chunk-2.tri"))
+
+    const stale = new ScrollbackArchive({ rootDir, maxBytes: 1024 * 1024, chunkMaxLines: 2 })
+    expect(stale.candidateRanges("error", 0, 4)).toEqual([[0, 4]])
+    stale.clearCache()
+  })
+})
+
+describe("ScrollbackArchiveManager", () => {
+  const lines = (count: number, prefix: string) =>
+    Array.from({ length: count }, (_, i) => rowFromString(`${prefix}${String(i).padStart(3, "0")}`))
+
+  it("evicts the globally oldest chunk and keeps a running total", async () => {
+    const manager = new ScrollbackArchiveManager(1024 * 1024)
+    const first = createArchive({ chunkMaxLines: 2, manager })
+    const second = createArchive({ chunkMaxLines: 2, manager })
+    await first.appendLines(lines(4, "a"))
+    await new Promise((resolve) => setTimeout(resolve, 5))
+    await second.appendLines(lines(4, "b"))
+    expect(manager.bytes).toBe(first.bytes + second.bytes)
+
+    // Lower the budget to just under the current total
+    const tight = new ScrollbackArchiveManager(first.bytes + second.bytes - 1)
+    const a = createArchive({ chunkMaxLines: 2, manager: tight })
+    await a.appendLines(lines(4, "a"))
+    await new Promise((resolve) => setTimeout(resolve, 5))
+    const b = createArchive({ chunkMaxLines: 2, manager: tight })
+    await b.appendLines(lines(4, "b"))
+
+    expect(a.length).toBe(2)
+    expect(lineText(a.getLine(0))).toBe("a002")
+    expect(b.length).toBe(4)
+    expect(tight.bytes).toBe(a.bytes + b.bytes)
+
+    a.dispose()
+    expect(tight.bytes).toBe(b.bytes)
+    for (const archive of [first, second, b]) archive.dispose()
+  })
+
+  it("evicts from archives over their quota before older history elsewhere", async () => {
+    const manager = new ScrollbackArchiveManager(1000)
+    const quiet = createArchive({ chunkMaxLines: 2, manager })
+    await quiet.appendLines(lines(2, "q"))
+    const noisy = createArchive({ chunkMaxLines: 2, manager })
+    for (let i = 0; i < 10; i++) {
+      await noisy.appendLines(lines(10, `n${i}-`))
+    }
+
+    // The quiet pane's chunk is the oldest, but it is within its share
+    expect(quiet.length).toBe(2)
+    expect(noisy.length).toBeLessThan(100)
+    expect(manager.bytes).toBeLessThanOrEqual(1000)
+    expect(manager.bytes).toBe(quiet.bytes + noisy.bytes)
+
+    // Without a share of its own, the quiet pane goes first
+    manager.setWeight(quiet, 0)
+    await noisy.appendLines(lines(10, "n10-"))
+    expect(quiet.length).toBe(0)
+    quiet.dispose()
+    noisy.dispose()
+  })
+})
@@ -0,0 +1,87 @@
+/**
+ * Tests for cooperative, nearest-first search jobs.
+ */
+
+import { describe, it, expect } from "bun:test";
+import type { SearchMatch } from '../../src/terminal/emulator-interface';
+import { SEARCH_LINES_PER_STEP, runNumberedSearch, runSearchJob, searchSteps } from '../../src/terminal/search-job';
+import { searchLines } from '../../src/terminal/ghostty-vt/terminal-search';
+
+describe('searchSteps', () => {
+  it('runs oldest to newest without an anchor', () => {
+    expect(searchSteps(0, 25, 10)).toEqual([[0, 10], [10, 20], [20, 25]]);
+    expect(searchSteps(5, 5, 10)).toEqual([]);
+  });
+
+  it('starts at the anchor and alternates outward', () => {
+    expect(searchSteps(0, 50, 10, 25)).toEqual([[20, 30], [10, 20], [30, 40], [0, 10], [40, 50]]);
+  });
+
+  it('clamps the anchor to the range', () => {
+    expect(searchSteps(0, 30, 10, 1000)).toEqual([[24, 30], [14, 24], [4, 14], [0, 4]]);
+  });
+});
+
+describe('runSearchJob', () => {
+  const lineCount = SEARCH_LINES_PER_STEP * 3;
+  const getText = (index: number) => (index % 1000 === 0 ? `hit ${index}` : 'miss');
+  const search = (start: number, end: number, limit: number) => searchLines('hit', limit, start, end, getText);
+
+  it('streams batches nearest the anchor first and returns sorted matches', async () => {
+    const batches: SearchMatch[][] = [];
+    const result = await runSearchJob(
+      { anchor: lineCount - 1, onMatches: (batch) => batches.push(batch) },
+      lineCount,
+      search
+    );
+
+    expect(batches[0][0].lineIndex).toBeGreaterThanOrEqual(lineCount - SEARCH_LINES_PER_STEP);
+    expect(result.matches).toHaveLength(lineCount / 1000);
+    expect(result.matches.map((m) => m.lineIndex)).toEqual(
+      [...result.matches.map((m) => m.lineIndex)].sort((a, b) => a - b)
+    );
+    expect(result.hasMore).toBe(false);
+  });
+
+  it('keeps the nearest matches when the limit is hit', async () => {
+    const result = await runSearchJob({ anchor: lineCount - 1, limit: 2 }, lineCount, search);
+    expect(result.matches.map((m) => m.lineIndex)).toEqual([lineCount - 2000, lineCount - 1000]);
+    expect(result.hasMore).toBe(true);
+  });
+
+  it('honours startLine and endLine', async () => {
+    const result = await runSearchJob({ startLine: 1500, endLine: 3001 }, lineCount, search);
+    expect(result.matches.map((m) => m.lineIndex)).toEqual([2000, 3000]);
+  });
+
+  it('stops between steps once aborted', async () => {
+    const controller = new AbortController();
+    let steps = 0;
+    const result = await runSearchJob({ signal: controller.signal }, lineCount, (start, end, limit) => {
+      steps += 1;
+      controller.abort();
+      return search(start, end, limit);
+    });
+    expect(steps).toBe(1);
+    expect(result.hasMore).toBe(true);
+  });
+});
+
+describe('runNumberedSearch', () => {
+  it('reports the numbering the matches refer to', async () => {
+    const numbering = { epoch: 1, dropped: 10 };
+    const result = await runNumberedSearch(() => numbering, async () => ({ matches: [], hasMore: false }));
+    expect(result.numbering).toEqual(numbering);
+    expect(result.renumbered).toBeUndefined();
+  });
+
+  it('flags lines renumbered during the search', async () => {
+    let dropped = 0;
+    const result = await runNumberedSearch(() => ({ epoch: 0, dropped }), async () => {
+      dropped = 5;
+      return { matches: [], hasMore: false };
+    });
+    expect(result.numbering).toEqual({ epoch: 0, dropped: 5 });
+    expect(result.renumbered).toBe(true);
+  });
+});
@@ -7,9 +7,28 @@ import { createSyncModeParser } from '../../src/terminal/sync-mode-parser'
 const SYNC_SET = '\x1b[?2026h'
 const SYNC_RESET = '\x1b[?2026l'
 
+const encoder = new TextEncoder()
+const decoder = new TextDecoder()
+
+// The parser works on bytes; adapt it to strings to keep assertions readable.
+function createParser() {
+  const parser = createSyncModeParser()
+  return {
+    process(data: string) {
+      const result = parser.process(encoder.encode(data))
+      return {
+        readySegments: result.readySegments.map((segment) => decoder.decode(segment)),
+        isBuffering: result.isBuffering,
+      }
+    },
+    flush: () => decoder.decode(parser.flush()),
+    isInSyncMode: () => parser.isInSyncMode(),
+  }
+}
+
 describe('SyncModeParser', () => {
   test('passes through data without sync sequences', () => {
-    const parser = createSyncModeParser()
+    const parser = createParser()
     const result = parser.process('hello world')
 
     expect(result.readySegments).toEqual(['hello world'])
@@ -17,7 +36,7 @@ describe('SyncModeParser', () => {
   })
 
   test('buffers content between sync start and end', () => {
-    const parser = createSyncModeParser()
+    const parser = createParser()
 
     // Sync start - should start buffering
     const result1 = parser.process(`${SYNC_SET}frame content`)
@@ -31,7 +50,7 @@ describe('SyncModeParser', () => {
   })
 
   test('emits content before sync start', () => {
-    const parser = createSyncModeParser()
+    const parser = createParser()
     const result = parser.process(`prefix${SYNC_SET}buffered`)
 
     expect(result.readySegments).toEqual(['prefix'])
@@ -39,7 +58,7 @@ describe('SyncModeParser', () => {
   })
 
   test('emits content after sync end', () => {
-    const parser = createSyncModeParser()
+    const parser = createParser()
 
     parser.process(`${SYNC_SET}frame`)
     const result = parser.process(`${SYNC_RESET}suffix`)
@@ -49,7 +68,7 @@ describe('SyncModeParser', () => {
   })
 
   test('handles multiple sync frames in one chunk', () => {
-    const parser = createSyncModeParser()
+    const parser = createParser()
     const data = `${SYNC_SET}frame1${SYNC_RESET}between${SYNC_SET}frame2${SYNC_RESET}`
     const result = parser.process(data)
 
@@ -58,7 +77,7 @@ describe('SyncModeParser', () => {
   })
 
   test('handles split sync sequences across chunks', () => {
-    const parser = createSyncModeParser()
+    const parser = createParser()
 
     // Partial sync start sequence
     const result1 = parser.process('hello\x1b[?2026')
@@ -79,7 +98,7 @@ describe('SyncModeParser', () => {
   })
 
   test('flush returns buffered content and resets state', () => {
-    const parser = createSyncModeParser()
+    const parser = createParser()
 
     parser.process(`${SYNC_SET}buffered content`)
     expect(parser.isInSyncMode()).toBe(true)
@@ -90,7 +109,7 @@ describe('SyncModeParser', () => {
   })
 
   test('flush returns partial escape sequences', () => {
-    const parser = createSyncModeParser()
+    const parser = createParser()
 
     parser.process('data\x1b[?20')
     const flushed = parser.flush()
@@ -99,7 +118,7 @@ describe('SyncModeParser', () => {
   })
 
   test('handles empty data', () => {
-    const parser = createSyncModeParser()
+    const parser = createParser()
     const result = parser.process('')
 
     expect(result.readySegments).toEqual([])
@@ -107,7 +126,7 @@ describe('SyncModeParser', () => {
   })
 
   test('handles just sync sequences without content', () => {
-    const parser = createSyncModeParser()
+    const parser = createParser()
     const result = parser.process(`${SYNC_SET}${SYNC_RESET}`)
 
     expect(result.readySegments).toEqual([])
@@ -115,7 +134,7 @@ describe('SyncModeParser', () => {
   })
 
   test('handles nested-looking sequences (not actually nested)', () => {
-    const parser = createSyncModeParser()
+    const parser = createParser()
 
     // Sync mode doesn't actually nest - second start is just content
     const result = parser.process(`${SYNC_SET}start${SYNC_SET}more${SYNC_RESET}`)
@@ -124,4 +143,13 @@ describe('SyncModeParser', () => {
     expect(result.readySegments).toEqual([`start${SYNC_SET}more`])
     expect(result.isBuffering).toBe(false)
   })
+
+  test('passes plain bytes through without copying', () => {
+    const parser = createSyncModeParser()
+    const input = encoder.encode('plain output')
+    const result = parser.process(input)
+
+    expect(result.readySegments).toHaveLength(1)
+    expect(result.readySegments[0].buffer).toBe(input.buffer)
+  })
 })
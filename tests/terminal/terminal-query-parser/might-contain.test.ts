@@ -3,7 +3,7 @@
  */
 
 import { describe, test, expect } from "bun:test";
-import { mightContainQueries } from '../../../src/terminal/terminal-query-passthrough/parser';
+import { mightContainQueries, mightContainQueriesBytes } from '../../../src/terminal/terminal-query-passthrough/parser';
 import {
   ESC,
   BEL,
@@ -132,5 +132,30 @@ describe('mightContainQueries', () => {
       expect(mightContainQueries(`hello${DSR_CPR_QUERY}world`)).toBe(true);
     });
   });
-});
 
+  describe('byte form', () => {
+    const samples = [
+      'hello world',
+      '123456789',
+      `${ESC}[1mbold${ESC}[0m`,
+      `${ESC}[31m2t`,
+      DSR_CPR_QUERY,
+      DA2_QUERY,
+      XTVERSION_QUERY,
+      KITTY_KEYBOARD_QUERY,
+      DECXCPR_QUERY,
+      OSC_FG_QUERY_BEL,
+      `${ESC}]0;title${BEL}`,
+      `${DCS}+q${ST}`,
+      `\x9b6n`,
+      `caf\u00e9 ${ESC}[0m`,
+    ];
+
+    for (const sample of samples) {
+      test(`matches string form for ${JSON.stringify(sample)}`, () => {
+        const bytes = new TextEncoder().encode(sample);
+        expect(mightContainQueriesBytes(bytes)).toBe(mightContainQueries(sample));
+      });
+    }
+  });
+});
@@ -105,4 +105,33 @@ describe('TerminalQueryPassthrough', () => {
     expect(result.responses).toEqual([generateDa1Response()]);
     expect(responses).toHaveLength(0);
   });
+
+  it('returns plain byte output as the same view', () => {
+    const passthrough = new TerminalQueryPassthrough();
+    const data = new TextEncoder().encode(`${ESC}[1mbold${ESC}[0m text`);
+
+    expect(passthrough.processBytes(data)).toBe(data);
+  });
+
+  it('answers queries in byte output', () => {
+    const passthrough = new TerminalQueryPassthrough();
+    const responses: string[] = [];
+    passthrough.setPtyWriter((response) => responses.push(response));
+
+    const result = passthrough.processBytes(new TextEncoder().encode(`a${ESC}[cb`));
+
+    expect(new TextDecoder().decode(result)).toBe('ab');
+    expect(responses).toEqual([generateDa1Response()]);
+  });
+
+  it('holds back byte output that ends inside a sequence', () => {
+    const passthrough = new TerminalQueryPassthrough();
+    const encoder = new TextEncoder();
+
+    const first = passthrough.processBytes(encoder.encode(`text${ESC}[`));
+    const second = passthrough.processBytes(encoder.encode('31m'));
+
+    expect(new TextDecoder().decode(first)).toBe('text');
+    expect(new TextDecoder().decode(second)).toBe(`${ESC}[31m`);
+  });
 });
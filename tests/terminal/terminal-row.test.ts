@@ -0,0 +1,100 @@
+/**
+ * Tests for packed terminal rows and the ghostty cell conversion into them
+ */
+
+import { describe, it, expect } from "bun:test";
+import { convertCompactRows, convertLineToRow } from '../../src/terminal/ghostty-emulator/cell-converter';
+import {
+  extractRowText,
+  rowCellAt,
+  rowFromCells,
+  rowToCells,
+} from '../../src/terminal/terminal-row';
+import type { GhosttyCell } from '../../src/terminal/ghostty-vt/types';
+import type { TerminalColors } from '../../src/terminal/terminal-colors';
+
+const colors: TerminalColors = {
+  foreground: 0xc0c0c0,
+  background: 0x101010,
+  palette: [],
+  isDefault: true,
+};
+
+function ghosttyCell(codepoint: number, overrides: Partial<GhosttyCell> = {}): GhosttyCell {
+  return {
+    codepoint,
+    fg_r: 255,
+    fg_g: 0,
+    fg_b: 0,
+    bg_r: 0,
+    bg_g: 0,
+    bg_b: 255,
+    flags: 0,
+    width: 1,
+    hyperlink_id: 0,
+    grapheme_len: 0,
+    ...overrides,
+  };
+}
+
+describe('terminal-row', () => {
+  it('converts a ghostty line with normalization and EOL fill', () => {
+    const row = convertLineToRow([
+      ghosttyCell(0x41, { flags: 1 | (1 << 7) }), // bold + faint
+      ghosttyCell(0x200b), // zero-width
+      ghosttyCell(0x65e5, { width: 2 }),
+      ghosttyCell(0, { width: 0 }),
+    ], 6, colors);
+
+    expect(extractRowText(row)).toBe('A 日  ');
+    expect(rowCellAt(row, 0)).toMatchObject({ char: 'A', bold: true, dim: true, fg: { r: 255, g: 0, b: 0 } });
+    // Zero-width cells hide their foreground
+    expect(row.fg[1]).toBe(row.bg[1]);
+    expect(row.widths[2]).toBe(2);
+    expect(row.fg[5]).toBe(colors.foreground);
+    expect(row.bg[5]).toBe(colors.background);
+  });
+
+  it('converts compact frames without cell objects', () => {
+    const cells = new Uint8Array(2 * 8);
+    const cellView = new DataView(cells.buffer);
+    cellView.setUint32(0, 0x78, true);
+    cellView.setUint16(4, 1, true);
+    cells[6] = 1;
+    cellView.setUint32(8, 0x79, true);
+    cells[14] = 1;
+    const styles = new Uint8Array([
+      1, 2, 3, 4, 5, 6, 0, 0,
+      9, 9, 9, 0, 0, 0, 1 << 4, 1,
+    ]);
+
+    const [row] = convertCompactRows({ rows: [0], cells, styles, styleCount: 2 }, 2);
+    expect(extractRowText(row)).toBe('xy');
+    expect(row.fg[0]).toBe(0x090909);
+    expect(rowCellAt(row, 0)).toMatchObject({ inverse: true, hyperlinkId: 1 });
+    expect(row.bg[1]).toBe(0x040506);
+  });
+
+  it('round-trips cells and shares color objects when materializing', () => {
+    const fg = { r: 1, g: 2, b: 3 };
+    const bg = { r: 4, g: 5, b: 6 };
+    const base = {
+      fg,
+      bg,
+      bold: false,
+      italic: true,
+      underline: false,
+      strikethrough: false,
+      inverse: false,
+      blink: false,
+      dim: false,
+      width: 1 as const,
+    };
+    const row = rowFromCells([{ ...base, char: 'a' }, { ...base, char: 'b' }], 3);
+    const cells = rowToCells(row);
+
+    expect(cells.map((cell) => cell.char).join('')).toBe('ab ');
+    expect(cells[0]).toMatchObject({ fg, bg, italic: true });
+    expect(cells[0].fg).toBe(cells[1].fg);
+  });
+});
@@ -0,0 +1,139 @@
+/**
+ * Tests for the JS line search used for archived lines and as the native fallback.
+ */
+
+import { describe, it, expect } from "bun:test";
+import type { TerminalCell } from '../../src/core/types';
+import {
+  cellsLineText,
+  compileSearchRegex,
+  regexMatches,
+  rowLineText,
+  searchLines,
+  searchLinesRegex,
+  searchWrappedLinesRegex,
+} from '../../src/terminal/ghostty-vt/terminal-search';
+import { rowFromCells } from '../../src/terminal/terminal-row';
+
+const black = { r: 0, g: 0, b: 0 };
+
+function cells(text: string, cols = text.length): TerminalCell[] {
+  const out: TerminalCell[] = [];
+  for (const char of text) {
+    const wide = char.codePointAt(0)! >= 0x3000;
+    out.push({
+      char,
+      fg: black,
+      bg: black,
+      bold: false,
+      italic: false,
+      underline: false,
+      strikethrough: false,
+      inverse: false,
+      blink: false,
+      dim: false,
+      width: wide ? 2 : 1,
+    });
+    if (wide) out.push({ ...out[out.length - 1], char: ' ', width: 1 });
+  }
+  while (out.length < cols) out.push({ ...out[0], char: ' ', width: 1 });
+  return out;
+}
+
+describe('terminal-search regex', () => {
+  it('maps matches to cell columns and trims trailing blanks', () => {
+    const line = cellsLineText(cells('日本 id=42', 16));
+    expect(line.text).toBe('日本 id=42');
+
+    const regex = compileSearchRegex('id=\\d+$')!;
+    const match = regex.exec(line.text)!;
+    expect(line.columns[match.index]).toBe(5);
+    expect(line.columns[match.index + match[0].length]).toBe(10);
+
+    expect(rowLineText(rowFromCells(cells('ab  ', 4))).text).toBe('ab');
+  });
+
+  it('rejects invalid patterns', () => {
+    expect(compileSearchRegex('(')).toBeNull();
+    expect(compileSearchRegex('')).toBeNull();
+  });
+
+  it('searches lines case-insensitively with a limit', () => {
+    const lines = ['REQ-1 req-22', 'nothing', 'req-333'].map((text) => cellsLineText(cells(text)));
+    const regex = compileSearchRegex('req-\\d+')!;
+
+    const all = searchLinesRegex(regex, 10, 0, lines.length, (i) => lines[i]);
+    expect(all.matches).toEqual([
+      { lineIndex: 0, startCol: 0, endCol: 5 },
+      { lineIndex: 0, startCol: 6, endCol: 12 },
+      { lineIndex: 2, startCol: 0, endCol: 7 },
+    ]);
+    expect(all.hasMore).toBe(false);
+
+    const limited = searchLinesRegex(regex, 2, 0, lines.length, (i) => lines[i]);
+    expect(limited.matches).toHaveLength(2);
+    expect(limited.hasMore).toBe(true);
+
+    const ranged = searchLinesRegex(regex, 10, 1, 3, (i) => lines[i]);
+    expect(ranged.matches).toEqual([{ lineIndex: 2, startCol: 0, endCol: 7 }]);
+  });
+
+  it('skips empty matches', () => {
+    const lines = [cellsLineText(cells('xax'))];
+    const result = searchLinesRegex(compileSearchRegex('a*')!, 10, 0, 1, (i) => lines[i]);
+    expect(result.matches).toEqual([{ lineIndex: 0, startCol: 1, endCol: 2 }]);
+  });
+});
+
+describe('terminal-search wrapped regex', () => {
+  const rows = [cells('xabc'), cells('defg'), cells('h   '), cells('abcd')];
+  const wrapped = [true, true, false, false];
+  const search = (pattern: string, start: number, end: number, limit = 10) => {
+    const regex = compileSearchRegex(pattern)!;
+    return searchWrappedLinesRegex(
+      (text) => regexMatches(regex, text),
+      limit,
+      start,
+      end,
+      (i) => rows[i] ?? null,
+      (i) => wrapped[i] ?? false
+    );
+  };
+
+  it('matches across wrap points once per row', () => {
+    expect(search('c.*h$', 0, 4).matches).toEqual([
+      { lineIndex: 0, startCol: 3, endCol: 4 },
+      { lineIndex: 1, startCol: 0, endCol: 4 },
+      { lineIndex: 2, startCol: 0, endCol: 1 },
+    ]);
+  });
+
+  it('keeps only the segments inside the range', () => {
+    expect(search('c.*h$', 1, 2).matches).toEqual([{ lineIndex: 1, startCol: 0, endCol: 4 }]);
+    expect(search('cd', 2, 4).matches).toEqual([{ lineIndex: 3, startCol: 2, endCol: 4 }]);
+  });
+
+  it('reports more matches past the limit', () => {
+    const result = search('[a-d]', 0, 4, 3);
+    expect(result.matches).toHaveLength(3);
+    expect(result.hasMore).toBe(true);
+  });
+});
+
+describe('terminal-search literal', () => {
+  it('finds overlapping matches within the range', () => {
+    const lines = ['aaa', 'xAAx', 'aa'];
+    const result = searchLines('aa', 10, 1, 3, (i) => lines[i]);
+    expect(result.matches).toEqual([
+      { lineIndex: 1, startCol: 1, endCol: 3 },
+      { lineIndex: 2, startCol: 0, endCol: 2 },
+    ]);
+    expect(result.hasMore).toBe(false);
+  });
+
+  it('reports more matches past the limit, but not at an exact fit', () => {
+    const lines = ['x', 'x'];
+    expect(searchLines('x', 1, 0, 2, (i) => lines[i]).hasMore).toBe(true);
+    expect(searchLines('x', 2, 0, 2, (i) => lines[i]).hasMore).toBe(false);
+  });
+});